@@ -0,0 +1,145 @@
+/*****************************************************************************/
+/**
+ *  @file   main.cpp
+ *  @brief  Example program of the barrier over peer-to-peer TCP sockets.
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include <iostream>
+#include <vector>
+#include <kvs/CommandLine>
+#include <kvs/DisseminationBarrier>
+#include <kvs/SocketAddress>
+#include <kvs/IPAddress>
+#include <kvs/Timer>
+#include <kvs/Platform>
+#if !defined( KVS_PLATFORM_WINDOWS )
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+
+/*===========================================================================*/
+/**
+ *  @brief  Argument class.
+ */
+/*===========================================================================*/
+class Argument : public kvs::CommandLine
+{
+public:
+
+    Argument( int argc, char** argv ):
+        kvs::CommandLine( argc, argv )
+    {
+        addHelpOption();
+        addOption( "n", "Max. number of the local processes. (default: 16)", 1, false );
+        addOption( "loops", "Number of the barriers. (default: 1000)", 1, false );
+        addOption( "port", "First port number. (default: 6000)", 1, false );
+        addOption( "tree", "Use the tree algorithm.", 0, false );
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Runs the barriers as a rank.
+ *  @param  rank [in] rank
+ *  @param  addresses [in] addresses of all the ranks
+ *  @param  loops [in] number of the barriers
+ *  @param  tree [in] if true, the tree algorithm is used
+ *  @return true, if all the barriers succeed
+ */
+/*===========================================================================*/
+bool Run( const size_t rank, const std::vector<kvs::SocketAddress>& addresses, const int loops, const bool tree )
+{
+    kvs::DisseminationBarrier barrier( rank, addresses.size() );
+    if ( tree ) { barrier.setAlgorithmToTree(); }
+    if ( !barrier.connect( addresses ) ) { return false; }
+
+    // Warm up.
+    if ( !barrier.wait() ) { return false; }
+
+    kvs::Timer timer( kvs::Timer::Start );
+    for ( int i = 0; i < loops; i++ )
+    {
+        if ( !barrier.wait() ) { return false; }
+    }
+    timer.stop();
+
+    if ( rank == 0 )
+    {
+        std::cout << addresses.size() << " processes, "
+                  << barrier.numberOfRounds() << " rounds: "
+                  << timer.usec() / loops << " [usec/barrier]" << std::endl;
+    }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Main function.
+ *  @param  argc [in] argument count
+ *  @param  argv [in] argument values
+ */
+/*===========================================================================*/
+int main( int argc, char** argv )
+{
+    Argument argument( argc, argv );
+    if ( !argument.parse() ) exit( EXIT_FAILURE );
+
+    const int max_nprocs = argument.hasOption("n") ? argument.optionValue<int>("n") : 16;
+    const int loops = argument.hasOption("loops") ? argument.optionValue<int>("loops") : 1000;
+    const int port = argument.hasOption("port") ? argument.optionValue<int>("port") : 6000;
+    const bool tree = argument.hasOption("tree");
+
+#if defined( KVS_PLATFORM_WINDOWS )
+    kvsMessageError("This example needs fork() to run the local processes.");
+    return EXIT_FAILURE;
+#else
+    // Measure the latency by the number of the processes on the localhost.
+    for ( int nprocs = 2; nprocs <= max_nprocs; nprocs *= 2 )
+    {
+        std::vector<kvs::SocketAddress> addresses;
+        for ( int i = 0; i < nprocs; i++ )
+        {
+            addresses.push_back( kvs::SocketAddress( kvs::IPAddress("127.0.0.1"), port + i ) );
+        }
+
+        std::vector<pid_t> pids;
+        for ( int rank = 0; rank < nprocs; rank++ )
+        {
+            const pid_t pid = fork();
+            if ( pid == 0 )
+            {
+                const bool success = Run( rank, addresses, loops, tree );
+                std::cout << std::flush;
+                _exit( success ? EXIT_SUCCESS : EXIT_FAILURE );
+            }
+            pids.push_back( pid );
+        }
+
+        bool success = true;
+        for ( size_t i = 0; i < pids.size(); i++ )
+        {
+            int status = 0;
+            waitpid( pids[i], &status, 0 );
+            success = success && WIFEXITED( status ) && WEXITSTATUS( status ) == EXIT_SUCCESS;
+        }
+
+        if ( !success )
+        {
+            kvsMessageError("Barrier failed with %d processes.", nprocs );
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+#endif
+}
@@ -62,6 +62,7 @@ $(OUTDIR)/./FileFormat/GrADS/XYZDef.o \
 $(OUTDIR)/./FileFormat/IPLab/IPLab.o \
 $(OUTDIR)/./FileFormat/IPLab/IPLabList.o \
 $(OUTDIR)/./FileFormat/KVSML/CellTag.o \
+$(OUTDIR)/./FileFormat/KVSML/ChunkedData.o \
 $(OUTDIR)/./FileFormat/KVSML/ColorMapTag.o \
 $(OUTDIR)/./FileFormat/KVSML/ColorTag.o \
 $(OUTDIR)/./FileFormat/KVSML/ColumnTag.o \
@@ -71,6 +72,7 @@ $(OUTDIR)/./FileFormat/KVSML/DataArrayTag.o \
 $(OUTDIR)/./FileFormat/KVSML/DataReader.o \
 $(OUTDIR)/./FileFormat/KVSML/DataValueTag.o \
 $(OUTDIR)/./FileFormat/KVSML/DataWriter.o \
+$(OUTDIR)/./FileFormat/KVSML/ExternalDataWriter.o \
 $(OUTDIR)/./FileFormat/KVSML/ImageObjectTag.o \
 $(OUTDIR)/./FileFormat/KVSML/KVSMLImageObject.o \
 $(OUTDIR)/./FileFormat/KVSML/KVSMLLineObject.o \
@@ -113,6 +115,7 @@ $(OUTDIR)/./FileFormat/TIFF/ImageFileDirectory.o \
 $(OUTDIR)/./FileFormat/TIFF/Tag.o \
 $(OUTDIR)/./FileFormat/TIFF/TagDictionary.o \
 $(OUTDIR)/./FileFormat/TIFF/Tiff.o \
+$(OUTDIR)/./FileFormat/TimeSeries/UnstructuredTimeSeries.o \
 $(OUTDIR)/./FileFormat/XML/TinyXML.o \
 $(OUTDIR)/./FileFormat/XML/XMLComment.o \
 $(OUTDIR)/./FileFormat/XML/XMLDeclaration.o \
@@ -150,14 +153,17 @@ $(OUTDIR)/./NanoVG/NanoVG.o \
 $(OUTDIR)/./NanoVG/nvg.o \
 $(OUTDIR)/./Network/Acceptor.o \
 $(OUTDIR)/./Network/Connector.o \
+$(OUTDIR)/./Network/DisseminationBarrier.o \
 $(OUTDIR)/./Network/HttpConnector.o \
 $(OUTDIR)/./Network/HttpRequestHeader.o \
 $(OUTDIR)/./Network/IPAddress.o \
 $(OUTDIR)/./Network/MessageBlock.o \
 $(OUTDIR)/./Network/Socket.o \
 $(OUTDIR)/./Network/SocketAddress.o \
+$(OUTDIR)/./Network/SocketEventLoop.o \
 $(OUTDIR)/./Network/SocketSelector.o \
 $(OUTDIR)/./Network/SocketTimer.o \
+$(OUTDIR)/./Network/SortLastCompositor.o \
 $(OUTDIR)/./Network/TCPBarrier.o \
 $(OUTDIR)/./Network/TCPBarrierServer.o \
 $(OUTDIR)/./Network/TCPServer.o \
@@ -168,6 +174,7 @@ $(OUTDIR)/./Numeric/EigenDecomposer.o \
 $(OUTDIR)/./Numeric/FastKMeans.o \
 $(OUTDIR)/./Numeric/GaussEliminationSolver.o \
 $(OUTDIR)/./Numeric/KMeans.o \
+$(OUTDIR)/./Numeric/KdTree.o \
 $(OUTDIR)/./Numeric/LUDecomposer.o \
 $(OUTDIR)/./Numeric/LUSolver.o \
 $(OUTDIR)/./Numeric/MersenneTwister.o \
@@ -177,6 +184,7 @@ $(OUTDIR)/./Numeric/Quaternion.o \
 $(OUTDIR)/./Numeric/ResponseSurface.o \
 $(OUTDIR)/./Numeric/SVDecomposer.o \
 $(OUTDIR)/./Numeric/SVSolver.o \
+$(OUTDIR)/./Numeric/ValueStatistics.o \
 $(OUTDIR)/./Numeric/Xorshift128.o \
 $(OUTDIR)/./OpenGL/BufferObject.o \
 $(OUTDIR)/./OpenGL/DisplayList.o \
@@ -210,13 +218,17 @@ $(OUTDIR)/./Thread/ReadWriteLock.o \
 $(OUTDIR)/./Thread/Semaphore.o \
 $(OUTDIR)/./Thread/Thread.o \
 $(OUTDIR)/./Thread/WriteLocker.o \
+$(OUTDIR)/./Utility/AlignedAllocator.o \
+$(OUTDIR)/./Utility/Allocator.o \
 $(OUTDIR)/./Utility/AnyValue.o \
 $(OUTDIR)/./Utility/AnyValueArray.o \
 $(OUTDIR)/./Utility/AnyValueTable.o \
+$(OUTDIR)/./Utility/ArenaAllocator.o \
 $(OUTDIR)/./Utility/BitArray.o \
 $(OUTDIR)/./Utility/CommandLine.o \
 $(OUTDIR)/./Utility/Date.o \
 $(OUTDIR)/./Utility/Directory.o \
+$(OUTDIR)/./Utility/FastCompressor.o \
 $(OUTDIR)/./Utility/FastTokenizer.o \
 $(OUTDIR)/./Utility/File.o \
 $(OUTDIR)/./Utility/Indent.o \
@@ -267,11 +279,15 @@ $(OUTDIR)/./Visualization/Exporter/UnstructuredVolumeExporter.o \
 $(OUTDIR)/./Visualization/Filter/InverseDistanceWeighting.o \
 $(OUTDIR)/./Visualization/Filter/KMeansClustering.o \
 $(OUTDIR)/./Visualization/Filter/LineIntegralConvolution.o \
+$(OUTDIR)/./Visualization/Filter/PolygonDecimation.o \
+$(OUTDIR)/./Visualization/Filter/PolygonReordering.o \
+$(OUTDIR)/./Visualization/Filter/ScatteredDataInterpolation.o \
 $(OUTDIR)/./Visualization/Filter/StructuredVectorToScalar.o \
 $(OUTDIR)/./Visualization/Filter/TetrahedraToTetrahedra.o \
 $(OUTDIR)/./Visualization/Filter/Tubeline.o \
 $(OUTDIR)/./Visualization/Filter/UnstructuredGradient.o \
 $(OUTDIR)/./Visualization/Filter/UnstructuredQCriterion.o \
+$(OUTDIR)/./Visualization/Filter/UnstructuredReordering.o \
 $(OUTDIR)/./Visualization/Filter/UnstructuredVectorToScalar.o \
 $(OUTDIR)/./Visualization/Importer/ImageImporter.o \
 $(OUTDIR)/./Visualization/Importer/LineImporter.o \
@@ -337,6 +353,7 @@ $(OUTDIR)/./Visualization/Object/PolygonObject.o \
 $(OUTDIR)/./Visualization/Object/StructuredVolumeObject.o \
 $(OUTDIR)/./Visualization/Object/TableObject.o \
 $(OUTDIR)/./Visualization/Object/UnstructuredVolumeObject.o \
+$(OUTDIR)/./Visualization/Object/UnstructuredVolumeTimeSeries.o \
 $(OUTDIR)/./Visualization/Object/VolumeObjectBase.o \
 $(OUTDIR)/./Visualization/Pipeline/ObjectImporter.o \
 $(OUTDIR)/./Visualization/Pipeline/PipelineModule.o \
@@ -405,9 +422,11 @@ $(OUTDIR)/./Visualization/Viewer/ObjectCoordinate.o \
 $(OUTDIR)/./Visualization/Viewer/ObjectManager.o \
 $(OUTDIR)/./Visualization/Viewer/PaintDevice.o \
 $(OUTDIR)/./Visualization/Viewer/Painter.o \
+$(OUTDIR)/./Visualization/Viewer/RemoteRenderService.o \
 $(OUTDIR)/./Visualization/Viewer/RendererManager.o \
 $(OUTDIR)/./Visualization/Viewer/Scene.o \
 $(OUTDIR)/./Visualization/Viewer/ScreenBase.o \
+$(OUTDIR)/./Visualization/Viewer/TimeStepPlayer.o \
 $(OUTDIR)/./Visualization/Viewer/Trackball.o \
 $(OUTDIR)/./Visualization/Viewer/WindowCoordinate.o \
 $(OUTDIR)/./Visualization/Viewer/WorldCoordinate.o \
@@ -517,6 +536,10 @@ $(OUTDIR)/./FileFormat/XML/%.o: ./FileFormat/XML/%.cpp ./FileFormat/XML/%.h
 	$(MKDIR) $(OUTDIR)/./FileFormat/XML
 	$(CPP) -c $(CPPFLAGS) $(DEFINITIONS) $(INCLUDE_PATH) -o $@ $<
 
+$(OUTDIR)/./FileFormat/TimeSeries/%.o: ./FileFormat/TimeSeries/%.cpp ./FileFormat/TimeSeries/%.h
+	$(MKDIR) $(OUTDIR)/./FileFormat/TimeSeries
+	$(CPP) -c $(CPPFLAGS) $(DEFINITIONS) $(INCLUDE_PATH) -o $@ $<
+
 $(OUTDIR)/./FileFormat/TIFF/%.o: ./FileFormat/TIFF/%.cpp ./FileFormat/TIFF/%.h
 	$(MKDIR) $(OUTDIR)/./FileFormat/TIFF
 	$(CPP) -c $(CPPFLAGS) $(DEFINITIONS) $(INCLUDE_PATH) -o $@ $<
@@ -623,6 +646,8 @@ install::
 	$(INSTALL) ./FileFormat/STL/*.h $(INSTALL_DIR)/include/Core/./FileFormat/STL
 	$(MKDIR) $(INSTALL_DIR)/include/Core/./FileFormat/TIFF
 	$(INSTALL) ./FileFormat/TIFF/*.h $(INSTALL_DIR)/include/Core/./FileFormat/TIFF
+	$(MKDIR) $(INSTALL_DIR)/include/Core/./FileFormat/TimeSeries
+	$(INSTALL) ./FileFormat/TimeSeries/*.h $(INSTALL_DIR)/include/Core/./FileFormat/TimeSeries
 	$(MKDIR) $(INSTALL_DIR)/include/Core/./FileFormat/XML
 	$(INSTALL) ./FileFormat/XML/*.h $(INSTALL_DIR)/include/Core/./FileFormat/XML
 	$(MKDIR) $(INSTALL_DIR)/include/Core/./Image
@@ -62,6 +62,7 @@ $(OUTDIR)\.\FileFormat\GrADS\XYZDef.obj \
 $(OUTDIR)\.\FileFormat\IPLab\IPLab.obj \
 $(OUTDIR)\.\FileFormat\IPLab\IPLabList.obj \
 $(OUTDIR)\.\FileFormat\KVSML\CellTag.obj \
+$(OUTDIR)\.\FileFormat\KVSML\ChunkedData.obj \
 $(OUTDIR)\.\FileFormat\KVSML\ColorMapTag.obj \
 $(OUTDIR)\.\FileFormat\KVSML\ColorTag.obj \
 $(OUTDIR)\.\FileFormat\KVSML\ColumnTag.obj \
@@ -71,6 +72,7 @@ $(OUTDIR)\.\FileFormat\KVSML\DataArrayTag.obj \
 $(OUTDIR)\.\FileFormat\KVSML\DataReader.obj \
 $(OUTDIR)\.\FileFormat\KVSML\DataValueTag.obj \
 $(OUTDIR)\.\FileFormat\KVSML\DataWriter.obj \
+$(OUTDIR)\.\FileFormat\KVSML\ExternalDataWriter.obj \
 $(OUTDIR)\.\FileFormat\KVSML\ImageObjectTag.obj \
 $(OUTDIR)\.\FileFormat\KVSML\KVSMLImageObject.obj \
 $(OUTDIR)\.\FileFormat\KVSML\KVSMLLineObject.obj \
@@ -113,6 +115,7 @@ $(OUTDIR)\.\FileFormat\TIFF\ImageFileDirectory.obj \
 $(OUTDIR)\.\FileFormat\TIFF\Tag.obj \
 $(OUTDIR)\.\FileFormat\TIFF\TagDictionary.obj \
 $(OUTDIR)\.\FileFormat\TIFF\Tiff.obj \
+$(OUTDIR)\.\FileFormat\TimeSeries\UnstructuredTimeSeries.obj \
 $(OUTDIR)\.\FileFormat\XML\TinyXML.obj \
 $(OUTDIR)\.\FileFormat\XML\XMLComment.obj \
 $(OUTDIR)\.\FileFormat\XML\XMLDeclaration.obj \
@@ -150,14 +153,17 @@ $(OUTDIR)\.\NanoVG\NanoVG.obj \
 $(OUTDIR)\.\NanoVG\nvg.obj \
 $(OUTDIR)\.\Network\Acceptor.obj \
 $(OUTDIR)\.\Network\Connector.obj \
+$(OUTDIR)\.\Network\DisseminationBarrier.obj \
 $(OUTDIR)\.\Network\HttpConnector.obj \
 $(OUTDIR)\.\Network\HttpRequestHeader.obj \
 $(OUTDIR)\.\Network\IPAddress.obj \
 $(OUTDIR)\.\Network\MessageBlock.obj \
 $(OUTDIR)\.\Network\Socket.obj \
 $(OUTDIR)\.\Network\SocketAddress.obj \
+$(OUTDIR)\.\Network\SocketEventLoop.obj \
 $(OUTDIR)\.\Network\SocketSelector.obj \
 $(OUTDIR)\.\Network\SocketTimer.obj \
+$(OUTDIR)\.\Network\SortLastCompositor.obj \
 $(OUTDIR)\.\Network\TCPBarrier.obj \
 $(OUTDIR)\.\Network\TCPBarrierServer.obj \
 $(OUTDIR)\.\Network\TCPServer.obj \
@@ -168,6 +174,7 @@ $(OUTDIR)\.\Numeric\EigenDecomposer.obj \
 $(OUTDIR)\.\Numeric\FastKMeans.obj \
 $(OUTDIR)\.\Numeric\GaussEliminationSolver.obj \
 $(OUTDIR)\.\Numeric\KMeans.obj \
+$(OUTDIR)\.\Numeric\KdTree.obj \
 $(OUTDIR)\.\Numeric\LUDecomposer.obj \
 $(OUTDIR)\.\Numeric\LUSolver.obj \
 $(OUTDIR)\.\Numeric\MersenneTwister.obj \
@@ -177,6 +184,7 @@ $(OUTDIR)\.\Numeric\Quaternion.obj \
 $(OUTDIR)\.\Numeric\ResponseSurface.obj \
 $(OUTDIR)\.\Numeric\SVDecomposer.obj \
 $(OUTDIR)\.\Numeric\SVSolver.obj \
+$(OUTDIR)\.\Numeric\ValueStatistics.obj \
 $(OUTDIR)\.\Numeric\Xorshift128.obj \
 $(OUTDIR)\.\OpenGL\BufferObject.obj \
 $(OUTDIR)\.\OpenGL\DisplayList.obj \
@@ -210,13 +218,17 @@ $(OUTDIR)\.\Thread\ReadWriteLock.obj \
 $(OUTDIR)\.\Thread\Semaphore.obj \
 $(OUTDIR)\.\Thread\Thread.obj \
 $(OUTDIR)\.\Thread\WriteLocker.obj \
+$(OUTDIR)\.\Utility\AlignedAllocator.obj \
+$(OUTDIR)\.\Utility\Allocator.obj \
 $(OUTDIR)\.\Utility\AnyValue.obj \
 $(OUTDIR)\.\Utility\AnyValueArray.obj \
 $(OUTDIR)\.\Utility\AnyValueTable.obj \
+$(OUTDIR)\.\Utility\ArenaAllocator.obj \
 $(OUTDIR)\.\Utility\BitArray.obj \
 $(OUTDIR)\.\Utility\CommandLine.obj \
 $(OUTDIR)\.\Utility\Date.obj \
 $(OUTDIR)\.\Utility\Directory.obj \
+$(OUTDIR)\.\Utility\FastCompressor.obj \
 $(OUTDIR)\.\Utility\FastTokenizer.obj \
 $(OUTDIR)\.\Utility\File.obj \
 $(OUTDIR)\.\Utility\Indent.obj \
@@ -267,11 +279,15 @@ $(OUTDIR)\.\Visualization\Exporter\UnstructuredVolumeExporter.obj \
 $(OUTDIR)\.\Visualization\Filter\InverseDistanceWeighting.obj \
 $(OUTDIR)\.\Visualization\Filter\KMeansClustering.obj \
 $(OUTDIR)\.\Visualization\Filter\LineIntegralConvolution.obj \
+$(OUTDIR)\.\Visualization\Filter\PolygonDecimation.obj \
+$(OUTDIR)\.\Visualization\Filter\PolygonReordering.obj \
+$(OUTDIR)\.\Visualization\Filter\ScatteredDataInterpolation.obj \
 $(OUTDIR)\.\Visualization\Filter\StructuredVectorToScalar.obj \
 $(OUTDIR)\.\Visualization\Filter\TetrahedraToTetrahedra.obj \
 $(OUTDIR)\.\Visualization\Filter\Tubeline.obj \
 $(OUTDIR)\.\Visualization\Filter\UnstructuredGradient.obj \
 $(OUTDIR)\.\Visualization\Filter\UnstructuredQCriterion.obj \
+$(OUTDIR)\.\Visualization\Filter\UnstructuredReordering.obj \
 $(OUTDIR)\.\Visualization\Filter\UnstructuredVectorToScalar.obj \
 $(OUTDIR)\.\Visualization\Importer\ImageImporter.obj \
 $(OUTDIR)\.\Visualization\Importer\LineImporter.obj \
@@ -337,6 +353,7 @@ $(OUTDIR)\.\Visualization\Object\PolygonObject.obj \
 $(OUTDIR)\.\Visualization\Object\StructuredVolumeObject.obj \
 $(OUTDIR)\.\Visualization\Object\TableObject.obj \
 $(OUTDIR)\.\Visualization\Object\UnstructuredVolumeObject.obj \
+$(OUTDIR)\.\Visualization\Object\UnstructuredVolumeTimeSeries.obj \
 $(OUTDIR)\.\Visualization\Object\VolumeObjectBase.obj \
 $(OUTDIR)\.\Visualization\Pipeline\ObjectImporter.obj \
 $(OUTDIR)\.\Visualization\Pipeline\PipelineModule.obj \
@@ -405,9 +422,11 @@ $(OUTDIR)\.\Visualization\Viewer\ObjectCoordinate.obj \
 $(OUTDIR)\.\Visualization\Viewer\ObjectManager.obj \
 $(OUTDIR)\.\Visualization\Viewer\PaintDevice.obj \
 $(OUTDIR)\.\Visualization\Viewer\Painter.obj \
+$(OUTDIR)\.\Visualization\Viewer\RemoteRenderService.obj \
 $(OUTDIR)\.\Visualization\Viewer\RendererManager.obj \
 $(OUTDIR)\.\Visualization\Viewer\Scene.obj \
 $(OUTDIR)\.\Visualization\Viewer\ScreenBase.obj \
+$(OUTDIR)\.\Visualization\Viewer\TimeStepPlayer.obj \
 $(OUTDIR)\.\Visualization\Viewer\Trackball.obj \
 $(OUTDIR)\.\Visualization\Viewer\WindowCoordinate.obj \
 $(OUTDIR)\.\Visualization\Viewer\WorldCoordinate.obj \
@@ -559,6 +578,12 @@ $<
 $<
 <<
 
+{.\FileFormat\TimeSeries\}.cpp{$(OUTDIR)\.\FileFormat\TimeSeries\}.obj::
+	IF NOT EXIST $(OUTDIR)\.\FileFormat\TimeSeries $(MKDIR) $(OUTDIR)\.\FileFormat\TimeSeries
+	$(CPP) /c $(CPPFLAGS) $(DEFINITIONS) $(INCLUDE_PATH) /Fo$(OUTDIR)\.\FileFormat\TimeSeries\ @<<
+$<
+<<
+
 {.\FileFormat\TIFF\}.cpp{$(OUTDIR)\.\FileFormat\TIFF\}.obj::
 	IF NOT EXIST $(OUTDIR)\.\FileFormat\TIFF $(MKDIR) $(OUTDIR)\.\FileFormat\TIFF
 	$(CPP) /c $(CPPFLAGS) $(DEFINITIONS) $(INCLUDE_PATH) /Fo$(OUTDIR)\.\FileFormat\TIFF\ @<<
@@ -699,6 +724,8 @@ install::
 	$(INSTALL) .\FileFormat\STL\*.h $(INSTALL_DIR)\include\Core\.\FileFormat\STL
 	IF NOT EXIST $(INSTALL_DIR)\include\Core\.\FileFormat\TIFF $(MKDIR) $(INSTALL_DIR)\include\Core\.\FileFormat\TIFF
 	$(INSTALL) .\FileFormat\TIFF\*.h $(INSTALL_DIR)\include\Core\.\FileFormat\TIFF
+	IF NOT EXIST $(INSTALL_DIR)\include\Core\.\FileFormat\TimeSeries $(MKDIR) $(INSTALL_DIR)\include\Core\.\FileFormat\TimeSeries
+	$(INSTALL) .\FileFormat\TimeSeries\*.h $(INSTALL_DIR)\include\Core\.\FileFormat\TimeSeries
 	IF NOT EXIST $(INSTALL_DIR)\include\Core\.\FileFormat\XML $(MKDIR) $(INSTALL_DIR)\include\Core\.\FileFormat\XML
 	$(INSTALL) .\FileFormat\XML\*.h $(INSTALL_DIR)\include\Core\.\FileFormat\XML
 	IF NOT EXIST $(INSTALL_DIR)\include\Core\.\Image $(MKDIR) $(INSTALL_DIR)\include\Core\.\Image
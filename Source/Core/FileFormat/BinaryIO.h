@@ -0,0 +1,108 @@
+/*****************************************************************************/
+/**
+ *  @file   BinaryIO.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#pragma once
+#include <cstdio>
+#include <kvs/Type>
+#include <kvs/Endian>
+#include <kvs/Platform>
+
+
+namespace kvs
+{
+
+namespace detail
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Writes the integer in the little endian.
+ *  @param  p [out] pointer to the 8 bytes
+ *  @param  value [in] integer
+ */
+/*===========================================================================*/
+inline void Put64( kvs::UInt8* p, const kvs::UInt64 value )
+{
+    for ( size_t i = 0; i < 8; i++ ) { p[i] = static_cast<kvs::UInt8>( value >> ( 8 * i ) ); }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reads the integer in the little endian.
+ *  @param  p [in] pointer to the 8 bytes
+ *  @return integer
+ */
+/*===========================================================================*/
+inline kvs::UInt64 Get64( const kvs::UInt8* p )
+{
+    kvs::UInt64 value = 0;
+    for ( size_t i = 0; i < 8; i++ ) { value |= kvs::UInt64( p[i] ) << ( 8 * i ); }
+    return value;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Swaps the byte order of the values.
+ *  @param  data [in/out] values
+ *  @param  n [in] number of the values
+ *  @param  value_size [in] size of the value in bytes
+ */
+/*===========================================================================*/
+inline void Swap( void* data, const size_t n, const size_t value_size )
+{
+    switch ( value_size )
+    {
+    case 2: kvs::Endian::Swap( static_cast<kvs::UInt16*>( data ), n ); break;
+    case 4: kvs::Endian::Swap( static_cast<kvs::UInt32*>( data ), n ); break;
+    case 8: kvs::Endian::Swap( static_cast<kvs::UInt64*>( data ), n ); break;
+    default: break;
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Moves the position of the file with the 64-bit offset.
+ *  @param  fp [in] file pointer
+ *  @param  offset [in] offset in bytes
+ *  @param  origin [in] SEEK_SET, SEEK_CUR or SEEK_END
+ *  @return true, if the position is moved
+ */
+/*===========================================================================*/
+inline bool Seek( std::FILE* fp, const kvs::Int64 offset, const int origin )
+{
+#if defined( KVS_PLATFORM_WINDOWS )
+    return _fseeki64( fp, offset, origin ) == 0;
+#else
+    return fseeko( fp, static_cast<off_t>( offset ), origin ) == 0;
+#endif
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the 64-bit position of the file.
+ *  @param  fp [in] file pointer
+ *  @return position in bytes (-1, if failed)
+ */
+/*===========================================================================*/
+inline kvs::Int64 Tell( std::FILE* fp )
+{
+#if defined( KVS_PLATFORM_WINDOWS )
+    return _ftelli64( fp );
+#else
+    return static_cast<kvs::Int64>( ftello( fp ) );
+#endif
+}
+
+} // end of namespace detail
+
+} // end of namespace kvs
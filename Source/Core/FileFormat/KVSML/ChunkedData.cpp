@@ -0,0 +1,505 @@
+/*****************************************************************************/
+/**
+ *  @file   ChunkedData.cpp
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "ChunkedData.h"
+#include "../BinaryIO.h"
+#include <cstdio>
+#include <cstring>
+#include <kvs/Message>
+#include <kvs/Endian>
+#include <kvs/Math>
+#include <kvs/OpenMP>
+#include <kvs/FastCompressor>
+
+
+namespace
+{
+
+/// Version of the file.
+const kvs::UInt8 Version = 1;
+
+/// Size of the fixed part of the header in bytes.
+const size_t HeaderSize = 4 + 4 + 8 * 3;
+
+/*===========================================================================*/
+/**
+ *  @brief  Applies the filters to the chunk.
+ *  @param  src [in] values
+ *  @param  n [in] number of the values
+ *  @param  value_size [in] size of the value in bytes
+ *  @param  filter [in] filters
+ *  @param  dst [out] filtered bytes (n * value_size)
+ */
+/*===========================================================================*/
+void Filter(
+    const kvs::UInt8* src,
+    const size_t n,
+    const size_t value_size,
+    const int filter,
+    kvs::UInt8* dst )
+{
+    const bool shuffle = ( filter & kvs::kvsml::ChunkedData::Shuffle ) && value_size > 1;
+    const bool delta = ( filter & kvs::kvsml::ChunkedData::Delta ) != 0;
+    if ( shuffle )
+    {
+        // The b-th bytes of the values are stored in the b-th plane, and
+        // replaced by the difference from the previous byte of the plane.
+        for ( size_t b = 0; b < value_size; b++ )
+        {
+            const kvs::UInt8* s = src + b;
+            kvs::UInt8* d = dst + b * n;
+            kvs::UInt8 previous = 0;
+            for ( size_t i = 0; i < n; i++ )
+            {
+                const kvs::UInt8 value = s[ i * value_size ];
+                d[i] = delta ? static_cast<kvs::UInt8>( value - previous ) : value;
+                previous = value;
+            }
+        }
+    }
+    else if ( delta )
+    {
+        // Difference from the same byte of the previous value.
+        const size_t bytes = n * value_size;
+        for ( size_t i = 0; i < bytes; i++ )
+        {
+            dst[i] = i < value_size ? src[i] : static_cast<kvs::UInt8>( src[i] - src[ i - value_size ] );
+        }
+    }
+    else
+    {
+        std::memcpy( dst, src, n * value_size );
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Removes the filters from the chunk.
+ *  @param  src [in] filtered bytes
+ *  @param  n [in] number of the values
+ *  @param  value_size [in] size of the value in bytes
+ *  @param  filter [in] filters
+ *  @param  dst [out] values
+ */
+/*===========================================================================*/
+void Unfilter(
+    const kvs::UInt8* src,
+    const size_t n,
+    const size_t value_size,
+    const int filter,
+    kvs::UInt8* dst )
+{
+    const bool shuffle = ( filter & kvs::kvsml::ChunkedData::Shuffle ) && value_size > 1;
+    const bool delta = ( filter & kvs::kvsml::ChunkedData::Delta ) != 0;
+    if ( shuffle )
+    {
+        // The running sum is kept in the register in one pass of the plane.
+        for ( size_t b = 0; b < value_size; b++ )
+        {
+            const kvs::UInt8* s = src + b * n;
+            kvs::UInt8* d = dst + b;
+            kvs::UInt8 value = 0;
+            for ( size_t i = 0; i < n; i++ )
+            {
+                value = delta ? static_cast<kvs::UInt8>( value + s[i] ) : s[i];
+                d[ i * value_size ] = value;
+            }
+        }
+    }
+    else if ( delta )
+    {
+        const size_t bytes = n * value_size;
+        for ( size_t i = 0; i < bytes; i++ )
+        {
+            dst[i] = i < value_size ? src[i] : static_cast<kvs::UInt8>( src[i] + dst[ i - value_size ] );
+        }
+    }
+    else
+    {
+        std::memcpy( dst, src, n * value_size );
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Decodes the chunk.
+ *  @param  src [in] chunk data
+ *  @param  src_size [in] size of the chunk data in bytes
+ *  @param  n [in] number of the values in the chunk
+ *  @param  header [in] header
+ *  @param  dst [out] values
+ *  @return true, if the chunk is decoded successfully
+ */
+/*===========================================================================*/
+bool DecodeChunk(
+    const kvs::UInt8* src,
+    const size_t src_size,
+    const size_t n,
+    const kvs::kvsml::ChunkedData::Header& header,
+    kvs::UInt8* dst )
+{
+    const size_t bytes = n * header.value_size;
+    if ( src_size == bytes )
+    {
+        // Stored without the compression and the filters.
+        std::memcpy( dst, src, bytes );
+    }
+    else
+    {
+        std::vector<kvs::UInt8> buffer( bytes );
+        if ( !kvs::FastCompressor::Decompress( src, src_size, bytes > 0 ? &buffer[0] : NULL, bytes ) )
+        {
+            return false;
+        }
+        if ( bytes > 0 ) { ::Unfilter( &buffer[0], n, header.value_size, header.filter, dst ); }
+    }
+
+    if ( header.swap ) { kvs::detail::Swap( dst, n, header.value_size ); }
+    return true;
+}
+
+} // end of namespace
+
+
+namespace kvs
+{
+
+namespace kvsml
+{
+
+namespace ChunkedData
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the default filters for the value size.
+ *  @param  value_size [in] size of the value in bytes
+ *  @return filters
+ *
+ *  The byte shuffle gathers the exponents and the upper bytes, which vary
+ *  slowly in the fields, and the delta makes the smooth planes to zeros.
+ */
+/*===========================================================================*/
+int DefaultFilter( const size_t value_size )
+{
+    return value_size > 1 ? ( Shuffle | Delta ) : Delta;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Writes the values to the chunked data file.
+ *  @param  data [in] pointer to the values
+ *  @param  nelements [in] number of the values
+ *  @param  value_size [in] size of the value in bytes
+ *  @param  filename [in] filename
+ *  @param  filter [in] filters (combination of Filter)
+ *  @param  chunk_size [in] number of the values in a chunk (0: default)
+ *  @return true, if the writing process is done successfully
+ */
+/*===========================================================================*/
+bool Write(
+    const void* data,
+    const size_t nelements,
+    const size_t value_size,
+    const std::string& filename,
+    const int filter,
+    const size_t chunk_size )
+{
+    if ( value_size == 0 || value_size > 255 )
+    {
+        kvsMessageError( "Unsupported value size %d.", int( value_size ) );
+        return false;
+    }
+
+    const size_t nvalues = chunk_size > 0 ? chunk_size : kvs::Math::Max( DefaultChunkBytes / value_size, size_t( 1 ) );
+    const size_t nchunks = ( nelements + nvalues - 1 ) / nvalues;
+    const kvs::UInt8* values = static_cast<const kvs::UInt8*>( data );
+
+    // Encode the chunks in parallel.
+    std::vector< std::vector<kvs::UInt8> > chunks( nchunks );
+    KVS_OMP_PARALLEL_FOR( schedule(dynamic) )
+    for ( size_t i = 0; i < nchunks; i++ )
+    {
+        const size_t n = kvs::Math::Min( nvalues, nelements - i * nvalues );
+        const size_t bytes = n * value_size;
+        const kvs::UInt8* src = values + i * nvalues * value_size;
+
+        std::vector<kvs::UInt8> filtered( bytes );
+        ::Filter( src, n, value_size, filter, &filtered[0] );
+
+        std::vector<kvs::UInt8>& chunk = chunks[i];
+        chunk.resize( kvs::FastCompressor::MaxCompressedSize( bytes ) );
+        const size_t size = kvs::FastCompressor::Compress( &filtered[0], bytes, &chunk[0] );
+        if ( size < bytes )
+        {
+            chunk.resize( size );
+        }
+        else
+        {
+            chunk.assign( src, src + bytes );
+        }
+    }
+
+    // Header and chunk index.
+    std::vector<kvs::UInt8> header( ::HeaderSize + 16 * nchunks );
+    std::memcpy( &header[0], "KVSC", 4 );
+    header[4] = ::Version;
+    header[5] = kvs::Endian::IsBig() ? 1 : 0;
+    header[6] = static_cast<kvs::UInt8>( filter );
+    header[7] = static_cast<kvs::UInt8>( value_size );
+    kvs::detail::Put64( &header[8], nelements );
+    kvs::detail::Put64( &header[16], nvalues );
+    kvs::detail::Put64( &header[24], nchunks );
+    kvs::UInt64 offset = header.size();
+    for ( size_t i = 0; i < nchunks; i++ )
+    {
+        kvs::detail::Put64( &header[ ::HeaderSize + 16 * i ], offset );
+        kvs::detail::Put64( &header[ ::HeaderSize + 16 * i + 8 ], chunks[i].size() );
+        offset += chunks[i].size();
+    }
+
+    FILE* ofs = fopen( filename.c_str(), "wb" );
+    if ( !ofs )
+    {
+        kvsMessageError( "Cannot open '%s'.", filename.c_str() );
+        return false;
+    }
+
+    bool success = fwrite( &header[0], 1, header.size(), ofs ) == header.size();
+    for ( size_t i = 0; success && i < nchunks; i++ )
+    {
+        success = fwrite( &chunks[i][0], 1, chunks[i].size(), ofs ) == chunks[i].size();
+    }
+    success = ( fclose( ofs ) == 0 ) && success;
+    if ( !success )
+    {
+        kvsMessageError( "Cannot write '%s'.", filename.c_str() );
+        return false;
+    }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reads the header and the chunk index of the chunked data file.
+ *  @param  filename [in] filename
+ *  @param  header [out] pointer to the header
+ *  @return true, if the reading process is done successfully
+ */
+/*===========================================================================*/
+bool ReadHeader( const std::string& filename, Header* header )
+{
+    FILE* ifs = fopen( filename.c_str(), "rb" );
+    if ( !ifs )
+    {
+        kvsMessageError( "Cannot open '%s'.", filename.c_str() );
+        return false;
+    }
+
+    const kvs::Int64 end = kvs::detail::Seek( ifs, 0, SEEK_END ) ? kvs::detail::Tell( ifs ) : -1;
+    if ( end < 0 || !kvs::detail::Seek( ifs, 0, SEEK_SET ) )
+    {
+        kvsMessageError( "Cannot read '%s'.", filename.c_str() );
+        fclose( ifs );
+        return false;
+    }
+    const kvs::UInt64 file_size = static_cast<kvs::UInt64>( end );
+
+    kvs::UInt8 buffer[ ::HeaderSize ];
+    if ( fread( buffer, 1, ::HeaderSize, ifs ) != ::HeaderSize ||
+         std::memcmp( buffer, "KVSC", 4 ) != 0 || buffer[4] != ::Version )
+    {
+        kvsMessageError( "'%s' is not a chunked data file.", filename.c_str() );
+        fclose( ifs );
+        return false;
+    }
+
+    header->swap = ( buffer[5] != 0 ) != kvs::Endian::IsBig();
+    header->filter = buffer[6];
+    header->value_size = buffer[7];
+    header->nelements = static_cast<size_t>( kvs::detail::Get64( buffer + 8 ) );
+    header->chunk_size = static_cast<size_t>( kvs::detail::Get64( buffer + 16 ) );
+    const kvs::UInt64 nchunks = kvs::detail::Get64( buffer + 24 );
+
+    const bool valid =
+        header->value_size > 0 && header->chunk_size > 0 &&
+        nchunks == ( header->nelements + header->chunk_size - 1 ) / header->chunk_size &&
+        nchunks <= ( file_size - ::HeaderSize ) / 16;
+    if ( !valid )
+    {
+        kvsMessageError( "Broken header in '%s'.", filename.c_str() );
+        fclose( ifs );
+        return false;
+    }
+
+    std::vector<kvs::UInt8> index( 16 * nchunks );
+    if ( nchunks > 0 && fread( &index[0], 1, index.size(), ifs ) != index.size() )
+    {
+        kvsMessageError( "Cannot read '%s'.", filename.c_str() );
+        fclose( ifs );
+        return false;
+    }
+    fclose( ifs );
+
+    header->offsets.resize( nchunks );
+    header->sizes.resize( nchunks );
+    for ( size_t i = 0; i < nchunks; i++ )
+    {
+        header->offsets[i] = kvs::detail::Get64( &index[ 16 * i ] );
+        header->sizes[i] = kvs::detail::Get64( &index[ 16 * i + 8 ] );
+        if ( header->offsets[i] > file_size || header->sizes[i] > file_size - header->offsets[i] )
+        {
+            kvsMessageError( "Broken chunk index in '%s'.", filename.c_str() );
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reads all the values from the chunked data file.
+ *  @param  data [out] pointer to the buffer of the values
+ *  @param  nelements [in] number of the values
+ *  @param  value_size [in] size of the value in bytes
+ *  @param  filename [in] filename
+ *  @return true, if the reading process is done successfully
+ */
+/*===========================================================================*/
+bool Read(
+    void* data,
+    const size_t nelements,
+    const size_t value_size,
+    const std::string& filename )
+{
+    return Read( data, 0, nelements, value_size, filename );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reads the range of the values from the chunked data file.
+ *  @param  data [out] pointer to the buffer of the 'count' values
+ *  @param  first [in] index of the first value
+ *  @param  count [in] number of the values
+ *  @param  value_size [in] size of the value in bytes
+ *  @param  filename [in] filename
+ *  @return true, if the reading process is done successfully
+ *
+ *  Only the chunks overlapping the range are read by a single read call
+ *  and decoded in parallel.
+ */
+/*===========================================================================*/
+bool Read(
+    void* data,
+    const size_t first,
+    const size_t count,
+    const size_t value_size,
+    const std::string& filename )
+{
+    Header header;
+    if ( !ReadHeader( filename, &header ) ) { return false; }
+
+    if ( header.value_size != value_size )
+    {
+        kvsMessageError( "Value size %d in '%s' is not %d.",
+                         int( header.value_size ), filename.c_str(), int( value_size ) );
+        return false;
+    }
+
+    if ( first > header.nelements || count > header.nelements - first )
+    {
+        kvsMessageError( "Range [%lu, %lu) exceeds %lu values in '%s'.",
+                         (unsigned long)first, (unsigned long)( first + count ),
+                         (unsigned long)header.nelements, filename.c_str() );
+        return false;
+    }
+
+    if ( count == 0 ) { return true; }
+
+    // Read the overlapping chunks at once.
+    const size_t begin = first / header.chunk_size;
+    const size_t end = ( first + count - 1 ) / header.chunk_size + 1;
+    const kvs::UInt64 span_offset = header.offsets[ begin ];
+    const kvs::UInt64 span_end = header.offsets[ end - 1 ] + header.sizes[ end - 1 ];
+    for ( size_t i = begin; i < end; i++ )
+    {
+        if ( header.offsets[i] < span_offset || header.offsets[i] + header.sizes[i] > span_end )
+        {
+            kvsMessageError( "Broken chunk index in '%s'.", filename.c_str() );
+            return false;
+        }
+    }
+
+    std::vector<kvs::UInt8> span( static_cast<size_t>( span_end - span_offset ) );
+    FILE* ifs = fopen( filename.c_str(), "rb" );
+    if ( !ifs )
+    {
+        kvsMessageError( "Cannot open '%s'.", filename.c_str() );
+        return false;
+    }
+    const bool success =
+        kvs::detail::Seek( ifs, static_cast<kvs::Int64>( span_offset ), SEEK_SET ) &&
+        ( span.empty() || fread( &span[0], 1, span.size(), ifs ) == span.size() );
+    fclose( ifs );
+    if ( !success )
+    {
+        kvsMessageError( "Cannot read '%s'.", filename.c_str() );
+        return false;
+    }
+
+    // Decode the chunks in parallel.
+    kvs::UInt8* values = static_cast<kvs::UInt8*>( data );
+    std::vector<char> decoded( end - begin, 0 );
+    KVS_OMP_PARALLEL_FOR( schedule(dynamic) )
+    for ( size_t i = begin; i < end; i++ )
+    {
+        const size_t chunk_first = i * header.chunk_size;
+        const size_t n = kvs::Math::Min( header.chunk_size, header.nelements - chunk_first );
+        const kvs::UInt8* src = span.empty() ? NULL : &span[ static_cast<size_t>( header.offsets[i] - span_offset ) ];
+        const size_t src_size = static_cast<size_t>( header.sizes[i] );
+
+        const size_t copy_first = kvs::Math::Max( first, chunk_first );
+        const size_t copy_last = kvs::Math::Min( first + count, chunk_first + n );
+        kvs::UInt8* dst = values + ( copy_first - first ) * value_size;
+        if ( copy_first == chunk_first && copy_last == chunk_first + n )
+        {
+            decoded[ i - begin ] = ::DecodeChunk( src, src_size, n, header, dst );
+        }
+        else
+        {
+            // The chunk is partially in the range.
+            std::vector<kvs::UInt8> buffer( n * value_size );
+            decoded[ i - begin ] = ::DecodeChunk( src, src_size, n, header, &buffer[0] );
+            std::memcpy( dst, &buffer[ ( copy_first - chunk_first ) * value_size ], ( copy_last - copy_first ) * value_size );
+        }
+    }
+
+    for ( size_t i = 0; i < decoded.size(); i++ )
+    {
+        if ( !decoded[i] )
+        {
+            kvsMessageError( "Broken chunk %lu in '%s'.", (unsigned long)( begin + i ), filename.c_str() );
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // end of namespace ChunkedData
+
+} // end of namespace kvsml
+
+} // end of namespace kvs
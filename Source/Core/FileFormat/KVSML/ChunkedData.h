@@ -0,0 +1,110 @@
+/*****************************************************************************/
+/**
+ *  @file   ChunkedData.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVS__KVSML__CHUNKED_DATA_H_INCLUDE
+#define KVS__KVSML__CHUNKED_DATA_H_INCLUDE
+
+#include <string>
+#include <vector>
+#include <kvs/Type>
+
+
+namespace kvs
+{
+
+namespace kvsml
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Chunked and compressed external data file (format="chunked").
+ *
+ *  The array is divided into the chunks of a fixed number of elements, and
+ *  each chunk is filtered and compressed by kvs::FastCompressor
+ *  independently, so that the chunks are encoded and decoded in parallel
+ *  and any range of the elements can be read without decoding the others.
+ *
+ *  File layout (the integers are little endian):
+ *    "KVSC" version(1B) endian(1B, 0: little, 1: big) filter(1B)
+ *    value_size(1B) nelements(8B) chunk_size(8B, elements) nchunks(8B)
+ *    {offset(8B) size(8B)}*nchunks
+ *    chunk data
+ *  A chunk of which the size is equal to the original byte size is stored
+ *  without the compression. The values are stored in the byte order given
+ *  by 'endian' and swapped in reading if needed.
+ */
+/*===========================================================================*/
+namespace ChunkedData
+{
+
+/// Filters applied to each chunk before the compression.
+enum Filter
+{
+    NoFilter = 0, ///< no filter
+    Shuffle = 1, ///< byte shuffle (the n-th bytes of the values are gathered)
+    Delta = 2 ///< byte delta (after the shuffle, if specified)
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Header of the chunked data file.
+ */
+/*===========================================================================*/
+struct Header
+{
+    int filter; ///< filters (combination of Filter)
+    bool swap; ///< true, if the values must be swapped
+    size_t value_size; ///< size of the value in bytes
+    size_t nelements; ///< number of the elements
+    size_t chunk_size; ///< number of the elements in a chunk
+    std::vector<kvs::UInt64> offsets; ///< offsets of the chunks from the file head
+    std::vector<kvs::UInt64> sizes; ///< sizes of the chunks in bytes
+
+    size_t numberOfChunks() const { return offsets.size(); }
+};
+
+/// Default number of the bytes in a chunk.
+const size_t DefaultChunkBytes = 1024 * 1024;
+
+int DefaultFilter( const size_t value_size );
+
+bool Write(
+    const void* data,
+    const size_t nelements,
+    const size_t value_size,
+    const std::string& filename,
+    const int filter,
+    const size_t chunk_size = 0 );
+
+bool ReadHeader( const std::string& filename, Header* header );
+
+bool Read(
+    void* data,
+    const size_t nelements,
+    const size_t value_size,
+    const std::string& filename );
+
+bool Read(
+    void* data,
+    const size_t first,
+    const size_t count,
+    const size_t value_size,
+    const std::string& filename );
+
+} // end of namespace ChunkedData
+
+} // end of namespace kvsml
+
+} // end of namespace kvs
+
+#endif // KVS__KVSML__CHUNKED_DATA_H_INCLUDE
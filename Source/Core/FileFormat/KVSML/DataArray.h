@@ -22,6 +22,10 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <cstdio>
+#include <cstring>
+#include "ChunkedData.h"
+#include "ExternalDataWriter.h"
 
 
 namespace kvs
@@ -182,7 +186,7 @@ inline bool ReadInternalData(
  *  @param  data_array [out] pointer to the any-value array
  *  @param  nelements  [in] number of elements
  *  @param  filename   [in] external file name
- *  @param  format     [in] file format (binary or ascii)
+ *  @param  format     [in] file format (binary, chunked or ascii)
  *  @return true, if the reading process is done successfully
  */
 /*===========================================================================*/
@@ -214,6 +218,14 @@ inline bool ReadExternalData(
 
         fclose( ifs );
     }
+    else if ( format == "chunked" )
+    {
+        const size_t data_size = data_array->size();
+        if ( !kvs::kvsml::ChunkedData::Read( data_array->data(), data_size, sizeof(T), filename ) )
+        {
+            return false;
+        }
+    }
     else if ( format == "ascii" )
     {
         FILE* ifs = fopen( filename.c_str(), "r" );
@@ -273,7 +285,7 @@ inline bool ReadExternalData(
  *  @param  data_array [out] pointer to the value array
  *  @param  nelements  [in] number of elements
  *  @param  filename   [in] external file name
- *  @param  format     [in] file format (binary or ascii)
+ *  @param  format     [in] file format (binary, chunked or ascii)
  *  @return true, if the reading process is done successfully
  */
 /*===========================================================================*/
@@ -322,6 +334,26 @@ inline bool ReadExternalData(
         }
         fclose( ifs );
     }
+    else if ( format == "chunked" )
+    {
+        if ( typeid( T1 ) == typeid( T2 ) )
+        {
+            if ( !kvs::kvsml::ChunkedData::Read( data_array.data(), nelements, sizeof( T1 ), filename ) )
+            {
+                return false;
+            }
+        }
+        else
+        {
+            kvs::ValueArray<T2> values( nelements );
+            if ( !kvs::kvsml::ChunkedData::Read( values.data(), nelements, sizeof( T2 ), filename ) )
+            {
+                return false;
+            }
+
+            for ( size_t i = 0; i < nelements; i++ ) { data_array[i] = static_cast<T1>( values[i] ); }
+        }
+    }
     else if ( format == "ascii" )
     {
         FILE* ifs = fopen( filename.c_str(), "r" );
@@ -384,71 +416,21 @@ inline bool WriteExternalData(
 {
     if ( format == "ascii" )
     {
-        std::ofstream ofs( filename.c_str() );
-        if ( ofs.fail() )
-        {
-            kvsMessageError("Cannot open file '%s'.", filename.c_str() );
-            return false;
-        }
-
-        const std::string delim(", ");
-        const std::type_info& data_type = data_array.typeInfo()->type();
-        const size_t data_size = data_array.size();
-        if ( data_type == typeid(kvs::Int8) )
-        {
-            const kvs::Int8* values = static_cast<const kvs::Int8*>( data_array.data() );
-            for ( size_t i = 0; i < data_size; i++ ) ofs << kvs::Int16(values[i]) << delim;
-        }
-        else if ( data_type == typeid(kvs::UInt8) )
-        {
-            const kvs::UInt8* values = static_cast<const kvs::UInt8*>( data_array.data() );
-            for ( size_t i = 0; i < data_size; i++ ) ofs << kvs::UInt16(values[i]) << delim;
-        }
-        else if ( data_type == typeid(kvs::Int16) )
-        {
-            const kvs::Int16* values = static_cast<const kvs::Int16*>( data_array.data() );
-            for ( size_t i = 0; i < data_size; i++ ) ofs << values[i] << delim;
-        }
-        else if ( data_type == typeid(kvs::UInt16) )
-        {
-            const kvs::UInt16* values = static_cast<const kvs::UInt16*>( data_array.data() );
-            for ( size_t i = 0; i < data_size; i++ ) ofs << values[i] << delim;
-        }
-        else if ( data_type == typeid(kvs::Int32) )
-        {
-            const kvs::Int32* values = static_cast<const kvs::Int32*>( data_array.data() );
-            for ( size_t i = 0; i < data_size; i++ ) ofs << values[i] << delim;
-        }
-        else if ( data_type == typeid(kvs::UInt32) )
-        {
-            const kvs::UInt32* values = static_cast<const kvs::UInt32*>( data_array.data() );
-            for ( size_t i = 0; i < data_size; i++ ) ofs << values[i] << delim;
-        }
-        else if ( data_type == typeid(kvs::Real32) )
-        {
-            const kvs::Real32* values = static_cast<const kvs::Real32*>( data_array.data() );
-            for ( size_t i = 0; i < data_size; i++ ) ofs << values[i] << delim;
-        }
-        else if ( data_type == typeid(kvs::Real64) )
-        {
-            const kvs::Real64* values = static_cast<const kvs::Real64*>( data_array.data() );
-            for ( size_t i = 0; i < data_size; i++ ) ofs << values[i] << delim;
-        }
-
-        ofs.close();
+        return kvs::kvsml::ExternalDataWriter::WriteAscii( data_array, filename );
     }
     else if ( format == "binary" )
     {
-        std::ofstream ofs( filename.c_str(), std::ios::out | std::ios::binary );
-        if ( ofs.fail() )
-        {
-            kvsMessageError("Cannot open file '%s'.", filename.c_str() );
-            return false;
-        }
-        const void* data_pointer = data_array.data();
-        const size_t data_byte_size = data_array.byteSize();
-        ofs.write( static_cast<const char*>(data_pointer), data_byte_size );
-        ofs.close();
+        return kvs::kvsml::ExternalDataWriter::WriteBinary( data_array.data(), data_array.byteSize(), filename );
+    }
+    else if ( format == "chunked" )
+    {
+        const size_t value_size = data_array.size() > 0 ? data_array.byteSize() / data_array.size() : 1;
+        return kvs::kvsml::ChunkedData::Write(
+            data_array.data(),
+            data_array.size(),
+            value_size,
+            filename,
+            kvs::kvsml::ChunkedData::DefaultFilter( value_size ) );
     }
     else
     {
@@ -476,38 +458,20 @@ inline bool WriteExternalData(
 {
     if ( format == "ascii" )
     {
-        std::ofstream ofs( filename.c_str() );
-        if ( ofs.fail() )
-        {
-            kvsMessageError("Cannot open file '%s'.", filename.c_str() );
-            return false;
-        }
-
-        const std::string delim(", ");
-        const size_t data_size = data_array.size();
-        if ( typeid(T) == typeid(kvs::Int8) || typeid(T) == typeid(kvs::UInt8) )
-        {
-            for ( size_t i = 0; i < data_size; i++ ) ofs << int( data_array[i] ) << delim;
-        }
-        else
-        {
-            for ( size_t i = 0; i < data_size; i++ ) ofs << data_array[i] << delim;
-        }
-
-        ofs.close();
+        return kvs::kvsml::ExternalDataWriter::WriteAscii( kvs::AnyValueArray( data_array ), filename );
     }
     else if ( format == "binary" )
     {
-        std::ofstream ofs( filename.c_str(), std::ios::out | std::ios::binary );
-        if ( ofs.fail() )
-        {
-            kvsMessageError("Cannot open file '%s'.", filename.c_str() );
-            return false;
-        }
-        const char* data_pointer = reinterpret_cast<const char*>( data_array.data() );
-        const size_t data_byte_size = data_array.byteSize();
-        ofs.write( data_pointer, data_byte_size );
-        ofs.close();
+        return kvs::kvsml::ExternalDataWriter::WriteBinary( data_array.data(), data_array.byteSize(), filename );
+    }
+    else if ( format == "chunked" )
+    {
+        return kvs::kvsml::ChunkedData::Write(
+            data_array.data(),
+            data_array.size(),
+            sizeof( T ),
+            filename,
+            kvs::kvsml::ChunkedData::DefaultFilter( sizeof( T ) ) );
     }
 
     return true;
@@ -45,7 +45,8 @@ DataArrayTag::DataArrayTag():
     m_type( "" ),
     m_file( "" ),
     m_format( "" ),
-    m_endian( "" )
+    m_endian( "" ),
+    m_writer( NULL )
 {
 }
 
@@ -173,6 +174,7 @@ bool DataArrayTag::write(
 
         // Write the data to the external data file.
         const std::string filename = pathname + kvs::File::Separator() + m_file;
+        if ( m_writer ) { return m_writer->write( data, filename, m_format ); }
         return kvs::kvsml::DataArray::WriteExternalData( data, filename, m_format );
     }
 }
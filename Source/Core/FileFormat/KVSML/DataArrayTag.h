@@ -24,6 +24,7 @@
 #include <kvs/XMLDocument>
 #include "DataArray.h"
 #include "TagBase.h"
+#include "ExternalDataWriter.h"
 
 
 namespace kvs
@@ -53,6 +54,7 @@ private:
     std::string m_file; ///< external file name
     std::string m_format; ///< external file format
     std::string m_endian; ///< endianness of the binary data
+    kvs::kvsml::ExternalDataWriter* m_writer; ///< writer of the external data in background (optional)
 
 public:
 
@@ -70,6 +72,7 @@ public:
     void setFile( const std::string& file ) { m_has_file = true; m_file = file; }
     void setFormat( const std::string& format ) { m_has_format = true; m_format = format; }
     void setEndian( const std::string& endian ) { m_has_endian = true; m_endian = endian; }
+    void setWriter( kvs::kvsml::ExternalDataWriter* writer ) { m_writer = writer; }
 
     bool read( const kvs::XMLNode::SuperClass* parent, const size_t nelements, kvs::AnyValueArray* data );
     template <typename T>
@@ -176,6 +179,7 @@ inline bool DataArrayTag::write(
 
         // Set text.
         const std::string filename = pathname + kvs::File::Separator() + m_file;
+        if ( m_writer ) { return m_writer->write( kvs::AnyValueArray( data ), filename, m_format ); }
         return kvs::kvsml::DataArray::WriteExternalData( data, filename, m_format );
     }
 }
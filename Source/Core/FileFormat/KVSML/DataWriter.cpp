@@ -70,6 +70,11 @@ bool WriteCoordData(
             data_tag.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "coord" ) );
             data_tag.setFormat( "binary" );
         }
+        else if ( writing_type == kvs::kvsml::ExternalChunked )
+        {
+            data_tag.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "coord" ) );
+            data_tag.setFormat( "chunked" );
+        }
 
         const std::string pathname = kvs::File( filename ).pathName();
         if ( !data_tag.write( coord_tag.node(), coords, pathname ) )
@@ -136,6 +141,11 @@ bool WriteColorData(
                 data_tag.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "color" ) );
                 data_tag.setFormat( "binary" );
             }
+            else if ( writing_type == kvs::kvsml::ExternalChunked )
+            {
+                data_tag.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "color" ) );
+                data_tag.setFormat( "chunked" );
+            }
 
             const std::string pathname = kvs::File( filename ).pathName();
             if ( !data_tag.write( color_tag.node(), colors, pathname ) )
@@ -203,6 +213,11 @@ bool WriteNormalData(
                 data_tag.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "normal" ) );
                 data_tag.setFormat( "binary" );
             }
+            else if ( writing_type == kvs::kvsml::ExternalChunked )
+            {
+                data_tag.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "normal" ) );
+                data_tag.setFormat( "chunked" );
+            }
 
             const std::string pathname = kvs::File( filename ).pathName();
             if ( !data_tag.write( normal_tag.node(), normals, pathname ) )
@@ -270,6 +285,11 @@ bool WriteSizeData(
                 data_tag.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "size" ) );
                 data_tag.setFormat( "binary" );
             }
+            else if ( writing_type == kvs::kvsml::ExternalChunked )
+            {
+                data_tag.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "size" ) );
+                data_tag.setFormat( "chunked" );
+            }
 
             const std::string pathname = kvs::File( filename ).pathName();
             if ( !data_tag.write( size_tag.node(), sizes, pathname ) )
@@ -323,6 +343,11 @@ bool WriteConnectionData(
             data_tag.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "connect" ) );
             data_tag.setFormat( "binary" );
         }
+        else if ( writing_type == kvs::kvsml::ExternalChunked )
+        {
+            data_tag.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "connect" ) );
+            data_tag.setFormat( "chunked" );
+        }
 
         const std::string pathname = kvs::File( filename ).pathName();
         if ( !data_tag.write( connection_tag.node(), connections, pathname ) )
@@ -389,6 +414,11 @@ bool WriteOpacityData(
                 data_tag.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "opacity" ) );
                 data_tag.setFormat( "binary" );
             }
+            else if ( writing_type == kvs::kvsml::ExternalChunked )
+            {
+                data_tag.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "opacity" ) );
+                data_tag.setFormat( "chunked" );
+            }
 
             const std::string pathname = kvs::File( filename ).pathName();
             if ( !data_tag.write( opacity_tag.node(), opacities, pathname ) )
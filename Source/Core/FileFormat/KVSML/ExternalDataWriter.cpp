@@ -0,0 +1,698 @@
+/*****************************************************************************/
+/**
+ *  @file   ExternalDataWriter.cpp
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "ExternalDataWriter.h"
+#include "DataArray.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <kvs/Platform>
+#include <kvs/Message>
+#include <kvs/Math>
+#include <kvs/OpenMP>
+#include <kvs/Thread>
+#if !defined( KVS_PLATFORM_WINDOWS )
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+
+namespace
+{
+
+/// Number of the values formatted in a block.
+const size_t BlockSize = 64 * 1024;
+
+/// Number of the blocks for each thread in a batch.
+const size_t BlocksPerThread = 4;
+
+/// Max. size of a write call for the binary data in bytes.
+const size_t WriteSize = 8 * 1024 * 1024;
+
+/*===========================================================================*/
+/**
+ *  @brief  Formats the unsigned integer.
+ *  @param  buffer [out] buffer of 24 bytes at least
+ *  @param  value [in] value
+ *  @return number of the characters
+ */
+/*===========================================================================*/
+inline size_t Format( char* buffer, kvs::UInt64 value )
+{
+    char digits[24];
+    size_t n = 0;
+    do
+    {
+        digits[ n++ ] = static_cast<char>( '0' + value % 10 );
+        value /= 10;
+    } while ( value > 0 );
+
+    for ( size_t i = 0; i < n; i++ ) { buffer[i] = digits[ n - 1 - i ]; }
+    return n;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Formats the signed integer.
+ *  @param  buffer [out] buffer of 24 bytes at least
+ *  @param  value [in] value
+ *  @return number of the characters
+ */
+/*===========================================================================*/
+inline size_t Format( char* buffer, const kvs::Int64 value )
+{
+    if ( value >= 0 ) { return Format( buffer, kvs::UInt64( value ) ); }
+
+    // The negation in the unsigned type is valid for the min. value.
+    buffer[0] = '-';
+    return 1 + Format( buffer + 1, kvs::UInt64( 0 ) - kvs::UInt64( value ) );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Floating-point value with the 64-bit significand (f * 2^e).
+ */
+/*===========================================================================*/
+struct DiyFp
+{
+    kvs::UInt64 f; ///< significand
+    int e; ///< exponent
+
+    DiyFp( const kvs::UInt64 f_ = 0, const int e_ = 0 ): f( f_ ), e( e_ ) {}
+
+    DiyFp operator -( const DiyFp& y ) const { return DiyFp( f - y.f, e ); }
+
+    DiyFp operator *( const DiyFp& y ) const
+    {
+        // Upper 64 bits of the 128-bit product with the rounding.
+        const kvs::UInt64 a = f >> 32, b = f & 0xFFFFFFFFu;
+        const kvs::UInt64 c = y.f >> 32, d = y.f & 0xFFFFFFFFu;
+        const kvs::UInt64 ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+        const kvs::UInt64 mid = ( bd >> 32 ) + ( ad & 0xFFFFFFFFu ) + ( bc & 0xFFFFFFFFu ) + ( 1u << 31 );
+        return DiyFp( ac + ( ad >> 32 ) + ( bc >> 32 ) + ( mid >> 32 ), e + y.e + 64 );
+    }
+
+    DiyFp normalized() const
+    {
+        DiyFp x( *this );
+        while ( ( x.f >> 63 ) == 0 ) { x.f <<= 1; x.e--; }
+        return x;
+    }
+};
+
+/// Cached power of ten (f * 2^e = 10^k).
+struct CachedPower { kvs::UInt64 f; int e; int k; };
+
+/// Cached powers of ten from 10^-300 to 10^324 by 10^8.
+const CachedPower CachedPowers[] =
+{
+    { 0xAB70FE17C79AC6CAULL, -1060, -300 },
+    { 0xFF77B1FCBEBCDC4FULL, -1034, -292 },
+    { 0xBE5691EF416BD60CULL, -1007, -284 },
+    { 0x8DD01FAD907FFC3CULL,  -980, -276 },
+    { 0xD3515C2831559A83ULL,  -954, -268 },
+    { 0x9D71AC8FADA6C9B5ULL,  -927, -260 },
+    { 0xEA9C227723EE8BCBULL,  -901, -252 },
+    { 0xAECC49914078536DULL,  -874, -244 },
+    { 0x823C12795DB6CE57ULL,  -847, -236 },
+    { 0xC21094364DFB5637ULL,  -821, -228 },
+    { 0x9096EA6F3848984FULL,  -794, -220 },
+    { 0xD77485CB25823AC7ULL,  -768, -212 },
+    { 0xA086CFCD97BF97F4ULL,  -741, -204 },
+    { 0xEF340A98172AACE5ULL,  -715, -196 },
+    { 0xB23867FB2A35B28EULL,  -688, -188 },
+    { 0x84C8D4DFD2C63F3BULL,  -661, -180 },
+    { 0xC5DD44271AD3CDBAULL,  -635, -172 },
+    { 0x936B9FCEBB25C996ULL,  -608, -164 },
+    { 0xDBAC6C247D62A584ULL,  -582, -156 },
+    { 0xA3AB66580D5FDAF6ULL,  -555, -148 },
+    { 0xF3E2F893DEC3F126ULL,  -529, -140 },
+    { 0xB5B5ADA8AAFF80B8ULL,  -502, -132 },
+    { 0x87625F056C7C4A8BULL,  -475, -124 },
+    { 0xC9BCFF6034C13053ULL,  -449, -116 },
+    { 0x964E858C91BA2655ULL,  -422, -108 },
+    { 0xDFF9772470297EBDULL,  -396, -100 },
+    { 0xA6DFBD9FB8E5B88FULL,  -369,  -92 },
+    { 0xF8A95FCF88747D94ULL,  -343,  -84 },
+    { 0xB94470938FA89BCFULL,  -316,  -76 },
+    { 0x8A08F0F8BF0F156BULL,  -289,  -68 },
+    { 0xCDB02555653131B6ULL,  -263,  -60 },
+    { 0x993FE2C6D07B7FACULL,  -236,  -52 },
+    { 0xE45C10C42A2B3B06ULL,  -210,  -44 },
+    { 0xAA242499697392D3ULL,  -183,  -36 },
+    { 0xFD87B5F28300CA0EULL,  -157,  -28 },
+    { 0xBCE5086492111AEBULL,  -130,  -20 },
+    { 0x8CBCCC096F5088CCULL,  -103,  -12 },
+    { 0xD1B71758E219652CULL,   -77,   -4 },
+    { 0x9C40000000000000ULL,   -50,    4 },
+    { 0xE8D4A51000000000ULL,   -24,   12 },
+    { 0xAD78EBC5AC620000ULL,     3,   20 },
+    { 0x813F3978F8940984ULL,    30,   28 },
+    { 0xC097CE7BC90715B3ULL,    56,   36 },
+    { 0x8F7E32CE7BEA5C70ULL,    83,   44 },
+    { 0xD5D238A4ABE98068ULL,   109,   52 },
+    { 0x9F4F2726179A2245ULL,   136,   60 },
+    { 0xED63A231D4C4FB27ULL,   162,   68 },
+    { 0xB0DE65388CC8ADA8ULL,   189,   76 },
+    { 0x83C7088E1AAB65DBULL,   216,   84 },
+    { 0xC45D1DF942711D9AULL,   242,   92 },
+    { 0x924D692CA61BE758ULL,   269,  100 },
+    { 0xDA01EE641A708DEAULL,   295,  108 },
+    { 0xA26DA3999AEF774AULL,   322,  116 },
+    { 0xF209787BB47D6B85ULL,   348,  124 },
+    { 0xB454E4A179DD1877ULL,   375,  132 },
+    { 0x865B86925B9BC5C2ULL,   402,  140 },
+    { 0xC83553C5C8965D3DULL,   428,  148 },
+    { 0x952AB45CFA97A0B3ULL,   455,  156 },
+    { 0xDE469FBD99A05FE3ULL,   481,  164 },
+    { 0xA59BC234DB398C25ULL,   508,  172 },
+    { 0xF6C69A72A3989F5CULL,   534,  180 },
+    { 0xB7DCBF5354E9BECEULL,   561,  188 },
+    { 0x88FCF317F22241E2ULL,   588,  196 },
+    { 0xCC20CE9BD35C78A5ULL,   614,  204 },
+    { 0x98165AF37B2153DFULL,   641,  212 },
+    { 0xE2A0B5DC971F303AULL,   667,  220 },
+    { 0xA8D9D1535CE3B396ULL,   694,  228 },
+    { 0xFB9B7CD9A4A7443CULL,   720,  236 },
+    { 0xBB764C4CA7A44410ULL,   747,  244 },
+    { 0x8BAB8EEFB6409C1AULL,   774,  252 },
+    { 0xD01FEF10A657842CULL,   800,  260 },
+    { 0x9B10A4E5E9913129ULL,   827,  268 },
+    { 0xE7109BFBA19C0C9DULL,   853,  276 },
+    { 0xAC2820D9623BF429ULL,   880,  284 },
+    { 0x80444B5E7AA7CF85ULL,   907,  292 },
+    { 0xBF21E44003ACDD2DULL,   933,  300 },
+    { 0x8E679C2F5E44FF8FULL,   960,  308 },
+    { 0xD433179D9C8CB841ULL,   986,  316 },
+    { 0x9E19DB92B4E31BA9ULL,  1013,  324 }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Generates the shortest digits in the boundaries (Grisu2).
+ *  @param  buffer [out] digits
+ *  @param  length [out] number of the digits
+ *  @param  exponent [out] decimal exponent (value = digits * 10^exponent)
+ *  @param  v [in] value
+ *  @param  m_minus [in] lower boundary
+ *  @param  m_plus [in] upper boundary
+ *
+ *  The boundaries are the midpoints to the neighbors, so that any digits
+ *  in them are read back as the value.
+ */
+/*===========================================================================*/
+void Grisu2( char* buffer, int& length, int& exponent, DiyFp v, DiyFp m_minus, DiyFp m_plus )
+{
+    // Cached power to scale the upper boundary to the exponent of [-60, -32].
+    const int alpha = -60;
+    const int f = alpha - m_plus.e - 1;
+    const int k = ( f * 78913 ) / ( 1 << 18 ) + ( f > 0 );
+    const int index = ( 300 + k + 7 ) / 8;
+    const DiyFp c( CachedPowers[ index ].f, CachedPowers[ index ].e );
+
+    const DiyFp w = v * c;
+    const DiyFp w_minus = m_minus * c;
+    const DiyFp w_plus = m_plus * c;
+    const DiyFp lower( w_minus.f + 1, w_minus.e );
+    const DiyFp upper( w_plus.f - 1, w_plus.e );
+    exponent = -CachedPowers[ index ].k;
+
+    kvs::UInt64 delta = ( upper - lower ).f;
+    kvs::UInt64 dist = ( upper - w ).f;
+    const DiyFp one( kvs::UInt64( 1 ) << -upper.e, upper.e );
+    kvs::UInt32 p1 = static_cast<kvs::UInt32>( upper.f >> -one.e );
+    kvs::UInt64 p2 = upper.f & ( one.f - 1 );
+
+    // Integral digits.
+    kvs::UInt32 pow10 = 1000000000;
+    int n = 10;
+    while ( n > 1 && p1 < pow10 ) { pow10 /= 10; n--; }
+
+    length = 0;
+    kvs::UInt64 rest = 0;
+    kvs::UInt64 ten_k = 0;
+    bool done = false;
+    while ( n > 0 )
+    {
+        buffer[ length++ ] = static_cast<char>( '0' + p1 / pow10 );
+        p1 %= pow10;
+        n--;
+        rest = ( kvs::UInt64( p1 ) << -one.e ) + p2;
+        if ( rest <= delta )
+        {
+            exponent += n;
+            ten_k = kvs::UInt64( pow10 ) << -one.e;
+            done = true;
+            break;
+        }
+        pow10 /= 10;
+    }
+
+    // Fractional digits.
+    if ( !done )
+    {
+        int m = 0;
+        do
+        {
+            p2 *= 10;
+            buffer[ length++ ] = static_cast<char>( '0' + ( p2 >> -one.e ) );
+            p2 &= one.f - 1;
+            delta *= 10;
+            dist *= 10;
+            m++;
+        } while ( p2 > delta );
+        exponent -= m;
+        rest = p2;
+        ten_k = one.f;
+    }
+
+    // Round the last digit toward the value.
+    while ( rest < dist && delta - rest >= ten_k &&
+            ( rest + ten_k < dist || dist - rest > rest + ten_k - dist ) )
+    {
+        buffer[ length - 1 ]--;
+        rest += ten_k;
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Formats the digits as the decimal or the exponential notation.
+ *  @param  buffer [in/out] digits to the formatted text
+ *  @param  length [in] number of the digits
+ *  @param  exponent [in] decimal exponent
+ *  @return number of the characters
+ */
+/*===========================================================================*/
+size_t FormatDigits( char* buffer, const int length, const int exponent )
+{
+    // The value is in [10^(n-1), 10^n).
+    const int n = length + exponent;
+    const int min_exp = -4;
+    const int max_exp = 15;
+
+    if ( length <= n && n <= max_exp )
+    {
+        // ddd000
+        std::memset( buffer + length, '0', n - length );
+        return n;
+    }
+
+    if ( 0 < n && n <= max_exp )
+    {
+        // ddd.ddd
+        std::memmove( buffer + n + 1, buffer + n, length - n );
+        buffer[n] = '.';
+        return length + 1;
+    }
+
+    if ( min_exp < n && n <= 0 )
+    {
+        // 0.000ddd
+        std::memmove( buffer + 2 - n, buffer, length );
+        buffer[0] = '0';
+        buffer[1] = '.';
+        std::memset( buffer + 2, '0', -n );
+        return 2 - n + length;
+    }
+
+    // d.ddde+xx
+    size_t size = 1;
+    if ( length > 1 )
+    {
+        std::memmove( buffer + 2, buffer + 1, length - 1 );
+        buffer[1] = '.';
+        size = length + 1;
+    }
+    int e = n - 1;
+    buffer[ size++ ] = 'e';
+    buffer[ size++ ] = e < 0 ? '-' : '+';
+    if ( e < 0 ) { e = -e; }
+    if ( e >= 100 ) { buffer[ size++ ] = static_cast<char>( '0' + e / 100 ); e %= 100; }
+    buffer[ size++ ] = static_cast<char>( '0' + e / 10 );
+    buffer[ size++ ] = static_cast<char>( '0' + e % 10 );
+    return size;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Formats the real value with the shortest digits for the round trip.
+ *  @param  buffer [out] buffer of 32 bytes at least
+ *  @param  bits [in] bits of the value
+ *  @param  precision [in] number of the significand bits including the hidden bit
+ *  @param  exponent_bits [in] number of the exponent bits
+ *  @return number of the characters
+ */
+/*===========================================================================*/
+size_t FormatReal( char* buffer, const kvs::UInt64 bits, const int precision, const int exponent_bits )
+{
+    const kvs::UInt64 hidden_bit = kvs::UInt64( 1 ) << ( precision - 1 );
+    const int max_exponent = ( 1 << exponent_bits ) - 1;
+    const int bias = ( max_exponent >> 1 ) + precision - 1;
+    const kvs::UInt64 F = bits & ( hidden_bit - 1 );
+    const int E = static_cast<int>( ( bits >> ( precision - 1 ) ) & max_exponent );
+    const bool negative = ( ( bits >> ( precision - 1 + exponent_bits ) ) & 1 ) != 0;
+
+    if ( E == max_exponent && F != 0 )
+    {
+        std::memcpy( buffer, "nan", 3 );
+        return 3;
+    }
+
+    size_t size = 0;
+    if ( negative ) { buffer[ size++ ] = '-'; }
+
+    if ( E == max_exponent )
+    {
+        std::memcpy( buffer + size, "inf", 3 );
+        return size + 3;
+    }
+
+    if ( E == 0 && F == 0 )
+    {
+        buffer[ size++ ] = '0';
+        return size;
+    }
+
+    // Value and the midpoints to the neighbors.
+    const DiyFp v = E == 0 ? DiyFp( F, 1 - bias ) : DiyFp( F + hidden_bit, E - bias );
+    const bool lower_is_closer = F == 0 && E > 1;
+    const DiyFp m_plus = DiyFp( 2 * v.f + 1, v.e - 1 ).normalized();
+    DiyFp m_minus = lower_is_closer ? DiyFp( 4 * v.f - 1, v.e - 2 ) : DiyFp( 2 * v.f - 1, v.e - 1 );
+    m_minus.f <<= m_minus.e - m_plus.e;
+    m_minus.e = m_plus.e;
+
+    int length = 0;
+    int exponent = 0;
+    ::Grisu2( buffer + size, length, exponent, v.normalized(), m_minus, m_plus );
+    return size + ::FormatDigits( buffer + size, length, exponent );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Formats the real value with the shortest digits for the round trip.
+ *  @param  buffer [out] buffer of 32 bytes at least
+ *  @param  value [in] value
+ *  @return number of the characters
+ */
+/*===========================================================================*/
+inline size_t Format( char* buffer, const kvs::Real32 value )
+{
+    kvs::UInt32 bits = 0;
+    std::memcpy( &bits, &value, sizeof( bits ) );
+    return ::FormatReal( buffer, bits, 24, 8 );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Formats the real value with the shortest digits for the round trip.
+ *  @param  buffer [out] buffer of 32 bytes at least
+ *  @param  value [in] value
+ *  @return number of the characters
+ */
+/*===========================================================================*/
+inline size_t Format( char* buffer, const kvs::Real64 value )
+{
+    kvs::UInt64 bits = 0;
+    std::memcpy( &bits, &value, sizeof( bits ) );
+    return ::FormatReal( buffer, bits, 53, 11 );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Formats the block of the values with the delimiters.
+ *  @param  values [in] pointer to the values
+ *  @param  nvalues [in] number of the values
+ *  @param  text [out] formatted text
+ */
+/*===========================================================================*/
+template <typename T, typename FormatT>
+void FormatBlock( const T* values, const size_t nvalues, std::string* text )
+{
+    char buffer[32];
+    text->clear();
+    text->reserve( nvalues * 12 );
+    for ( size_t i = 0; i < nvalues; i++ )
+    {
+        const size_t n = ::Format( buffer, static_cast<FormatT>( values[i] ) );
+        buffer[n] = ',';
+        buffer[n + 1] = ' ';
+        text->append( buffer, n + 2 );
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Formats the block of the values in the any-value array.
+ *  @param  data [in] data array
+ *  @param  first [in] index of the first value
+ *  @param  nvalues [in] number of the values
+ *  @param  text [out] formatted text
+ */
+/*===========================================================================*/
+void FormatBlock( const kvs::AnyValueArray& data, const size_t first, const size_t nvalues, std::string* text )
+{
+    const void* p = static_cast<const kvs::UInt8*>( data.data() ) + first * ( data.byteSize() / data.size() );
+    switch ( data.typeID() )
+    {
+    case kvs::Type::TypeInt8: FormatBlock<kvs::Int8,kvs::Int64>( static_cast<const kvs::Int8*>( p ), nvalues, text ); break;
+    case kvs::Type::TypeInt16: FormatBlock<kvs::Int16,kvs::Int64>( static_cast<const kvs::Int16*>( p ), nvalues, text ); break;
+    case kvs::Type::TypeInt32: FormatBlock<kvs::Int32,kvs::Int64>( static_cast<const kvs::Int32*>( p ), nvalues, text ); break;
+    case kvs::Type::TypeInt64: FormatBlock<kvs::Int64,kvs::Int64>( static_cast<const kvs::Int64*>( p ), nvalues, text ); break;
+    case kvs::Type::TypeUInt8: FormatBlock<kvs::UInt8,kvs::UInt64>( static_cast<const kvs::UInt8*>( p ), nvalues, text ); break;
+    case kvs::Type::TypeUInt16: FormatBlock<kvs::UInt16,kvs::UInt64>( static_cast<const kvs::UInt16*>( p ), nvalues, text ); break;
+    case kvs::Type::TypeUInt32: FormatBlock<kvs::UInt32,kvs::UInt64>( static_cast<const kvs::UInt32*>( p ), nvalues, text ); break;
+    case kvs::Type::TypeUInt64: FormatBlock<kvs::UInt64,kvs::UInt64>( static_cast<const kvs::UInt64*>( p ), nvalues, text ); break;
+    case kvs::Type::TypeReal32: FormatBlock<kvs::Real32,kvs::Real32>( static_cast<const kvs::Real32*>( p ), nvalues, text ); break;
+    case kvs::Type::TypeReal64: FormatBlock<kvs::Real64,kvs::Real64>( static_cast<const kvs::Real64*>( p ), nvalues, text ); break;
+    default: text->clear(); break;
+    }
+}
+
+} // end of namespace
+
+
+namespace kvs
+{
+
+namespace kvsml
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Task writing an external data file in the background thread.
+ */
+/*===========================================================================*/
+class ExternalDataWriter::Task : public kvs::Thread
+{
+private:
+
+    kvs::AnyValueArray m_data; ///< data array (shared)
+    std::string m_filename; ///< filename
+    std::string m_format; ///< format
+    bool m_success; ///< true, if the file is written
+
+public:
+
+    Task( const kvs::AnyValueArray& data, const std::string& filename, const std::string& format ):
+        m_data( data ),
+        m_filename( filename ),
+        m_format( format ),
+        m_success( false ) {}
+
+    bool success() const { return m_success; }
+
+    void run()
+    {
+        m_success = kvs::kvsml::DataArray::WriteExternalData( m_data, m_filename, m_format );
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Writes the data array to the external ascii file.
+ *  @param  data [in] data array
+ *  @param  filename [in] filename
+ *  @return true, if the writing process is done successfully
+ */
+/*===========================================================================*/
+bool ExternalDataWriter::WriteAscii( const kvs::AnyValueArray& data, const std::string& filename )
+{
+    FILE* ofs = fopen( filename.c_str(), "w" );
+    if ( !ofs )
+    {
+        kvsMessageError( "Cannot open file '%s'.", filename.c_str() );
+        return false;
+    }
+
+    // The blocks in a batch are formatted in parallel and written in order.
+    const size_t nvalues = data.size();
+    const size_t nblocks = ( nvalues + ::BlockSize - 1 ) / ::BlockSize;
+    const size_t batch_size = kvs::Math::Max( kvs::OpenMP::GetMaxThreads(), 1 ) * ::BlocksPerThread;
+    std::vector<std::string> texts( kvs::Math::Min( batch_size, nblocks ) );
+
+    bool success = true;
+    for ( size_t batch = 0; success && batch < nblocks; batch += batch_size )
+    {
+        const size_t n = kvs::Math::Min( batch_size, nblocks - batch );
+        KVS_OMP_PARALLEL_FOR( schedule(dynamic) )
+        for ( size_t i = 0; i < n; i++ )
+        {
+            const size_t first = ( batch + i ) * ::BlockSize;
+            const size_t count = kvs::Math::Min( ::BlockSize, nvalues - first );
+            ::FormatBlock( data, first, count, &texts[i] );
+        }
+
+        for ( size_t i = 0; success && i < n; i++ )
+        {
+            success = fwrite( texts[i].data(), 1, texts[i].size(), ofs ) == texts[i].size();
+        }
+    }
+
+    success = ( fclose( ofs ) == 0 ) && success;
+    if ( !success )
+    {
+        kvsMessageError( "Cannot write '%s'.", filename.c_str() );
+        return false;
+    }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Writes the data to the external binary file.
+ *  @param  data [in] pointer to the data
+ *  @param  size [in] size of the data in bytes
+ *  @param  filename [in] filename
+ *  @return true, if the writing process is done successfully
+ */
+/*===========================================================================*/
+bool ExternalDataWriter::WriteBinary( const void* data, const size_t size, const std::string& filename )
+{
+    const char* p = static_cast<const char*>( data );
+    bool success = true;
+
+#if defined( KVS_PLATFORM_WINDOWS )
+    FILE* ofs = fopen( filename.c_str(), "wb" );
+    if ( !ofs )
+    {
+        kvsMessageError( "Cannot open file '%s'.", filename.c_str() );
+        return false;
+    }
+
+    // The stream buffer is not used for the large writes.
+    setvbuf( ofs, NULL, _IONBF, 0 );
+    for ( size_t offset = 0; success && offset < size; offset += ::WriteSize )
+    {
+        const size_t n = kvs::Math::Min( ::WriteSize, size - offset );
+        success = fwrite( p + offset, 1, n, ofs ) == n;
+    }
+    success = ( fclose( ofs ) == 0 ) && success;
+#else
+    const int fd = ::open( filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+    if ( fd < 0 )
+    {
+        kvsMessageError( "Cannot open file '%s'.", filename.c_str() );
+        return false;
+    }
+
+    // The offsets of the writes are aligned to the pages except the last one.
+    size_t offset = 0;
+    while ( success && offset < size )
+    {
+        const ssize_t n = ::write( fd, p + offset, kvs::Math::Min( ::WriteSize, size - offset ) );
+        if ( n < 0 && errno == EINTR ) { continue; }
+        success = n > 0;
+        if ( success ) { offset += n; }
+    }
+    success = ( ::close( fd ) == 0 ) && success;
+#endif
+
+    if ( !success )
+    {
+        kvsMessageError( "Cannot write '%s'.", filename.c_str() );
+        return false;
+    }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new ExternalDataWriter class.
+ */
+/*===========================================================================*/
+ExternalDataWriter::ExternalDataWriter()
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Destroys the ExternalDataWriter class after the writing tasks.
+ */
+/*===========================================================================*/
+ExternalDataWriter::~ExternalDataWriter()
+{
+    this->wait();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Starts writing the data array to the external file.
+ *  @param  data [in] data array (shared until wait())
+ *  @param  filename [in] filename
+ *  @param  format [in] file format
+ *  @return true, if the writing is started or done successfully
+ */
+/*===========================================================================*/
+bool ExternalDataWriter::write(
+    const kvs::AnyValueArray& data,
+    const std::string& filename,
+    const std::string& format )
+{
+    Task* task = new Task( data, filename, format );
+    if ( !task->start() )
+    {
+        // Write in this thread instead.
+        delete task;
+        return kvs::kvsml::DataArray::WriteExternalData( data, filename, format );
+    }
+
+    m_tasks.push_back( task );
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Waits for all the writing tasks.
+ *  @return true, if all the files are written successfully
+ */
+/*===========================================================================*/
+bool ExternalDataWriter::wait()
+{
+    bool success = true;
+    for ( size_t i = 0; i < m_tasks.size(); i++ )
+    {
+        m_tasks[i]->wait();
+        success = m_tasks[i]->success() && success;
+        delete m_tasks[i];
+    }
+    m_tasks.clear();
+    return success;
+}
+
+} // end of namespace kvsml
+
+} // end of namespace kvs
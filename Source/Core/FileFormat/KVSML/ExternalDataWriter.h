@@ -0,0 +1,72 @@
+/*****************************************************************************/
+/**
+ *  @file   ExternalDataWriter.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVS__KVSML__EXTERNAL_DATA_WRITER_H_INCLUDE
+#define KVS__KVSML__EXTERNAL_DATA_WRITER_H_INCLUDE
+
+#include <string>
+#include <vector>
+#include <kvs/AnyValueArray>
+
+
+namespace kvs
+{
+
+namespace kvsml
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Writer of the external data files.
+ *
+ *  The ascii data is formatted in parallel by the blocks of the values, in
+ *  which the real values are written with the shortest digits (Grisu2) that
+ *  read back the same value, and the blocks are written in order. The
+ *  binary data is written by the large writes without the stream buffer.
+ *
+ *  The instance writes the files in the background threads, so that the
+ *  files of the coordinates, the values and the connections are written
+ *  simultaneously. The data arrays are shared (not copied) until wait().
+ */
+/*===========================================================================*/
+class ExternalDataWriter
+{
+private:
+
+    class Task;
+    std::vector<Task*> m_tasks; ///< writing tasks
+
+public:
+
+    static bool WriteAscii( const kvs::AnyValueArray& data, const std::string& filename );
+    static bool WriteBinary( const void* data, const size_t size, const std::string& filename );
+
+public:
+
+    ExternalDataWriter();
+    ~ExternalDataWriter();
+
+    bool write( const kvs::AnyValueArray& data, const std::string& filename, const std::string& format );
+    bool wait();
+
+private:
+
+    ExternalDataWriter( const ExternalDataWriter& );
+    ExternalDataWriter& operator =( const ExternalDataWriter& );
+};
+
+} // end of namespace kvsml
+
+} // end of namespace kvs
+
+#endif // KVS__KVSML__EXTERNAL_DATA_WRITER_H_INCLUDE
@@ -41,7 +41,8 @@ public:
     {
         Ascii = 0,     ///< ascii data type
         ExternalAscii, ///< external ascii data type
-        ExternalBinary ///< external binary data type
+        ExternalBinary, ///< external binary data type
+        ExternalChunked ///< external chunked and compressed binary data type
     };
 
 protected:
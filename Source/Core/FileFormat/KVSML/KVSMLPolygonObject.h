@@ -40,7 +40,8 @@ public:
     {
         Ascii = 0,     ///< ascii data type
         ExternalAscii, ///< external ascii data type
-        ExternalBinary ///< external binary data type
+        ExternalBinary, ///< external binary data type
+        ExternalChunked ///< external chunked and compressed binary data type
     };
 
 private:
@@ -325,6 +325,9 @@ bool KVSMLStructuredVolumeObject::write( const std::string& filename )
     document.InsertEndChild( kvs::XMLDeclaration( "1.0" ) );
     document.InsertEndChild( kvs::XMLComment( comment.c_str() ) );
 
+    // The external data files are written simultaneously.
+    kvs::kvsml::ExternalDataWriter writer;
+
     // <KVSML>
     m_kvsml_tag.write( &document );
 
@@ -373,6 +376,7 @@ bool KVSMLStructuredVolumeObject::write( const std::string& filename )
 
     // <DataArray>
     kvs::kvsml::DataArrayTag values;
+    values.setWriter( &writer );
     if ( m_writing_type == ExternalAscii )
     {
         values.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "value" ) );
@@ -383,6 +387,11 @@ bool KVSMLStructuredVolumeObject::write( const std::string& filename )
         values.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "value" ) );
         values.setFormat( "binary" );
     }
+    else if ( m_writing_type == ExternalChunked )
+    {
+        values.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "value" ) );
+        values.setFormat( "chunked" );
+    }
 
     const std::string pathname = kvs::File( filename ).pathName();
     if ( !values.write( value_tag.node(), m_values, pathname ) )
@@ -405,6 +414,7 @@ bool KVSMLStructuredVolumeObject::write( const std::string& filename )
 
         // <DataArray>
         kvs::kvsml::DataArrayTag coords;
+        coords.setWriter( &writer );
         if ( m_writing_type == ExternalAscii )
         {
             coords.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "coord" ) );
@@ -415,6 +425,11 @@ bool KVSMLStructuredVolumeObject::write( const std::string& filename )
             coords.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "coord" ) );
             coords.setFormat( "binary" );
         }
+        else if ( m_writing_type == ExternalChunked )
+        {
+            coords.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "coord" ) );
+            coords.setFormat( "chunked" );
+        }
 
         if ( !coords.write( coord_tag.node(), m_coords, pathname ) )
         {
@@ -425,6 +440,12 @@ bool KVSMLStructuredVolumeObject::write( const std::string& filename )
         }
     }
 
+    if ( !writer.wait() )
+    {
+        kvsMessageError( "Cannot write the external data files." );
+        return false;
+    }
+
     const bool success = document.write( filename );
     BaseClass::setSuccess( success );
 
@@ -42,7 +42,8 @@ public:
     {
         Ascii = 0,
         ExternalAscii,
-        ExternalBinary
+        ExternalBinary,
+        ExternalChunked
     };
 
 private:
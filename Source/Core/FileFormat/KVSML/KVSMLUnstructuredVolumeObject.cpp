@@ -322,6 +322,9 @@ bool KVSMLUnstructuredVolumeObject::write( const std::string& filename )
     document.InsertEndChild( kvs::XMLDeclaration("1.0") );
     document.InsertEndChild( kvs::XMLComment( comment.c_str() ) );
 
+    // The external data files are written simultaneously.
+    kvs::kvsml::ExternalDataWriter writer;
+
     // <KVSML>
     m_kvsml_tag.write( &document );
 
@@ -358,6 +361,7 @@ bool KVSMLUnstructuredVolumeObject::write( const std::string& filename )
 
     // <DataArray>
     kvs::kvsml::DataArrayTag values;
+    values.setWriter( &writer );
     if ( m_writing_type == ExternalAscii )
     {
         values.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "value" ) );
@@ -368,6 +372,11 @@ bool KVSMLUnstructuredVolumeObject::write( const std::string& filename )
         values.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "value" ) );
         values.setFormat( "binary" );
     }
+    else if ( m_writing_type == ExternalChunked )
+    {
+        values.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "value" ) );
+        values.setFormat( "chunked" );
+    }
 
     const std::string pathname = kvs::File( filename ).pathName();
     if ( !values.write( m_value_tag.node(), m_values, pathname ) )
@@ -387,6 +396,7 @@ bool KVSMLUnstructuredVolumeObject::write( const std::string& filename )
 
     // <DataArray>
     kvs::kvsml::DataArrayTag coords;
+    coords.setWriter( &writer );
     if ( m_writing_type == ExternalAscii )
     {
         coords.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "coord" ) );
@@ -397,6 +407,11 @@ bool KVSMLUnstructuredVolumeObject::write( const std::string& filename )
         coords.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "coord" ) );
         coords.setFormat( "binary" );
     }
+    else if ( m_writing_type == ExternalChunked )
+    {
+        coords.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "coord" ) );
+        coords.setFormat( "chunked" );
+    }
 
     if ( !coords.write( m_coord_tag.node(), m_coords, pathname ) )
     {
@@ -408,6 +423,12 @@ bool KVSMLUnstructuredVolumeObject::write( const std::string& filename )
 
     if ( m_volume_tag.cellType() == "point" )
     {
+        if ( !writer.wait() )
+        {
+            kvsMessageError( "Cannot write the external data files." );
+            return false;
+        }
+
         const bool success = document.write( filename );
         BaseClass::setSuccess( success );
         return success;
@@ -429,6 +450,7 @@ bool KVSMLUnstructuredVolumeObject::write( const std::string& filename )
 
     // <DataArray>
     kvs::kvsml::DataArrayTag connections;
+    connections.setWriter( &writer );
     if ( m_writing_type == ExternalAscii )
     {
         connections.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "connect" ) );
@@ -439,6 +461,11 @@ bool KVSMLUnstructuredVolumeObject::write( const std::string& filename )
         connections.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "connect" ) );
         connections.setFormat( "binary" );
     }
+    else if ( m_writing_type == ExternalChunked )
+    {
+        connections.setFile( kvs::kvsml::DataArray::GetDataFilename( filename, "connect" ) );
+        connections.setFormat( "chunked" );
+    }
 
     if ( !connections.write( m_connection_tag.node(), m_connections, pathname ) )
     {
@@ -448,6 +475,12 @@ bool KVSMLUnstructuredVolumeObject::write( const std::string& filename )
         return false;
     }
 
+    if ( !writer.wait() )
+    {
+        kvsMessageError( "Cannot write the external data files." );
+        return false;
+    }
+
     const bool success = document.write( filename );
     BaseClass::setSuccess( success );
 
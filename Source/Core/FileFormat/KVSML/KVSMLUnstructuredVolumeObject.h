@@ -48,7 +48,8 @@ public:
     {
         Ascii = 0,
         ExternalAscii,
-        ExternalBinary
+        ExternalBinary,
+        ExternalChunked
     };
 
 private:
@@ -0,0 +1,1113 @@
+/*****************************************************************************/
+/**
+ *  @file   UnstructuredTimeSeries.cpp
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "UnstructuredTimeSeries.h"
+#include "../BinaryIO.h"
+#include <cstring>
+#include <kvs/File>
+#include <kvs/Message>
+#include <kvs/Endian>
+#include <kvs/Math>
+#include <kvs/OpenMP>
+#include <kvs/MutexLocker>
+#include <kvs/FastCompressor>
+
+
+namespace
+{
+
+/// Version of the file.
+const kvs::UInt8 Version = 1;
+
+/// Size of the fixed part of the header in bytes.
+const size_t HeaderSize = 56;
+
+/// Size of the footer in bytes.
+const size_t FooterSize = 24;
+
+/// Size of an entry of the step index in bytes.
+const size_t IndexEntrySize = 24;
+
+/// Default number of the bytes in a chunk of the blocks.
+const size_t ChunkBytes = 1024 * 1024;
+
+/// Index of no step.
+const size_t NoStep = size_t(-1);
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the size of the value of the given type.
+ *  @param  type [in] type ID
+ *  @return size in bytes (0 for the unsupported type)
+ */
+/*===========================================================================*/
+size_t ValueSize( const kvs::Type::TypeID type )
+{
+    switch ( type )
+    {
+    case kvs::Type::TypeInt8: case kvs::Type::TypeUInt8: return 1;
+    case kvs::Type::TypeInt16: case kvs::Type::TypeUInt16: return 2;
+    case kvs::Type::TypeInt32: case kvs::Type::TypeUInt32: case kvs::Type::TypeReal32: return 4;
+    case kvs::Type::TypeInt64: case kvs::Type::TypeUInt64: case kvs::Type::TypeReal64: return 8;
+    default: return 0;
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Allocates the value array of the given type.
+ *  @param  type [in] type ID
+ *  @param  n [in] number of the values
+ *  @return value array
+ */
+/*===========================================================================*/
+kvs::AnyValueArray Allocate( const kvs::Type::TypeID type, const size_t n )
+{
+    switch ( type )
+    {
+    case kvs::Type::TypeInt8: return kvs::AnyValueArray( kvs::ValueArray<kvs::Int8>( n ) );
+    case kvs::Type::TypeUInt8: return kvs::AnyValueArray( kvs::ValueArray<kvs::UInt8>( n ) );
+    case kvs::Type::TypeInt16: return kvs::AnyValueArray( kvs::ValueArray<kvs::Int16>( n ) );
+    case kvs::Type::TypeUInt16: return kvs::AnyValueArray( kvs::ValueArray<kvs::UInt16>( n ) );
+    case kvs::Type::TypeInt32: return kvs::AnyValueArray( kvs::ValueArray<kvs::Int32>( n ) );
+    case kvs::Type::TypeUInt32: return kvs::AnyValueArray( kvs::ValueArray<kvs::UInt32>( n ) );
+    case kvs::Type::TypeInt64: return kvs::AnyValueArray( kvs::ValueArray<kvs::Int64>( n ) );
+    case kvs::Type::TypeUInt64: return kvs::AnyValueArray( kvs::ValueArray<kvs::UInt64>( n ) );
+    case kvs::Type::TypeReal32: return kvs::AnyValueArray( kvs::ValueArray<kvs::Real32>( n ) );
+    case kvs::Type::TypeReal64: return kvs::AnyValueArray( kvs::ValueArray<kvs::Real64>( n ) );
+    default: return kvs::AnyValueArray();
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the residual of the values from the key frame.
+ *  @param  values [in] values
+ *  @param  key [in] values of the key frame
+ *  @param  n [in] number of the values
+ *  @param  encoding [in] encoding
+ *  @param  residual [out] residual
+ *
+ *  The bit patterns are handled as the unsigned integers U. The difference
+ *  is mapped by the zigzag encoding so that the small negative differences
+ *  have the zero upper bytes as well as the positive ones.
+ */
+/*===========================================================================*/
+template <typename U>
+void Residual(
+    const U* values,
+    const U* key,
+    const size_t n,
+    const kvs::UnstructuredTimeSeries::Encoding encoding,
+    U* residual )
+{
+    const int msb = int( sizeof( U ) * 8 - 1 );
+    if ( encoding == kvs::UnstructuredTimeSeries::XorEncoding )
+    {
+        KVS_OMP_PARALLEL_FOR( schedule(static) )
+        for ( size_t i = 0; i < n; i++ )
+        {
+            residual[i] = static_cast<U>( values[i] ^ key[i] );
+        }
+    }
+    else
+    {
+        KVS_OMP_PARALLEL_FOR( schedule(static) )
+        for ( size_t i = 0; i < n; i++ )
+        {
+            const U d = static_cast<U>( values[i] - key[i] );
+            residual[i] = static_cast<U>( static_cast<U>( d << 1 ) ^ static_cast<U>( U(0) - static_cast<U>( d >> msb ) ) );
+        }
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Restores the values from the residual and the key frame.
+ *  @param  data [in/out] residual (in) and values (out)
+ *  @param  key [in] values of the key frame
+ *  @param  n [in] number of the values
+ *  @param  encoding [in] encoding
+ */
+/*===========================================================================*/
+template <typename U>
+void Restore(
+    U* data,
+    const U* key,
+    const size_t n,
+    const kvs::UnstructuredTimeSeries::Encoding encoding )
+{
+    if ( encoding == kvs::UnstructuredTimeSeries::XorEncoding )
+    {
+        KVS_OMP_PARALLEL_FOR( schedule(static) )
+        for ( size_t i = 0; i < n; i++ )
+        {
+            data[i] = static_cast<U>( data[i] ^ key[i] );
+        }
+    }
+    else
+    {
+        KVS_OMP_PARALLEL_FOR( schedule(static) )
+        for ( size_t i = 0; i < n; i++ )
+        {
+            const U z = data[i];
+            const U d = static_cast<U>( static_cast<U>( z >> 1 ) ^ static_cast<U>( U(0) - static_cast<U>( z & 1 ) ) );
+            data[i] = static_cast<U>( key[i] + d );
+        }
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the residual for the value size.
+ */
+/*===========================================================================*/
+void Residual(
+    const void* values,
+    const void* key,
+    const size_t n,
+    const size_t value_size,
+    const kvs::UnstructuredTimeSeries::Encoding encoding,
+    void* residual )
+{
+    switch ( value_size )
+    {
+    case 1: Residual( static_cast<const kvs::UInt8*>( values ), static_cast<const kvs::UInt8*>( key ), n, encoding, static_cast<kvs::UInt8*>( residual ) ); break;
+    case 2: Residual( static_cast<const kvs::UInt16*>( values ), static_cast<const kvs::UInt16*>( key ), n, encoding, static_cast<kvs::UInt16*>( residual ) ); break;
+    case 4: Residual( static_cast<const kvs::UInt32*>( values ), static_cast<const kvs::UInt32*>( key ), n, encoding, static_cast<kvs::UInt32*>( residual ) ); break;
+    case 8: Residual( static_cast<const kvs::UInt64*>( values ), static_cast<const kvs::UInt64*>( key ), n, encoding, static_cast<kvs::UInt64*>( residual ) ); break;
+    default: break;
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Restores the values for the value size.
+ */
+/*===========================================================================*/
+void Restore(
+    void* data,
+    const void* key,
+    const size_t n,
+    const size_t value_size,
+    const kvs::UnstructuredTimeSeries::Encoding encoding )
+{
+    switch ( value_size )
+    {
+    case 1: Restore( static_cast<kvs::UInt8*>( data ), static_cast<const kvs::UInt8*>( key ), n, encoding ); break;
+    case 2: Restore( static_cast<kvs::UInt16*>( data ), static_cast<const kvs::UInt16*>( key ), n, encoding ); break;
+    case 4: Restore( static_cast<kvs::UInt32*>( data ), static_cast<const kvs::UInt32*>( key ), n, encoding ); break;
+    case 8: Restore( static_cast<kvs::UInt64*>( data ), static_cast<const kvs::UInt64*>( key ), n, encoding ); break;
+    default: break;
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the number of the nodes of the cell.
+ *  @param  cell_type [in] cell type name
+ *  @return number of the nodes (0 for the unknown cell type)
+ */
+/*===========================================================================*/
+size_t NumberOfCellNodes( const std::string& cell_type )
+{
+    if (      cell_type == "tetrahedra" ) { return 4; }
+    else if ( cell_type == "quadratic tetrahedra" ) { return 10; }
+    else if ( cell_type == "hexahedra" ) { return 8; }
+    else if ( cell_type == "quadratic hexahedra" ) { return 20; }
+    else if ( cell_type == "pyramid" ) { return 5; }
+    else if ( cell_type == "prism" ) { return 6; }
+    else if ( cell_type == "point" ) { return 1; }
+    return 0;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the number of the chunks in the block.
+ *  @param  n [in] number of the values
+ *  @param  chunk_size [in] number of the values in a chunk
+ *  @return number of the chunks
+ */
+/*===========================================================================*/
+inline size_t NumberOfChunks( const size_t n, const size_t chunk_size )
+{
+    return ( n + chunk_size - 1 ) / chunk_size;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Encodes the values into the block.
+ *  @param  data [in] values
+ *  @param  n [in] number of the values
+ *  @param  value_size [in] size of the value in bytes
+ *  @param  chunk_bytes [in] number of the bytes in a chunk
+ *  @param  block [out] block
+ */
+/*===========================================================================*/
+void EncodeBlock(
+    const void* data,
+    const size_t n,
+    const size_t value_size,
+    const size_t chunk_bytes,
+    std::vector<kvs::UInt8>* block )
+{
+    const size_t chunk_size = kvs::Math::Max( chunk_bytes / value_size, size_t(1) );
+    const size_t nchunks = ::NumberOfChunks( n, chunk_size );
+    const kvs::UInt8* values = static_cast<const kvs::UInt8*>( data );
+
+    std::vector< std::vector<kvs::UInt8> > chunks( nchunks );
+    KVS_OMP_PARALLEL_FOR( schedule(dynamic) )
+    for ( size_t i = 0; i < nchunks; i++ )
+    {
+        const size_t m = kvs::Math::Min( chunk_size, n - i * chunk_size );
+        const size_t bytes = m * value_size;
+        const kvs::UInt8* src = values + i * chunk_size * value_size;
+
+        // The b-th bytes of the values are gathered in the b-th plane.
+        std::vector<kvs::UInt8> shuffled( bytes );
+        for ( size_t b = 0; b < value_size; b++ )
+        {
+            kvs::UInt8* d = &shuffled[ b * m ];
+            for ( size_t j = 0; j < m; j++ ) { d[j] = src[ j * value_size + b ]; }
+        }
+
+        std::vector<kvs::UInt8>& chunk = chunks[i];
+        chunk.resize( kvs::FastCompressor::MaxCompressedSize( bytes ) );
+        const size_t size = kvs::FastCompressor::Compress( &shuffled[0], bytes, &chunk[0] );
+        if ( size < bytes ) { chunk.resize( size ); }
+        else { chunk.assign( src, src + bytes ); }
+    }
+
+    size_t size = 8 + 8 * nchunks;
+    for ( size_t i = 0; i < nchunks; i++ ) { size += chunks[i].size(); }
+
+    block->resize( size );
+    kvs::UInt8* p = &(*block)[0];
+    kvs::detail::Put64( p, n );
+    for ( size_t i = 0; i < nchunks; i++ ) { kvs::detail::Put64( p + 8 + 8 * i, chunks[i].size() ); }
+    p += 8 + 8 * nchunks;
+    for ( size_t i = 0; i < nchunks; i++ )
+    {
+        if ( !chunks[i].empty() ) { std::memcpy( p, &chunks[i][0], chunks[i].size() ); }
+        p += chunks[i].size();
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Decodes the values from the block.
+ *  @param  block [in] block
+ *  @param  block_size [in] size of the block in bytes
+ *  @param  n [in] number of the values
+ *  @param  value_size [in] size of the value in bytes
+ *  @param  chunk_bytes [in] number of the bytes in a chunk
+ *  @param  data [out] values
+ *  @return true, if the block is decoded successfully
+ */
+/*===========================================================================*/
+bool DecodeBlock(
+    const kvs::UInt8* block,
+    const size_t block_size,
+    const size_t n,
+    const size_t value_size,
+    const size_t chunk_bytes,
+    void* data )
+{
+    const size_t chunk_size = kvs::Math::Max( chunk_bytes / value_size, size_t(1) );
+    const size_t nchunks = ::NumberOfChunks( n, chunk_size );
+    if ( block_size < 8 + 8 * nchunks || kvs::detail::Get64( block ) != n ) { return false; }
+
+    std::vector<size_t> offsets( nchunks + 1 );
+    offsets[0] = 8 + 8 * nchunks;
+    for ( size_t i = 0; i < nchunks; i++ )
+    {
+        const kvs::UInt64 size = kvs::detail::Get64( block + 8 + 8 * i );
+        if ( size > block_size - offsets[i] ) { return false; }
+        offsets[ i + 1 ] = offsets[i] + static_cast<size_t>( size );
+    }
+
+    kvs::UInt8* values = static_cast<kvs::UInt8*>( data );
+    std::vector<char> decoded( nchunks, 1 );
+    KVS_OMP_PARALLEL_FOR( schedule(dynamic) )
+    for ( size_t i = 0; i < nchunks; i++ )
+    {
+        const size_t m = kvs::Math::Min( chunk_size, n - i * chunk_size );
+        const size_t bytes = m * value_size;
+        const kvs::UInt8* src = block + offsets[i];
+        const size_t src_size = offsets[ i + 1 ] - offsets[i];
+        kvs::UInt8* dst = values + i * chunk_size * value_size;
+        if ( src_size == bytes )
+        {
+            std::memcpy( dst, src, bytes );
+            continue;
+        }
+
+        std::vector<kvs::UInt8> shuffled( bytes );
+        if ( !kvs::FastCompressor::Decompress( src, src_size, &shuffled[0], bytes ) )
+        {
+            decoded[i] = 0;
+            continue;
+        }
+
+        for ( size_t b = 0; b < value_size; b++ )
+        {
+            const kvs::UInt8* s = &shuffled[ b * m ];
+            for ( size_t j = 0; j < m; j++ ) { dst[ j * value_size + b ] = s[j]; }
+        }
+    }
+
+    for ( size_t i = 0; i < nchunks; i++ )
+    {
+        if ( !decoded[i] ) { return false; }
+    }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reads the block at the current position of the file.
+ *  @param  fp [in] file pointer
+ *  @param  value_size [in] size of the value in bytes
+ *  @param  chunk_bytes [in] number of the bytes in a chunk
+ *  @param  nvalues [in] number of the values expected in the block
+ *  @param  file_size [in] size of the file in bytes
+ *  @param  block [out] block
+ *  @return number of the values, or size_t(-1) if failed
+ *
+ *  The number of the values and the sizes of the chunks are checked before
+ *  the allocation, so that the broken block is not read beyond the file.
+ */
+/*===========================================================================*/
+size_t ReadBlock(
+    std::FILE* fp,
+    const size_t value_size,
+    const size_t chunk_bytes,
+    const size_t nvalues,
+    const kvs::UInt64 file_size,
+    std::vector<kvs::UInt8>* block )
+{
+    const kvs::Int64 position = kvs::detail::Tell( fp );
+    if ( position < 0 || file_size < kvs::UInt64( position ) + 8 ) { return ::NoStep; }
+    kvs::UInt64 remaining = file_size - kvs::UInt64( position ) - 8;
+
+    kvs::UInt8 buffer[8];
+    if ( std::fread( buffer, 1, 8, fp ) != 8 ) { return ::NoStep; }
+    if ( kvs::detail::Get64( buffer ) != nvalues ) { return ::NoStep; }
+
+    const size_t n = nvalues;
+    const size_t chunk_size = kvs::Math::Max( chunk_bytes / value_size, size_t(1) );
+    const size_t nchunks = ::NumberOfChunks( n, chunk_size );
+    if ( nchunks > remaining / 8 ) { return ::NoStep; }
+    remaining -= 8 * nchunks;
+
+    block->resize( 8 + 8 * nchunks );
+    std::memcpy( &(*block)[0], buffer, 8 );
+    if ( nchunks > 0 && std::fread( &(*block)[8], 1, 8 * nchunks, fp ) != 8 * nchunks ) { return ::NoStep; }
+
+    size_t size = block->size();
+    for ( size_t i = 0; i < nchunks; i++ )
+    {
+        const kvs::UInt64 chunk = kvs::detail::Get64( &(*block)[ 8 + 8 * i ] );
+        if ( chunk > remaining ) { return ::NoStep; }
+        remaining -= chunk;
+        size += static_cast<size_t>( chunk );
+    }
+
+    const size_t header_size = block->size();
+    block->resize( size );
+    if ( size > header_size && std::fread( &(*block)[ header_size ], 1, size - header_size, fp ) != size - header_size )
+    {
+        return ::NoStep;
+    }
+
+    return n;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reads and decodes the mesh array at the current position of the file.
+ *  @param  fp [in] file pointer
+ *  @param  chunk_bytes [in] number of the bytes in a chunk
+ *  @param  swap [in] true, if the values must be swapped
+ *  @param  nvalues [in] number of the values expected in the array
+ *  @param  file_size [in] size of the file in bytes
+ *  @param  values [out] values
+ *  @return true, if the reading process is done successfully
+ */
+/*===========================================================================*/
+template <typename T>
+bool ReadArray(
+    std::FILE* fp,
+    const size_t chunk_bytes,
+    const bool swap,
+    const size_t nvalues,
+    const kvs::UInt64 file_size,
+    kvs::ValueArray<T>* values )
+{
+    std::vector<kvs::UInt8> block;
+    const size_t n = ::ReadBlock( fp, sizeof(T), chunk_bytes, nvalues, file_size, &block );
+    if ( n == ::NoStep ) { return false; }
+
+    values->allocate( n );
+    if ( n > 0 && !::DecodeBlock( &block[0], block.size(), n, sizeof(T), chunk_bytes, values->data() ) ) { return false; }
+    if ( swap ) { kvs::detail::Swap( values->data(), n, sizeof(T) ); }
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Writes the bytes to the file.
+ *  @param  fp [in] file pointer
+ *  @param  data [in] bytes
+ *  @param  size [in] number of the bytes
+ *  @return true, if the writing process is done successfully
+ */
+/*===========================================================================*/
+inline bool WriteBytes( std::FILE* fp, const void* data, const size_t size )
+{
+    return size == 0 || std::fwrite( data, 1, size, fp ) == size;
+}
+
+} // end of namespace
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Checks the file extension.
+ *  @param  filename [in] filename
+ *  @return true, if the given filename has the supported extension
+ */
+/*===========================================================================*/
+bool UnstructuredTimeSeries::CheckExtension( const std::string& filename )
+{
+    const kvs::File file( filename );
+    if ( file.extension() == "kvsts" || file.extension() == "KVSTS" )
+    {
+        return true;
+    }
+
+    return false;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Check the file format.
+ *  @param  filename [in] filename
+ *  @return true, if the UnstructuredTimeSeries class can read the given file
+ */
+/*===========================================================================*/
+bool UnstructuredTimeSeries::CheckFormat( const std::string& filename )
+{
+    std::FILE* fp = std::fopen( filename.c_str(), "rb" );
+    if ( !fp ) { return false; }
+
+    char magic[6];
+    const bool valid = std::fread( magic, 1, 6, fp ) == 6 && std::memcmp( magic, "KVSTS", 5 ) == 0 && magic[5] == char( ::Version );
+    std::fclose( fp );
+    return valid;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new UnstructuredTimeSeries class.
+ */
+/*===========================================================================*/
+UnstructuredTimeSeries::UnstructuredTimeSeries():
+    m_cell_type( "" ),
+    m_veclen( 1 ),
+    m_nnodes( 0 ),
+    m_ncells( 0 ),
+    m_value_type( kvs::Type::UnknownType ),
+    m_encoding( DeltaEncoding ),
+    m_key_interval( 16 ),
+    m_chunk_bytes( ::ChunkBytes ),
+    m_swap( false ),
+    m_fp( NULL ),
+    m_offset( 0 ),
+    m_key_index( ::NoStep )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new UnstructuredTimeSeries class by reading the file.
+ *  @param  filename [in] filename
+ */
+/*===========================================================================*/
+UnstructuredTimeSeries::UnstructuredTimeSeries( const std::string& filename ):
+    m_cell_type( "" ),
+    m_veclen( 1 ),
+    m_nnodes( 0 ),
+    m_ncells( 0 ),
+    m_value_type( kvs::Type::UnknownType ),
+    m_encoding( DeltaEncoding ),
+    m_key_interval( 16 ),
+    m_chunk_bytes( ::ChunkBytes ),
+    m_swap( false ),
+    m_fp( NULL ),
+    m_offset( 0 ),
+    m_key_index( ::NoStep )
+{
+    this->read( filename );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Destroys the UnstructuredTimeSeries class.
+ *
+ *  The file opened by create() is closed (the index is written) if it has
+ *  not been closed yet.
+ */
+/*===========================================================================*/
+UnstructuredTimeSeries::~UnstructuredTimeSeries()
+{
+    if ( m_fp ) { this->close(); }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the values of the step.
+ *  @param  index [in] index of the step
+ *  @return values (empty, if the reading process is failed)
+ *
+ *  The values of the last key frame referred are cached, so that the steps
+ *  following the same key frame are decoded from their own blocks only.
+ *  This method can be called from the multiple threads.
+ */
+/*===========================================================================*/
+kvs::AnyValueArray UnstructuredTimeSeries::values( const size_t index ) const
+{
+    if ( index >= this->numberOfSteps() )
+    {
+        kvsMessageError( "Step %lu is out of range [0, %lu).", (unsigned long)index, (unsigned long)this->numberOfSteps() );
+        return kvs::AnyValueArray();
+    }
+
+    const size_t interval = kvs::Math::Max( m_key_interval, size_t(1) );
+    const size_t key = m_encoding == NoEncoding ? index : index - index % interval;
+    if ( key == index )
+    {
+        if ( m_encoding != NoEncoding )
+        {
+            kvs::MutexLocker locker( &m_mutex );
+            if ( m_key_index == key ) { return m_key_values.clone(); }
+        }
+
+        kvs::AnyValueArray values = this->read_block( index );
+        if ( m_encoding != NoEncoding && !values.empty() )
+        {
+            kvs::MutexLocker locker( &m_mutex );
+            m_key_index = key;
+            m_key_values = values.clone();
+        }
+        return values;
+    }
+
+    kvs::AnyValueArray key_values;
+    {
+        kvs::MutexLocker locker( &m_mutex );
+        if ( m_key_index == key ) { key_values = m_key_values; }
+    }
+
+    if ( key_values.empty() )
+    {
+        key_values = this->read_block( key );
+        if ( key_values.empty() ) { return kvs::AnyValueArray(); }
+
+        kvs::MutexLocker locker( &m_mutex );
+        m_key_index = key;
+        m_key_values = key_values;
+    }
+
+    kvs::AnyValueArray values = this->read_block( index );
+    if ( values.empty() ) { return kvs::AnyValueArray(); }
+
+    const size_t value_size = ::ValueSize( m_value_type );
+    ::Restore( values.data(), key_values.data(), values.size(), value_size, m_encoding );
+    return values;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Adds the values of the step to be written by write().
+ *  @param  values [in] values of the step (shared, not copied)
+ *  @param  time [in] time of the step
+ */
+/*===========================================================================*/
+void UnstructuredTimeSeries::addStep( const kvs::AnyValueArray& values, const double time )
+{
+    m_steps.push_back( values );
+    m_times.push_back( time );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Prints the information of the time series.
+ *  @param  os [in] output stream
+ *  @param  indent [in] indent
+ */
+/*===========================================================================*/
+void UnstructuredTimeSeries::print( std::ostream& os, const kvs::Indent& indent ) const
+{
+    const char* encoding[] = { "none", "delta", "xor" };
+    os << indent << "Filename : " << BaseClass::filename() << std::endl;
+    os << indent << "Cell type : " << this->cellType() << std::endl;
+    os << indent << "Veclen : " << this->veclen() << std::endl;
+    os << indent << "Number of nodes : " << this->nnodes() << std::endl;
+    os << indent << "Number of cells : " << this->ncells() << std::endl;
+    os << indent << "Number of steps : " << this->numberOfSteps() << std::endl;
+    os << indent << "Encoding : " << encoding[ m_encoding ] << std::endl;
+    os << indent << "Key interval : " << this->keyInterval() << std::endl;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reads the header, the mesh and the step index of the file.
+ *  @param  filename [in] filename
+ *  @return true, if the reading process is done successfully
+ *
+ *  The values of the steps are read by values() on demand.
+ */
+/*===========================================================================*/
+bool UnstructuredTimeSeries::read( const std::string& filename )
+{
+    BaseClass::setFilename( filename );
+    BaseClass::setSuccess( false );
+
+    m_steps.clear();
+    m_times.clear();
+    m_offsets.clear();
+    m_sizes.clear();
+    {
+        kvs::MutexLocker locker( &m_mutex );
+        m_key_index = ::NoStep;
+        m_key_values = kvs::AnyValueArray();
+    }
+
+    std::FILE* fp = std::fopen( filename.c_str(), "rb" );
+    if ( !fp )
+    {
+        kvsMessageError( "Cannot open '%s'.", filename.c_str() );
+        return false;
+    }
+
+    const kvs::Int64 end = kvs::detail::Seek( fp, 0, SEEK_END ) ? kvs::detail::Tell( fp ) : -1;
+    if ( end < 0 || !kvs::detail::Seek( fp, 0, SEEK_SET ) )
+    {
+        kvsMessageError( "Cannot read '%s'.", filename.c_str() );
+        std::fclose( fp );
+        return false;
+    }
+    const kvs::UInt64 file_size = static_cast<kvs::UInt64>( end );
+
+    // Header.
+    kvs::UInt8 header[ ::HeaderSize ];
+    if ( std::fread( header, 1, ::HeaderSize, fp ) != ::HeaderSize ||
+         std::memcmp( header, "KVSTS", 5 ) != 0 || header[5] != ::Version )
+    {
+        kvsMessageError( "'%s' is not a time-series file.", filename.c_str() );
+        std::fclose( fp );
+        return false;
+    }
+
+    m_swap = ( header[6] != 0 ) != kvs::Endian::IsBig();
+    m_encoding = static_cast<Encoding>( header[7] );
+    m_value_type = static_cast<kvs::Type::TypeID>( header[8] );
+    m_key_interval = 0;
+    for ( size_t i = 0; i < 4; i++ ) { m_key_interval |= size_t( header[ 12 + i ] ) << ( 8 * i ); }
+    m_veclen = static_cast<size_t>( kvs::detail::Get64( header + 16 ) );
+    m_nnodes = static_cast<size_t>( kvs::detail::Get64( header + 24 ) );
+    m_ncells = static_cast<size_t>( kvs::detail::Get64( header + 32 ) );
+    m_chunk_bytes = static_cast<size_t>( kvs::detail::Get64( header + 40 ) );
+    const kvs::UInt64 length = kvs::detail::Get64( header + 48 );
+
+    const bool valid =
+        m_encoding <= XorEncoding && m_chunk_bytes > 0 &&
+        ::ValueSize( m_value_type ) == header[9] && header[9] > 0 &&
+        length < file_size;
+    if ( !valid )
+    {
+        kvsMessageError( "Broken header in '%s'.", filename.c_str() );
+        std::fclose( fp );
+        return false;
+    }
+
+    m_cell_type.resize( static_cast<size_t>( length ) );
+    if ( length > 0 && std::fread( &m_cell_type[0], 1, m_cell_type.size(), fp ) != m_cell_type.size() )
+    {
+        kvsMessageError( "Cannot read '%s'.", filename.c_str() );
+        std::fclose( fp );
+        return false;
+    }
+
+    // Mesh, whose sizes are checked against the header before the allocation.
+    const size_t ncell_nodes = ::NumberOfCellNodes( m_cell_type );
+    const size_t max_size = size_t(-1) / 32;
+    if ( ncell_nodes == 0 || m_nnodes > max_size || m_ncells > max_size || m_veclen == 0 || m_veclen > max_size / kvs::Math::Max( m_nnodes, size_t(1) ) )
+    {
+        kvsMessageError( "Broken header in '%s'.", filename.c_str() );
+        std::fclose( fp );
+        return false;
+    }
+
+    if ( !::ReadArray( fp, m_chunk_bytes, m_swap, m_nnodes * 3, file_size, &m_coords ) ||
+         !::ReadArray( fp, m_chunk_bytes, m_swap, m_ncells * ncell_nodes, file_size, &m_connections ) )
+    {
+        kvsMessageError( "Cannot read the mesh in '%s'.", filename.c_str() );
+        std::fclose( fp );
+        return false;
+    }
+
+    // Footer and step index.
+    kvs::UInt8 footer[ ::FooterSize ];
+    if ( !kvs::detail::Seek( fp, -kvs::Int64( ::FooterSize ), SEEK_END ) ||
+         std::fread( footer, 1, ::FooterSize, fp ) != ::FooterSize ||
+         std::memcmp( footer + 16, "KVSTSEND", 8 ) != 0 )
+    {
+        kvsMessageError( "'%s' is not closed.", filename.c_str() );
+        std::fclose( fp );
+        return false;
+    }
+
+    const kvs::UInt64 nsteps = kvs::detail::Get64( footer );
+    const kvs::UInt64 index_offset = kvs::detail::Get64( footer + 8 );
+    if ( index_offset > file_size || nsteps > ( file_size - index_offset ) / ::IndexEntrySize )
+    {
+        kvsMessageError( "Broken step index in '%s'.", filename.c_str() );
+        std::fclose( fp );
+        return false;
+    }
+
+    std::vector<kvs::UInt8> index( static_cast<size_t>( nsteps ) * ::IndexEntrySize );
+    const bool success =
+        kvs::detail::Seek( fp, static_cast<kvs::Int64>( index_offset ), SEEK_SET ) &&
+        ( index.empty() || std::fread( &index[0], 1, index.size(), fp ) == index.size() );
+    std::fclose( fp );
+    if ( !success )
+    {
+        kvsMessageError( "Cannot read '%s'.", filename.c_str() );
+        return false;
+    }
+
+    m_times.resize( static_cast<size_t>( nsteps ) );
+    m_offsets.resize( static_cast<size_t>( nsteps ) );
+    m_sizes.resize( static_cast<size_t>( nsteps ) );
+    for ( size_t i = 0; i < m_times.size(); i++ )
+    {
+        const kvs::UInt8* entry = &index[ i * ::IndexEntrySize ];
+        const kvs::UInt64 time = kvs::detail::Get64( entry + 16 );
+        m_offsets[i] = kvs::detail::Get64( entry );
+        m_sizes[i] = kvs::detail::Get64( entry + 8 );
+        std::memcpy( &m_times[i], &time, sizeof( double ) );
+        if ( m_offsets[i] > index_offset || m_sizes[i] > index_offset - m_offsets[i] )
+        {
+            kvsMessageError( "Broken step index in '%s'.", filename.c_str() );
+            return false;
+        }
+    }
+
+    BaseClass::setSuccess( true );
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Writes the mesh and the steps added by addStep() to the file.
+ *  @param  filename [in] filename
+ *  @return true, if the writing process is done successfully
+ */
+/*===========================================================================*/
+bool UnstructuredTimeSeries::write( const std::string& filename )
+{
+    const std::vector<kvs::AnyValueArray> steps( m_steps );
+    const std::vector<double> times( m_times );
+
+    if ( !this->create( filename ) ) { return false; }
+    for ( size_t i = 0; i < steps.size(); i++ )
+    {
+        if ( !this->append( steps[i], times[i] ) )
+        {
+            std::fclose( m_fp );
+            m_fp = NULL;
+            return false;
+        }
+    }
+
+    return this->close();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Creates the file and writes the header and the mesh.
+ *  @param  filename [in] filename
+ *  @return true, if the writing process is done successfully
+ *
+ *  The values of the steps are written by append() one by one, and the file
+ *  is completed by close(), so that all of the steps are not needed to be
+ *  held in the memory.
+ */
+/*===========================================================================*/
+bool UnstructuredTimeSeries::create( const std::string& filename )
+{
+    BaseClass::setFilename( filename );
+    BaseClass::setSuccess( false );
+
+    if ( m_fp )
+    {
+        kvsMessageError( "The file is already created." );
+        return false;
+    }
+
+    if ( m_coords.size() != m_nnodes * 3 )
+    {
+        kvsMessageError( "The number of the coordinates is not equal to the number of nodes." );
+        return false;
+    }
+
+    const size_t ncell_nodes = ::NumberOfCellNodes( m_cell_type );
+    if ( ncell_nodes == 0 )
+    {
+        kvsMessageError( "Unknown cell type '%s'.", m_cell_type.c_str() );
+        return false;
+    }
+
+    if ( m_connections.size() != m_ncells * ncell_nodes )
+    {
+        kvsMessageError( "The number of the connections is not equal to the number of cells." );
+        return false;
+    }
+
+    m_fp = std::fopen( filename.c_str(), "wb" );
+    if ( !m_fp )
+    {
+        kvsMessageError( "Cannot open '%s'.", filename.c_str() );
+        return false;
+    }
+
+    m_times.clear();
+    m_offsets.clear();
+    m_sizes.clear();
+    m_swap = false;
+    m_chunk_bytes = ::ChunkBytes;
+    m_value_type = kvs::Type::UnknownType;
+    m_key_index = ::NoStep;
+    m_key_values = kvs::AnyValueArray();
+
+    // Header, in which the value type is written by close().
+    kvs::UInt8 header[ ::HeaderSize ];
+    std::memset( header, 0, ::HeaderSize );
+    std::memcpy( header, "KVSTS", 5 );
+    header[5] = ::Version;
+    header[6] = kvs::Endian::IsBig() ? 1 : 0;
+    header[7] = static_cast<kvs::UInt8>( m_encoding );
+    const size_t interval = kvs::Math::Max( m_key_interval, size_t(1) );
+    for ( size_t i = 0; i < 4; i++ ) { header[ 12 + i ] = static_cast<kvs::UInt8>( interval >> ( 8 * i ) ); }
+    kvs::detail::Put64( header + 16, m_veclen );
+    kvs::detail::Put64( header + 24, m_nnodes );
+    kvs::detail::Put64( header + 32, m_ncells );
+    kvs::detail::Put64( header + 40, m_chunk_bytes );
+    kvs::detail::Put64( header + 48, m_cell_type.size() );
+
+    std::vector<kvs::UInt8> coords;
+    std::vector<kvs::UInt8> connections;
+    ::EncodeBlock( m_coords.data(), m_coords.size(), sizeof( kvs::Real32 ), m_chunk_bytes, &coords );
+    ::EncodeBlock( m_connections.data(), m_connections.size(), sizeof( kvs::UInt32 ), m_chunk_bytes, &connections );
+
+    const bool success =
+        ::WriteBytes( m_fp, header, ::HeaderSize ) &&
+        ::WriteBytes( m_fp, m_cell_type.data(), m_cell_type.size() ) &&
+        ::WriteBytes( m_fp, &coords[0], coords.size() ) &&
+        ::WriteBytes( m_fp, &connections[0], connections.size() );
+    if ( !success )
+    {
+        kvsMessageError( "Cannot write '%s'.", filename.c_str() );
+        std::fclose( m_fp );
+        m_fp = NULL;
+        return false;
+    }
+
+    m_offset = ::HeaderSize + m_cell_type.size() + coords.size() + connections.size();
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Appends the values of the step to the file created by create().
+ *  @param  values [in] values of the step
+ *  @param  time [in] time of the step
+ *  @return true, if the writing process is done successfully
+ */
+/*===========================================================================*/
+bool UnstructuredTimeSeries::append( const kvs::AnyValueArray& values, const double time )
+{
+    if ( !m_fp )
+    {
+        kvsMessageError( "The file is not created." );
+        return false;
+    }
+
+    if ( values.size() != m_nnodes * m_veclen )
+    {
+        kvsMessageError( "The number of the values is not equal to nnodes * veclen." );
+        return false;
+    }
+
+    const size_t value_size = ::ValueSize( values.typeID() );
+    if ( value_size == 0 )
+    {
+        kvsMessageError( "Unsupported value type." );
+        return false;
+    }
+
+    if ( m_value_type == kvs::Type::UnknownType ) { m_value_type = values.typeID(); }
+    if ( values.typeID() != m_value_type )
+    {
+        kvsMessageError( "The value type is different from the one of the previous steps." );
+        return false;
+    }
+
+    // The key frame is kept (copied) for the residual of the following steps.
+    const size_t index = m_times.size();
+    const size_t interval = kvs::Math::Max( m_key_interval, size_t(1) );
+    std::vector<kvs::UInt8> block;
+    if ( m_encoding == NoEncoding || index % interval == 0 )
+    {
+        ::EncodeBlock( values.data(), values.size(), value_size, m_chunk_bytes, &block );
+        if ( m_encoding != NoEncoding && interval > 1 ) { m_key_values = values.clone(); }
+    }
+    else
+    {
+        std::vector<kvs::UInt8> residual( values.byteSize() );
+        ::Residual( values.data(), m_key_values.data(), values.size(), value_size, m_encoding, residual.empty() ? NULL : &residual[0] );
+        ::EncodeBlock( residual.empty() ? NULL : &residual[0], values.size(), value_size, m_chunk_bytes, &block );
+    }
+
+    if ( !::WriteBytes( m_fp, &block[0], block.size() ) )
+    {
+        kvsMessageError( "Cannot write '%s'.", BaseClass::filename().c_str() );
+        return false;
+    }
+
+    m_times.push_back( time );
+    m_offsets.push_back( m_offset );
+    m_sizes.push_back( block.size() );
+    m_offset += block.size();
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Writes the step index and closes the file created by create().
+ *  @return true, if the writing process is done successfully
+ */
+/*===========================================================================*/
+bool UnstructuredTimeSeries::close()
+{
+    if ( !m_fp )
+    {
+        kvsMessageError( "The file is not created." );
+        return false;
+    }
+
+    const size_t nsteps = m_times.size();
+    std::vector<kvs::UInt8> index( nsteps * ::IndexEntrySize + ::FooterSize );
+    for ( size_t i = 0; i < nsteps; i++ )
+    {
+        kvs::UInt8* entry = &index[ i * ::IndexEntrySize ];
+        kvs::UInt64 time = 0;
+        std::memcpy( &time, &m_times[i], sizeof( double ) );
+        kvs::detail::Put64( entry, m_offsets[i] );
+        kvs::detail::Put64( entry + 8, m_sizes[i] );
+        kvs::detail::Put64( entry + 16, time );
+    }
+
+    kvs::UInt8* footer = &index[ nsteps * ::IndexEntrySize ];
+    kvs::detail::Put64( footer, nsteps );
+    kvs::detail::Put64( footer + 8, m_offset );
+    std::memcpy( footer + 16, "KVSTSEND", 8 );
+
+    // Value type of the steps in the header (Real32 for the empty series).
+    if ( m_value_type == kvs::Type::UnknownType ) { m_value_type = kvs::Type::TypeReal32; }
+    const kvs::UInt8 type[2] = {
+        static_cast<kvs::UInt8>( m_value_type ),
+        static_cast<kvs::UInt8>( ::ValueSize( m_value_type ) ) };
+
+    bool success = ::WriteBytes( m_fp, &index[0], index.size() );
+    success = success && kvs::detail::Seek( m_fp, 8, SEEK_SET ) && ::WriteBytes( m_fp, type, 2 );
+    success = ( std::fclose( m_fp ) == 0 ) && success;
+    m_fp = NULL;
+    m_key_values = kvs::AnyValueArray();
+    if ( !success )
+    {
+        kvsMessageError( "Cannot write '%s'.", BaseClass::filename().c_str() );
+        return false;
+    }
+
+    BaseClass::setSuccess( true );
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reads and decodes the block of the step.
+ *  @param  index [in] index of the step
+ *  @return values or residual of the step (empty, if failed)
+ */
+/*===========================================================================*/
+kvs::AnyValueArray UnstructuredTimeSeries::read_block( const size_t index ) const
+{
+    const std::string& filename = BaseClass::filename();
+    std::FILE* fp = std::fopen( filename.c_str(), "rb" );
+    if ( !fp )
+    {
+        kvsMessageError( "Cannot open '%s'.", filename.c_str() );
+        return kvs::AnyValueArray();
+    }
+
+    std::vector<kvs::UInt8> block( static_cast<size_t>( m_sizes[ index ] ) );
+    const bool success =
+        kvs::detail::Seek( fp, static_cast<kvs::Int64>( m_offsets[ index ] ), SEEK_SET ) &&
+        ( block.empty() || std::fread( &block[0], 1, block.size(), fp ) == block.size() );
+    std::fclose( fp );
+    if ( !success )
+    {
+        kvsMessageError( "Cannot read '%s'.", filename.c_str() );
+        return kvs::AnyValueArray();
+    }
+
+    // The chunk table of the block is checked before the allocation.
+    const size_t n = m_nnodes * m_veclen;
+    const size_t value_size = ::ValueSize( m_value_type );
+    const size_t chunk_size = kvs::Math::Max( m_chunk_bytes / value_size, size_t(1) );
+    if ( block.size() < 8 || ::NumberOfChunks( n, chunk_size ) > ( block.size() - 8 ) / 8 )
+    {
+        kvsMessageError( "Broken block of step %lu in '%s'.", (unsigned long)index, filename.c_str() );
+        return kvs::AnyValueArray();
+    }
+
+    kvs::AnyValueArray values = ::Allocate( m_value_type, n );
+    if ( block.empty() || !::DecodeBlock( &block[0], block.size(), n, value_size, m_chunk_bytes, values.data() ) )
+    {
+        kvsMessageError( "Broken block of step %lu in '%s'.", (unsigned long)index, filename.c_str() );
+        return kvs::AnyValueArray();
+    }
+
+    if ( m_swap ) { kvs::detail::Swap( values.data(), n, value_size ); }
+    return values;
+}
+
+} // end of namespace kvs
@@ -0,0 +1,147 @@
+/*****************************************************************************/
+/**
+ *  @file   UnstructuredTimeSeries.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVS__UNSTRUCTURED_TIME_SERIES_H_INCLUDE
+#define KVS__UNSTRUCTURED_TIME_SERIES_H_INCLUDE
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <kvs/FileFormatBase>
+#include <kvs/AnyValueArray>
+#include <kvs/ValueArray>
+#include <kvs/Type>
+#include <kvs/Indent>
+#include <kvs/Mutex>
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Time-series file format of the unstructured volume (*.kvsts).
+ *
+ *  The mesh (coordinates and connections) shared by all of the time steps is
+ *  stored only once, followed by the value blocks of the steps. The values
+ *  of the steps between the key frames (every keyInterval() steps) can be
+ *  stored as the residual from the values of the preceding key frame, which
+ *  is the difference (DeltaEncoding) or the exclusive-or (XorEncoding) of
+ *  the bit patterns, so that the encoding is lossless for the real values.
+ *  Any step is decoded from at most two blocks (the key frame and the step).
+ *  Each block is divided into the chunks, which are byte-shuffled and
+ *  compressed by kvs::FastCompressor in parallel.
+ *
+ *  File layout (the integers are little endian):
+ *    "KVSTS" version(1B) endian(1B, 0: little, 1: big) encoding(1B)
+ *    value_type(1B) value_size(1B) reserved(2B) key_interval(4B)
+ *    veclen(8B) nnodes(8B) ncells(8B) chunk_bytes(8B)
+ *    cell_type_length(8B) cell_type
+ *    coords block, connections block, value blocks of the steps
+ *    {offset(8B) size(8B) time(8B)}*nsteps
+ *    nsteps(8B) index_offset(8B) "KVSTSEND"
+ *  where a block consists of the number of the values(8B), the sizes of the
+ *  chunks {size(8B)}*nchunks and the chunk data, and a chunk contains
+ *  chunk_bytes / value_size values. A chunk of which the size
+ *  is equal to the original byte size is stored without the compression.
+ */
+/*===========================================================================*/
+class UnstructuredTimeSeries : public kvs::FileFormatBase
+{
+public:
+
+    typedef kvs::FileFormatBase BaseClass;
+
+    enum Encoding
+    {
+        NoEncoding = 0, ///< values of each step are stored as they are
+        DeltaEncoding = 1, ///< difference from the key frame
+        XorEncoding = 2 ///< exclusive-or with the key frame
+    };
+
+private:
+
+    std::string m_cell_type; ///< cell type
+    size_t m_veclen; ///< vector length
+    size_t m_nnodes; ///< number of nodes
+    size_t m_ncells; ///< number of cells
+    kvs::Type::TypeID m_value_type; ///< type of the values
+    Encoding m_encoding; ///< encoding of the values
+    size_t m_key_interval; ///< interval of the key frames
+    kvs::ValueArray<kvs::Real32> m_coords; ///< coordinate value array (shared by the steps)
+    kvs::ValueArray<kvs::UInt32> m_connections; ///< connection id array (shared by the steps)
+    std::vector<kvs::AnyValueArray> m_steps; ///< values of the steps to be written
+    std::vector<double> m_times; ///< times of the steps
+    std::vector<kvs::UInt64> m_offsets; ///< offsets of the value blocks
+    std::vector<kvs::UInt64> m_sizes; ///< sizes of the value blocks in bytes
+    size_t m_chunk_bytes; ///< number of the bytes in a chunk of the blocks
+    bool m_swap; ///< true, if the values in the file must be swapped
+    std::FILE* m_fp; ///< file pointer for the step-by-step writing
+    kvs::UInt64 m_offset; ///< current offset in the writing file
+    mutable kvs::Mutex m_mutex; ///< mutex for the key frame cache
+    mutable size_t m_key_index; ///< index of the cached key frame
+    mutable kvs::AnyValueArray m_key_values; ///< values of the cached key frame
+
+public:
+
+    static bool CheckExtension( const std::string& filename );
+    static bool CheckFormat( const std::string& filename );
+
+public:
+
+    UnstructuredTimeSeries();
+    UnstructuredTimeSeries( const std::string& filename );
+    virtual ~UnstructuredTimeSeries();
+
+    const std::string& cellType() const { return m_cell_type; }
+    size_t veclen() const { return m_veclen; }
+    size_t nnodes() const { return m_nnodes; }
+    size_t ncells() const { return m_ncells; }
+    kvs::Type::TypeID valueType() const { return m_value_type; }
+    Encoding encoding() const { return m_encoding; }
+    size_t keyInterval() const { return m_key_interval; }
+    const kvs::ValueArray<kvs::Real32>& coords() const { return m_coords; }
+    const kvs::ValueArray<kvs::UInt32>& connections() const { return m_connections; }
+    size_t numberOfSteps() const { return m_times.size(); }
+    double time( const size_t index ) const { return m_times[ index ]; }
+    kvs::AnyValueArray values( const size_t index ) const;
+
+    void setCellType( const std::string& type ) { m_cell_type = type; }
+    void setVeclen( const size_t veclen ) { m_veclen = veclen; }
+    void setNNodes( const size_t nnodes ) { m_nnodes = nnodes; }
+    void setNCells( const size_t ncells ) { m_ncells = ncells; }
+    void setEncoding( const Encoding encoding ) { m_encoding = encoding; }
+    void setKeyInterval( const size_t interval ) { m_key_interval = interval; }
+    void setCoords( const kvs::ValueArray<kvs::Real32>& coords ) { m_coords = coords; }
+    void setConnections( const kvs::ValueArray<kvs::UInt32>& connections ) { m_connections = connections; }
+    void addStep( const kvs::AnyValueArray& values, const double time );
+
+    void print( std::ostream& os, const kvs::Indent& indent = kvs::Indent(0) ) const;
+    bool read( const std::string& filename );
+    bool write( const std::string& filename );
+
+    bool create( const std::string& filename );
+    bool append( const kvs::AnyValueArray& values, const double time );
+    bool close();
+
+private:
+
+    UnstructuredTimeSeries( const UnstructuredTimeSeries& );
+    UnstructuredTimeSeries& operator =( const UnstructuredTimeSeries& );
+
+    kvs::AnyValueArray read_block( const size_t index ) const;
+};
+
+} // end of namespace kvs
+
+#endif // KVS__UNSTRUCTURED_TIME_SERIES_H_INCLUDE
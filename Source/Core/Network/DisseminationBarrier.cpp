@@ -0,0 +1,364 @@
+/*****************************************************************************/
+/**
+ *  @file   DisseminationBarrier.cpp
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "DisseminationBarrier.h"
+#include "TCPConnect.h"
+#include <kvs/Message>
+#include <kvs/Math>
+#include <kvs/SocketTimer>
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Disables the Nagle algorithm so that the token is sent at once.
+ *  @param  socket [in] pointer to the socket
+ */
+/*===========================================================================*/
+void SetNoDelay( kvs::TCPSocket* socket )
+{
+    int nodelay = 1;
+    ::setsockopt( socket->id(), IPPROTO_TCP, TCP_NODELAY,
+                  reinterpret_cast<const char*>( &nodelay ), sizeof( nodelay ) );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sends the token.
+ *  @param  socket [in] pointer to the socket
+ *  @param  token [in] token
+ *  @return true, if the token is sent
+ */
+/*===========================================================================*/
+bool SendToken( kvs::TCPSocket* socket, const kvs::UInt8 token )
+{
+    return socket->send( &token, 1 ) == 1;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Receives the token and checks it.
+ *  @param  socket [in] pointer to the socket
+ *  @param  token [in] expected token
+ *  @return true, if the expected token is received
+ */
+/*===========================================================================*/
+bool ReceiveToken( kvs::TCPSocket* socket, const kvs::UInt8 token )
+{
+    kvs::UInt8 received = 0;
+    if ( socket->receive( &received, 1 ) != 1 ) { return false; }
+    if ( received != token )
+    {
+        kvsMessageError("Barrier token %d is received instead of %d.", int( received ), int( token ) );
+        return false;
+    }
+    return true;
+}
+
+} // end of namespace
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new DisseminationBarrier class.
+ *  @param  rank [in] rank of this process
+ *  @param  nranks [in] number of the ranks
+ */
+/*===========================================================================*/
+DisseminationBarrier::DisseminationBarrier( const size_t rank, const size_t nranks ):
+    m_rank( rank ),
+    m_nranks( nranks ),
+    m_algorithm( Dissemination ),
+    m_counter( 0 ),
+    m_server( NULL )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Destroys the DisseminationBarrier class.
+ */
+/*===========================================================================*/
+DisseminationBarrier::~DisseminationBarrier()
+{
+    this->disconnect();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the number of the communication steps of a barrier.
+ *  @return number of the steps on the critical path
+ */
+/*===========================================================================*/
+size_t DisseminationBarrier::numberOfRounds() const
+{
+    size_t nrounds = 0;
+    while ( ( size_t( 1 ) << nrounds ) < m_nranks ) { nrounds++; }
+
+    if ( m_algorithm == Dissemination ) { return nrounds; }
+
+    // Depth of the binary tree (gather and broadcast).
+    size_t depth = 0;
+    while ( ( size_t( 1 ) << ( depth + 1 ) ) <= m_nranks ) { depth++; }
+    return depth * 2;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets the barrier algorithm.
+ *  @param  algorithm [in] barrier algorithm
+ *
+ *  The algorithm cannot be changed while the ranks are connected, since the
+ *  sockets are connected to the partners of the algorithm.
+ */
+/*===========================================================================*/
+void DisseminationBarrier::setAlgorithm( const Algorithm algorithm )
+{
+    if ( this->isConnected() )
+    {
+        kvsMessageError("Cannot change the algorithm while the ranks are connected.");
+        return;
+    }
+
+    m_algorithm = algorithm;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Connects the ranks.
+ *  @param  addresses [in] addresses of all the ranks
+ *  @param  timeout_sec [in] timeout in seconds
+ *  @return true, if all the connections are established
+ */
+/*===========================================================================*/
+bool DisseminationBarrier::connect( const std::vector<kvs::SocketAddress>& addresses, const int timeout_sec )
+{
+    this->disconnect();
+
+    if ( addresses.size() != m_nranks || m_rank >= m_nranks )
+    {
+        kvsMessageError("Number of the addresses is not equal to the number of the ranks.");
+        return false;
+    }
+
+    if ( m_nranks == 1 ) { return true; }
+
+    const size_t nincoming = this->number_of_incoming();
+    m_server = new kvs::TCPServer( addresses[ m_rank ].port(), static_cast<int>( nincoming + 1 ) );
+    if ( !m_server->isBound() || !m_server->listen() )
+    {
+        kvsMessageError("Cannot listen to the port %d.", addresses[ m_rank ].port() );
+        this->disconnect();
+        return false;
+    }
+
+    // Connect to the partners, which may not be listening yet. The
+    // connections are queued by the partners until they are accepted.
+    const std::vector<size_t> outgoing = this->outgoing_ranks();
+    m_outgoing.assign( outgoing.size(), static_cast<kvs::TCPSocket*>( NULL ) );
+    for ( size_t i = 0; i < outgoing.size(); i++ )
+    {
+        m_outgoing[i] = kvs::detail::ConnectWithRetry( addresses[ outgoing[i] ], timeout_sec );
+        const kvs::UInt32 hello[2] = {
+            htonl( static_cast<kvs::UInt32>( m_rank ) ),
+            htonl( static_cast<kvs::UInt32>( i ) ) };
+        if ( !m_outgoing[i] || m_outgoing[i]->send( hello, sizeof( hello ) ) != int( sizeof( hello ) ) )
+        {
+            kvsMessageError("Cannot connect to the rank %d.", int( outgoing[i] ) );
+            this->disconnect();
+            return false;
+        }
+
+        ::SetNoDelay( m_outgoing[i] );
+    }
+
+    // Accept the partners and identify them by the rank and the round.
+    const kvs::SocketTimer timeout( timeout_sec );
+    m_incoming.assign( nincoming, static_cast<kvs::TCPSocket*>( NULL ) );
+    for ( size_t i = 0; i < nincoming; i++ )
+    {
+        kvs::TCPSocket* socket = m_server->checkForNewConnection( &timeout );
+        kvs::UInt32 hello[2] = { 0, 0 };
+        if ( !socket || socket->receive( hello, sizeof( hello ) ) != int( sizeof( hello ) ) )
+        {
+            kvsMessageError("Cannot accept the connection from the partners.");
+            delete socket;
+            this->disconnect();
+            return false;
+        }
+
+        const size_t rank = ntohl( hello[0] );
+        const size_t round = ntohl( hello[1] );
+        size_t index = nincoming;
+        if ( m_algorithm == Dissemination )
+        {
+            const bool valid = round < nincoming && ( rank + ( size_t( 1 ) << round ) ) % m_nranks == m_rank;
+            if ( valid ) { index = round; }
+        }
+        else
+        {
+            if ( rank > m_rank * 2 && rank <= m_rank * 2 + nincoming ) { index = rank - m_rank * 2 - 1; }
+        }
+
+        if ( index >= nincoming || m_incoming[ index ] )
+        {
+            kvsMessageError("Unexpected connection from the rank %d.", int( rank ) );
+            delete socket;
+            this->disconnect();
+            return false;
+        }
+
+        ::SetNoDelay( socket );
+        m_incoming[ index ] = socket;
+    }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Disconnects the ranks.
+ */
+/*===========================================================================*/
+void DisseminationBarrier::disconnect()
+{
+    for ( size_t i = 0; i < m_outgoing.size(); i++ )
+    {
+        if ( m_outgoing[i] ) { delete m_outgoing[i]; }
+    }
+    m_outgoing.clear();
+
+    for ( size_t i = 0; i < m_incoming.size(); i++ )
+    {
+        if ( m_incoming[i] ) { delete m_incoming[i]; }
+    }
+    m_incoming.clear();
+
+    if ( m_server ) { delete m_server; m_server = NULL; }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Waits for all the ranks.
+ *  @return true, if all the ranks have reached the barrier
+ */
+/*===========================================================================*/
+bool DisseminationBarrier::wait()
+{
+    if ( m_nranks == 1 ) { return true; }
+
+    if ( m_outgoing.empty() && m_incoming.empty() )
+    {
+        kvsMessageError("Ranks are not connected.");
+        return false;
+    }
+
+    m_counter++;
+    const bool success = m_algorithm == Dissemination ? this->wait_dissemination() : this->wait_tree();
+    if ( !success ) { kvsMessageError("Cannot synchronize the ranks."); }
+
+    return success;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the ranks connected by this rank.
+ *  @return ranks of the partners in the rounds (or the parent)
+ */
+/*===========================================================================*/
+std::vector<size_t> DisseminationBarrier::outgoing_ranks() const
+{
+    std::vector<size_t> ranks;
+    if ( m_algorithm == Dissemination )
+    {
+        for ( size_t distance = 1; distance < m_nranks; distance *= 2 )
+        {
+            ranks.push_back( ( m_rank + distance ) % m_nranks );
+        }
+    }
+    else
+    {
+        if ( m_rank > 0 ) { ranks.push_back( ( m_rank - 1 ) / 2 ); }
+    }
+
+    return ranks;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the number of the connections accepted by this rank.
+ *  @return number of the partners in the rounds (or the children)
+ */
+/*===========================================================================*/
+size_t DisseminationBarrier::number_of_incoming() const
+{
+    if ( m_algorithm == Dissemination ) { return this->outgoing_ranks().size(); }
+
+    const size_t first_child = m_rank * 2 + 1;
+    if ( first_child >= m_nranks ) { return 0; }
+    return kvs::Math::Min( m_nranks - first_child, size_t( 2 ) );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Waits for all the ranks by the dissemination algorithm.
+ *  @return true, if all the ranks have reached the barrier
+ */
+/*===========================================================================*/
+bool DisseminationBarrier::wait_dissemination()
+{
+    for ( size_t k = 0; k < m_outgoing.size(); k++ )
+    {
+        if ( !::SendToken( m_outgoing[k], m_counter ) ) { return false; }
+        if ( !::ReceiveToken( m_incoming[k], m_counter ) ) { return false; }
+    }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Waits for all the ranks by the tree algorithm.
+ *  @return true, if all the ranks have reached the barrier
+ */
+/*===========================================================================*/
+bool DisseminationBarrier::wait_tree()
+{
+    // Gather the arrivals of the subtree.
+    for ( size_t i = 0; i < m_incoming.size(); i++ )
+    {
+        if ( !::ReceiveToken( m_incoming[i], m_counter ) ) { return false; }
+    }
+
+    // Notify the parent and wait for the release.
+    if ( !m_outgoing.empty() )
+    {
+        if ( !::SendToken( m_outgoing[0], m_counter ) ) { return false; }
+        if ( !::ReceiveToken( m_outgoing[0], m_counter ) ) { return false; }
+    }
+
+    // Release the subtree.
+    for ( size_t i = 0; i < m_incoming.size(); i++ )
+    {
+        if ( !::SendToken( m_incoming[i], m_counter ) ) { return false; }
+    }
+
+    return true;
+}
+
+} // end of namespace kvs
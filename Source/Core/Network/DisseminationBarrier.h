@@ -0,0 +1,94 @@
+/*****************************************************************************/
+/**
+ *  @file   DisseminationBarrier.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVS__DISSEMINATION_BARRIER_H_INCLUDE
+#define KVS__DISSEMINATION_BARRIER_H_INCLUDE
+
+#include <vector>
+#include <kvs/Type>
+#include <kvs/SocketAddress>
+#include <kvs/TCPSocket>
+#include <kvs/TCPServer>
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Barrier class over peer-to-peer TCP sockets.
+ *
+ *  The ranks (processes) are synchronized without the central server. In
+ *  the dissemination algorithm, each rank sends a one-byte token to the
+ *  rank 2^k ahead and receives it from the rank 2^k behind in the k-th
+ *  round, and all the ranks have been reached after ceil(log2 N) rounds.
+ *  In the tree algorithm, the tokens are gathered up the binary tree rooted
+ *  at the rank zero and the release is broadcasted down the tree in
+ *  2 log2 N steps, which needs only the sockets to the parent and children.
+ *
+ *  The ranks are connected to each other by connect() with the addresses of
+ *  all the ranks, where each rank listens to the port of its own address.
+ *  The token is the count of the barrier modulo 256, which is checked by the
+ *  receiver.
+ */
+/*===========================================================================*/
+class DisseminationBarrier
+{
+public:
+
+    enum Algorithm
+    {
+        Dissemination, ///< dissemination algorithm (ceil(log2 N) rounds)
+        Tree           ///< binary tree algorithm (gather and broadcast)
+    };
+
+private:
+
+    size_t m_rank; ///< rank of this process
+    size_t m_nranks; ///< number of the ranks
+    Algorithm m_algorithm; ///< barrier algorithm
+    kvs::UInt8 m_counter; ///< count of the barrier (modulo 256)
+    kvs::TCPServer* m_server; ///< server socket
+    std::vector<kvs::TCPSocket*> m_outgoing; ///< sockets connected to the partners (or the parent)
+    std::vector<kvs::TCPSocket*> m_incoming; ///< sockets accepted from the partners (or the children)
+
+public:
+
+    DisseminationBarrier( const size_t rank, const size_t nranks );
+    virtual ~DisseminationBarrier();
+
+    size_t rank() const { return m_rank; }
+    size_t numberOfRanks() const { return m_nranks; }
+    Algorithm algorithm() const { return m_algorithm; }
+    size_t numberOfRounds() const;
+    bool isConnected() const { return m_server != NULL; }
+
+    void setAlgorithm( const Algorithm algorithm );
+    void setAlgorithmToDissemination() { this->setAlgorithm( Dissemination ); }
+    void setAlgorithmToTree() { this->setAlgorithm( Tree ); }
+
+    bool connect( const std::vector<kvs::SocketAddress>& addresses, const int timeout_sec = 30 );
+    void disconnect();
+    bool wait();
+
+private:
+
+    std::vector<size_t> outgoing_ranks() const;
+    size_t number_of_incoming() const;
+    bool wait_dissemination();
+    bool wait_tree();
+};
+
+} // end of namespace kvs
+
+#endif // KVS__DISSEMINATION_BARRIER_H_INCLUDE
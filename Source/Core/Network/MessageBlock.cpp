@@ -15,11 +15,38 @@
 #include "MessageBlock.h"
 #include <cstring>
 #include <kvs/Type>
+#include <kvs/Message>
+#include <kvs/Value>
 
 
 namespace
 {
 const size_t SizeOfHeader = sizeof( kvs::UInt32 ); // 32 bits = 4 bytes
+
+/*==========================================================================*/
+/**
+ *  Deleter which does not delete the referenced external buffer.
+ */
+/*==========================================================================*/
+struct NullDeleter
+{
+    void operator () ( unsigned char* ) const {}
+};
+
+/*==========================================================================*/
+/**
+ *  Write the message size in network byte-order to the header.
+ *  @param header [out] pointer to the header
+ *  @param message_size [in] size of message
+ */
+/*==========================================================================*/
+void WriteHeader( unsigned char* header, const size_t message_size )
+{
+    // Convert host byte-order to network byte-order.
+    const kvs::UInt32 size = htonl( static_cast<kvs::UInt32>( message_size ) );
+    memcpy( header, &size, SizeOfHeader );
+}
+
 }
 
 namespace kvs
@@ -87,6 +114,7 @@ MessageBlock::~MessageBlock()
 /*==========================================================================*/
 size_t MessageBlock::size() const
 {
+    if( this->isReferenced() ) return( m_reference.size() );
     if( m_block.size() == 0 ) return( 0 );
 
     return( m_block.size() == 0 ? 0 : m_block.size() - SizeOfHeader );
@@ -100,6 +128,7 @@ size_t MessageBlock::size() const
 /*==========================================================================*/
 void* MessageBlock::data()
 {
+    if( this->isReferenced() ) return( m_reference.data() );
     return( m_block.data() + SizeOfHeader );
 }
 
@@ -111,42 +140,76 @@ void* MessageBlock::data()
 /*==========================================================================*/
 const void* MessageBlock::data() const
 {
+    if( this->isReferenced() ) return( m_reference.data() );
     return( m_block.data() + SizeOfHeader );
 }
 
 /*==========================================================================*/
 /**
- *  Get a size of message block.
+ *  Get a size of message block (header and message).
  *  @return message block size [byte]
  */
 /*==========================================================================*/
 size_t MessageBlock::blockSize() const
 {
-    return( m_block.size() );
+    return( m_block.size() + m_reference.size() );
 }
 
 /*==========================================================================*/
 /**
  *  Get a point to message block.
- *  @return pointer to message block
+ *  @return pointer to message block (NULL for referenced message)
  */
 /*==========================================================================*/
 void* MessageBlock::blockData()
 {
-    return( m_block.data() );
+    return( this->isReferenced() ? NULL : m_block.data() );
 }
 
 /*==========================================================================*/
 /**
  *  Get a point to message block.
- *  @return pointer to message block
+ *  @return pointer to message block (NULL for referenced message)
  */
 /*==========================================================================*/
 const void* MessageBlock::blockData() const
+{
+    return( this->isReferenced() ? NULL : m_block.data() );
+}
+
+/*==========================================================================*/
+/**
+ *  Get a size of header.
+ *  @return header size [byte]
+ */
+/*==========================================================================*/
+size_t MessageBlock::headerSize() const
+{
+    return( m_block.size() == 0 ? 0 : SizeOfHeader );
+}
+
+/*==========================================================================*/
+/**
+ *  Get a pointer to header (followed by the message unless referenced).
+ *  @return pointer to header
+ */
+/*==========================================================================*/
+const void* MessageBlock::headerData() const
 {
     return( m_block.data() );
 }
 
+/*==========================================================================*/
+/**
+ *  Check whether the message is referenced without copying.
+ *  @return true, if the message is referenced
+ */
+/*==========================================================================*/
+bool MessageBlock::isReferenced() const
+{
+    return( m_reference.size() > 0 );
+}
+
 /*==========================================================================*/
 /**
  *  Get message as string.
@@ -172,13 +235,8 @@ void MessageBlock::copy( const void* message, size_t message_size )
 {
     if( this->allocate( message_size ) )
     {
-        // Convert host byte-order to network byte-order.
-        kvs::UInt32 size = htonl( static_cast<kvs::UInt32>( message_size ) );
-//        unsigned int size = htonl( static_cast<unsigned int>( message_size ) );
-//        u_long size = htonl( static_cast<u_long>( message_size ) );
-
         unsigned char* p = m_block.data();
-        memcpy( p,                &size,   SizeOfHeader );
+        ::WriteHeader( p, message_size );
         memcpy( p + SizeOfHeader, message, message_size );
     }
 }
@@ -215,10 +273,24 @@ void MessageBlock::copy( const std::vector<T>& message )
 /*==========================================================================*/
 void* MessageBlock::allocate( size_t data_size )
 {
+    m_reference.release();
     m_block.allocate( data_size + SizeOfHeader );
     return( m_block.data() );
 }
 
+/*==========================================================================*/
+/**
+ *  Reference message without copying.
+ *  @param message [in] pointer to message (must be valid until it is sent)
+ *  @param message_size [in] size of message
+ */
+/*==========================================================================*/
+void MessageBlock::reference( const void* message, const size_t message_size )
+{
+    unsigned char* p = static_cast<unsigned char*>( const_cast<void*>( message ) );
+    this->set_reference( kvs::SharedPointer<unsigned char>( p, ::NullDeleter() ), message_size );
+}
+
 /*==========================================================================*/
 /**
  *  Deallocate.
@@ -227,6 +299,31 @@ void* MessageBlock::allocate( size_t data_size )
 void MessageBlock::release()
 {
     m_block.release();
+    m_reference.release();
+}
+
+/*==========================================================================*/
+/**
+ *  Set referenced message.
+ *  @param message [in] shared pointer to message
+ *  @param message_size [in] size of message
+ */
+/*==========================================================================*/
+void MessageBlock::set_reference( const kvs::SharedPointer<unsigned char>& message, const size_t message_size )
+{
+    if( message_size > kvs::Value<kvs::UInt32>::Max() )
+    {
+        kvsMessageError( "Message size %lu exceeds the 32-bit size header.",
+                         static_cast<unsigned long>( message_size ) );
+        return;
+    }
+
+    // An empty message is held as the copied block with the header only.
+    if( message_size == 0 ) { this->allocate( 0 ); ::WriteHeader( m_block.data(), 0 ); return; }
+
+    m_block.allocate( SizeOfHeader );
+    ::WriteHeader( m_block.data(), message_size );
+    m_reference = kvs::ValueArray<unsigned char>( message, message_size );
 }
 
 } // end of namespace kvs
@@ -14,7 +14,10 @@
 #ifndef KVS__MESSAGE_BLOCK_H_INCLUDE
 #define KVS__MESSAGE_BLOCK_H_INCLUDE
 
+#include <string>
+#include <vector>
 #include <kvs/ValueArray>
+#include <kvs/SharedPointer>
 #include <kvs/Deprecated>
 
 
@@ -24,6 +27,11 @@ namespace kvs
 /*==========================================================================*/
 /**
  *  Message block class.
+ *
+ *  The message is copied into the block following the size header, or it is
+ *  referenced by the block without copying (reference()). For a referenced
+ *  message, the block holds only the header, blockData() returns NULL and the
+ *  header and the message are sent separately by the gather write.
  */
 /*==========================================================================*/
 class MessageBlock
@@ -43,7 +51,8 @@ protected:
      *    --------------    ---
      */
 
-    kvs::ValueArray<unsigned char> m_block; ///< message block
+    kvs::ValueArray<unsigned char> m_block; ///< message block (header only for referenced message)
+    kvs::ValueArray<unsigned char> m_reference; ///< referenced message (not copied)
 
 public:
 
@@ -52,6 +61,8 @@ public:
     MessageBlock( const std::string& data );
     template<typename T>
     MessageBlock( const std::vector<T>& data );
+    template<typename T>
+    explicit MessageBlock( const kvs::ValueArray<T>& data );
     virtual ~MessageBlock();
 
     size_t size() const;
@@ -60,15 +71,25 @@ public:
     size_t blockSize() const;
     void* blockData();
     const void* blockData() const;
+    size_t headerSize() const;
+    const void* headerData() const;
+    bool isReferenced() const;
     std::string toString() const;
 
     void copy( const void* data, const size_t data_size );
     void copy( const std::string& data );
     template <typename T>
     void copy( const std::vector<T>& data );
+    void reference( const void* data, const size_t data_size );
+    template <typename T>
+    void reference( const kvs::ValueArray<T>& data );
     void* allocate( const size_t data_size );
     void release();
 
+private:
+
+    void set_reference( const kvs::SharedPointer<unsigned char>& data, const size_t data_size );
+
 public:
 
     KVS_DEPRECATED( void* pointer() ) { return this->data(); }
@@ -78,6 +99,33 @@ public:
     KVS_DEPRECATED( void deallocate() ) { this->release(); }
 };
 
+/*==========================================================================*/
+/**
+ *  Constructor (the data is referenced without copying).
+ *  @param data [in] message
+ */
+/*==========================================================================*/
+template<typename T>
+inline MessageBlock::MessageBlock( const kvs::ValueArray<T>& data )
+{
+    this->reference( data );
+}
+
+/*==========================================================================*/
+/**
+ *  Reference the array as the message without copying.
+ *  @param data [in] message (shared with the block)
+ */
+/*==========================================================================*/
+template <typename T>
+inline void MessageBlock::reference( const kvs::ValueArray<T>& data )
+{
+    const kvs::SharedPointer<unsigned char> p(
+        data.sharedPointer(),
+        reinterpret_cast<unsigned char*>( const_cast<T*>( data.data() ) ) );
+    this->set_reference( p, data.byteSize() );
+}
+
 } // end of namespace kvs
 
 #endif // KVS__MESSAGE_BLOCK_H_INCLUDE
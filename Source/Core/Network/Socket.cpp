@@ -15,7 +15,12 @@
 #include "IPAddress.h"
 #include "SocketSelector.h"
 #include "SocketTimer.h"
+#include <cstring>
+#include <algorithm>
 #include <kvs/Platform>
+#if !defined( KVS_PLATFORM_WINDOWS )
+#include <sys/uio.h>
+#endif
 
 
 namespace kvs
@@ -437,6 +442,109 @@ int Socket::receive_exact( id_type id, char* buffer, int length )
     return( received_size );
 }
 
+/*==========================================================================*/
+/**
+ *  Send buffer exactly.
+ *  @param id [in] socket ID
+ *  @param buffer [in] pointer to buffer
+ *  @param length [in] buffer length [byte]
+ *  @param flags [in] flags of send
+ *  @return true, if the whole buffer is sent
+ */
+/*==========================================================================*/
+bool Socket::send_exact( id_type id, const char* buffer, size_t length, int flags )
+{
+    while( length > 0 )
+    {
+        const int size = static_cast<int>( std::min( length, size_t( 1 ) << 30 ) );
+        const int actual_size = ::send( id, buffer, size, flags );
+        if( actual_size < 0 )
+        {
+#if !defined( KVS_PLATFORM_WINDOWS )
+            if( errno == EINTR ) continue;
+#endif
+            return( false );
+        }
+
+        buffer += actual_size;
+        length -= actual_size;
+    }
+
+    return( true );
+}
+
+/*==========================================================================*/
+/**
+ *  Send message block by the gather write.
+ *  @param id [in] socket ID
+ *  @param message [in] message block
+ *  @param flags [in] flags of send
+ *  @param nsends [out] number of the zero-copy send calls (optional)
+ *  @return true, if the whole message block is sent
+ *
+ *  The header and the referenced message are sent by sendmsg without being
+ *  concatenated. If the zero-copy send is not accepted by lack of the kernel
+ *  buffer, the rest is sent with copying.
+ */
+/*==========================================================================*/
+bool Socket::send_message( id_type id, const kvs::MessageBlock& message, int flags, size_t* nsends )
+{
+    // Segments: header (or the whole copied block) and the referenced message.
+    const char* segment0 = static_cast<const char*>( message.headerData() );
+    const size_t size0 = message.isReferenced() ? message.headerSize() : message.blockSize();
+    const char* segment1 = static_cast<const char*>( message.data() );
+    const size_t size1 = message.isReferenced() ? message.size() : 0;
+
+#if defined( KVS_PLATFORM_WINDOWS )
+    if( nsends ) *nsends = 0;
+    return( this->send_exact( id, segment0, size0, flags ) &&
+            this->send_exact( id, segment1, size1, flags ) );
+#else
+    size_t counter = 0;
+    size_t sent_size = 0;
+    while( sent_size < size0 + size1 )
+    {
+        struct iovec iov[2];
+        struct msghdr msg;
+        memset( &msg, 0, sizeof( msg ) );
+        msg.msg_iov = iov;
+
+        if( sent_size < size0 )
+        {
+            iov[ msg.msg_iovlen ].iov_base = const_cast<char*>( segment0 + sent_size );
+            iov[ msg.msg_iovlen ].iov_len = size0 - sent_size;
+            msg.msg_iovlen++;
+        }
+
+        const size_t offset1 = sent_size > size0 ? sent_size - size0 : 0;
+        if( offset1 < size1 )
+        {
+            iov[ msg.msg_iovlen ].iov_base = const_cast<char*>( segment1 + offset1 );
+            iov[ msg.msg_iovlen ].iov_len = size1 - offset1;
+            msg.msg_iovlen++;
+        }
+
+        const ssize_t actual_size = ::sendmsg( id, &msg, flags );
+        if( actual_size < 0 )
+        {
+            if( errno == EINTR ) continue;
+#if defined( MSG_ZEROCOPY )
+            if( errno == ENOBUFS && ( flags & MSG_ZEROCOPY ) ) { flags &= ~MSG_ZEROCOPY; continue; }
+#endif
+            break;
+        }
+
+#if defined( MSG_ZEROCOPY )
+        if( flags & MSG_ZEROCOPY ) counter++;
+#endif
+        sent_size += actual_size;
+    }
+
+    if( nsends ) *nsends = counter;
+    return( sent_size == size0 + size1 );
+#endif
+}
+
 /*==========================================================================*/
 /**
  *  Receive a line buffer.
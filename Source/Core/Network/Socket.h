@@ -18,6 +18,7 @@
 #include "SocketAddress.h"
 #include "SocketTimer.h"
 #include "IPAddress.h"
+#include "MessageBlock.h"
 #include <kvs/Platform>
 #include <string>
 
@@ -97,6 +98,8 @@ protected:
     int receive_exact( id_type id, char* buffer, int length );
     int receive_peek( id_type id, char* buffer, int length );
     int receive_line( id_type id, std::string& line );
+    bool send_exact( id_type id, const char* buffer, size_t length, int flags = 0 );
+    bool send_message( id_type id, const kvs::MessageBlock& message, int flags = 0, size_t* nsends = 0 );
     int connect_to_host( const kvs::SocketAddress& socket_address, const kvs::SocketTimer* timeout = 0 );
     int connect_complete( const kvs::SocketTimer* timeout );
     void blocking_socket( id_type id );
@@ -0,0 +1,858 @@
+/*****************************************************************************/
+/**
+ *  @file   SocketEventLoop.cpp
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "SocketEventLoop.h"
+#include "SocketStandard.h"
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <kvs/Message>
+#include <kvs/Math>
+#include <kvs/Thread>
+#if defined( KVS_PLATFORM_WINDOWS )
+#include <windows.h>
+#else
+#include <sys/time.h>
+#include <sys/uio.h>
+#if defined( KVS_PLATFORM_LINUX )
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+#endif
+
+
+namespace
+{
+
+/// Max. number of the events processed at once.
+const int MaxEvents = 256;
+
+/// Size of the buffer of a read.
+const size_t ReadBufferSize = 65536;
+
+/// Size of the message header (message size in the network byte order).
+const size_t HeaderSize = sizeof( kvs::UInt32 );
+
+/// Flags of send (the broken connection is reported as an error, not a signal).
+#if defined( MSG_NOSIGNAL )
+const int SendFlags = MSG_NOSIGNAL;
+#else
+const int SendFlags = 0;
+#endif
+
+/*===========================================================================*/
+/**
+ *  @brief  Socket ready for the I/O.
+ */
+/*===========================================================================*/
+struct Ready
+{
+    kvs::Socket::id_type id; ///< socket ID
+    bool readable; ///< true, if the socket is readable (or closed)
+    bool writable; ///< true, if the socket is writable
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the current time in milliseconds.
+ *  @return current time
+ */
+/*===========================================================================*/
+double Now()
+{
+#if defined( KVS_PLATFORM_WINDOWS )
+    return static_cast<double>( GetTickCount() );
+#else
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the time value of the socket timer in milliseconds.
+ *  @param  timer [in] socket timer
+ *  @return time in milliseconds
+ */
+/*===========================================================================*/
+double Milliseconds( const kvs::SocketTimer& timer )
+{
+    return timer.value().tv_sec * 1000.0 + timer.value().tv_usec / 1000.0;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets the socket to the non-blocking mode.
+ *  @param  id [in] socket ID
+ *  @return true, if the mode is set
+ */
+/*===========================================================================*/
+bool SetNonBlocking( const kvs::Socket::id_type id )
+{
+#if defined( KVS_PLATFORM_WINDOWS )
+    u_long mode = 1;
+    return ioctlsocket( id, FIONBIO, &mode ) == 0;
+#else
+    const int flags = fcntl( id, F_GETFL, 0 );
+    return flags != -1 && fcntl( id, F_SETFL, flags | O_NONBLOCK ) != -1;
+#endif
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if the last socket operation would block.
+ *  @return true, if the operation would block
+ */
+/*===========================================================================*/
+bool WouldBlock()
+{
+#if defined( KVS_PLATFORM_WINDOWS )
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if the last socket operation was interrupted.
+ *  @return true, if the operation was interrupted
+ */
+/*===========================================================================*/
+bool Interrupted()
+{
+#if defined( KVS_PLATFORM_WINDOWS )
+    return WSAGetLastError() == WSAEINTR;
+#else
+    return errno == EINTR;
+#endif
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Closes the socket.
+ *  @param  id [in] socket ID
+ */
+/*===========================================================================*/
+void CloseSocket( const kvs::Socket::id_type id )
+{
+#if defined( KVS_PLATFORM_WINDOWS )
+    ::closesocket( id );
+#else
+    ::close( id );
+#endif
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sends the rest of the message block by a gather write.
+ *  @param  id [in] socket ID
+ *  @param  message [in] message block
+ *  @param  offset [in] sent bytes of the message block
+ *  @return sent bytes (-1: error)
+ */
+/*===========================================================================*/
+int SendBlock( const kvs::Socket::id_type id, const kvs::MessageBlock& message, const size_t offset )
+{
+    // Segments: header (or the whole copied block) and the referenced message.
+    const char* segment[2] = {
+        static_cast<const char*>( message.headerData() ),
+        static_cast<const char*>( message.data() ) };
+    const size_t size[2] = {
+        message.isReferenced() ? message.headerSize() : message.blockSize(),
+        message.isReferenced() ? message.size() : 0 };
+
+#if defined( KVS_PLATFORM_WINDOWS )
+    const size_t i = offset < size[0] ? 0 : 1;
+    const size_t o = offset < size[0] ? offset : offset - size[0];
+    return ::send( id, segment[i] + o, static_cast<int>( size[i] - o ), ::SendFlags );
+#else
+    struct iovec iov[2];
+    struct msghdr msg;
+    std::memset( &msg, 0, sizeof( msg ) );
+    msg.msg_iov = iov;
+
+    size_t o = offset;
+    for ( size_t i = 0; i < 2; i++ )
+    {
+        if ( o < size[i] )
+        {
+            iov[ msg.msg_iovlen ].iov_base = const_cast<char*>( segment[i] + o );
+            iov[ msg.msg_iovlen ].iov_len = size[i] - o;
+            msg.msg_iovlen++;
+        }
+        o = o > size[i] ? o - size[i] : 0;
+    }
+
+    return static_cast<int>( ::sendmsg( id, &msg, ::SendFlags ) );
+#endif
+}
+
+} // end of namespace
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Called when a connection is accepted and registered to the loop.
+ *  @param  loop [in] pointer to the event loop
+ *  @param  id [in] socket ID of the connection
+ *  @param  address [in] address of the peer
+ */
+/*===========================================================================*/
+void SocketEventLoop::Handler::acceptEvent( SocketEventLoop*, const id_type, const kvs::SocketAddress& )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Called when a message is received.
+ *  @param  loop [in] pointer to the event loop
+ *  @param  id [in] socket ID of the connection
+ *  @param  message [in] received message
+ */
+/*===========================================================================*/
+void SocketEventLoop::Handler::receiveEvent( SocketEventLoop*, const id_type, const kvs::MessageBlock& )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Called when all the queued messages of the connection are sent.
+ *  @param  loop [in] pointer to the event loop
+ *  @param  id [in] socket ID of the connection
+ */
+/*===========================================================================*/
+void SocketEventLoop::Handler::sendEvent( SocketEventLoop*, const id_type )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Called when the connection is closed by the peer, an error or close().
+ *  @param  loop [in] pointer to the event loop
+ *  @param  id [in] socket ID of the connection
+ */
+/*===========================================================================*/
+void SocketEventLoop::Handler::closeEvent( SocketEventLoop*, const id_type )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Called when the timer is expired.
+ *  @param  loop [in] pointer to the event loop
+ *  @param  timer_id [in] timer ID
+ */
+/*===========================================================================*/
+void SocketEventLoop::Handler::timerEvent( SocketEventLoop*, const int )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new SocketEventLoop class.
+ *  @param  handler [in] pointer to the event handler
+ */
+/*===========================================================================*/
+SocketEventLoop::SocketEventLoop( Handler* handler ):
+    m_handler( handler ),
+    m_timer_counter( 0 ),
+    m_max_message_size( 256 * 1024 * 1024 ),
+    m_quit( false ),
+    m_backend( -1 )
+{
+#if defined( KVS_PLATFORM_LINUX )
+    m_backend = epoll_create( ::MaxEvents );
+    if ( m_backend == -1 )
+    {
+        kvsMessageError("Cannot create the epoll instance.");
+    }
+#endif
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Destroys the SocketEventLoop class.
+ */
+/*===========================================================================*/
+SocketEventLoop::~SocketEventLoop()
+{
+    std::map<id_type,Connection*>::iterator connection = m_connections.begin();
+    while ( connection != m_connections.end() )
+    {
+        if ( connection->second->owner ) { ::CloseSocket( connection->first ); }
+        delete connection->second;
+        connection++;
+    }
+    m_connections.clear();
+    this->release_closed();
+
+    for ( size_t i = 0; i < m_servers.size(); i++ ) { delete m_servers[i]; }
+
+#if defined( KVS_PLATFORM_LINUX )
+    if ( m_backend != -1 ) { ::close( m_backend ); }
+#endif
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the number of the connections (except the listening sockets).
+ *  @return number of the connections
+ */
+/*===========================================================================*/
+size_t SocketEventLoop::numberOfConnections() const
+{
+    size_t counter = 0;
+    std::map<id_type,Connection*>::const_iterator connection = m_connections.begin();
+    while ( connection != m_connections.end() )
+    {
+        if ( !connection->second->listener ) { counter++; }
+        connection++;
+    }
+    return counter;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the size of the output queued to the connection.
+ *  @param  id [in] socket ID of the connection
+ *  @return number of the bytes not sent yet (0 for the unknown socket)
+ */
+/*===========================================================================*/
+size_t SocketEventLoop::pendingOutputSize( const id_type id ) const
+{
+    std::map<id_type,Connection*>::const_iterator connection = m_connections.find( id );
+    if ( connection == m_connections.end() ) { return 0; }
+
+    size_t size = 0;
+    const std::deque<kvs::MessageBlock>& output = connection->second->output;
+    for ( size_t i = 0; i < output.size(); i++ ) { size += output[i].blockSize(); }
+    return size - ( output.empty() ? 0 : connection->second->output_offset );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Listens to the port and accepts the connections in the loop.
+ *  @param  port [in] port number
+ *  @param  backlog [in] max. number of the pending connections
+ *  @return true, if the port is listened
+ */
+/*===========================================================================*/
+bool SocketEventLoop::listen( const int port, const int backlog )
+{
+    kvs::TCPServer* server = new kvs::TCPServer( port, backlog );
+    if ( !server->isBound() || !server->listen() || !this->addServer( server ) )
+    {
+        kvsMessageError("Cannot listen to the port %d.", port );
+        delete server;
+        return false;
+    }
+
+    m_servers.push_back( server );
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Adds the listening server socket to the loop.
+ *  @param  server [in] pointer to the listening server (not closed by the loop)
+ *  @return true, if the server is added
+ */
+/*===========================================================================*/
+bool SocketEventLoop::addServer( const kvs::TCPServer* server )
+{
+    return this->add( server->id(), true, false );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Adds the connected socket to the loop.
+ *  @param  id [in] socket ID (closed by the loop)
+ *  @return true, if the socket is added
+ */
+/*===========================================================================*/
+bool SocketEventLoop::addConnection( const id_type id )
+{
+    return this->add( id, false, true );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Queues the message to be sent to the connection.
+ *  @param  id [in] socket ID of the connection
+ *  @param  message [in] message (shared with the queue until sent)
+ *  @return true, if the message is queued
+ */
+/*===========================================================================*/
+bool SocketEventLoop::send( const id_type id, const kvs::MessageBlock& message )
+{
+    std::map<id_type,Connection*>::iterator connection = m_connections.find( id );
+    if ( connection == m_connections.end() || connection->second->listener ) { return false; }
+    if ( message.blockSize() == 0 ) { return true; }
+
+    connection->second->output.push_back( message );
+    if ( connection->second->output.size() == 1 ) { this->write( connection->second ); }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Closes the connection (or the listening socket).
+ *  @param  id [in] socket ID
+ */
+/*===========================================================================*/
+void SocketEventLoop::close( const id_type id )
+{
+    std::map<id_type,Connection*>::iterator connection = m_connections.find( id );
+    if ( connection != m_connections.end() ) { this->close( connection->second ); }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Starts the timer.
+ *  @param  interval [in] interval
+ *  @param  repeat [in] if true, the timer is repeated until stopTimer()
+ *  @return timer ID
+ */
+/*===========================================================================*/
+int SocketEventLoop::startTimer( const kvs::SocketTimer& interval, const bool repeat )
+{
+    Timer timer;
+    timer.id = ++m_timer_counter;
+    timer.interval = ::Milliseconds( interval );
+    timer.next = ::Now() + timer.interval;
+    timer.repeat = repeat;
+    m_timers.push_back( timer );
+    return timer.id;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Stops the timer.
+ *  @param  timer_id [in] timer ID
+ */
+/*===========================================================================*/
+void SocketEventLoop::stopTimer( const int timer_id )
+{
+    for ( size_t i = 0; i < m_timers.size(); i++ )
+    {
+        if ( m_timers[i].id == timer_id ) { m_timers.erase( m_timers.begin() + i ); return; }
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Waits for the events and processes them once.
+ *  @param  timeout [in] max. waiting time (NULL: until an event or a timer)
+ *  @return false, if waiting for the events fails
+ */
+/*===========================================================================*/
+bool SocketEventLoop::runOnce( const kvs::SocketTimer* timeout )
+{
+    this->release_closed();
+
+    const int wait_time = this->wait_timeout( timeout );
+    std::vector< ::Ready > ready;
+
+#if defined( KVS_PLATFORM_LINUX )
+    struct epoll_event events[ ::MaxEvents ];
+    const int nevents = epoll_wait( m_backend, events, ::MaxEvents, wait_time );
+    if ( nevents < 0 && !::Interrupted() )
+    {
+        kvsMessageError("Cannot wait for the socket events.");
+        return false;
+    }
+
+    for ( int i = 0; i < nevents; i++ )
+    {
+        const ::Ready r = {
+            events[i].data.fd,
+            ( events[i].events & ( EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR ) ) != 0,
+            ( events[i].events & EPOLLOUT ) != 0 };
+        ready.push_back( r );
+    }
+#elif defined( KVS_PLATFORM_WINDOWS )
+    if ( m_connections.empty() )
+    {
+        if ( wait_time > 0 ) { kvs::Thread::MilliSleep( wait_time ); }
+    }
+    else
+    {
+        fd_set readable; FD_ZERO( &readable );
+        fd_set writable; FD_ZERO( &writable );
+        std::map<id_type,Connection*>::iterator connection = m_connections.begin();
+        for ( ; connection != m_connections.end(); connection++ )
+        {
+            FD_SET( connection->first, &readable );
+            if ( !connection->second->output.empty() ) { FD_SET( connection->first, &writable ); }
+        }
+
+        struct timeval tv = { wait_time / 1000, ( wait_time % 1000 ) * 1000 };
+        const int nevents = ::select( 0, &readable, &writable, NULL, wait_time < 0 ? NULL : &tv );
+        if ( nevents < 0 )
+        {
+            kvsMessageError("Cannot wait for the socket events.");
+            return false;
+        }
+
+        for ( connection = m_connections.begin(); connection != m_connections.end(); connection++ )
+        {
+            const ::Ready r = {
+                connection->first,
+                FD_ISSET( connection->first, &readable ) != 0,
+                FD_ISSET( connection->first, &writable ) != 0 };
+            if ( r.readable || r.writable ) { ready.push_back( r ); }
+        }
+    }
+#else
+    std::vector<struct pollfd> fds;
+    std::map<id_type,Connection*>::iterator connection = m_connections.begin();
+    for ( ; connection != m_connections.end(); connection++ )
+    {
+        struct pollfd fd;
+        fd.fd = connection->first;
+        fd.events = POLLIN | ( connection->second->output.empty() ? 0 : POLLOUT );
+        fd.revents = 0;
+        fds.push_back( fd );
+    }
+
+    const int nevents = ::poll( fds.empty() ? NULL : &fds[0], fds.size(), wait_time );
+    if ( nevents < 0 && !::Interrupted() )
+    {
+        kvsMessageError("Cannot wait for the socket events.");
+        return false;
+    }
+
+    for ( size_t i = 0; i < fds.size() && nevents > 0; i++ )
+    {
+        const ::Ready r = {
+            fds[i].fd,
+            ( fds[i].revents & ( POLLIN | POLLHUP | POLLERR ) ) != 0,
+            ( fds[i].revents & POLLOUT ) != 0 };
+        if ( r.readable || r.writable ) { ready.push_back( r ); }
+    }
+#endif
+
+    for ( size_t i = 0; i < ready.size(); i++ )
+    {
+        std::map<id_type,Connection*>::iterator connection = m_connections.find( ready[i].id );
+        if ( connection == m_connections.end() ) { continue; }
+
+        Connection* c = connection->second;
+        if ( c->listener )
+        {
+            this->accept( c );
+            continue;
+        }
+
+        if ( ready[i].readable ) { this->read( c ); }
+        if ( ready[i].writable && !c->closed && !c->output.empty() ) { this->write( c ); }
+    }
+
+    this->process_timers();
+    this->release_closed();
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Runs the loop until quit() or no sockets and timers remain.
+ */
+/*===========================================================================*/
+void SocketEventLoop::run()
+{
+    m_quit = false;
+    while ( !m_quit )
+    {
+        if ( m_connections.empty() && m_timers.empty() ) { break; }
+        if ( !this->runOnce() ) { break; }
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Registers the socket to the loop.
+ *  @param  id [in] socket ID
+ *  @param  listener [in] true, if the socket is a listening socket
+ *  @param  owner [in] true, if the socket is closed by the loop
+ *  @return true, if the socket is registered
+ */
+/*===========================================================================*/
+bool SocketEventLoop::add( const id_type id, const bool listener, const bool owner )
+{
+    if ( id == kvs::Socket::InvalidID || m_connections.find( id ) != m_connections.end() ) { return false; }
+    if ( !::SetNonBlocking( id ) ) { return false; }
+
+#if defined( KVS_PLATFORM_LINUX )
+    struct epoll_event event;
+    std::memset( &event, 0, sizeof( event ) );
+    event.events = listener ? EPOLLIN | EPOLLET : EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.fd = id;
+    if ( epoll_ctl( m_backend, EPOLL_CTL_ADD, id, &event ) == -1 ) { return false; }
+#endif
+
+    Connection* connection = new Connection();
+    connection->id = id;
+    connection->listener = listener;
+    connection->owner = owner;
+    connection->closed = false;
+    connection->output_offset = 0;
+    m_connections[ id ] = connection;
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Accepts all the pending connections of the listening socket.
+ *  @param  connection [in] listening socket
+ */
+/*===========================================================================*/
+void SocketEventLoop::accept( Connection* connection )
+{
+    for ( ; ; )
+    {
+        kvs::SocketAddress::address_type address;
+        kvs::SocketAddress::initialize( &address );
+        kvs::Socket::length_type length = sizeof( address );
+        const id_type id = ::accept( connection->id, reinterpret_cast<sockaddr*>( &address ), &length );
+        if ( id == kvs::Socket::InvalidID )
+        {
+            if ( ::Interrupted() ) { continue; }
+            if ( !::WouldBlock() ) { kvsMessageError("Cannot accept the connection."); }
+            return;
+        }
+
+        if ( !this->add( id, false, true ) )
+        {
+            ::CloseSocket( id );
+            continue;
+        }
+
+        kvs::SocketAddress peer;
+        peer.setAddress( address );
+        if ( m_handler ) { m_handler->acceptEvent( this, id, peer ); }
+        if ( connection->closed ) { return; }
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reads all the received bytes and delivers the complete messages.
+ *  @param  connection [in] connection
+ *
+ *  The messages are delivered after each read, so that the header is checked
+ *  as soon as it arrives and at most HeaderSize + maxMessageSize() bytes of
+ *  an incomplete message are buffered however fast the peer sends.
+ */
+/*===========================================================================*/
+void SocketEventLoop::read( Connection* connection )
+{
+    // Read until the socket would block (required by the edge-triggered epoll).
+    char buffer[ ::ReadBufferSize ];
+    for ( ; ; )
+    {
+        const int size = ::recv( connection->id, buffer, static_cast<int>( ::ReadBufferSize ), 0 );
+        if ( size > 0 )
+        {
+            connection->input.insert( connection->input.end(), buffer, buffer + size );
+            if ( !this->deliver( connection ) ) { return; }
+            continue;
+        }
+
+        if ( size < 0 && ::Interrupted() ) { continue; }
+        if ( size < 0 && ::WouldBlock() ) { return; }
+
+        this->close( connection );
+        return;
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Delivers the complete messages in the received bytes.
+ *  @param  connection [in] connection
+ *  @return false, if the connection has been closed
+ */
+/*===========================================================================*/
+bool SocketEventLoop::deliver( Connection* connection )
+{
+    std::vector<kvs::UInt8>& input = connection->input;
+    size_t offset = 0;
+    while ( !connection->closed && input.size() - offset >= ::HeaderSize )
+    {
+        kvs::UInt32 size = 0;
+        std::memcpy( &size, &input[ offset ], ::HeaderSize );
+        size = ntohl( size );
+        if ( size > m_max_message_size )
+        {
+            kvsMessageError("Size of the received message exceeds the limit.");
+            this->close( connection );
+            return false;
+        }
+
+        if ( input.size() - offset - ::HeaderSize < size ) { break; }
+
+        const kvs::MessageBlock message( size > 0 ? &input[ offset + ::HeaderSize ] : NULL, size );
+        offset += ::HeaderSize + size;
+        if ( m_handler ) { m_handler->receiveEvent( this, connection->id, message ); }
+    }
+
+    if ( connection->closed ) { return false; }
+    input.erase( input.begin(), input.begin() + offset );
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Writes the queued messages until the socket would block.
+ *  @param  connection [in] connection
+ */
+/*===========================================================================*/
+void SocketEventLoop::write( Connection* connection )
+{
+    std::deque<kvs::MessageBlock>& output = connection->output;
+    while ( !output.empty() )
+    {
+        const kvs::MessageBlock& message = output.front();
+        const int size = ::SendBlock( connection->id, message, connection->output_offset );
+        if ( size > 0 )
+        {
+            connection->output_offset += size;
+            if ( connection->output_offset == message.blockSize() )
+            {
+                output.pop_front();
+                connection->output_offset = 0;
+            }
+            continue;
+        }
+
+        if ( size < 0 && ::Interrupted() ) { continue; }
+        if ( size < 0 && ::WouldBlock() ) { return; }
+
+        this->close( connection );
+        return;
+    }
+
+    if ( m_handler ) { m_handler->sendEvent( this, connection->id ); }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Closes the socket.
+ *  @param  connection [in] socket
+ *
+ *  The socket is unregistered immediately, and the socket ID is released at
+ *  the end of the iteration so that it is not reused by the sockets accepted
+ *  in the same iteration.
+ */
+/*===========================================================================*/
+void SocketEventLoop::close( Connection* connection )
+{
+    if ( connection->closed ) { return; }
+
+    connection->closed = true;
+    m_connections.erase( connection->id );
+    m_closed.push_back( connection );
+
+#if defined( KVS_PLATFORM_LINUX )
+    epoll_ctl( m_backend, EPOLL_CTL_DEL, connection->id, NULL );
+#endif
+
+    if ( m_handler ) { m_handler->closeEvent( this, connection->id ); }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Releases the closed sockets.
+ */
+/*===========================================================================*/
+void SocketEventLoop::release_closed()
+{
+    for ( size_t i = 0; i < m_closed.size(); i++ )
+    {
+        if ( m_closed[i]->owner ) { ::CloseSocket( m_closed[i]->id ); }
+        delete m_closed[i];
+    }
+    m_closed.clear();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the waiting time for the events.
+ *  @param  timeout [in] max. waiting time (NULL: unlimited)
+ *  @return waiting time in milliseconds (-1: unlimited)
+ */
+/*===========================================================================*/
+int SocketEventLoop::wait_timeout( const kvs::SocketTimer* timeout ) const
+{
+    double wait_time = timeout ? ::Milliseconds( *timeout ) : -1.0;
+    if ( !m_timers.empty() )
+    {
+        const double now = ::Now();
+        for ( size_t i = 0; i < m_timers.size(); i++ )
+        {
+            const double t = kvs::Math::Max( m_timers[i].next - now, 0.0 );
+            wait_time = wait_time < 0.0 ? t : kvs::Math::Min( wait_time, t );
+        }
+    }
+
+    // Round up not to wake up before the expiration.
+    return wait_time < 0.0 ? -1 : static_cast<int>( std::ceil( wait_time ) );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Notifies the expired timers.
+ */
+/*===========================================================================*/
+void SocketEventLoop::process_timers()
+{
+    const double now = ::Now();
+    std::vector<int> expired;
+    for ( size_t i = 0; i < m_timers.size(); i++ )
+    {
+        if ( m_timers[i].next <= now ) { expired.push_back( m_timers[i].id ); }
+    }
+
+    // The handler may start or stop the timers.
+    for ( size_t i = 0; i < expired.size(); i++ )
+    {
+        bool found = false;
+        for ( size_t j = 0; j < m_timers.size(); j++ )
+        {
+            if ( m_timers[j].id != expired[i] ) { continue; }
+
+            found = true;
+            if ( m_timers[j].repeat )
+            {
+                m_timers[j].next += m_timers[j].interval;
+                if ( m_timers[j].next <= now ) { m_timers[j].next = now + m_timers[j].interval; }
+            }
+            else
+            {
+                m_timers.erase( m_timers.begin() + j );
+            }
+            break;
+        }
+
+        if ( found && m_handler ) { m_handler->timerEvent( this, expired[i] ); }
+    }
+}
+
+} // end of namespace kvs
@@ -0,0 +1,144 @@
+/*****************************************************************************/
+/**
+ *  @file   SocketEventLoop.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVS__SOCKET_EVENT_LOOP_H_INCLUDE
+#define KVS__SOCKET_EVENT_LOOP_H_INCLUDE
+
+#include <map>
+#include <vector>
+#include <deque>
+#include <kvs/Type>
+#include <kvs/Platform>
+#include "Socket.h"
+#include "SocketAddress.h"
+#include "SocketTimer.h"
+#include "MessageBlock.h"
+#include "TCPServer.h"
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Asynchronous event loop of the TCP sockets.
+ *
+ *  The listening sockets and the connections are handled by a single thread
+ *  with non-blocking accept, read and write. The events are waited by epoll
+ *  (edge-triggered) on Linux and by poll on the other platforms (select on
+ *  Windows). The received bytes are buffered per connection and delivered
+ *  as the MessageBlocks (32-bit size header in the network byte order and
+ *  the message), and the sent MessageBlocks are queued per connection and
+ *  written by the gather write when the socket becomes writable (referenced
+ *  messages are sent without copying). The timers are integrated with
+ *  the waiting of the events.
+ *
+ *  The events are notified to the handler, whose functions can call the
+ *  functions of the loop (send, close, timers and quit). The loop is not
+ *  thread-safe and must be used by the thread running it.
+ */
+/*===========================================================================*/
+class SocketEventLoop
+{
+public:
+
+    typedef kvs::Socket::id_type id_type;
+
+    /*=======================================================================*/
+    /**
+     *  @brief  Event handler of the loop.
+     */
+    /*=======================================================================*/
+    class Handler
+    {
+    public:
+
+        virtual ~Handler() {}
+
+        virtual void acceptEvent( SocketEventLoop* loop, const id_type id, const kvs::SocketAddress& address );
+        virtual void receiveEvent( SocketEventLoop* loop, const id_type id, const kvs::MessageBlock& message );
+        virtual void sendEvent( SocketEventLoop* loop, const id_type id );
+        virtual void closeEvent( SocketEventLoop* loop, const id_type id );
+        virtual void timerEvent( SocketEventLoop* loop, const int timer_id );
+    };
+
+private:
+
+    struct Connection
+    {
+        id_type id; ///< socket ID
+        bool listener; ///< true, if the socket is a listening socket
+        bool owner; ///< true, if the socket is closed by the loop
+        bool closed; ///< true, if the socket has been closed
+        std::vector<kvs::UInt8> input; ///< received bytes
+        std::deque<kvs::MessageBlock> output; ///< messages to be sent
+        size_t output_offset; ///< sent bytes of the first message
+    };
+
+    struct Timer
+    {
+        int id; ///< timer ID
+        double interval; ///< interval in milliseconds
+        double next; ///< next expiration time in milliseconds
+        bool repeat; ///< true, if the timer is repeated
+    };
+
+    Handler* m_handler; ///< event handler (not allocated in this class)
+    std::map<id_type,Connection*> m_connections; ///< registered sockets
+    std::vector<Connection*> m_closed; ///< sockets closed in the current iteration
+    std::vector<Timer> m_timers; ///< timers
+    std::vector<kvs::TCPServer*> m_servers; ///< servers created by listen()
+    int m_timer_counter; ///< counter of the timer IDs
+    size_t m_max_message_size; ///< max. size of the received message
+    bool m_quit; ///< true, if the loop is quitted
+    int m_backend; ///< epoll descriptor (Linux only)
+
+public:
+
+    SocketEventLoop( Handler* handler );
+    virtual ~SocketEventLoop();
+
+    size_t numberOfConnections() const;
+    size_t pendingOutputSize( const id_type id ) const;
+    size_t maxMessageSize() const { return m_max_message_size; }
+    void setMaxMessageSize( const size_t size ) { m_max_message_size = size; }
+
+    bool listen( const int port, const int backlog = 128 );
+    bool addServer( const kvs::TCPServer* server );
+    bool addConnection( const id_type id );
+    bool send( const id_type id, const kvs::MessageBlock& message );
+    void close( const id_type id );
+
+    int startTimer( const kvs::SocketTimer& interval, const bool repeat = true );
+    void stopTimer( const int timer_id );
+
+    bool runOnce( const kvs::SocketTimer* timeout = 0 );
+    void run();
+    void quit() { m_quit = true; }
+
+private:
+
+    bool add( const id_type id, const bool listener, const bool owner );
+    void accept( Connection* connection );
+    void read( Connection* connection );
+    bool deliver( Connection* connection );
+    void write( Connection* connection );
+    void close( Connection* connection );
+    void release_closed();
+    int wait_timeout( const kvs::SocketTimer* timeout ) const;
+    void process_timers();
+};
+
+} // end of namespace kvs
+
+#endif // KVS__SOCKET_EVENT_LOOP_H_INCLUDE
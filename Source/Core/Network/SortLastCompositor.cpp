@@ -0,0 +1,792 @@
+/*****************************************************************************/
+/**
+ *  @file   SortLastCompositor.cpp
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "SortLastCompositor.h"
+#include "TCPConnect.h"
+#include <cstring>
+#include <algorithm>
+#include <kvs/Message>
+#include <kvs/Math>
+#include <kvs/Thread>
+#include <kvs/SocketTimer>
+
+
+namespace
+{
+
+/// Size of the message header (payload size in bytes).
+const size_t HeaderSize = sizeof( kvs::UInt32 );
+
+/// Max. size of the data sent or received at once.
+const size_t MaxChunkSize = 1 << 30;
+
+typedef std::vector<kvs::UInt8> Message;
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the pointer to the data of the message.
+ *  @param  message [in] message
+ *  @return pointer to the data (NULL if the message is empty)
+ */
+/*===========================================================================*/
+inline const kvs::UInt8* Data( const Message& message )
+{
+    return message.empty() ? NULL : &message[0];
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Appends the value to the message.
+ *  @param  message [in/out] message
+ *  @param  data [in] pointer to the value
+ *  @param  size [in] size of the value in bytes
+ */
+/*===========================================================================*/
+inline void Append( Message* message, const void* data, const size_t size )
+{
+    const kvs::UInt8* p = static_cast<const kvs::UInt8*>( data );
+    message->insert( message->end(), p, p + size );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sends the data completely.
+ *  @param  socket [in] pointer to the socket
+ *  @param  data [in] pointer to the data
+ *  @param  size [in] size of the data in bytes
+ *  @return true, if the data is sent
+ */
+/*===========================================================================*/
+bool SendAll( kvs::TCPSocket* socket, const void* data, size_t size )
+{
+    const char* p = static_cast<const char*>( data );
+    while ( size > 0 )
+    {
+        const int n = socket->send( p, static_cast<int>( kvs::Math::Min( size, ::MaxChunkSize ) ) );
+        if ( n <= 0 ) { return false; }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Receives the data completely.
+ *  @param  socket [in] pointer to the socket
+ *  @param  data [out] pointer to the data
+ *  @param  size [in] size of the data in bytes
+ *  @return true, if the data is received
+ */
+/*===========================================================================*/
+bool ReceiveAll( kvs::TCPSocket* socket, void* data, size_t size )
+{
+    char* p = static_cast<char*>( data );
+    while ( size > 0 )
+    {
+        const int chunk = static_cast<int>( kvs::Math::Min( size, ::MaxChunkSize ) );
+        const int n = socket->receive( p, chunk );
+        if ( n != chunk ) { return false; }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Writes the payload size to the header of the message.
+ *  @param  message [in/out] message (the first HeaderSize bytes are reserved for the header)
+ */
+/*===========================================================================*/
+inline void Seal( Message* message )
+{
+    const kvs::UInt32 size = htonl( static_cast<kvs::UInt32>( message->size() - ::HeaderSize ) );
+    std::memcpy( &(*message)[0], &size, ::HeaderSize );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sends the sealed message.
+ *  @param  socket [in] pointer to the socket
+ *  @param  message [in] message with the header
+ *  @return true, if the message is sent
+ */
+/*===========================================================================*/
+inline bool SendMessage( kvs::TCPSocket* socket, const Message& message )
+{
+    return SendAll( socket, Data( message ), message.size() );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Receives the message with the header.
+ *  @param  socket [in] pointer to the socket
+ *  @param  message [out] message (payload only)
+ *  @return true, if the message is received
+ */
+/*===========================================================================*/
+bool ReceiveMessage( kvs::TCPSocket* socket, Message* message )
+{
+    kvs::UInt32 size = 0;
+    if ( !ReceiveAll( socket, &size, ::HeaderSize ) ) { return false; }
+
+    message->resize( ntohl( size ) );
+    return message->empty() || ReceiveAll( socket, &(*message)[0], message->size() );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Thread to send the messages to the sockets in order.
+ */
+/*===========================================================================*/
+class Sender : public kvs::Thread
+{
+private:
+
+    const std::vector<kvs::TCPSocket*>& m_sockets; ///< destination sockets
+    const std::vector<const Message*>& m_messages; ///< messages
+    bool m_success; ///< true, if all the messages are sent
+
+public:
+
+    Sender( const std::vector<kvs::TCPSocket*>& sockets, const std::vector<const Message*>& messages ):
+        m_sockets( sockets ),
+        m_messages( messages ),
+        m_success( false ) {}
+
+    bool isSuccess() const { return m_success; }
+
+    void run()
+    {
+        m_success = true;
+        for ( size_t i = 0; i < m_sockets.size() && m_success; i++ )
+        {
+            m_success = SendMessage( m_sockets[i], *m_messages[i] );
+        }
+    }
+};
+
+typedef kvs::SortLastCompositor::Image Image;
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if the pixel is empty.
+ *  @param  op [in] compositing operator
+ *  @param  color [in] pointer to the RGBA color
+ *  @param  depth [in] depth
+ *  @return true, if the pixel is empty
+ */
+/*===========================================================================*/
+inline bool IsEmpty( const kvs::SortLastCompositor::Operator op, const kvs::UInt8* color, const kvs::Real32 depth )
+{
+    return op == kvs::SortLastCompositor::AlphaBlend ? color[3] == 0 : !( depth < 1.0f );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Composites the pixel behind the result pixel.
+ *  @param  op [in] compositing operator
+ *  @param  result_color [in/out] pointer to the RGBA color of the result
+ *  @param  result_depth [in/out] pointer to the depth of the result
+ *  @param  color [in] pointer to the RGBA color behind the result
+ *  @param  depth [in] depth behind the result
+ */
+/*===========================================================================*/
+inline void CompositePixel(
+    const kvs::SortLastCompositor::Operator op,
+    kvs::UInt8* result_color,
+    kvs::Real32* result_depth,
+    const kvs::UInt8* color,
+    const kvs::Real32 depth )
+{
+    if ( op == kvs::SortLastCompositor::AlphaBlend )
+    {
+        const unsigned int transparency = 255 - result_color[3];
+        for ( int c = 0; c < 4; c++ )
+        {
+            const unsigned int value = result_color[c] + ( color[c] * transparency + 127 ) / 255;
+            result_color[c] = static_cast<kvs::UInt8>( kvs::Math::Min( value, 255u ) );
+        }
+        *result_depth = kvs::Math::Min( *result_depth, depth );
+    }
+    else if ( depth < *result_depth )
+    {
+        std::memcpy( result_color, color, 4 );
+        *result_depth = depth;
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Encodes the pixels with the run-length encoding of the empty pixels.
+ *  @param  op [in] compositing operator
+ *  @param  image [in] image
+ *  @param  begin [in] index of the first pixel
+ *  @param  end [in] index of the pixel after the last one
+ *  @param  message [in/out] message to which the runs of [#empty, #filled, filled pixels] are appended
+ */
+/*===========================================================================*/
+void Encode(
+    const kvs::SortLastCompositor::Operator op,
+    const ::Image& image,
+    const size_t begin,
+    const size_t end,
+    Message* message )
+{
+    size_t i = begin;
+    while ( i < end )
+    {
+        const size_t empty_begin = i;
+        while ( i < end && IsEmpty( op, image.color + 4 * i, image.depth[i] ) ) { i++; }
+        const size_t filled_begin = i;
+        while ( i < end && !IsEmpty( op, image.color + 4 * i, image.depth[i] ) ) { i++; }
+
+        const kvs::UInt32 nempty = static_cast<kvs::UInt32>( filled_begin - empty_begin );
+        const kvs::UInt32 nfilled = static_cast<kvs::UInt32>( i - filled_begin );
+        Append( message, &nempty, sizeof( nempty ) );
+        Append( message, &nfilled, sizeof( nfilled ) );
+        Append( message, image.color + 4 * filled_begin, 4 * nfilled );
+        Append( message, image.depth + filled_begin, sizeof( kvs::Real32 ) * nfilled );
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Decodes the pixels and composites them behind the result.
+ *  @param  op [in] compositing operator
+ *  @param  data [in] pointer to the encoded pixels
+ *  @param  size [in] size of the encoded pixels in bytes
+ *  @param  npixels [in] number of the encoded pixels
+ *  @param  result [in/out] result pixels (from the first encoded pixel)
+ *  @param  overwrite [in] if true, the pixels are copied instead of composited
+ *  @return true, if the message is valid
+ */
+/*===========================================================================*/
+bool Decode(
+    const kvs::SortLastCompositor::Operator op,
+    const kvs::UInt8* data,
+    const size_t size,
+    const size_t npixels,
+    const ::Image& result,
+    const bool overwrite )
+{
+    const kvs::UInt8* p = data;
+    const kvs::UInt8* const last = p + size;
+    size_t i = 0;
+    while ( i < npixels )
+    {
+        kvs::UInt32 nempty = 0;
+        kvs::UInt32 nfilled = 0;
+        if ( last - p < static_cast<ptrdiff_t>( 2 * sizeof( kvs::UInt32 ) ) ) { return false; }
+        std::memcpy( &nempty, p, sizeof( nempty ) ); p += sizeof( nempty );
+        std::memcpy( &nfilled, p, sizeof( nfilled ) ); p += sizeof( nfilled );
+        if ( i + nempty + nfilled > npixels ) { return false; }
+        if ( last - p < static_cast<ptrdiff_t>( nfilled * ( 4 + sizeof( kvs::Real32 ) ) ) ) { return false; }
+
+        i += nempty;
+        const kvs::UInt8* color = p;
+        const kvs::UInt8* depth = p + 4 * nfilled;
+        for ( size_t j = 0; j < nfilled; j++, i++ )
+        {
+            kvs::Real32 d;
+            std::memcpy( &d, depth + sizeof( kvs::Real32 ) * j, sizeof( d ) );
+            if ( overwrite )
+            {
+                std::memcpy( result.color + 4 * i, color + 4 * j, 4 );
+                result.depth[i] = d;
+            }
+            else
+            {
+                CompositePixel( op, result.color + 4 * i, result.depth + i, color + 4 * j, d );
+            }
+        }
+        p += nfilled * ( 4 + sizeof( kvs::Real32 ) );
+    }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Clears the pixels to the empty pixels.
+ *  @param  image [in] image
+ *  @param  begin [in] index of the first pixel
+ *  @param  end [in] index of the pixel after the last one
+ */
+/*===========================================================================*/
+void Clear( const ::Image& image, const size_t begin, const size_t end )
+{
+    std::memset( image.color + 4 * begin, 0, 4 * ( end - begin ) );
+    std::fill( image.depth + begin, image.depth + end, 1.0f );
+}
+
+} // end of namespace
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new SortLastCompositor class.
+ *  @param  rank [in] rank of this process
+ *  @param  nranks [in] number of the ranks
+ */
+/*===========================================================================*/
+SortLastCompositor::SortLastCompositor( const size_t rank, const size_t nranks ):
+    m_rank( rank ),
+    m_nranks( nranks ),
+    m_root( 0 ),
+    m_method( BinarySwap ),
+    m_operator( DepthTest ),
+    m_radix( 4 ),
+    m_server( NULL ),
+    m_width( 0 ),
+    m_height( 0 )
+{
+    for ( size_t i = 0; i < nranks; i++ ) { m_order.push_back( i ); }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Destroys the SortLastCompositor class.
+ */
+/*===========================================================================*/
+SortLastCompositor::~SortLastCompositor()
+{
+    this->disconnect();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets the visibility order of the ranks.
+ *  @param  ranks [in] ranks sorted from front to back (same for all the ranks)
+ */
+/*===========================================================================*/
+void SortLastCompositor::setVisibilityOrder( const std::vector<size_t>& ranks )
+{
+    std::vector<size_t> sorted( ranks );
+    std::sort( sorted.begin(), sorted.end() );
+    for ( size_t i = 0; i < sorted.size(); i++ )
+    {
+        if ( sorted.size() != m_nranks || sorted[i] != i )
+        {
+            kvsMessageError("Visibility order is not a permutation of the ranks.");
+            return;
+        }
+    }
+
+    m_order = ranks;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Connects the ranks to each other.
+ *  @param  addresses [in] addresses of all the ranks
+ *  @param  timeout_sec [in] timeout of the connections in seconds
+ *  @return true, if all the ranks are connected
+ *
+ *  Each rank listens to the port of its own address, connects to the ranks
+ *  lower than itself and accepts the ranks higher than itself.
+ */
+/*===========================================================================*/
+bool SortLastCompositor::connect( const std::vector<kvs::SocketAddress>& addresses, const int timeout_sec )
+{
+    this->disconnect();
+
+    if ( addresses.size() != m_nranks || m_rank >= m_nranks )
+    {
+        kvsMessageError("Number of the addresses is not equal to the number of the ranks.");
+        return false;
+    }
+
+    m_sockets.assign( m_nranks, static_cast<kvs::TCPSocket*>( NULL ) );
+    if ( m_nranks == 1 ) { return true; }
+
+    m_server = new kvs::TCPServer( addresses[ m_rank ].port(), static_cast<int>( m_nranks ) );
+    if ( !m_server->isBound() || !m_server->listen() )
+    {
+        kvsMessageError("Cannot listen to the port %d.", addresses[ m_rank ].port() );
+        this->disconnect();
+        return false;
+    }
+
+    // Connect to the lower ranks, which may not be listening yet.
+    for ( size_t i = 0; i < m_rank; i++ )
+    {
+        m_sockets[i] = kvs::detail::ConnectWithRetry( addresses[i], timeout_sec );
+        const kvs::UInt32 rank = htonl( static_cast<kvs::UInt32>( m_rank ) );
+        if ( !m_sockets[i] || !::SendAll( m_sockets[i], &rank, sizeof( rank ) ) )
+        {
+            kvsMessageError("Cannot connect to the rank %d.", int( i ) );
+            this->disconnect();
+            return false;
+        }
+    }
+
+    // Accept the higher ranks.
+    const kvs::SocketTimer timeout( timeout_sec );
+    for ( size_t i = m_rank + 1; i < m_nranks; i++ )
+    {
+        kvs::TCPSocket* socket = m_server->checkForNewConnection( &timeout );
+        kvs::UInt32 rank = 0;
+        if ( !socket || !::ReceiveAll( socket, &rank, sizeof( rank ) ) ||
+             ntohl( rank ) <= m_rank || ntohl( rank ) >= m_nranks || m_sockets[ ntohl( rank ) ] )
+        {
+            kvsMessageError("Cannot accept the connection from the higher ranks.");
+            delete socket;
+            this->disconnect();
+            return false;
+        }
+
+        m_sockets[ ntohl( rank ) ] = socket;
+    }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Disconnects the ranks.
+ */
+/*===========================================================================*/
+void SortLastCompositor::disconnect()
+{
+    for ( size_t i = 0; i < m_sockets.size(); i++ )
+    {
+        if ( m_sockets[i] ) { delete m_sockets[i]; }
+    }
+    m_sockets.clear();
+
+    if ( m_server ) { delete m_server; m_server = NULL; }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Composites the images of all the ranks to the root rank.
+ *  @param  width [in] image width
+ *  @param  height [in] image height
+ *  @param  color [in] RGBA color buffer of this rank
+ *  @param  depth [in] depth buffer of this rank
+ *  @return true, if the compositing succeeds (the image is given by
+ *          colorBuffer() and depthBuffer() of the root rank)
+ */
+/*===========================================================================*/
+bool SortLastCompositor::composite(
+    const size_t width,
+    const size_t height,
+    const kvs::ValueArray<kvs::UInt8>& color,
+    const kvs::ValueArray<kvs::Real32>& depth )
+{
+    const size_t npixels = width * height;
+    if ( color.size() != npixels * 4 || depth.size() != npixels )
+    {
+        kvsMessageError("Size of the color or depth buffer is invalid.");
+        return false;
+    }
+
+    if ( m_sockets.size() != m_nranks )
+    {
+        kvsMessageError("Ranks are not connected.");
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+
+    kvs::ValueArray<kvs::UInt8> work_color = color.clone();
+    kvs::ValueArray<kvs::Real32> work_depth = depth.clone();
+    ::Image work = { work_color.data(), work_depth.data() };
+    for ( size_t i = 0; i < npixels; i++ )
+    {
+        if ( ::IsEmpty( m_operator, work.color + 4 * i, work.depth[i] ) ) { ::Clear( work, i, i + 1 ); }
+    }
+
+    // Participants in the visibility order.
+    std::vector<size_t> ranks( m_order );
+    size_t index = std::find( ranks.begin(), ranks.end(), m_rank ) - ranks.begin();
+    bool active = true;
+
+    // Fold the extra ranks of the binary-swap into the front neighbors.
+    if ( m_method == BinarySwap )
+    {
+        size_t n = 1;
+        while ( n * 2 <= m_nranks ) { n *= 2; }
+        const size_t nextras = m_nranks - n;
+
+        std::vector<size_t> folded;
+        for ( size_t i = 0; i < m_nranks; i++ )
+        {
+            if ( i < 2 * nextras && i % 2 == 1 ) { continue; }
+            folded.push_back( ranks[i] );
+        }
+
+        if ( index < 2 * nextras )
+        {
+            ::Message message( ::HeaderSize );
+            if ( index % 2 == 1 )
+            {
+                ::Encode( m_operator, work, 0, npixels, &message );
+                ::Seal( &message );
+                if ( !::SendMessage( m_sockets[ ranks[ index - 1 ] ], message ) ) { return false; }
+                active = false;
+            }
+            else
+            {
+                if ( !::ReceiveMessage( m_sockets[ ranks[ index + 1 ] ], &message ) ||
+                     !::Decode( m_operator, ::Data( message ), message.size(), npixels, work, false ) )
+                {
+                    kvsMessageError("Cannot receive the image from the rank %d.", int( ranks[ index + 1 ] ) );
+                    return false;
+                }
+                index /= 2;
+            }
+        }
+        else
+        {
+            index -= nextras;
+        }
+
+        ranks = folded;
+    }
+
+    // Exchange and composite the parts of the images in the groups.
+    size_t begin = 0;
+    size_t end = npixels;
+    const std::vector<size_t> factors = this->factors();
+    size_t stride = 1;
+    for ( size_t r = 0; r < factors.size() && active; r++ )
+    {
+        const size_t k = factors[r];
+        const size_t digit = ( index / stride ) % k;
+        const size_t base = index - digit * stride;
+        const size_t length = end - begin;
+
+        std::vector<size_t> partners( k );
+        std::vector<size_t> bounds( k + 1 );
+        for ( size_t m = 0; m < k; m++ ) { partners[m] = ranks[ base + m * stride ]; }
+        for ( size_t m = 0; m <= k; m++ ) { bounds[m] = begin + length * m / k; }
+
+        std::vector< ::Message > messages( k, ::Message( ::HeaderSize ) );
+        for ( size_t m = 0; m < k; m++ )
+        {
+            if ( m == digit ) { continue; }
+            ::Encode( m_operator, work, bounds[m], bounds[m+1], &messages[m] );
+            ::Seal( &messages[m] );
+        }
+
+        std::vector< ::Message > received;
+        if ( !this->exchange( partners, messages, &received ) ) { return false; }
+
+        // Composite the part from front to back.
+        const size_t part_begin = bounds[ digit ];
+        const size_t part_end = bounds[ digit + 1 ];
+        const size_t part_size = part_end - part_begin;
+        kvs::ValueArray<kvs::UInt8> part_color( part_size * 4 );
+        kvs::ValueArray<kvs::Real32> part_depth( part_size );
+        ::Image part = { part_color.data(), part_depth.data() };
+        ::Clear( part, 0, part_size );
+        for ( size_t m = 0; m < k; m++ )
+        {
+            if ( m == digit )
+            {
+                for ( size_t i = 0; i < part_size; i++ )
+                {
+                    const size_t j = part_begin + i;
+                    if ( ::IsEmpty( m_operator, work.color + 4 * j, work.depth[j] ) ) { continue; }
+                    ::CompositePixel( m_operator, part.color + 4 * i, part.depth + i, work.color + 4 * j, work.depth[j] );
+                }
+            }
+            else if ( !::Decode( m_operator, ::Data( received[m] ), received[m].size(), part_size, part, false ) )
+            {
+                kvsMessageError("Cannot decode the image from the rank %d.", int( partners[m] ) );
+                return false;
+            }
+        }
+
+        std::memcpy( work.color + 4 * part_begin, part.color, 4 * part_size );
+        std::memcpy( work.depth + part_begin, part.depth, sizeof( kvs::Real32 ) * part_size );
+        begin = part_begin;
+        end = part_end;
+        stride *= k;
+    }
+
+    return this->gather( ranks, work, begin, end, active );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the group sizes of the compositing rounds.
+ *  @return group sizes
+ */
+/*===========================================================================*/
+std::vector<size_t> SortLastCompositor::factors() const
+{
+    std::vector<size_t> factors;
+    if ( m_method == BinarySwap )
+    {
+        for ( size_t n = 2; n <= m_nranks; n *= 2 ) { factors.push_back( 2 ); }
+        return factors;
+    }
+
+    // Prime factors merged up to the radix.
+    std::vector<size_t> primes;
+    size_t n = m_nranks;
+    for ( size_t p = 2; p * p <= n; p++ )
+    {
+        while ( n % p == 0 ) { primes.push_back( p ); n /= p; }
+    }
+    if ( n > 1 ) { primes.push_back( n ); }
+
+    const size_t radix = kvs::Math::Max( m_radix, size_t( 2 ) );
+    size_t factor = 1;
+    for ( size_t i = 0; i < primes.size(); i++ )
+    {
+        if ( factor > 1 && factor * primes[i] > radix )
+        {
+            factors.push_back( factor );
+            factor = 1;
+        }
+        factor *= primes[i];
+    }
+    if ( factor > 1 ) { factors.push_back( factor ); }
+
+    return factors;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Exchanges the messages in the group.
+ *  @param  partners [in] ranks of the group members in the visibility order
+ *  @param  messages [in] messages to the members
+ *  @param  received [out] messages from the members
+ *  @return true, if the messages are exchanged
+ *
+ *  At the step t, the member m sends the message to the member m+t and
+ *  receives the message from the member m-t (modulo the group size). The
+ *  messages are sent by another thread to avoid the deadlock.
+ */
+/*===========================================================================*/
+bool SortLastCompositor::exchange(
+    const std::vector<size_t>& partners,
+    const std::vector< std::vector<kvs::UInt8> >& messages,
+    std::vector< std::vector<kvs::UInt8> >* received )
+{
+    const size_t k = partners.size();
+    const size_t digit = std::find( partners.begin(), partners.end(), m_rank ) - partners.begin();
+
+    std::vector<kvs::TCPSocket*> destinations;
+    std::vector<const ::Message*> outgoing;
+    for ( size_t t = 1; t < k; t++ )
+    {
+        const size_t m = ( digit + t ) % k;
+        destinations.push_back( m_sockets[ partners[m] ] );
+        outgoing.push_back( &messages[m] );
+    }
+
+    ::Sender sender( destinations, outgoing );
+    sender.start();
+
+    received->assign( k, ::Message() );
+    bool success = true;
+    for ( size_t t = 1; t < k && success; t++ )
+    {
+        const size_t m = ( digit + k - t ) % k;
+        success = ::ReceiveMessage( m_sockets[ partners[m] ], &(*received)[m] );
+    }
+
+    sender.wait();
+    if ( !success || !sender.isSuccess() )
+    {
+        kvsMessageError("Cannot exchange the images.");
+        return false;
+    }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Gathers the composited parts to the root rank.
+ *  @param  ranks [in] ranks having the parts
+ *  @param  image [in] composited image of this rank
+ *  @param  begin [in] index of the first pixel of the part of this rank
+ *  @param  end [in] index of the pixel after the last one of the part
+ *  @param  active [in] true, if this rank has a part
+ *  @return true, if the parts are gathered
+ */
+/*===========================================================================*/
+bool SortLastCompositor::gather(
+    const std::vector<size_t>& ranks,
+    const Image& image,
+    const size_t begin,
+    const size_t end,
+    const bool active )
+{
+    if ( m_rank != m_root )
+    {
+        if ( !active ) { return true; }
+
+        ::Message message( ::HeaderSize );
+        const kvs::UInt32 range[2] = { static_cast<kvs::UInt32>( begin ), static_cast<kvs::UInt32>( end ) };
+        ::Append( &message, range, sizeof( range ) );
+        ::Encode( m_operator, image, begin, end, &message );
+        ::Seal( &message );
+        if ( !::SendMessage( m_sockets[ m_root ], message ) )
+        {
+            kvsMessageError("Cannot send the image to the root rank.");
+            return false;
+        }
+        return true;
+    }
+
+    const size_t npixels = m_width * m_height;
+    m_color.allocate( npixels * 4 );
+    m_depth.allocate( npixels );
+    const ::Image result = { m_color.data(), m_depth.data() };
+    ::Clear( result, 0, npixels );
+    if ( active )
+    {
+        std::memcpy( result.color + 4 * begin, image.color + 4 * begin, 4 * ( end - begin ) );
+        std::memcpy( result.depth + begin, image.depth + begin, sizeof( kvs::Real32 ) * ( end - begin ) );
+    }
+
+    for ( size_t i = 0; i < ranks.size(); i++ )
+    {
+        if ( ranks[i] == m_root ) { continue; }
+
+        ::Message message;
+        kvs::UInt32 range[2] = { 0, 0 };
+        bool success = ::ReceiveMessage( m_sockets[ ranks[i] ], &message ) && message.size() >= sizeof( range );
+        if ( success )
+        {
+            std::memcpy( range, ::Data( message ), sizeof( range ) );
+            success = range[0] <= range[1] && range[1] <= npixels;
+        }
+        if ( success )
+        {
+            const ::Image part = { result.color + 4 * range[0], result.depth + range[0] };
+            success = ::Decode( m_operator, ::Data( message ) + sizeof( range ), message.size() - sizeof( range ), range[1] - range[0], part, true );
+        }
+        if ( !success )
+        {
+            kvsMessageError("Cannot receive the image from the rank %d.", int( ranks[i] ) );
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // end of namespace kvs
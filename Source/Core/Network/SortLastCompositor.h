@@ -0,0 +1,140 @@
+/*****************************************************************************/
+/**
+ *  @file   SortLastCompositor.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVS__SORT_LAST_COMPOSITOR_H_INCLUDE
+#define KVS__SORT_LAST_COMPOSITOR_H_INCLUDE
+
+#include <vector>
+#include <kvs/ValueArray>
+#include <kvs/Type>
+#include <kvs/SocketAddress>
+#include <kvs/TCPSocket>
+#include <kvs/TCPServer>
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Sort-last image compositing class over TCP sockets.
+ *
+ *  Each rank (process) renders a part of the data to an RGBA color buffer
+ *  and a depth buffer of the same size, and the images of all the ranks are
+ *  composited to the root rank by the binary-swap or radix-k algorithm.
+ *  The images are merged by the depth test or blended by the 'over'
+ *  operator (the colors are premultiplied by the alpha) in the visibility
+ *  order of the ranks. The empty pixels (alpha is zero for the blending and
+ *  depth is one or more for the depth test) are run-length encoded in the
+ *  exchanged messages, and they are zero color with depth one in the result.
+ *  The blended colors are rounded to 8 bits at each compositing step, so
+ *  they may differ slightly from the serial blending.
+ *
+ *  The ranks are connected to each other by connect() with the addresses of
+ *  all the ranks, where each rank listens to the port of its own address.
+ *  The binary-swap for the number of ranks which is not a power of two folds
+ *  the images of the extra ranks into their neighbors in the visibility
+ *  order at first. The radix-k uses the factorization of the number of ranks
+ *  into the factors up to k (and the prime factors greater than k).
+ */
+/*===========================================================================*/
+class SortLastCompositor
+{
+public:
+
+    enum Method
+    {
+        BinarySwap, ///< binary-swap
+        RadixK      ///< radix-k
+    };
+
+    enum Operator
+    {
+        DepthTest,  ///< merge by the depth test
+        AlphaBlend  ///< blend by the 'over' operator in the visibility order
+    };
+
+    struct Image
+    {
+        kvs::UInt8* color; ///< RGBA colors
+        kvs::Real32* depth; ///< depths
+    };
+
+private:
+
+    size_t m_rank; ///< rank of this process
+    size_t m_nranks; ///< number of the ranks
+    size_t m_root; ///< rank gathering the composited image
+    Method m_method; ///< compositing method
+    Operator m_operator; ///< compositing operator
+    size_t m_radix; ///< max. group size (k) of radix-k
+    std::vector<size_t> m_order; ///< ranks in the visibility order (front to back)
+    kvs::TCPServer* m_server; ///< server socket
+    std::vector<kvs::TCPSocket*> m_sockets; ///< sockets connected to the ranks
+    size_t m_width; ///< image width
+    size_t m_height; ///< image height
+    kvs::ValueArray<kvs::UInt8> m_color; ///< composited color buffer (root only)
+    kvs::ValueArray<kvs::Real32> m_depth; ///< composited depth buffer (root only)
+
+public:
+
+    SortLastCompositor( const size_t rank, const size_t nranks );
+    virtual ~SortLastCompositor();
+
+    size_t rank() const { return m_rank; }
+    size_t numberOfRanks() const { return m_nranks; }
+    size_t root() const { return m_root; }
+    Method method() const { return m_method; }
+    Operator compositingOperator() const { return m_operator; }
+    size_t radix() const { return m_radix; }
+    const std::vector<size_t>& visibilityOrder() const { return m_order; }
+    size_t width() const { return m_width; }
+    size_t height() const { return m_height; }
+    const kvs::ValueArray<kvs::UInt8>& colorBuffer() const { return m_color; }
+    const kvs::ValueArray<kvs::Real32>& depthBuffer() const { return m_depth; }
+
+    void setRoot( const size_t root ) { m_root = root; }
+    void setMethod( const Method method ) { m_method = method; }
+    void setMethodToBinarySwap() { this->setMethod( BinarySwap ); }
+    void setMethodToRadixK( const size_t k ) { this->setMethod( RadixK ); m_radix = k; }
+    void setOperator( const Operator op ) { m_operator = op; }
+    void setOperatorToDepthTest() { this->setOperator( DepthTest ); }
+    void setOperatorToAlphaBlend() { this->setOperator( AlphaBlend ); }
+    void setVisibilityOrder( const std::vector<size_t>& ranks );
+
+    bool connect( const std::vector<kvs::SocketAddress>& addresses, const int timeout_sec = 30 );
+    void disconnect();
+    bool composite(
+        const size_t width,
+        const size_t height,
+        const kvs::ValueArray<kvs::UInt8>& color,
+        const kvs::ValueArray<kvs::Real32>& depth );
+
+private:
+
+    std::vector<size_t> factors() const;
+    bool exchange(
+        const std::vector<size_t>& partners,
+        const std::vector< std::vector<kvs::UInt8> >& messages,
+        std::vector< std::vector<kvs::UInt8> >* received );
+    bool gather(
+        const std::vector<size_t>& ranks,
+        const Image& image,
+        const size_t begin,
+        const size_t end,
+        const bool active );
+};
+
+} // end of namespace kvs
+
+#endif // KVS__SORT_LAST_COMPOSITOR_H_INCLUDE
@@ -0,0 +1,59 @@
+/*****************************************************************************/
+/**
+ *  @file   TCPConnect.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVS__TCP_CONNECT_H_INCLUDE
+#define KVS__TCP_CONNECT_H_INCLUDE
+
+#include "TCPSocket.h"
+#include "SocketAddress.h"
+#include <kvs/Math>
+#include <kvs/Thread>
+
+
+namespace kvs
+{
+
+namespace detail
+{
+
+/// Interval of the connection retries in milliseconds.
+const int ConnectRetryInterval = 100;
+
+/*===========================================================================*/
+/**
+ *  @brief  Connects to the address, retrying until the peer is listening.
+ *  @param  address [in] address of the peer
+ *  @param  timeout_sec [in] timeout in seconds
+ *  @return pointer to the connected socket (NULL, if the timeout is expired)
+ */
+/*===========================================================================*/
+inline kvs::TCPSocket* ConnectWithRetry( const kvs::SocketAddress& address, const int timeout_sec )
+{
+    const int max_retries = kvs::Math::Max( 1, timeout_sec * 1000 / ConnectRetryInterval );
+    for ( int retry = 0; retry < max_retries; retry++ )
+    {
+        kvs::TCPSocket* socket = new kvs::TCPSocket( address );
+        if ( socket->isConnected() ) { return socket; }
+
+        delete socket;
+        kvs::Thread::MilliSleep( ConnectRetryInterval );
+    }
+
+    return NULL;
+}
+
+} // end of namespace detail
+
+} // end of namespace kvs
+
+#endif // KVS__TCP_CONNECT_H_INCLUDE
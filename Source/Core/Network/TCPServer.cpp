@@ -232,9 +232,10 @@ int TCPServer::send( const kvs::MessageBlock& message, kvs::SocketAddress* clien
     kvs::Socket::id_type id = this->accept( client_address );
     if( id != kvs::Socket::InvalidID )
     {
-        size = ::send( id,
-                       (const char*)message.blockData(),
-                       message.blockSize(), 0 );
+        if( kvs::Socket::send_message( id, message ) )
+        {
+            size = static_cast<int>( message.blockSize() );
+        }
 
         kvs::Socket::close_socket( id );
     }
@@ -284,10 +285,11 @@ int TCPServer::receive( kvs::MessageBlock* message, kvs::SocketAddress* client_a
         int status = kvs::Socket::receive_peek( id, (char*)&data_size, sizeof( size_t ) );
         if( status == -1 ) return( status );
 
-        message->allocate( ntohl( data_size ) );
+        // The block allocated for the received message is never referenced.
+        char* block = static_cast<char*>( message->allocate( ntohl( data_size ) ) );
 
         size = kvs::Socket::receive_exact( id,
-                                           (char*)message->blockData(),
+                                           block,
                                            message->blockSize() );
 
         kvs::Socket::close_socket( id );
@@ -16,8 +16,40 @@
 #include "SocketAddress.h"
 #include "SocketTimer.h"
 #include "MessageBlock.h"
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <kvs/Message>
+#include <kvs/Value>
+#if defined( KVS_PLATFORM_LINUX )
+#include <poll.h>
+#include <sys/sendfile.h>
+#include <linux/errqueue.h>
+#if defined( SO_ZEROCOPY ) && defined( MSG_ZEROCOPY )
+#define KVS_TCP_SOCKET_ZERO_COPY
+#endif
+#endif
 
 
+namespace
+{
+
+/*==========================================================================*/
+/**
+ *  Returns the sent size as the return value of send.
+ *  @param size [in] sent size
+ *  @return sent size (clamped to INT_MAX)
+ */
+/*==========================================================================*/
+int SentSize( const size_t size )
+{
+    return( static_cast<int>( std::min( size, static_cast<size_t>( INT_MAX ) ) ) );
+}
+
+}
+
 namespace kvs
 {
 
@@ -27,7 +59,11 @@ namespace kvs
  */
 /*==========================================================================*/
 TCPSocket::TCPSocket():
-    m_is_connected( false )
+    m_is_connected( false ),
+    m_zero_copy_threshold( 0 ),
+    m_zero_copy_state( 0 ),
+    m_zero_copy_issued( 0 ),
+    m_zero_copy_completed( 0 )
 {
 }
 
@@ -40,7 +76,11 @@ TCPSocket::TCPSocket():
  */
 /*==========================================================================*/
 TCPSocket::TCPSocket( const kvs::IPAddress& ip, const int port , const kvs::SocketTimer* timeout ):
-    m_is_connected( false )
+    m_is_connected( false ),
+    m_zero_copy_threshold( 0 ),
+    m_zero_copy_state( 0 ),
+    m_zero_copy_issued( 0 ),
+    m_zero_copy_completed( 0 )
 {
     this->open();
     this->connect( ip, port, timeout );
@@ -54,7 +94,11 @@ TCPSocket::TCPSocket( const kvs::IPAddress& ip, const int port , const kvs::Sock
  */
 /*==========================================================================*/
 TCPSocket::TCPSocket( const kvs::SocketAddress& socket_address, const kvs::SocketTimer* timeout ):
-    m_is_connected( false )
+    m_is_connected( false ),
+    m_zero_copy_threshold( 0 ),
+    m_zero_copy_state( 0 ),
+    m_zero_copy_issued( 0 ),
+    m_zero_copy_completed( 0 )
 {
     this->open();
     this->connect( socket_address, timeout );
@@ -69,7 +113,11 @@ TCPSocket::TCPSocket( const kvs::SocketAddress& socket_address, const kvs::Socke
 /*==========================================================================*/
 TCPSocket::TCPSocket( const kvs::Socket::id_type& id, const kvs::SocketAddress& address ):
     kvs::Socket( id, address ),
-    m_is_connected( false )
+    m_is_connected( false ),
+    m_zero_copy_threshold( 0 ),
+    m_zero_copy_state( 0 ),
+    m_zero_copy_issued( 0 ),
+    m_zero_copy_completed( 0 )
 {
 }
 
@@ -207,12 +255,87 @@ int TCPSocket::send( const void* message, const int message_size )
 /**
  *  Send messages.
  *  @param message [in] message
- *  @return size of sent message
+ *  @return size of sent message (-1: failure)
  */
 /*==========================================================================*/
 int TCPSocket::send( const kvs::MessageBlock& message )
 {
-    return( this->send( message.blockData(), message.blockSize() ) );
+    int flags = 0;
+#if defined( KVS_TCP_SOCKET_ZERO_COPY )
+    const bool zero_copy =
+        m_zero_copy_threshold > 0 &&
+        message.size() >= m_zero_copy_threshold &&
+        this->enable_zero_copy();
+    if( zero_copy ) flags |= MSG_ZEROCOPY;
+#endif
+
+    size_t nsends = 0;
+    const bool sent = kvs::Socket::send_message( kvs::Socket::id(), message, flags, &nsends );
+
+#if defined( KVS_TCP_SOCKET_ZERO_COPY )
+    // The message must not be modified until the kernel completes sending it.
+    m_zero_copy_issued += static_cast<kvs::UInt32>( nsends );
+    if( nsends > 0 && !this->wait_zero_copy() ) return( -1 );
+#endif
+
+    return( sent ? ::SentSize( message.blockSize() ) : -1 );
+}
+
+/*==========================================================================*/
+/**
+ *  Send file as a message.
+ *  @param filename [in] filename
+ *  @return size of sent message (-1: failure)
+ *
+ *  The file contents are sent following the size header, which can be
+ *  received as a message block. The contents are sent by sendfile without
+ *  being copied to the user space on Linux.
+ */
+/*==========================================================================*/
+int TCPSocket::sendFile( const std::string& filename )
+{
+    FILE* file = fopen( filename.c_str(), "rb" );
+    if( !file )
+    {
+        kvsMessageError( "Cannot open %s.", filename.c_str() );
+        return( -1 );
+    }
+
+    fseek( file, 0, SEEK_END );
+    const long file_size = ftell( file );
+    fseek( file, 0, SEEK_SET );
+    if( file_size < 0 || static_cast<unsigned long>( file_size ) > kvs::Value<kvs::UInt32>::Max() )
+    {
+        kvsMessageError( "Cannot send %s as a message.", filename.c_str() );
+        fclose( file );
+        return( -1 );
+    }
+
+    const kvs::UInt32 size = htonl( static_cast<kvs::UInt32>( file_size ) );
+    bool sent = false;
+#if defined( KVS_PLATFORM_LINUX )
+    sent = kvs::Socket::send_exact( kvs::Socket::id(), reinterpret_cast<const char*>( &size ), sizeof( size ), MSG_MORE );
+    off_t offset = 0;
+    while( sent && offset < file_size )
+    {
+        const ssize_t actual_size = ::sendfile( kvs::Socket::id(), fileno( file ), &offset, file_size - offset );
+        if( actual_size < 0 && errno == EINTR ) continue;
+        if( actual_size <= 0 ) sent = false;
+    }
+#else
+    sent = kvs::Socket::send_exact( kvs::Socket::id(), reinterpret_cast<const char*>( &size ), sizeof( size ) );
+    std::vector<char> buffer( 1024 * 1024 );
+    size_t remain = static_cast<size_t>( file_size );
+    while( sent && remain > 0 )
+    {
+        const size_t read_size = fread( &buffer[0], 1, std::min( remain, buffer.size() ), file );
+        sent = read_size > 0 && kvs::Socket::send_exact( kvs::Socket::id(), &buffer[0], read_size );
+        remain -= read_size;
+    }
+#endif
+
+    fclose( file );
+    return( sent ? ::SentSize( sizeof( size ) + file_size ) : -1 );
 }
 
 /*==========================================================================*/
@@ -243,9 +366,10 @@ int TCPSocket::receive( MessageBlock* message )
                                             sizeof( size_t ) );
     if( status == -1 ) return( status );
 
-    message->allocate( ntohl( message_size ) );
+    // The block allocated for the received message is never referenced.
+    void* block = message->allocate( ntohl( message_size ) );
 
-    return( this->receive( message->blockData(), message->blockSize() ) );
+    return( this->receive( block, message->blockSize() ) );
 }
 
 /*==========================================================================*/
@@ -273,4 +397,74 @@ int TCPSocket::receiveLine( std::string& line )
     return( kvs::Socket::receive_line( kvs::Socket::id(), line ) );
 }
 
+/*==========================================================================*/
+/**
+ *  Enable the zero-copy send.
+ *  @return true, if the zero-copy send is available
+ */
+/*==========================================================================*/
+bool TCPSocket::enable_zero_copy()
+{
+#if defined( KVS_TCP_SOCKET_ZERO_COPY )
+    if( m_zero_copy_state == 0 )
+    {
+        int enable = 1;
+        const int status = kvs::Socket::set_option( m_id, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable) );
+        m_zero_copy_state = status == 0 ? 1 : -1;
+    }
+#endif
+    return( m_zero_copy_state == 1 );
+}
+
+/*==========================================================================*/
+/**
+ *  Wait for the completion of the issued zero-copy sends.
+ *  @return true, if all the zero-copy sends are completed
+ */
+/*==========================================================================*/
+bool TCPSocket::wait_zero_copy()
+{
+#if defined( KVS_TCP_SOCKET_ZERO_COPY )
+    // The completions are notified as the ranges of the send IDs through the
+    // error queue of the socket.
+    while( m_zero_copy_completed != m_zero_copy_issued )
+    {
+        char control[256];
+        struct msghdr msg;
+        memset( &msg, 0, sizeof( msg ) );
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof( control );
+        if( ::recvmsg( m_id, &msg, MSG_ERRQUEUE ) < 0 )
+        {
+            if( errno == EINTR ) continue;
+            if( errno != EAGAIN && errno != EWOULDBLOCK ) return( false );
+
+            struct pollfd fd;
+            fd.fd = m_id;
+            fd.events = 0;
+            fd.revents = 0;
+            if( ::poll( &fd, 1, -1 ) < 0 && errno != EINTR ) return( false );
+            if( fd.revents & ( POLLHUP | POLLNVAL ) ) return( false );
+            continue;
+        }
+
+        for( struct cmsghdr* c = CMSG_FIRSTHDR( &msg ); c; c = CMSG_NXTHDR( &msg, c ) )
+        {
+            const bool recverr =
+                ( c->cmsg_level == SOL_IP && c->cmsg_type == IP_RECVERR ) ||
+                ( c->cmsg_level == SOL_IPV6 && c->cmsg_type == IPV6_RECVERR );
+            if( !recverr ) continue;
+
+            const struct sock_extended_err* error = reinterpret_cast<const struct sock_extended_err*>( CMSG_DATA( c ) );
+            if( error->ee_errno == 0 && error->ee_origin == SO_EE_ORIGIN_ZEROCOPY )
+            {
+                // [ee_info, ee_data] is the range of the completed send IDs.
+                m_zero_copy_completed = error->ee_data + 1;
+            }
+        }
+    }
+#endif
+    return( true );
+}
+
 } // end of namespace kvs
@@ -19,6 +19,8 @@
 #include "SocketAddress.h"
 #include "SocketTimer.h"
 #include "MessageBlock.h"
+#include <string>
+#include <kvs/Type>
 
 
 namespace kvs
@@ -27,6 +29,11 @@ namespace kvs
 /*==========================================================================*/
 /**
  *  TCP socket class.
+ *
+ *  The message block is sent by the gather write of the header and the
+ *  message. The messages of the zero-copy threshold size or larger are sent
+ *  by MSG_ZEROCOPY on Linux, where send() waits for the completion so that
+ *  the message can be modified after it returns.
  */
 /*==========================================================================*/
 class TCPSocket : public kvs::Socket
@@ -34,6 +41,10 @@ class TCPSocket : public kvs::Socket
 protected:
 
     bool m_is_connected; ///< check flag for connection
+    size_t m_zero_copy_threshold; ///< min. message size for zero-copy send (0: disabled)
+    int m_zero_copy_state; ///< zero-copy state (0: unknown, 1: enabled, -1: unsupported)
+    kvs::UInt32 m_zero_copy_issued; ///< number of issued zero-copy sends
+    kvs::UInt32 m_zero_copy_completed; ///< number of completed zero-copy sends
 
 public:
 
@@ -50,10 +61,19 @@ public:
     bool complete( const kvs::SocketTimer* timer = 0 );
     int send( const void* message, const int message_size );
     int send( const kvs::MessageBlock& message );
+    int sendFile( const std::string& filename );
     int receive( void* message, const int message_size );
     int receive( kvs::MessageBlock* message );
     int receiveOnce( void* message, const int message_size );
     int receiveLine( std::string& line );
+
+    size_t zeroCopyThreshold() const { return m_zero_copy_threshold; }
+    void setZeroCopyThreshold( const size_t size ) { m_zero_copy_threshold = size; }
+
+private:
+
+    bool enable_zero_copy();
+    bool wait_zero_copy();
 };
 
 } // end of namespace kvs
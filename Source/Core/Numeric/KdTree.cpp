@@ -0,0 +1,317 @@
+/*****************************************************************************/
+/**
+ *  @file   KdTree.cpp
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "KdTree.h"
+#include <algorithm>
+#include <kvs/Math>
+#include <kvs/Value>
+#include <kvs/OpenMP>
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Index comparison by one coordinate of the points.
+ */
+/*===========================================================================*/
+struct AxisLess
+{
+    const kvs::Real32* coords;
+    int axis;
+    AxisLess( const kvs::Real32* c, const int a ): coords( c ), axis( a ) {}
+    bool operator ()( const kvs::UInt32 a, const kvs::UInt32 b ) const
+    {
+        const kvs::Real32 va = coords[ 3 * a + axis ];
+        const kvs::Real32 vb = coords[ 3 * b + axis ];
+        return va < vb || ( va == vb && a < b );
+    }
+};
+
+} // end of namespace
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new empty KdTree class.
+ */
+/*===========================================================================*/
+KdTree::KdTree()
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new KdTree class.
+ *  @param  coords [in] coordinates of the points (x,y,z,x,y,z,...)
+ */
+/*===========================================================================*/
+KdTree::KdTree( const kvs::ValueArray<kvs::Real32>& coords )
+{
+    this->build( coords );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Builds the tree.
+ *  @param  coords [in] coordinates of the points (x,y,z,x,y,z,...)
+ */
+/*===========================================================================*/
+void KdTree::build( const kvs::ValueArray<kvs::Real32>& coords )
+{
+    const size_t npoints = coords.size() / 3;
+    m_indices.allocate( npoints );
+    m_axes.allocate( npoints );
+
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < npoints; i++ )
+    {
+        m_indices[i] = static_cast<kvs::UInt32>( i );
+        m_axes[i] = 0;
+    }
+
+    // The upper levels are split level by level with the ranges of a level
+    // in parallel, until there are enough ranges to keep the threads busy.
+    // Then the remaining subtrees are built in parallel.
+    m_points = coords;
+    std::vector<size_t> bounds( 1, 0 );
+    bounds.push_back( npoints );
+    const size_t nthreads = static_cast<size_t>( kvs::Math::Max( kvs::OpenMP::GetMaxThreads(), 1 ) );
+    while ( bounds.size() - 1 < nthreads * 4 )
+    {
+        bool split = false;
+        std::vector<size_t> next( 1, 0 );
+        const size_t nranges = bounds.size() - 1;
+        KVS_OMP_PARALLEL_FOR( schedule(dynamic) )
+        for ( size_t i = 0; i < nranges; i++ )
+        {
+            this->split_range( bounds[i], bounds[ i + 1 ] );
+        }
+
+        // The split ranges are replaced with the lower half, the median and
+        // the upper half.
+        for ( size_t i = 0; i < nranges; i++ )
+        {
+            const size_t begin = bounds[i];
+            const size_t end = bounds[ i + 1 ];
+            if ( end - begin > LeafSize )
+            {
+                const size_t mid = ( begin + end ) / 2;
+                next.push_back( mid );
+                next.push_back( mid + 1 );
+                split = true;
+            }
+            next.push_back( end );
+        }
+        if ( !split ) { break; }
+
+        bounds.swap( next );
+    }
+
+    const size_t nranges = bounds.size() - 1;
+    KVS_OMP_PARALLEL_FOR( schedule(dynamic) )
+    for ( size_t i = 0; i < nranges; i++ )
+    {
+        this->build_range( bounds[i], bounds[ i + 1 ] );
+    }
+
+    // Reorder the coordinates for the locality of the search.
+    kvs::ValueArray<kvs::Real32> points( npoints * 3 );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < npoints; i++ )
+    {
+        const size_t index = m_indices[i];
+        points[ 3 * i + 0 ] = coords[ 3 * index + 0 ];
+        points[ 3 * i + 1 ] = coords[ 3 * index + 1 ];
+        points[ 3 * i + 2 ] = coords[ 3 * index + 2 ];
+    }
+    m_points = points;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Releases the tree.
+ */
+/*===========================================================================*/
+void KdTree::release()
+{
+    m_points.release();
+    m_indices.release();
+    m_axes.release();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Searches the nearest points.
+ *  @param  point [in] query point
+ *  @param  k [in] max. number of the neighbors (0: unlimited)
+ *  @param  radius [in] search radius (0: unlimited)
+ *  @param  neighbors [out] neighbors sorted by the distance
+ *  @return number of the neighbors
+ */
+/*===========================================================================*/
+size_t KdTree::search(
+    const kvs::Vec3& point,
+    const size_t k,
+    const kvs::Real32 radius,
+    std::vector<Neighbor>& neighbors ) const
+{
+    neighbors.clear();
+    if ( k == 0 && radius <= 0.0f ) { return 0; }
+
+    kvs::Real32 max_distance2 = radius > 0.0f ? radius * radius : kvs::Value<kvs::Real32>::Max();
+    const kvs::Real32 p[3] = { point.x(), point.y(), point.z() };
+    this->search_range( 0, m_indices.size(), p, k, max_distance2, neighbors );
+
+    if ( k > 0 ) { std::sort_heap( neighbors.begin(), neighbors.end() ); }
+    else { std::sort( neighbors.begin(), neighbors.end() ); }
+
+    return neighbors.size();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Builds the subtree of the range serially.
+ *  @param  begin [in] first point of the range
+ *  @param  end [in] end of the range
+ */
+/*===========================================================================*/
+void KdTree::build_range( const size_t begin, const size_t end )
+{
+    if ( end - begin <= LeafSize ) { return; }
+
+    this->split_range( begin, end );
+
+    const size_t mid = ( begin + end ) / 2;
+    this->build_range( begin, mid );
+    this->build_range( mid + 1, end );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Splits the range at the median along the axis of the max. extent.
+ *  @param  begin [in] first point of the range
+ *  @param  end [in] end of the range
+ */
+/*===========================================================================*/
+void KdTree::split_range( const size_t begin, const size_t end )
+{
+    if ( end - begin <= LeafSize ) { return; }
+
+    const kvs::Real32* coords = m_points.data();
+    kvs::Real32 min_coord[3];
+    kvs::Real32 max_coord[3];
+    for ( int a = 0; a < 3; a++ )
+    {
+        min_coord[a] = max_coord[a] = coords[ 3 * m_indices[ begin ] + a ];
+    }
+    for ( size_t i = begin + 1; i < end; i++ )
+    {
+        const kvs::Real32* c = coords + 3 * m_indices[i];
+        for ( int a = 0; a < 3; a++ )
+        {
+            min_coord[a] = kvs::Math::Min( min_coord[a], c[a] );
+            max_coord[a] = kvs::Math::Max( max_coord[a], c[a] );
+        }
+    }
+
+    int axis = 0;
+    for ( int a = 1; a < 3; a++ )
+    {
+        if ( max_coord[a] - min_coord[a] > max_coord[axis] - min_coord[axis] ) { axis = a; }
+    }
+
+    const size_t mid = ( begin + end ) / 2;
+    kvs::UInt32* indices = m_indices.data();
+    std::nth_element( indices + begin, indices + mid, indices + end, ::AxisLess( coords, axis ) );
+    m_axes[ mid ] = static_cast<kvs::UInt8>( axis );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Searches the nearest points in the range.
+ *  @param  begin [in] first point of the range
+ *  @param  end [in] end of the range
+ *  @param  point [in] query point
+ *  @param  k [in] max. number of the neighbors (0: unlimited)
+ *  @param  max_distance2 [in/out] squared distance to accept the points
+ *  @param  neighbors [in/out] neighbors (max. heap if k > 0)
+ */
+/*===========================================================================*/
+void KdTree::search_range(
+    const size_t begin,
+    const size_t end,
+    const kvs::Real32* point,
+    const size_t k,
+    kvs::Real32& max_distance2,
+    std::vector<Neighbor>& neighbors ) const
+{
+    if ( begin >= end ) { return; }
+
+    if ( end - begin <= LeafSize )
+    {
+        for ( size_t i = begin; i < end; i++ )
+        {
+            const kvs::Real32* c = m_points.data() + 3 * i;
+            const kvs::Real32 dx = c[0] - point[0];
+            const kvs::Real32 dy = c[1] - point[1];
+            const kvs::Real32 dz = c[2] - point[2];
+            const kvs::Real32 d2 = dx * dx + dy * dy + dz * dz;
+            if ( d2 > max_distance2 ) { continue; }
+
+            Neighbor neighbor;
+            neighbor.distance2 = d2;
+            neighbor.index = m_indices[i];
+            if ( k == 0 )
+            {
+                neighbors.push_back( neighbor );
+            }
+            else if ( neighbors.size() < k )
+            {
+                neighbors.push_back( neighbor );
+                std::push_heap( neighbors.begin(), neighbors.end() );
+                if ( neighbors.size() == k ) { max_distance2 = kvs::Math::Min( max_distance2, neighbors.front().distance2 ); }
+            }
+            else if ( neighbor < neighbors.front() )
+            {
+                std::pop_heap( neighbors.begin(), neighbors.end() );
+                neighbors.back() = neighbor;
+                std::push_heap( neighbors.begin(), neighbors.end() );
+                max_distance2 = neighbors.front().distance2;
+            }
+        }
+        return;
+    }
+
+    // The median point, then the near side and the far side if it can contain neighbors.
+    const size_t mid = ( begin + end ) / 2;
+    const int axis = m_axes[ mid ];
+    const kvs::Real32 d = point[ axis ] - m_points[ 3 * mid + axis ];
+    this->search_range( mid, mid + 1, point, k, max_distance2, neighbors );
+    if ( d < 0.0f )
+    {
+        this->search_range( begin, mid, point, k, max_distance2, neighbors );
+        if ( d * d <= max_distance2 ) { this->search_range( mid + 1, end, point, k, max_distance2, neighbors ); }
+    }
+    else
+    {
+        this->search_range( mid + 1, end, point, k, max_distance2, neighbors );
+        if ( d * d <= max_distance2 ) { this->search_range( begin, mid, point, k, max_distance2, neighbors ); }
+    }
+}
+
+} // end of namespace kvs
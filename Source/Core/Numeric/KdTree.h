@@ -0,0 +1,93 @@
+/*****************************************************************************/
+/**
+ *  @file   KdTree.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVS__KD_TREE_H_INCLUDE
+#define KVS__KD_TREE_H_INCLUDE
+
+#include <vector>
+#include <kvs/ValueArray>
+#include <kvs/Vector3>
+#include <kvs/Type>
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  K-d tree of 3D points for the nearest neighbor search.
+ *
+ *  The tree is balanced and implicit: the points are reordered so that the
+ *  median of each range [begin,end) is at (begin+end)/2 and splits the range
+ *  along the axis stored for it. Ranges of at most LeafSize points are
+ *  leaves. The tree is built in O(N log N) with the independent ranges of
+ *  each level processed in parallel, and the search is thread-safe.
+ */
+/*===========================================================================*/
+class KdTree
+{
+public:
+
+    /// Neighbor point found by the search.
+    struct Neighbor
+    {
+        kvs::Real32 distance2; ///< squared distance to the query point
+        kvs::UInt32 index; ///< index of the point in the original array
+
+        bool operator <( const Neighbor& other ) const
+        {
+            return distance2 < other.distance2 || ( distance2 == other.distance2 && index < other.index );
+        }
+    };
+
+    enum { LeafSize = 8 };
+
+private:
+
+    kvs::ValueArray<kvs::Real32> m_points; ///< reordered coordinates (x,y,z,...)
+    kvs::ValueArray<kvs::UInt32> m_indices; ///< original index of each reordered point
+    kvs::ValueArray<kvs::UInt8> m_axes; ///< split axis of the range whose median is the point
+
+public:
+
+    KdTree();
+    KdTree( const kvs::ValueArray<kvs::Real32>& coords );
+
+    size_t numberOfPoints() const { return m_indices.size(); }
+    bool isEmpty() const { return m_indices.size() == 0; }
+
+    void build( const kvs::ValueArray<kvs::Real32>& coords );
+    void release();
+
+    size_t search(
+        const kvs::Vec3& point,
+        const size_t k,
+        const kvs::Real32 radius,
+        std::vector<Neighbor>& neighbors ) const;
+
+private:
+
+    void build_range( const size_t begin, const size_t end );
+    void split_range( const size_t begin, const size_t end );
+    void search_range(
+        const size_t begin,
+        const size_t end,
+        const kvs::Real32* point,
+        const size_t k,
+        kvs::Real32& max_distance2,
+        std::vector<Neighbor>& neighbors ) const;
+};
+
+} // end of namespace kvs
+
+#endif // KVS__KD_TREE_H_INCLUDE
@@ -0,0 +1,710 @@
+/*****************************************************************************/
+/**
+ *  @file   ValueStatistics.cpp
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "ValueStatistics.h"
+#include <cmath>
+#include <algorithm>
+#include <kvs/Math>
+#include <kvs/Value>
+#include <kvs/OpenMP>
+#include <kvs/TypeDispatch>
+
+
+namespace
+{
+
+/// Number of tuples processed by a thread at once.
+const size_t BlockSize = 16384;
+
+/// Number of lanes of the independent accumulators in the min/max loops.
+const size_t Lanes = 8;
+
+/// Number of bins of a refinement pass in the percentile search.
+const size_t RefinementBins = 1024;
+
+/// Number of candidates which are sorted directly in the percentile search.
+const size_t GatherSize = 4096;
+
+inline size_t NumberOfBlocks( const size_t nvalues )
+{
+    return ( nvalues + BlockSize - 1 ) / BlockSize;
+}
+
+inline size_t BlockEnd( const size_t block, const size_t nvalues )
+{
+    return kvs::Math::Min( ( block + 1 ) * BlockSize, nvalues );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the value used for the statistics (value or magnitude).
+ */
+/*===========================================================================*/
+template <typename T>
+inline kvs::Real64 Operand( const T* values, const size_t index, const size_t veclen )
+{
+    if ( veclen == 1 ) { return kvs::Real64( values[index] ); }
+
+    const T* tuple = values + index * veclen;
+    kvs::Real64 sum = 0.0;
+    for ( size_t i = 0; i < veclen; ++i )
+    {
+        const kvs::Real64 value = kvs::Real64( tuple[i] );
+        sum += value * value;
+    }
+    return std::sqrt( sum );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the bin index of the value (clamped to [0, last]).
+ */
+/*===========================================================================*/
+inline size_t BinIndex(
+    const kvs::Real64 value,
+    const kvs::Real64 min_value,
+    const kvs::Real64 bin_width,
+    const size_t last )
+{
+    const kvs::Real64 t = ( value - min_value ) / bin_width;
+    return !( t > 0.0 ) ? 0 : t >= kvs::Real64( last ) ? last : static_cast<size_t>( t );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Updates the min/max values of the scalar values in [begin, end).
+ */
+/*===========================================================================*/
+template <typename T>
+inline void ScalarMinMax( const T* values, const size_t begin, const size_t end, T& min_value, T& max_value )
+{
+    // Independent accumulators per lane so that the loop is vectorized.
+    T lane_min[Lanes];
+    T lane_max[Lanes];
+    for ( size_t k = 0; k < Lanes; ++k ) { lane_min[k] = min_value; lane_max[k] = max_value; }
+
+    size_t i = begin;
+    for ( ; i + Lanes <= end; i += Lanes )
+    {
+        for ( size_t k = 0; k < Lanes; ++k )
+        {
+            const T value = values[ i + k ];
+            lane_min[k] = value < lane_min[k] ? value : lane_min[k];
+            lane_max[k] = value > lane_max[k] ? value : lane_max[k];
+        }
+    }
+    for ( ; i < end; ++i )
+    {
+        const T value = values[i];
+        lane_min[0] = value < lane_min[0] ? value : lane_min[0];
+        lane_max[0] = value > lane_max[0] ? value : lane_max[0];
+    }
+
+    for ( size_t k = 0; k < Lanes; ++k )
+    {
+        min_value = lane_min[k] < min_value ? lane_min[k] : min_value;
+        max_value = lane_max[k] > max_value ? lane_max[k] : max_value;
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Updates the min/max squared magnitudes of the tuples in [begin, end).
+ */
+/*===========================================================================*/
+template <typename T>
+inline void SquaredMagnitudeMinMax(
+    const T* values,
+    const size_t begin,
+    const size_t end,
+    const size_t veclen,
+    kvs::Real64& min_value,
+    kvs::Real64& max_value )
+{
+    for ( size_t i = begin; i < end; ++i )
+    {
+        const T* tuple = values + i * veclen;
+        kvs::Real64 sum = 0.0;
+        for ( size_t j = 0; j < veclen; ++j )
+        {
+            const kvs::Real64 value = kvs::Real64( tuple[j] );
+            sum += value * value;
+        }
+        min_value = sum < min_value ? sum : min_value;
+        max_value = sum > max_value ? sum : max_value;
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Ignore value list tested only for the bins that may contain them.
+ */
+/*===========================================================================*/
+class IgnoreValueFilter
+{
+private:
+    std::vector<kvs::Real64> m_values; ///< ignore values
+    std::vector<unsigned char> m_suspects; ///< flags for the bins that may contain an ignore value
+
+public:
+    IgnoreValueFilter(
+        const std::vector<kvs::Real64>& values,
+        const kvs::Real64 min_value,
+        const kvs::Real64 bin_width,
+        const size_t nbins ):
+        m_values( values )
+    {
+        if ( m_values.empty() ) { return; }
+
+        // Equality is tested with the tolerance of kvs::Math::Equal.
+        const size_t last = nbins - 1;
+        m_suspects.resize( nbins, 0 );
+        for ( size_t i = 0; i < m_values.size(); ++i )
+        {
+            const size_t lower = ::BinIndex( m_values[i] - KVS__MATH_TINY_VALUE, min_value, bin_width, last );
+            const size_t upper = ::BinIndex( m_values[i] + KVS__MATH_TINY_VALUE, min_value, bin_width, last );
+            for ( size_t j = lower; j <= upper; ++j ) { m_suspects[j] = 1; }
+        }
+    }
+
+    bool isEmpty() const
+    {
+        return m_values.empty();
+    }
+
+    bool test( const size_t index, const kvs::Real64 value ) const
+    {
+        if ( !m_suspects[index] ) { return false; }
+        for ( size_t i = 0; i < m_values.size(); ++i )
+        {
+            if ( kvs::Math::Equal( value, m_values[i] ) ) { return true; }
+        }
+        return false;
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Bin selected by a refinement pass of the percentile search.
+ */
+/*===========================================================================*/
+struct RefinementPass
+{
+    kvs::Real64 min_value; ///< min. value of the pass
+    kvs::Real64 bin_width; ///< bin width of the pass
+    size_t bin; ///< selected bin
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if the value falls in the selected bins of all of the passes.
+ */
+/*===========================================================================*/
+inline bool IsCandidate( const kvs::Real64 value, const std::vector<RefinementPass>& passes )
+{
+    for ( size_t i = 0; i < passes.size(); ++i )
+    {
+        const RefinementPass& pass = passes[i];
+        if ( ::BinIndex( value, pass.min_value, pass.bin_width, RefinementBins - 1 ) != pass.bin ) { return false; }
+    }
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Functors for the AnyValueArray versions.
+ */
+/*===========================================================================*/
+struct MinMaxInvoker
+{
+    size_t nvalues;
+    size_t veclen;
+    kvs::Range range;
+    MinMaxInvoker( const size_t n, const size_t v ): nvalues( n ), veclen( v ) {}
+    template <typename T> void operator ()( const T* values ) { range = kvs::ValueStatistics::MinMax( values, nvalues, veclen ); }
+};
+
+struct HistogramInvoker
+{
+    size_t nvalues;
+    size_t veclen;
+    kvs::Real64 min_value;
+    kvs::Real64 bin_width;
+    size_t nbins;
+    size_t* bins;
+    const std::vector<kvs::Real64>& ignore_values;
+    size_t counts;
+    HistogramInvoker(
+        const size_t n,
+        const size_t v,
+        const kvs::Real64 min,
+        const kvs::Real64 width,
+        const size_t nb,
+        size_t* b,
+        const std::vector<kvs::Real64>& ignores ):
+        nvalues( n ), veclen( v ), min_value( min ), bin_width( width ), nbins( nb ), bins( b ), ignore_values( ignores ), counts( 0 ) {}
+    template <typename T> void operator ()( const T* values )
+    {
+        counts = kvs::ValueStatistics::Histogram( values, nvalues, veclen, min_value, bin_width, nbins, bins, ignore_values );
+    }
+};
+
+struct MeanVarianceInvoker
+{
+    size_t nvalues;
+    size_t veclen;
+    kvs::Real64 mean;
+    kvs::Real64 variance;
+    MeanVarianceInvoker( const size_t n, const size_t v ): nvalues( n ), veclen( v ), mean( 0 ), variance( 0 ) {}
+    template <typename T> void operator ()( const T* values ) { kvs::ValueStatistics::MeanVariance( values, nvalues, veclen, mean, variance ); }
+};
+
+struct PercentileInvoker
+{
+    size_t nvalues;
+    size_t veclen;
+    kvs::Real64 percent;
+    kvs::Real64 value;
+    PercentileInvoker( const size_t n, const size_t v, const kvs::Real64 p ): nvalues( n ), veclen( v ), percent( p ), value( 0 ) {}
+    template <typename T> void operator ()( const T* values ) { value = kvs::ValueStatistics::Percentile( values, nvalues, veclen, percent ); }
+};
+
+} // end of namespace
+
+
+namespace kvs
+{
+
+namespace ValueStatistics
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the min/max values (or magnitudes for veclen > 1).
+ *  @param  values [in] pointer to the values
+ *  @param  nvalues [in] number of tuples
+ *  @param  veclen [in] number of components of a tuple
+ *  @return value range (kvs::Range() for an empty array)
+ */
+/*===========================================================================*/
+template <typename T>
+kvs::Range MinMax( const T* values, const size_t nvalues, const size_t veclen )
+{
+    if ( nvalues == 0 ) { return kvs::Range(); }
+
+    const size_t nblocks = ::NumberOfBlocks( nvalues );
+    if ( veclen == 1 )
+    {
+        T min_value = values[0];
+        T max_value = values[0];
+        KVS_OMP_PARALLEL()
+        {
+            T local_min = values[0];
+            T local_max = values[0];
+            KVS_OMP_FOR( schedule(static) )
+            for ( size_t b = 0; b < nblocks; ++b )
+            {
+                ::ScalarMinMax( values, b * ::BlockSize, ::BlockEnd( b, nvalues ), local_min, local_max );
+            }
+
+            KVS_OMP_CRITICAL()
+            {
+                min_value = kvs::Math::Min( min_value, local_min );
+                max_value = kvs::Math::Max( max_value, local_max );
+            }
+        }
+        return kvs::Range( static_cast<double>( min_value ), static_cast<double>( max_value ) );
+    }
+
+    kvs::Real64 min_value = kvs::Value<kvs::Real64>::Max();
+    kvs::Real64 max_value = 0.0;
+    KVS_OMP_PARALLEL()
+    {
+        kvs::Real64 local_min = kvs::Value<kvs::Real64>::Max();
+        kvs::Real64 local_max = 0.0;
+        KVS_OMP_FOR( schedule(static) )
+        for ( size_t b = 0; b < nblocks; ++b )
+        {
+            ::SquaredMagnitudeMinMax( values, b * ::BlockSize, ::BlockEnd( b, nvalues ), veclen, local_min, local_max );
+        }
+
+        KVS_OMP_CRITICAL()
+        {
+            min_value = kvs::Math::Min( min_value, local_min );
+            max_value = kvs::Math::Max( max_value, local_max );
+        }
+    }
+    return kvs::Range( std::sqrt( min_value ), std::sqrt( max_value ) );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the min/max values of the array.
+ *  @param  values [in] value array
+ *  @param  veclen [in] number of components of a tuple
+ *  @return value range
+ */
+/*===========================================================================*/
+kvs::Range MinMax( const kvs::AnyValueArray& values, const size_t veclen )
+{
+    ::MinMaxInvoker invoker( veclen > 0 ? values.size() / veclen : 0, veclen );
+    kvs::DispatchValues( values, invoker );
+    return invoker.range;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Accumulates the histogram of the values.
+ *  @param  values [in] pointer to the values
+ *  @param  nvalues [in] number of tuples
+ *  @param  veclen [in] number of components of a tuple
+ *  @param  min_value [in] lower bound of the first bin
+ *  @param  bin_width [in] width of the bins
+ *  @param  nbins [in] number of bins
+ *  @param  bins [in/out] bin array (the counts are added to it)
+ *  @param  ignore_values [in] values which are not counted
+ *  @return number of counted values
+ *
+ *  The bin index is floor( ( value - min_value ) / bin_width ) clamped to
+ *  [0, nbins - 1]. The ignore values are compared with kvs::Math::Equal only
+ *  for the values that fall in the bins which may contain them.
+ */
+/*===========================================================================*/
+template <typename T>
+size_t Histogram(
+    const T* values,
+    const size_t nvalues,
+    const size_t veclen,
+    const kvs::Real64 min_value,
+    const kvs::Real64 bin_width,
+    const size_t nbins,
+    size_t* bins,
+    const std::vector<kvs::Real64>& ignore_values )
+{
+    if ( nvalues == 0 || nbins == 0 ) { return 0; }
+
+    const size_t last = nbins - 1;
+    const size_t nblocks = ::NumberOfBlocks( nvalues );
+    const ::IgnoreValueFilter filter( ignore_values, min_value, bin_width, nbins );
+    const bool has_ignore_values = !filter.isEmpty();
+
+    size_t counts = 0;
+    KVS_OMP_PARALLEL()
+    {
+        std::vector<size_t> local_bins( nbins, 0 );
+        size_t local_counts = 0;
+
+        // Bin indices are computed for a block first (vectorizable), then scattered.
+        std::vector<size_t> indices( ::BlockSize );
+        std::vector<kvs::Real64> operands( ::BlockSize );
+
+        KVS_OMP_FOR( schedule(static) )
+        for ( size_t b = 0; b < nblocks; ++b )
+        {
+            const size_t begin = b * ::BlockSize;
+            const size_t size = ::BlockEnd( b, nvalues ) - begin;
+            for ( size_t i = 0; i < size; ++i )
+            {
+                operands[i] = ::Operand( values, begin + i, veclen );
+            }
+            for ( size_t i = 0; i < size; ++i )
+            {
+                indices[i] = ::BinIndex( operands[i], min_value, bin_width, last );
+            }
+
+            if ( has_ignore_values )
+            {
+                for ( size_t i = 0; i < size; ++i )
+                {
+                    if ( filter.test( indices[i], operands[i] ) ) { continue; }
+                    local_bins[ indices[i] ]++;
+                    local_counts++;
+                }
+            }
+            else
+            {
+                for ( size_t i = 0; i < size; ++i ) { local_bins[ indices[i] ]++; }
+                local_counts += size;
+            }
+        }
+
+        KVS_OMP_CRITICAL()
+        {
+            for ( size_t i = 0; i < nbins; ++i ) { bins[i] += local_bins[i]; }
+            counts += local_counts;
+        }
+    }
+
+    return counts;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Accumulates the histogram of the array.
+ *  @param  values [in] value array
+ *  @param  veclen [in] number of components of a tuple
+ *  @param  min_value [in] lower bound of the first bin
+ *  @param  bin_width [in] width of the bins
+ *  @param  nbins [in] number of bins
+ *  @param  bins [in/out] bin array (the counts are added to it)
+ *  @param  ignore_values [in] values which are not counted
+ *  @return number of counted values
+ */
+/*===========================================================================*/
+size_t Histogram(
+    const kvs::AnyValueArray& values,
+    const size_t veclen,
+    const kvs::Real64 min_value,
+    const kvs::Real64 bin_width,
+    const size_t nbins,
+    size_t* bins,
+    const std::vector<kvs::Real64>& ignore_values )
+{
+    const size_t nvalues = veclen > 0 ? values.size() / veclen : 0;
+    ::HistogramInvoker invoker( nvalues, veclen, min_value, bin_width, nbins, bins, ignore_values );
+    kvs::DispatchValues( values, invoker );
+    return invoker.counts;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the mean and the (population) variance of the values.
+ *  @param  values [in] pointer to the values
+ *  @param  nvalues [in] number of tuples
+ *  @param  veclen [in] number of components of a tuple
+ *  @param  mean [out] mean value
+ *  @param  variance [out] variance
+ */
+/*===========================================================================*/
+template <typename T>
+void MeanVariance(
+    const T* values,
+    const size_t nvalues,
+    const size_t veclen,
+    kvs::Real64& mean,
+    kvs::Real64& variance )
+{
+    mean = 0.0;
+    variance = 0.0;
+    if ( nvalues == 0 ) { return; }
+
+    // The sums are taken around the first value to reduce the cancellation.
+    const kvs::Real64 shift = ::Operand( values, 0, veclen );
+    const size_t nblocks = ::NumberOfBlocks( nvalues );
+
+    kvs::Real64 sum = 0.0;
+    kvs::Real64 square_sum = 0.0;
+    KVS_OMP_PARALLEL()
+    {
+        kvs::Real64 local_sum = 0.0;
+        kvs::Real64 local_square_sum = 0.0;
+        KVS_OMP_FOR( schedule(static) )
+        for ( size_t b = 0; b < nblocks; ++b )
+        {
+            const size_t end = ::BlockEnd( b, nvalues );
+            for ( size_t i = b * ::BlockSize; i < end; ++i )
+            {
+                const kvs::Real64 d = ::Operand( values, i, veclen ) - shift;
+                local_sum += d;
+                local_square_sum += d * d;
+            }
+        }
+
+        KVS_OMP_CRITICAL()
+        {
+            sum += local_sum;
+            square_sum += local_square_sum;
+        }
+    }
+
+    const kvs::Real64 n = static_cast<kvs::Real64>( nvalues );
+    mean = shift + sum / n;
+    variance = kvs::Math::Max( ( square_sum - sum * sum / n ) / n, 0.0 );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the mean and the (population) variance of the array.
+ *  @param  values [in] value array
+ *  @param  veclen [in] number of components of a tuple
+ *  @param  mean [out] mean value
+ *  @param  variance [out] variance
+ */
+/*===========================================================================*/
+void MeanVariance(
+    const kvs::AnyValueArray& values,
+    const size_t veclen,
+    kvs::Real64& mean,
+    kvs::Real64& variance )
+{
+    ::MeanVarianceInvoker invoker( veclen > 0 ? values.size() / veclen : 0, veclen );
+    kvs::DispatchValues( values, invoker );
+    mean = invoker.mean;
+    variance = invoker.variance;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the percentile of the values.
+ *  @param  values [in] pointer to the values
+ *  @param  nvalues [in] number of tuples
+ *  @param  veclen [in] number of components of a tuple
+ *  @param  percent [in] percentage in [0, 100]
+ *  @return value of the nearest rank
+ *
+ *  The value range is repeatedly divided into histogram bins and narrowed to
+ *  the bin containing the rank, until the remaining candidates are few enough
+ *  to be selected directly. The result is exact, not interpolated.
+ */
+/*===========================================================================*/
+template <typename T>
+kvs::Real64 Percentile( const T* values, const size_t nvalues, const size_t veclen, const kvs::Real64 percent )
+{
+    if ( nvalues == 0 ) { return 0.0; }
+
+    const kvs::Real64 p = kvs::Math::Clamp( percent, 0.0, 100.0 );
+    const size_t rank = static_cast<size_t>( p / 100.0 * kvs::Real64( nvalues - 1 ) + 0.5 );
+    const size_t nblocks = ::NumberOfBlocks( nvalues );
+
+    const kvs::Range range = MinMax( values, nvalues, veclen );
+    kvs::Real64 lower = range.lower();
+    kvs::Real64 upper = range.upper();
+
+    std::vector< ::RefinementPass> passes;
+    size_t below = 0; // number of values ranked below the candidates
+    for ( ; ; )
+    {
+        if ( !( lower < upper ) ) { return lower; }
+
+        ::RefinementPass pass;
+        pass.min_value = lower;
+        pass.bin_width = ( upper - lower ) / kvs::Real64( ::RefinementBins );
+
+        std::vector<size_t> counts( ::RefinementBins, 0 );
+        std::vector<kvs::Real64> bin_min( ::RefinementBins, kvs::Value<kvs::Real64>::Max() );
+        std::vector<kvs::Real64> bin_max( ::RefinementBins, -kvs::Value<kvs::Real64>::Max() );
+        KVS_OMP_PARALLEL()
+        {
+            std::vector<size_t> local_counts( ::RefinementBins, 0 );
+            std::vector<kvs::Real64> local_min( ::RefinementBins, kvs::Value<kvs::Real64>::Max() );
+            std::vector<kvs::Real64> local_max( ::RefinementBins, -kvs::Value<kvs::Real64>::Max() );
+            KVS_OMP_FOR( schedule(static) )
+            for ( size_t b = 0; b < nblocks; ++b )
+            {
+                const size_t end = ::BlockEnd( b, nvalues );
+                for ( size_t i = b * ::BlockSize; i < end; ++i )
+                {
+                    const kvs::Real64 value = ::Operand( values, i, veclen );
+                    if ( !::IsCandidate( value, passes ) ) { continue; }
+
+                    const size_t index = ::BinIndex( value, pass.min_value, pass.bin_width, ::RefinementBins - 1 );
+                    local_counts[index]++;
+                    local_min[index] = kvs::Math::Min( local_min[index], value );
+                    local_max[index] = kvs::Math::Max( local_max[index], value );
+                }
+            }
+
+            KVS_OMP_CRITICAL()
+            {
+                for ( size_t i = 0; i < ::RefinementBins; ++i )
+                {
+                    counts[i] += local_counts[i];
+                    bin_min[i] = kvs::Math::Min( bin_min[i], local_min[i] );
+                    bin_max[i] = kvs::Math::Max( bin_max[i], local_max[i] );
+                }
+            }
+        }
+
+        // Select the bin containing the rank.
+        pass.bin = 0;
+        while ( pass.bin < ::RefinementBins - 1 && below + counts[ pass.bin ] <= rank )
+        {
+            below += counts[ pass.bin++ ];
+        }
+        passes.push_back( pass );
+
+        lower = bin_min[ pass.bin ];
+        upper = bin_max[ pass.bin ];
+        if ( !( lower < upper ) ) { return lower; }
+        if ( counts[ pass.bin ] <= ::GatherSize ) { break; }
+    }
+
+    // Select the rank from the remaining candidates.
+    std::vector<kvs::Real64> candidates;
+    KVS_OMP_PARALLEL()
+    {
+        std::vector<kvs::Real64> local_candidates;
+        KVS_OMP_FOR( schedule(static) )
+        for ( size_t b = 0; b < nblocks; ++b )
+        {
+            const size_t end = ::BlockEnd( b, nvalues );
+            for ( size_t i = b * ::BlockSize; i < end; ++i )
+            {
+                const kvs::Real64 value = ::Operand( values, i, veclen );
+                if ( ::IsCandidate( value, passes ) ) { local_candidates.push_back( value ); }
+            }
+        }
+
+        KVS_OMP_CRITICAL()
+        {
+            candidates.insert( candidates.end(), local_candidates.begin(), local_candidates.end() );
+        }
+    }
+
+    const size_t nth = kvs::Math::Min( rank - below, candidates.size() - 1 );
+    std::nth_element( candidates.begin(), candidates.begin() + nth, candidates.end() );
+    return candidates[ nth ];
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the percentile of the array.
+ *  @param  values [in] value array
+ *  @param  veclen [in] number of components of a tuple
+ *  @param  percent [in] percentage in [0, 100]
+ *  @return value of the nearest rank
+ */
+/*===========================================================================*/
+kvs::Real64 Percentile( const kvs::AnyValueArray& values, const size_t veclen, const kvs::Real64 percent )
+{
+    ::PercentileInvoker invoker( veclen > 0 ? values.size() / veclen : 0, veclen, percent );
+    kvs::DispatchValues( values, invoker );
+    return invoker.value;
+}
+
+#define KVS_VALUE_STATISTICS_INSTANTIATE( T )                           \
+    template kvs::Range MinMax<T>( const T*, const size_t, const size_t ); \
+    template size_t Histogram<T>(                                       \
+        const T*, const size_t, const size_t,                           \
+        const kvs::Real64, const kvs::Real64, const size_t, size_t*,    \
+        const std::vector<kvs::Real64>& );                              \
+    template void MeanVariance<T>(                                      \
+        const T*, const size_t, const size_t, kvs::Real64&, kvs::Real64& ); \
+    template kvs::Real64 Percentile<T>( const T*, const size_t, const size_t, const kvs::Real64 )
+
+KVS_VALUE_STATISTICS_INSTANTIATE( kvs::Int8   );
+KVS_VALUE_STATISTICS_INSTANTIATE( kvs::Int16  );
+KVS_VALUE_STATISTICS_INSTANTIATE( kvs::Int32  );
+KVS_VALUE_STATISTICS_INSTANTIATE( kvs::Int64  );
+KVS_VALUE_STATISTICS_INSTANTIATE( kvs::UInt8  );
+KVS_VALUE_STATISTICS_INSTANTIATE( kvs::UInt16 );
+KVS_VALUE_STATISTICS_INSTANTIATE( kvs::UInt32 );
+KVS_VALUE_STATISTICS_INSTANTIATE( kvs::UInt64 );
+KVS_VALUE_STATISTICS_INSTANTIATE( kvs::Real32 );
+KVS_VALUE_STATISTICS_INSTANTIATE( kvs::Real64 );
+
+#undef KVS_VALUE_STATISTICS_INSTANTIATE
+
+} // end of namespace ValueStatistics
+
+} // end of namespace kvs
@@ -0,0 +1,85 @@
+/*****************************************************************************/
+/**
+ *  @file   ValueStatistics.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVS__VALUE_STATISTICS_H_INCLUDE
+#define KVS__VALUE_STATISTICS_H_INCLUDE
+
+#include <cstddef>
+#include <vector>
+#include <kvs/Type>
+#include <kvs/Range>
+#include <kvs/AnyValueArray>
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Statistics kernels for the value arrays.
+ *
+ *  The kernels take 'nvalues' tuples of 'veclen' components. For veclen = 1
+ *  the values themselves are used, otherwise the magnitudes of the tuples.
+ *  Each kernel is a single pass over the array, split into blocks that are
+ *  processed by the OpenMP threads (if enabled) with per-thread partial
+ *  results, and the inner loops are written to be auto-vectorized.
+ */
+/*===========================================================================*/
+namespace ValueStatistics
+{
+
+template <typename T>
+kvs::Range MinMax( const T* values, const size_t nvalues, const size_t veclen = 1 );
+kvs::Range MinMax( const kvs::AnyValueArray& values, const size_t veclen = 1 );
+
+template <typename T>
+size_t Histogram(
+    const T* values,
+    const size_t nvalues,
+    const size_t veclen,
+    const kvs::Real64 min_value,
+    const kvs::Real64 bin_width,
+    const size_t nbins,
+    size_t* bins,
+    const std::vector<kvs::Real64>& ignore_values = std::vector<kvs::Real64>() );
+size_t Histogram(
+    const kvs::AnyValueArray& values,
+    const size_t veclen,
+    const kvs::Real64 min_value,
+    const kvs::Real64 bin_width,
+    const size_t nbins,
+    size_t* bins,
+    const std::vector<kvs::Real64>& ignore_values = std::vector<kvs::Real64>() );
+
+template <typename T>
+void MeanVariance(
+    const T* values,
+    const size_t nvalues,
+    const size_t veclen,
+    kvs::Real64& mean,
+    kvs::Real64& variance );
+void MeanVariance(
+    const kvs::AnyValueArray& values,
+    const size_t veclen,
+    kvs::Real64& mean,
+    kvs::Real64& variance );
+
+template <typename T>
+kvs::Real64 Percentile( const T* values, const size_t nvalues, const size_t veclen, const kvs::Real64 percent );
+kvs::Real64 Percentile( const kvs::AnyValueArray& values, const size_t veclen, const kvs::Real64 percent );
+
+} // end of namespace ValueStatistics
+
+} // end of namespace kvs
+
+#endif // KVS__VALUE_STATISTICS_H_INCLUDE
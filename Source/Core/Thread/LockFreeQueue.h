@@ -0,0 +1,239 @@
+/*****************************************************************************/
+/**
+ *  @file   LockFreeQueue.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVS__LOCK_FREE_QUEUE_H_INCLUDE
+#define KVS__LOCK_FREE_QUEUE_H_INCLUDE
+
+#include <vector>
+#include <cstddef>
+#include <kvs/Compiler>
+
+#if defined ( KVS_COMPILER_VC )
+#include <intrin.h>
+#endif
+
+
+namespace kvs
+{
+
+namespace detail
+{
+
+namespace lock_free_queue
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Loads the value with the acquire semantics.
+ *  @param  p [in] pointer to the value
+ *  @return value
+ */
+/*===========================================================================*/
+inline long Load( volatile long* p )
+{
+#if defined ( KVS_COMPILER_VC )
+    return _InterlockedCompareExchange( p, 0, 0 );
+#else
+    const long value = *p;
+    __sync_synchronize();
+    return value;
+#endif
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Stores the value with the release semantics.
+ *  @param  p [in] pointer to the value
+ *  @param  value [in] value
+ */
+/*===========================================================================*/
+inline void Store( volatile long* p, const long value )
+{
+#if defined ( KVS_COMPILER_VC )
+    _InterlockedExchange( p, value );
+#else
+    __sync_synchronize();
+    *p = value;
+#endif
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Replaces the value if it is equal to the expected one.
+ *  @param  p [in] pointer to the value
+ *  @param  expected [in] expected value
+ *  @param  desired [in] new value
+ *  @return true, if the value is replaced
+ */
+/*===========================================================================*/
+inline bool CompareAndSwap( volatile long* p, const long expected, const long desired )
+{
+#if defined ( KVS_COMPILER_VC )
+    return _InterlockedCompareExchange( p, desired, expected ) == expected;
+#else
+    return __sync_bool_compare_and_swap( p, expected, desired );
+#endif
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the signed difference of the sequence numbers.
+ *  @param  a [in] sequence number
+ *  @param  b [in] sequence number
+ *  @return a - b (wrapped around)
+ */
+/*===========================================================================*/
+inline long Difference( const long a, const long b )
+{
+    return static_cast<long>( static_cast<unsigned long>( a ) - static_cast<unsigned long>( b ) );
+}
+
+} // end of namespace lock_free_queue
+
+} // end of namespace detail
+
+/*===========================================================================*/
+/**
+ *  @brief  Bounded lock-free queue for the multiple producers and consumers.
+ *
+ *  Each cell of the ring buffer has the sequence number, by which the
+ *  producers and the consumers claim the cells with the compare-and-swap of
+ *  the positions and publish the values without any locks. push() and pop()
+ *  never block, and fail if the queue is full or empty. T must be
+ *  assignable, and the popped cells keep the copies of the values until
+ *  they are overwritten (use pointers or small structures).
+ */
+/*===========================================================================*/
+template <typename T>
+class LockFreeQueue
+{
+private:
+
+    struct Cell
+    {
+        volatile long sequence; ///< sequence number
+        T value; ///< value
+    };
+
+    enum { PaddingSize = 64 }; ///< size of the cache line
+
+    std::vector<Cell> m_cells; ///< ring buffer
+    size_t m_mask; ///< capacity - 1
+    char m_padding0[ PaddingSize ]; ///< padding to separate the positions
+    volatile long m_enqueue_position; ///< position of the next push
+    char m_padding1[ PaddingSize ]; ///< padding to separate the positions
+    volatile long m_dequeue_position; ///< position of the next pop
+    char m_padding2[ PaddingSize ]; ///< padding to separate the positions
+
+public:
+
+    LockFreeQueue( const size_t capacity );
+
+    size_t capacity() const { return m_cells.size(); }
+    bool push( const T& value );
+    bool pop( T* value );
+
+private:
+
+    LockFreeQueue( const LockFreeQueue& );
+    LockFreeQueue& operator =( const LockFreeQueue& );
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new LockFreeQueue class.
+ *  @param  capacity [in] capacity (rounded up to the power of two)
+ */
+/*===========================================================================*/
+template <typename T>
+inline LockFreeQueue<T>::LockFreeQueue( const size_t capacity ):
+    m_enqueue_position( 0 ),
+    m_dequeue_position( 0 )
+{
+    size_t size = 2;
+    while ( size < capacity ) { size <<= 1; }
+
+    m_cells.resize( size );
+    m_mask = size - 1;
+    for ( size_t i = 0; i < size; i++ ) { m_cells[i].sequence = static_cast<long>( i ); }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Pushes the value to the queue.
+ *  @param  value [in] value
+ *  @return true, if the value is pushed (false, if the queue is full)
+ */
+/*===========================================================================*/
+template <typename T>
+inline bool LockFreeQueue<T>::push( const T& value )
+{
+    namespace impl = kvs::detail::lock_free_queue;
+    for ( ;; )
+    {
+        const long position = impl::Load( &m_enqueue_position );
+        Cell& cell = m_cells[ static_cast<size_t>( position ) & m_mask ];
+        const long difference = impl::Difference( impl::Load( &cell.sequence ), position );
+        if ( difference == 0 )
+        {
+            if ( impl::CompareAndSwap( &m_enqueue_position, position, position + 1 ) )
+            {
+                cell.value = value;
+                impl::Store( &cell.sequence, position + 1 );
+                return true;
+            }
+        }
+        else if ( difference < 0 )
+        {
+            // The cell has not been popped since the previous round.
+            return false;
+        }
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Pops the value from the queue.
+ *  @param  value [out] pointer to the value
+ *  @return true, if the value is popped (false, if the queue is empty)
+ */
+/*===========================================================================*/
+template <typename T>
+inline bool LockFreeQueue<T>::pop( T* value )
+{
+    namespace impl = kvs::detail::lock_free_queue;
+    for ( ;; )
+    {
+        const long position = impl::Load( &m_dequeue_position );
+        Cell& cell = m_cells[ static_cast<size_t>( position ) & m_mask ];
+        const long difference = impl::Difference( impl::Load( &cell.sequence ), position + 1 );
+        if ( difference == 0 )
+        {
+            if ( impl::CompareAndSwap( &m_dequeue_position, position, position + 1 ) )
+            {
+                *value = cell.value;
+                impl::Store( &cell.sequence, position + static_cast<long>( m_mask ) + 1 );
+                return true;
+            }
+        }
+        else if ( difference < 0 )
+        {
+            // The cell has not been pushed yet.
+            return false;
+        }
+    }
+}
+
+} // end of namespace kvs
+
+#endif // KVS__LOCK_FREE_QUEUE_H_INCLUDE
@@ -0,0 +1,157 @@
+/*****************************************************************************/
+/**
+ *  @file   AlignedAllocator.cpp
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "AlignedAllocator.h"
+#include <new>
+#include <cstdlib>
+#include <kvs/Assert>
+#include <kvs/Platform>
+#if defined ( KVS_PLATFORM_WINDOWS )
+#include <malloc.h>
+#else
+#include <stdlib.h>
+#endif
+#if defined ( KVS_PLATFORM_LINUX )
+#include <sys/mman.h>
+#endif
+
+
+namespace
+{
+
+inline size_t RoundUp( const size_t size, const size_t unit )
+{
+    return ( size + unit - 1 ) / unit * unit;
+}
+
+} // end of namespace
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the byte size of a huge page assumed by the allocator.
+ *  @return huge page size (2MB)
+ */
+/*===========================================================================*/
+size_t AlignedAllocator::HugePageSize()
+{
+    return size_t( 2 ) * 1024 * 1024;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new AlignedAllocator class.
+ *  @param  alignment [in] alignment in bytes (power of two)
+ *  @param  mode [in] huge page mode
+ *  @param  huge_page_threshold [in] minimum byte size backed by huge pages (0: huge page size)
+ */
+/*===========================================================================*/
+AlignedAllocator::AlignedAllocator(
+    const size_t alignment,
+    const HugePageMode mode,
+    const size_t huge_page_threshold ):
+    m_alignment( alignment < sizeof( void* ) ? sizeof( void* ) : alignment ),
+    m_huge_page_mode( mode ),
+    m_huge_page_threshold( huge_page_threshold == 0 ? HugePageSize() : huge_page_threshold )
+{
+    KVS_ASSERT( ( alignment & ( alignment - 1 ) ) == 0 );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Allocates an aligned memory buffer.
+ *  @param  byte_size [in] byte size of the buffer
+ *  @return pointer to the allocated buffer
+ */
+/*===========================================================================*/
+void* AlignedAllocator::allocate( const size_t byte_size )
+{
+    // Zero-size requests still return a unique pointer as operator new[] does.
+    const size_t size = byte_size == 0 ? 1 : byte_size;
+
+#if defined ( KVS_PLATFORM_LINUX )
+    if ( this->is_huge( size ) )
+    {
+        const size_t length = ::RoundUp( size, HugePageSize() );
+        void* ptr = MAP_FAILED;
+#if defined ( MAP_HUGETLB )
+        if ( m_huge_page_mode == ExplicitHugePage )
+        {
+            ptr = mmap( NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+        }
+#endif
+        if ( ptr == MAP_FAILED )
+        {
+            ptr = mmap( NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+            if ( ptr == MAP_FAILED ) { throw std::bad_alloc(); }
+#if defined ( MADV_HUGEPAGE )
+            madvise( ptr, length, MADV_HUGEPAGE );
+#endif
+        }
+        return ptr;
+    }
+#endif
+
+#if defined ( KVS_PLATFORM_WINDOWS )
+    void* ptr = _aligned_malloc( size, m_alignment );
+    if ( !ptr ) { throw std::bad_alloc(); }
+#else
+    void* ptr = NULL;
+    if ( posix_memalign( &ptr, m_alignment, size ) != 0 ) { throw std::bad_alloc(); }
+#endif
+    return ptr;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Deallocates the memory buffer allocated by this allocator.
+ *  @param  ptr [in] pointer to the buffer
+ *  @param  byte_size [in] byte size given to allocate()
+ */
+/*===========================================================================*/
+void AlignedAllocator::deallocate( void* ptr, const size_t byte_size )
+{
+    if ( !ptr ) { return; }
+
+#if defined ( KVS_PLATFORM_LINUX )
+    const size_t size = byte_size == 0 ? 1 : byte_size;
+    if ( this->is_huge( size ) )
+    {
+        munmap( ptr, ::RoundUp( size, HugePageSize() ) );
+        return;
+    }
+#endif
+
+#if defined ( KVS_PLATFORM_WINDOWS )
+    _aligned_free( ptr );
+#else
+    free( ptr );
+#endif
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if the buffer of the given size is backed by huge pages.
+ *  @param  byte_size [in] byte size of the buffer
+ *  @return true, if huge pages are used
+ */
+/*===========================================================================*/
+bool AlignedAllocator::is_huge( const size_t byte_size ) const
+{
+    return m_huge_page_mode != NoHugePage && byte_size >= m_huge_page_threshold;
+}
+
+} // end of namespace kvs
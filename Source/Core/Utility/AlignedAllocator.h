@@ -0,0 +1,66 @@
+/*****************************************************************************/
+/**
+ *  @file   AlignedAllocator.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVS__ALIGNED_ALLOCATOR_H_INCLUDE
+#define KVS__ALIGNED_ALLOCATOR_H_INCLUDE
+
+#include <cstddef>
+#include "Allocator.h"
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Allocator that returns buffers aligned to a given byte boundary.
+ */
+/*===========================================================================*/
+class AlignedAllocator : public kvs::Allocator
+{
+public:
+    enum HugePageMode
+    {
+        NoHugePage = 0, ///< regular pages
+        TransparentHugePage, ///< advise the kernel to back the buffer by THP
+        ExplicitHugePage ///< try MAP_HUGETLB, fall back to TransparentHugePage
+    };
+
+private:
+    size_t m_alignment; ///< alignment in bytes (power of two)
+    HugePageMode m_huge_page_mode; ///< huge page mode
+    size_t m_huge_page_threshold; ///< minimum byte size backed by huge pages
+
+public:
+    static size_t HugePageSize();
+
+public:
+    AlignedAllocator(
+        const size_t alignment = kvs::Allocator::DefaultAlignment,
+        const HugePageMode mode = NoHugePage,
+        const size_t huge_page_threshold = 0 );
+
+    size_t alignment() const { return m_alignment; }
+    HugePageMode hugePageMode() const { return m_huge_page_mode; }
+    size_t hugePageThreshold() const { return m_huge_page_threshold; }
+
+    void* allocate( const size_t byte_size );
+    void deallocate( void* ptr, const size_t byte_size );
+
+private:
+    bool is_huge( const size_t byte_size ) const;
+};
+
+} // end of namespace kvs
+
+#endif // KVS__ALIGNED_ALLOCATOR_H_INCLUDE
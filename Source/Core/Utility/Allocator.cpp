@@ -0,0 +1,60 @@
+/*****************************************************************************/
+/**
+ *  @file   Allocator.cpp
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "Allocator.h"
+#include "AlignedAllocator.h"
+
+
+namespace
+{
+
+kvs::Allocator* CurrentAllocator = NULL;
+
+kvs::Allocator* BuiltinAllocator()
+{
+    static kvs::AlignedAllocator allocator( kvs::Allocator::DefaultAlignment );
+    return &allocator;
+}
+
+} // end of namespace
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the allocator used by the value arrays by default.
+ *  @return pointer to the default allocator (64-byte aligned unless replaced)
+ */
+/*===========================================================================*/
+Allocator* Allocator::Default()
+{
+    return ::CurrentAllocator ? ::CurrentAllocator : ::BuiltinAllocator();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Replaces the default allocator.
+ *  @param  allocator [in] pointer to the allocator (NULL: built-in aligned allocator)
+ *
+ *  The arrays that have been already allocated keep returning their buffers
+ *  to the allocator they were allocated from.
+ */
+/*===========================================================================*/
+void Allocator::SetDefault( Allocator* allocator )
+{
+    ::CurrentAllocator = allocator;
+}
+
+} // end of namespace kvs
@@ -0,0 +1,49 @@
+/*****************************************************************************/
+/**
+ *  @file   Allocator.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVS__ALLOCATOR_H_INCLUDE
+#define KVS__ALLOCATOR_H_INCLUDE
+
+#include <cstddef>
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Allocator base class for the memory buffers of the value arrays.
+ *
+ *  The allocator handed to kvs::ValueArray must outlive all of the arrays
+ *  allocated by it, since the arrays return their buffers to it on release.
+ */
+/*===========================================================================*/
+class Allocator
+{
+public:
+    enum { DefaultAlignment = 64 }; ///< default alignment in bytes (cache line)
+
+public:
+    static Allocator* Default();
+    static void SetDefault( Allocator* allocator );
+
+public:
+    virtual ~Allocator() {}
+
+    virtual void* allocate( const size_t byte_size ) = 0;
+    virtual void deallocate( void* ptr, const size_t byte_size ) = 0;
+};
+
+} // end of namespace kvs
+
+#endif // KVS__ALLOCATOR_H_INCLUDE
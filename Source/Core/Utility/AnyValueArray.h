@@ -417,6 +417,14 @@ public:
         return this->data();
     }
 
+    template<typename T>
+    void* allocate( const size_t size, kvs::Allocator* allocator )
+    {
+        this->deallocate();
+        *this = AnyValueArray( kvs::ValueArray<T>( size, allocator ) );
+        return this->data();
+    }
+
     bool isEmpty() const
     {
         return this->empty();
@@ -517,6 +525,12 @@ public:
         *this = AnyValueArray( kvs::ValueArray<T>( size ) );
     }
 
+    template<typename T>
+    void allocate( const size_t size, kvs::Allocator* allocator )
+    {
+        *this = AnyValueArray( kvs::ValueArray<T>( size, allocator ) );
+    }
+
 #endif
 
     void release();
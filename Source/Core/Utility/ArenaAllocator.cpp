@@ -0,0 +1,113 @@
+/*****************************************************************************/
+/**
+ *  @file   ArenaAllocator.cpp
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "ArenaAllocator.h"
+#include <kvs/MutexLocker>
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new ArenaAllocator class.
+ *  @param  chunk_size [in] default byte size of a chunk
+ *  @param  alignment [in] alignment of the returned buffers in bytes
+ */
+/*===========================================================================*/
+ArenaAllocator::ArenaAllocator( const size_t chunk_size, const size_t alignment ):
+    m_chunk_allocator( alignment, kvs::AlignedAllocator::TransparentHugePage ),
+    m_chunk_size( chunk_size ),
+    m_offset( 0 ),
+    m_used_size( 0 )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Destroys the ArenaAllocator class.
+ */
+/*===========================================================================*/
+ArenaAllocator::~ArenaAllocator()
+{
+    this->reset();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the total byte size of the chunks held by the arena.
+ *  @return byte size
+ */
+/*===========================================================================*/
+size_t ArenaAllocator::reservedSize() const
+{
+    size_t size = 0;
+    for ( size_t i = 0; i < m_chunks.size(); ++i ) { size += m_chunks[i].size; }
+    return size;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Allocates a buffer from the arena.
+ *  @param  byte_size [in] byte size of the buffer
+ *  @return pointer to the buffer
+ */
+/*===========================================================================*/
+void* ArenaAllocator::allocate( const size_t byte_size )
+{
+    const size_t alignment = m_chunk_allocator.alignment();
+    const size_t size = ( ( byte_size == 0 ? 1 : byte_size ) + alignment - 1 ) / alignment * alignment;
+
+    kvs::MutexLocker locker( &m_mutex );
+    if ( m_chunks.empty() || m_offset + size > m_chunks.back().size )
+    {
+        Chunk chunk;
+        chunk.size = size > m_chunk_size ? size : m_chunk_size;
+        chunk.data = static_cast<char*>( m_chunk_allocator.allocate( chunk.size ) );
+        m_chunks.push_back( chunk );
+        m_offset = 0;
+    }
+
+    void* ptr = m_chunks.back().data + m_offset;
+    m_offset += size;
+    m_used_size += size;
+    return ptr;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Does nothing; the buffers are released by reset().
+ */
+/*===========================================================================*/
+void ArenaAllocator::deallocate( void*, const size_t )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Releases all of the chunks.
+ */
+/*===========================================================================*/
+void ArenaAllocator::reset()
+{
+    kvs::MutexLocker locker( &m_mutex );
+    for ( size_t i = 0; i < m_chunks.size(); ++i )
+    {
+        m_chunk_allocator.deallocate( m_chunks[i].data, m_chunks[i].size );
+    }
+    m_chunks.clear();
+    m_offset = 0;
+    m_used_size = 0;
+}
+
+} // end of namespace kvs
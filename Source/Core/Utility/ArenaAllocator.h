@@ -0,0 +1,70 @@
+/*****************************************************************************/
+/**
+ *  @file   ArenaAllocator.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVS__ARENA_ALLOCATOR_H_INCLUDE
+#define KVS__ARENA_ALLOCATOR_H_INCLUDE
+
+#include <cstddef>
+#include <vector>
+#include <kvs/Noncopyable>
+#include <kvs/Mutex>
+#include "Allocator.h"
+#include "AlignedAllocator.h"
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Bump-pointer arena allocator for short-lived temporary arrays.
+ *
+ *  Buffers are carved from large chunks and are never returned one by one;
+ *  all of them are released at once by reset() or on destruction. The arrays
+ *  allocated from the arena must not be used after that.
+ */
+/*===========================================================================*/
+class ArenaAllocator : public kvs::Allocator, public kvs::Noncopyable
+{
+private:
+    struct Chunk
+    {
+        char* data; ///< chunk buffer
+        size_t size; ///< byte size of the chunk
+    };
+
+    kvs::AlignedAllocator m_chunk_allocator; ///< allocator for the chunks
+    size_t m_chunk_size; ///< default byte size of a chunk
+    std::vector<Chunk> m_chunks; ///< allocated chunks
+    size_t m_offset; ///< offset in the last chunk
+    size_t m_used_size; ///< total byte size handed out
+    kvs::Mutex m_mutex; ///< mutex for the bump pointer
+
+public:
+    ArenaAllocator(
+        const size_t chunk_size = size_t( 64 ) * 1024 * 1024,
+        const size_t alignment = kvs::Allocator::DefaultAlignment );
+    virtual ~ArenaAllocator();
+
+    size_t chunkSize() const { return m_chunk_size; }
+    size_t usedSize() const { return m_used_size; }
+    size_t reservedSize() const;
+
+    void* allocate( const size_t byte_size );
+    void deallocate( void* ptr, const size_t byte_size );
+    void reset();
+};
+
+} // end of namespace kvs
+
+#endif // KVS__ARENA_ALLOCATOR_H_INCLUDE
@@ -0,0 +1,273 @@
+/*****************************************************************************/
+/**
+ *  @file   FastCompressor.cpp
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "FastCompressor.h"
+#include <cstring>
+
+
+namespace
+{
+
+/// Min. length of the match.
+const size_t MinMatch = 4;
+
+/// Max. offset of the match.
+const size_t MaxOffset = 65535;
+
+/// Number of the bits of the hash table index.
+const int HashLog = 12;
+
+/*===========================================================================*/
+/**
+ *  @brief  Reads four bytes.
+ *  @param  p [in] pointer to the bytes
+ *  @return four bytes as an integer
+ */
+/*===========================================================================*/
+inline kvs::UInt32 Read32( const kvs::UInt8* p )
+{
+    kvs::UInt32 value;
+    std::memcpy( &value, p, sizeof( value ) );
+    return value;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the hash table index of the four bytes.
+ *  @param  value [in] four bytes
+ *  @return hash table index
+ */
+/*===========================================================================*/
+inline size_t Hash( const kvs::UInt32 value )
+{
+    return ( value * 2654435761U ) >> ( 32 - HashLog );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Writes the length exceeding the token field (15).
+ *  @param  op [in/out] output pointer
+ *  @param  length [in] length minus 15
+ */
+/*===========================================================================*/
+inline void WriteLength( kvs::UInt8*& op, size_t length )
+{
+    while ( length >= 255 ) { *op++ = 255; length -= 255; }
+    *op++ = static_cast<kvs::UInt8>( length );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reads the length exceeding the token field (15).
+ *  @param  ip [in/out] input pointer
+ *  @param  iend [in] end of the input
+ *  @param  length [in/out] length
+ *  @return false, if the input is truncated
+ */
+/*===========================================================================*/
+inline bool ReadLength( const kvs::UInt8*& ip, const kvs::UInt8* iend, size_t& length )
+{
+    kvs::UInt8 byte = 255;
+    while ( byte == 255 )
+    {
+        if ( ip >= iend ) { return false; }
+        byte = *ip++;
+        length += byte;
+    }
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Writes a sequence of the literals and the match.
+ *  @param  op [in/out] output pointer
+ *  @param  literals [in] pointer to the literals
+ *  @param  nliterals [in] number of the literals
+ *  @param  offset [in] match offset (0: last sequence without the match)
+ *  @param  match_length [in] match length
+ */
+/*===========================================================================*/
+inline void WriteSequence(
+    kvs::UInt8*& op,
+    const kvs::UInt8* literals,
+    const size_t nliterals,
+    const size_t offset,
+    const size_t match_length )
+{
+    kvs::UInt8* token = op++;
+    *token = static_cast<kvs::UInt8>( ( nliterals < 15 ? nliterals : 15 ) << 4 );
+    if ( nliterals >= 15 ) { WriteLength( op, nliterals - 15 ); }
+    std::memcpy( op, literals, nliterals );
+    op += nliterals;
+
+    if ( offset == 0 ) { return; }
+
+    *op++ = static_cast<kvs::UInt8>( offset & 0xff );
+    *op++ = static_cast<kvs::UInt8>( offset >> 8 );
+
+    const size_t length = match_length - MinMatch;
+    *token |= static_cast<kvs::UInt8>( length < 15 ? length : 15 );
+    if ( length >= 15 ) { WriteLength( op, length - 15 ); }
+}
+
+} // end of namespace
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the max. size of the compressed data.
+ *  @param  size [in] size of the data in bytes
+ *  @return max. size of the compressed data in bytes
+ */
+/*===========================================================================*/
+size_t FastCompressor::MaxCompressedSize( const size_t size )
+{
+    return size + size / 255 + 16;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Compresses the data.
+ *  @param  src [in] pointer to the data
+ *  @param  src_size [in] size of the data in bytes
+ *  @param  dst [out] pointer to the buffer of MaxCompressedSize( src_size ) bytes
+ *  @return size of the compressed data in bytes
+ */
+/*===========================================================================*/
+size_t FastCompressor::Compress( const void* src, const size_t src_size, void* dst )
+{
+    const kvs::UInt8* const base = static_cast<const kvs::UInt8*>( src );
+    const kvs::UInt8* const iend = base + src_size;
+    const kvs::UInt8* ip = base;
+    const kvs::UInt8* anchor = base;
+    kvs::UInt8* op = static_cast<kvs::UInt8*>( dst );
+    kvs::UInt8* const obegin = op;
+
+    if ( src_size > ::MinMatch )
+    {
+        // Positions of the last occurrences of the four bytes.
+        size_t table[ 1 << ::HashLog ];
+        std::memset( table, 0, sizeof( table ) );
+
+        const kvs::UInt8* const limit = iend - ::MinMatch;
+        ip++;
+        while ( ip <= limit )
+        {
+            const kvs::UInt32 sequence = ::Read32( ip );
+            const size_t h = ::Hash( sequence );
+            const kvs::UInt8* ref = base + table[h];
+            table[h] = ip - base;
+
+            if ( static_cast<size_t>( ip - ref ) > ::MaxOffset || ::Read32( ref ) != sequence )
+            {
+                // Skip faster in the incompressible data.
+                ip += 1 + ( ( ip - anchor ) >> 6 );
+                continue;
+            }
+
+            // Extend the match backward and forward.
+            while ( ip > anchor && ref > base && ip[-1] == ref[-1] ) { ip--; ref--; }
+            const kvs::UInt8* match_end = ip + ::MinMatch;
+            const kvs::UInt8* r = ref + ::MinMatch;
+            while ( match_end < iend && *match_end == *r ) { match_end++; r++; }
+
+            ::WriteSequence( op, anchor, ip - anchor, ip - ref, match_end - ip );
+            ip = match_end;
+            anchor = ip;
+        }
+    }
+
+    // Last literals.
+    ::WriteSequence( op, anchor, iend - anchor, 0, 0 );
+    return op - obegin;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Compresses the data.
+ *  @param  src [in] pointer to the data
+ *  @param  src_size [in] size of the data in bytes
+ *  @return compressed data
+ */
+/*===========================================================================*/
+kvs::ValueArray<kvs::UInt8> FastCompressor::Compress( const void* src, const size_t src_size )
+{
+    kvs::ValueArray<kvs::UInt8> buffer( MaxCompressedSize( src_size ) );
+    const size_t size = Compress( src, src_size, buffer.data() );
+    return kvs::ValueArray<kvs::UInt8>( buffer.data(), size );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Decompresses the data.
+ *  @param  src [in] pointer to the compressed data
+ *  @param  src_size [in] size of the compressed data in bytes
+ *  @param  dst [out] pointer to the buffer of the original size
+ *  @param  dst_size [in] original size in bytes
+ *  @return false, if the compressed data is broken or the size does not match
+ */
+/*===========================================================================*/
+bool FastCompressor::Decompress( const void* src, const size_t src_size, void* dst, const size_t dst_size )
+{
+    const kvs::UInt8* ip = static_cast<const kvs::UInt8*>( src );
+    const kvs::UInt8* const iend = ip + src_size;
+    kvs::UInt8* op = static_cast<kvs::UInt8*>( dst );
+    kvs::UInt8* const obegin = op;
+    kvs::UInt8* const oend = op + dst_size;
+
+    while ( ip < iend )
+    {
+        const kvs::UInt8 token = *ip++;
+
+        // Literals.
+        size_t nliterals = token >> 4;
+        if ( nliterals == 15 && !::ReadLength( ip, iend, nliterals ) ) { return false; }
+        if ( nliterals > static_cast<size_t>( iend - ip ) ||
+             nliterals > static_cast<size_t>( oend - op ) ) { return false; }
+        std::memcpy( op, ip, nliterals );
+        ip += nliterals;
+        op += nliterals;
+
+        // The last sequence has no match.
+        if ( ip == iend ) { break; }
+
+        // Match.
+        if ( iend - ip < 2 ) { return false; }
+        const size_t offset = ip[0] | ( ip[1] << 8 );
+        ip += 2;
+        size_t length = token & 15;
+        if ( length == 15 && !::ReadLength( ip, iend, length ) ) { return false; }
+        length += ::MinMatch;
+        if ( offset == 0 || offset > static_cast<size_t>( op - obegin ) ||
+             length > static_cast<size_t>( oend - op ) ) { return false; }
+
+        const kvs::UInt8* ref = op - offset;
+        if ( offset >= length )
+        {
+            std::memcpy( op, ref, length );
+            op += length;
+        }
+        else
+        {
+            // Overlapped copy repeats the pattern.
+            for ( size_t i = 0; i < length; i++ ) { *op++ = *ref++; }
+        }
+    }
+
+    return op == oend;
+}
+
+} // end of namespace kvs
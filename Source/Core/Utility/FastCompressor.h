@@ -0,0 +1,48 @@
+/*****************************************************************************/
+/**
+ *  @file   FastCompressor.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVS__FAST_COMPRESSOR_H_INCLUDE
+#define KVS__FAST_COMPRESSOR_H_INCLUDE
+
+#include <cstddef>
+#include <kvs/Type>
+#include <kvs/ValueArray>
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Fast lossless compressor of the byte sequence.
+ *
+ *  The data is compressed by the LZ77 with a single-probe hash table (LZ4
+ *  style) into the sequences of the literals and the match (16-bit offset
+ *  and the length of four bytes or more). The compression and the
+ *  decompression are thread-safe, and the compressed data does not contain
+ *  the original size, which must be given for the decompression.
+ */
+/*===========================================================================*/
+class FastCompressor
+{
+public:
+
+    static size_t MaxCompressedSize( const size_t size );
+    static size_t Compress( const void* src, const size_t src_size, void* dst );
+    static kvs::ValueArray<kvs::UInt8> Compress( const void* src, const size_t src_size );
+    static bool Decompress( const void* src, const size_t src_size, void* dst, const size_t dst_size );
+};
+
+} // end of namespace kvs
+
+#endif // KVS__FAST_COMPRESSOR_H_INCLUDE
@@ -0,0 +1,123 @@
+/*****************************************************************************/
+/**
+ *  @file   TypeDispatch.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVS__TYPE_DISPATCH_H_INCLUDE
+#define KVS__TYPE_DISPATCH_H_INCLUDE
+
+#include <kvs/Type>
+#include <kvs/AnyValueArray>
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Empty tag that carries a value type.
+ */
+/*===========================================================================*/
+template <typename T>
+struct TypeTag
+{
+    typedef T type;
+};
+
+namespace detail
+{
+
+template <typename Functor>
+struct TypeTagInvoker
+{
+    Functor& f;
+    TypeTagInvoker( Functor& functor ): f( functor ) {}
+    template <typename T> void apply() { f( kvs::TypeTag<T>() ); }
+};
+
+template <typename Functor>
+struct ValuePointerInvoker
+{
+    Functor& f;
+    const void* values;
+    ValuePointerInvoker( Functor& functor, const void* ptr ): f( functor ), values( ptr ) {}
+    template <typename T> void apply() { f( static_cast<const T*>( values ) ); }
+};
+
+template <typename Invoker>
+inline bool DispatchTypeID( const kvs::Type::TypeID id, Invoker& invoker )
+{
+    switch ( id )
+    {
+    case kvs::Type::TypeInt8:   invoker.template apply<kvs::Int8  >(); return true;
+    case kvs::Type::TypeInt16:  invoker.template apply<kvs::Int16 >(); return true;
+    case kvs::Type::TypeInt32:  invoker.template apply<kvs::Int32 >(); return true;
+    case kvs::Type::TypeInt64:  invoker.template apply<kvs::Int64 >(); return true;
+    case kvs::Type::TypeUInt8:  invoker.template apply<kvs::UInt8 >(); return true;
+    case kvs::Type::TypeUInt16: invoker.template apply<kvs::UInt16>(); return true;
+    case kvs::Type::TypeUInt32: invoker.template apply<kvs::UInt32>(); return true;
+    case kvs::Type::TypeUInt64: invoker.template apply<kvs::UInt64>(); return true;
+    case kvs::Type::TypeReal32: invoker.template apply<kvs::Real32>(); return true;
+    case kvs::Type::TypeReal64: invoker.template apply<kvs::Real64>(); return true;
+    default: break;
+    }
+    return false;
+}
+
+} // end of namespace detail
+
+/*===========================================================================*/
+/**
+ *  @brief  Calls f( kvs::TypeTag<T>() ) with the value type T of the given ID.
+ *  @param  id [in] type ID (one of the ten numeric types)
+ *  @param  f [in] functor having 'template <typename T> void operator ()( kvs::TypeTag<T> )'
+ *  @return false, if the type ID is not a numeric type
+ */
+/*===========================================================================*/
+template <typename Functor>
+inline bool DispatchType( const kvs::Type::TypeID id, Functor& f )
+{
+    kvs::detail::TypeTagInvoker<Functor> invoker( f );
+    return kvs::detail::DispatchTypeID( id, invoker );
+}
+
+template <typename Functor>
+inline bool DispatchType( const kvs::Type::TypeID id, const Functor& f )
+{
+    kvs::detail::TypeTagInvoker<const Functor> invoker( f );
+    return kvs::detail::DispatchTypeID( id, invoker );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Calls f( const T* values ) with the typed pointer of the array.
+ *  @param  values [in] value array
+ *  @param  f [in] functor having 'template <typename T> void operator ()( const T* )'
+ *  @return false, if the array does not hold numeric values
+ */
+/*===========================================================================*/
+template <typename Functor>
+inline bool DispatchValues( const kvs::AnyValueArray& values, Functor& f )
+{
+    kvs::detail::ValuePointerInvoker<Functor> invoker( f, values.data() );
+    return kvs::detail::DispatchTypeID( values.typeID(), invoker );
+}
+
+template <typename Functor>
+inline bool DispatchValues( const kvs::AnyValueArray& values, const Functor& f )
+{
+    kvs::detail::ValuePointerInvoker<const Functor> invoker( f, values.data() );
+    return kvs::detail::DispatchTypeID( values.typeID(), invoker );
+}
+
+} // end of namespace kvs
+
+#endif // KVS__TYPE_DISPATCH_H_INCLUDE
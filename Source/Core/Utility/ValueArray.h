@@ -18,12 +18,14 @@
 #include <iterator>
 #include <utility>
 #include <vector>
+#include <new>
 #if KVS_ENABLE_DEPRECATED
 #include <cstring>
 #endif
 #include <kvs/DebugNew>
 #include <kvs/Assert>
 #include <kvs/SharedPointer>
+#include <kvs/Allocator>
 #if KVS_ENABLE_DEPRECATED
 #include <kvs/Endian>
 #endif
@@ -43,6 +45,42 @@ struct ArrayDeleter
     }
 };
 
+template <typename T>
+struct AllocatorDeleter
+{
+    kvs::Allocator* allocator;
+    size_t size;
+
+    AllocatorDeleter( kvs::Allocator* a, const size_t n ): allocator( a ), size( n ) {}
+
+    void operator ()( T* ptr )
+    {
+        for ( size_t i = 0; i < size; ++i ) { ptr[i].~T(); }
+        allocator->deallocate( ptr, size * sizeof( T ) );
+    }
+};
+
+template <typename T>
+inline T* AllocateArray( kvs::Allocator* allocator, const size_t size )
+{
+    // The byte size must not wrap around, as new T[size] throws for it.
+    if ( size > size_t(-1) / sizeof( T ) ) { throw std::bad_alloc(); }
+
+    T* ptr = static_cast<T*>( allocator->allocate( size * sizeof( T ) ) );
+    size_t i = 0;
+    try
+    {
+        // Default-initialization as new T[size] does (no-op for arithmetic types).
+        for ( ; i < size; ++i ) { new ( ptr + i ) T; }
+    }
+    catch ( ... )
+    {
+        AllocatorDeleter<T>( allocator, i )( ptr );
+        throw;
+    }
+    return ptr;
+}
+
 }
 
 /*==========================================================================*/
@@ -80,6 +118,11 @@ public:
         this->allocate( size );
     }
 
+    ValueArray( const size_t size, kvs::Allocator* allocator )
+    {
+        this->allocate( size, allocator );
+    }
+
     ValueArray( const value_type* values, const size_t size )
     {
         this->allocate( size );
@@ -299,9 +342,16 @@ public:
 public:
 #if KVS_ENABLE_DEPRECATED
     value_type* allocate( const size_t size )
+    {
+        return this->allocate( size, kvs::Allocator::Default() );
+    }
+
+    value_type* allocate( const size_t size, kvs::Allocator* allocator )
     {
         this->release();
-        m_values.reset( new value_type[ size ], kvs::temporal::ArrayDeleter<value_type>() );
+        m_values.reset(
+            kvs::temporal::AllocateArray<value_type>( allocator, size ),
+            kvs::temporal::AllocatorDeleter<value_type>( allocator, size ) );
         m_size = size;
         return this->data();
     }
@@ -339,7 +389,14 @@ public:
 #else
     void allocate( const size_t size )
     {
-        m_values.reset( new value_type[ size ], kvs::temporal::ArrayDeleter<value_type>() );
+        this->allocate( size, kvs::Allocator::Default() );
+    }
+
+    void allocate( const size_t size, kvs::Allocator* allocator )
+    {
+        m_values.reset(
+            kvs::temporal::AllocateArray<value_type>( allocator, size ),
+            kvs::temporal::AllocatorDeleter<value_type>( allocator, size ) );
         m_size = size;
     }
 #endif
@@ -56,9 +56,9 @@ kvs::KVSMLPointObject* PointExporter<kvs::KVSMLPointObject>::exec( const kvs::Ob
         return NULL;
     }
 
-    this->setCoords( point->coords() );
-    this->setColors( point->colors() );
-    this->setNormals( point->normals() );
+    this->setCoords( point->decodedCoords() );
+    this->setColors( point->decodedColors() );
+    this->setNormals( point->decodedNormals() );
     this->setSizes( point->sizes() );
 
     return this;
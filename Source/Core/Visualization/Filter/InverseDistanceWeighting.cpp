@@ -13,11 +13,250 @@
  */
 /*****************************************************************************/
 #include "InverseDistanceWeighting.h"
+#include <algorithm>
+#include <kvs/Math>
+#include <kvs/OpenMP>
+
+
+namespace
+{
+
+/// Number of bits of the node index sorted in one radix pass.
+const size_t RadixBits = 11;
+const size_t RadixSize = size_t(1) << RadixBits;
+
+/*===========================================================================*/
+/**
+ *  @brief  Builds the node-to-slot adjacency in CSR form.
+ *  @param  connections [in] connections of the cells (node index of each slot)
+ *  @param  nslots [in] number of slots (ncells * nnodes_per_cell)
+ *  @param  nnodes [in] number of nodes
+ *  @param  offsets [out] offsets to the adjacent slots of each node
+ *  @param  slots [out] adjacent slots sorted by the node index
+ *
+ *  The slots are sorted by a stable LSD radix sort with per-thread
+ *  histograms, so that the slots of each node are in ascending order
+ *  and the result does not depend on the number of threads.
+ */
+/*===========================================================================*/
+void BuildAdjacency(
+    const kvs::UInt32* connections,
+    const size_t nslots,
+    const size_t nnodes,
+    kvs::ValueArray<kvs::UInt32>& offsets,
+    kvs::ValueArray<kvs::UInt32>& slots )
+{
+    kvs::ValueArray<kvs::UInt32> keys( nslots );
+    kvs::ValueArray<kvs::UInt32> keys_buffer( nslots );
+    kvs::ValueArray<kvs::UInt32> slots_buffer( nslots );
+    slots.allocate( nslots );
+
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < nslots; i++ )
+    {
+        keys[i] = connections[i];
+        slots[i] = static_cast<kvs::UInt32>( i );
+    }
+
+    const size_t nthreads = static_cast<size_t>( kvs::Math::Max( kvs::OpenMP::GetMaxThreads(), 1 ) );
+    std::vector<size_t> bounds( nthreads + 1 );
+    for ( size_t t = 0; t <= nthreads; t++ ) { bounds[t] = nslots * t / nthreads; }
+
+    std::vector<size_t> histogram( nthreads * ::RadixSize );
+    const size_t mask = ::RadixSize - 1;
+    const size_t max_key = nnodes > 0 ? nnodes - 1 : 0;
+    for ( size_t shift = 0; shift < 32 && ( max_key >> shift ) != 0; shift += ::RadixBits )
+    {
+        KVS_OMP_PARALLEL_FOR( schedule(static) )
+        for ( size_t t = 0; t < nthreads; t++ )
+        {
+            size_t* h = &histogram[ t * ::RadixSize ];
+            std::fill( h, h + ::RadixSize, size_t(0) );
+            for ( size_t i = bounds[t]; i < bounds[t+1]; i++ ) { h[ ( keys[i] >> shift ) & mask ]++; }
+        }
+
+        size_t sum = 0;
+        for ( size_t d = 0; d < ::RadixSize; d++ )
+        {
+            for ( size_t t = 0; t < nthreads; t++ )
+            {
+                const size_t count = histogram[ t * ::RadixSize + d ];
+                histogram[ t * ::RadixSize + d ] = sum;
+                sum += count;
+            }
+        }
+
+        KVS_OMP_PARALLEL_FOR( schedule(static) )
+        for ( size_t t = 0; t < nthreads; t++ )
+        {
+            size_t* h = &histogram[ t * ::RadixSize ];
+            for ( size_t i = bounds[t]; i < bounds[t+1]; i++ )
+            {
+                const size_t p = h[ ( keys[i] >> shift ) & mask ]++;
+                keys_buffer[p] = keys[i];
+                slots_buffer[p] = slots[i];
+            }
+        }
+
+        keys.swap( keys_buffer );
+        slots.swap( slots_buffer );
+    }
+
+    // offsets[n] is the position of the first slot whose key is not less than n.
+    offsets.allocate( nnodes + 1 );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i <= nslots; i++ )
+    {
+        const size_t lower = ( i == 0 ) ? 0 : keys[ i - 1 ] + 1;
+        const size_t upper = ( i == nslots ) ? nnodes : keys[i];
+        for ( size_t n = lower; n <= upper && n <= nnodes; n++ )
+        {
+            offsets[n] = static_cast<kvs::UInt32>( i );
+        }
+    }
+}
+
+inline void SetZero( kvs::Real32& value ) { value = 0.0f; }
+inline void SetZero( kvs::Vec3& value ) { value = kvs::Vec3::Zero(); }
+inline void SetZero( kvs::Mat3& value ) { value = kvs::Mat3::Zero(); }
+
+inline void Store( const kvs::Real32& value, kvs::Real32* dst )
+{
+    dst[0] = value;
+}
+
+inline void Store( const kvs::Vec3& value, kvs::Real32* dst )
+{
+    dst[0] = value[0];
+    dst[1] = value[1];
+    dst[2] = value[2];
+}
+
+inline void Store( const kvs::Mat3& value, kvs::Real32* dst )
+{
+    for ( int i = 0; i < 3; i++ )
+    {
+        dst[ i * 3 + 0 ] = value[i][0];
+        dst[ i * 3 + 1 ] = value[i][1];
+        dst[ i * 3 + 2 ] = value[i][2];
+    }
+}
+
+inline size_t Veclen( const kvs::Real32& ) { return 1; }
+inline size_t Veclen( const kvs::Vec3& ) { return 3; }
+inline size_t Veclen( const kvs::Mat3& ) { return 9; }
+
+} // end of namespace
 
 
 namespace kvs
 {
 
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new InverseDistanceWeighting class with the bucket.
+ *  @param  nnodes [in] number of nodes
+ */
+/*===========================================================================*/
+template <typename Value>
+InverseDistanceWeighting<Value>::InverseDistanceWeighting( const size_t nnodes ):
+    m_nnodes_per_cell( 0 )
+{
+    m_bucket.resize( nnodes );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new InverseDistanceWeighting class.
+ *  @param  volume [in] pointer to the unstructured volume object
+ */
+/*===========================================================================*/
+template <typename Value>
+InverseDistanceWeighting<Value>::InverseDistanceWeighting( const kvs::UnstructuredVolumeObject* volume ):
+    m_nnodes_per_cell( volume->numberOfCellNodes() )
+{
+    const size_t ncells = volume->numberOfCells();
+    const size_t nnodes = volume->numberOfNodes();
+    const size_t nslots = ncells * m_nnodes_per_cell;
+    ::BuildAdjacency( volume->connections().data(), nslots, nnodes, m_offsets, m_slots );
+
+    m_values.resize( ncells );
+    m_distances.allocate( nslots );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the node values calculated by the inverse distance weighting.
+ *  @return node values (Real32 x veclen for each node)
+ */
+/*===========================================================================*/
+template <typename Value>
+kvs::ValueArray<kvs::Real32> InverseDistanceWeighting<Value>::serialize() const
+{
+    const size_t veclen = ::Veclen( Value() );
+    const size_t nnodes = this->numberOfNodes();
+    const size_t nnodes_per_cell = m_nnodes_per_cell;
+
+    kvs::ValueArray<kvs::Real32> values( nnodes * veclen );
+    if ( m_offsets.size() == 0 )
+    {
+        KVS_OMP_PARALLEL_FOR( schedule(static) )
+        for ( size_t i = 0; i < nnodes; i++ )
+        {
+            const std::vector<Pair>& pairs = m_bucket[i];
+            const size_t n = pairs.size();
+
+            Value value;
+            ::SetZero( value );
+            if ( n > 0 )
+            {
+                kvs::Real32 w = 0.0f;
+                for ( size_t j = 0; j < n; j++ ) { w += 1.0f / pairs[j].second; }
+                for ( size_t j = 0; j < n; j++ )
+                {
+                    value += ( ( 1.0f / pairs[j].second ) / w ) * pairs[j].first;
+                }
+                value /= static_cast<kvs::Real32>( n );
+            }
+
+            ::Store( value, values.data() + i * veclen );
+        }
+
+        return values;
+    }
+
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < nnodes; i++ )
+    {
+        const size_t begin = m_offsets[i];
+        const size_t end = m_offsets[ i + 1 ];
+        const size_t n = end - begin;
+
+        Value value;
+        ::SetZero( value );
+        if ( n > 0 )
+        {
+            kvs::Real32 w = 0.0f;
+            for ( size_t j = begin; j < end; j++ )
+            {
+                w += 1.0f / m_distances[ m_slots[j] ];
+            }
+
+            for ( size_t j = begin; j < end; j++ )
+            {
+                const kvs::UInt32 slot = m_slots[j];
+                const kvs::Real32 d = m_distances[ slot ];
+                value += ( ( 1.0f / d ) / w ) * m_values[ slot / nnodes_per_cell ];
+            }
+            value /= static_cast<kvs::Real32>( n );
+        }
+
+        ::Store( value, values.data() + i * veclen );
+    }
+
+    return values;
+}
+
 template class InverseDistanceWeighting<kvs::Real32>;
 template class InverseDistanceWeighting<kvs::Vec3>;
 template class InverseDistanceWeighting<kvs::Mat3>;
@@ -15,10 +15,12 @@
 #pragma once
 
 #include <vector>
+#include <utility>
 #include <kvs/ValueArray>
 #include <kvs/Type>
 #include <kvs/Vector3>
 #include <kvs/Matrix33>
+#include <kvs/UnstructuredVolumeObject>
 
 
 namespace kvs
@@ -27,6 +29,17 @@ namespace kvs
 /*===========================================================================*/
 /**
  *  @brief  Inverse distance weighting calculation class
+ *
+ *  Each cell of the unstructured volume has a value (scalar as kvs::Real32,
+ *  vector as kvs::Vec3 or tensor as kvs::Mat3), and each node receives the
+ *  average of the values of its adjacent cells weighted by the inverse
+ *  distances between the node and the cell centers. The node-to-cell
+ *  adjacency is stored in compressed sparse row (CSR) form, so that the
+ *  values and distances can be set concurrently for different cells and
+ *  the node values are gathered in parallel without locks.
+ *
+ *  The object constructed with the number of nodes keeps the values and
+ *  distances inserted for each node in the bucket instead (not thread-safe).
  */
 /*===========================================================================*/
 template <typename Value>
@@ -39,145 +52,40 @@ public:
 
 private:
 
-    Bucket m_bucket;
+    Bucket m_bucket; ///< values and distances inserted for each node
+    size_t m_nnodes_per_cell; ///< number of nodes per cell
+    kvs::ValueArray<kvs::UInt32> m_offsets; ///< offsets to the adjacent slots of each node (nnodes + 1)
+    kvs::ValueArray<kvs::UInt32> m_slots; ///< adjacent slots (cell index * nnodes_per_cell + local node index)
+    std::vector<Value> m_values; ///< value of each cell
+    kvs::ValueArray<kvs::Real32> m_distances; ///< node-to-center distance of each slot
 
 public:
 
-    InverseDistanceWeighting( const size_t nnodes ) { m_bucket.resize( nnodes ); }
+    InverseDistanceWeighting( const size_t nnodes );
+    InverseDistanceWeighting( const kvs::UnstructuredVolumeObject* volume );
 
     const Bucket& bucket() const { return m_bucket; }
+    size_t numberOfNodes() const { return m_offsets.size() > 0 ? m_offsets.size() - 1 : m_bucket.size(); }
+    size_t numberOfCells() const { return m_values.size(); }
+    const kvs::ValueArray<kvs::UInt32>& offsets() const { return m_offsets; }
+    const kvs::ValueArray<kvs::UInt32>& slots() const { return m_slots; }
 
     void insert( const kvs::UInt32 index, const Value value, const kvs::Real32 distance )
     {
         m_bucket[ index ].push_back( std::make_pair( value, distance ) );
     }
 
-    kvs::ValueArray<kvs::Real32> serialize() const
+    void setValue( const size_t cell_index, const Value& value )
     {
-        // Specialized for
-        //    scalar value as kvs::Real32
-        //    vector value as kvs::Vec3
-        //    tensor value as kvs::Mat3
-        return kvs::ValueArray<kvs::Real32>( m_bucket.size() );
+        m_values[ cell_index ] = value;
     }
-};
 
-template <>
-inline kvs::ValueArray<kvs::Real32> InverseDistanceWeighting<kvs::Real32>::serialize() const
-{
-    typedef kvs::Real32 Scalar;
-    const size_t veclen = 1;
-
-    // Inverse distance weighting.
-    const size_t nnodes = m_bucket.size();
-    kvs::ValueArray<kvs::Real32> values( nnodes * veclen );
-    for ( size_t i = 0; i < nnodes; i++ )
+    void setDistance( const size_t cell_index, const size_t local_index, const kvs::Real32 distance )
     {
-        const size_t n = m_bucket.at(i).size();
-        //if ( n == 0 ) { continue; }
-
-        float w = 0.0f;
-        for ( size_t j = 0; j < n; j++ )
-        {
-            const float d = m_bucket.at(i).at(j).second;
-            w += 1.0f / d;
-        }
-
-        Scalar value = 0.0f;
-        for ( size_t j = 0; j < n; j++ )
-        {
-            const Scalar s = m_bucket.at(i).at(j).first;
-            const kvs::Real32 d = m_bucket.at(i).at(j).second;
-            value += ( ( 1.0f / d ) / w ) * s;
-        }
-        value /= n;
-
-        values[i] = value;
+        m_distances[ cell_index * m_nnodes_per_cell + local_index ] = distance;
     }
 
-    return values;
-}
-
-template <>
-inline kvs::ValueArray<kvs::Real32> InverseDistanceWeighting<kvs::Vec3>::serialize() const
-{
-    typedef kvs::Vec3 Vector;
-    const size_t veclen = 3;
-
-    // Inverse distance weighting.
-    const size_t nnodes = m_bucket.size();
-    kvs::ValueArray<kvs::Real32> values( nnodes * veclen );
-    for ( size_t i = 0; i < nnodes; i++ )
-    {
-        const size_t n = m_bucket.at(i).size();
-        //if ( n == 0 ) { continue; }
-
-        float w = 0.0f;
-        for ( size_t j = 0; j < n; j++ )
-        {
-            const float d = m_bucket.at(i).at(j).second;
-            w += 1.0f / d;
-        }
-
-        Vector value = Vector::Zero();
-        for ( size_t j = 0; j < n; j++ )
-        {
-            const Vector v = m_bucket.at(i).at(j).first;
-            const kvs::Real32 d = m_bucket.at(i).at(j).second;
-            value += ( ( 1.0f / d ) / w ) * v;
-        }
-        value /= n;
-
-        values[ i * veclen + 0 ] = value[0];
-        values[ i * veclen + 1 ] = value[1];
-        values[ i * veclen + 2 ] = value[2];
-    }
-
-    return values;
-}
-
-template <>
-inline kvs::ValueArray<kvs::Real32> InverseDistanceWeighting<kvs::Mat3>::serialize() const
-{
-    typedef kvs::Mat3 Tensor;
-    const size_t veclen = 9;
-
-    // Inverse distance weighting.
-    const size_t nnodes = m_bucket.size();
-    kvs::ValueArray<kvs::Real32> values( nnodes * veclen );
-    for ( size_t i = 0; i < nnodes; i++ )
-    {
-        const size_t n = m_bucket.at(i).size();
-        //if ( n == 0 ) { continue; }
-
-        float w = 0.0f;
-        for ( size_t j = 0; j < n; j++ )
-        {
-            const float d = m_bucket.at(i).at(j).second;
-            w += 1.0f / d;
-        }
-
-        Tensor value = Tensor::Zero();
-        for ( size_t j = 0; j < n; j++ )
-        {
-            const Tensor t = m_bucket.at(i).at(j).first;
-            const kvs::Real32 d = m_bucket.at(i).at(j).second;
-            value += ( ( 1.0f / d ) / w ) * t;
-        }
-        value /= n;
-
-        values[ i * veclen + 0 ] = value[0][0];
-        values[ i * veclen + 1 ] = value[0][1];
-        values[ i * veclen + 2 ] = value[0][2];
-        values[ i * veclen + 3 ] = value[1][0];
-        values[ i * veclen + 4 ] = value[1][1];
-        values[ i * veclen + 5 ] = value[1][2];
-        values[ i * veclen + 6 ] = value[2][0];
-        values[ i * veclen + 7 ] = value[2][1];
-        values[ i * veclen + 8 ] = value[2][2];
-    }
-
-    return values;
-}
+    kvs::ValueArray<kvs::Real32> serialize() const;
+};
 
 } // end of namespace kvs
@@ -16,6 +16,9 @@
 #include <kvs/DebugNew>
 #include <kvs/MersenneTwister>
 #include <kvs/Vector3>
+#include <kvs/OpenMP>
+#include <vector>
+#include <cmath>
 
 
 namespace kvs
@@ -28,7 +31,9 @@ namespace kvs
 /*===========================================================================*/
 LineIntegralConvolution::LineIntegralConvolution():
     m_length( 0.0 ),
-    m_noise( NULL )
+    m_noise( NULL ),
+    m_method( StandardLIC ),
+    m_min_hits( 1 )
 {
 }
 
@@ -39,7 +44,9 @@ LineIntegralConvolution::LineIntegralConvolution():
  */
 /*===========================================================================*/
 LineIntegralConvolution::LineIntegralConvolution( const kvs::StructuredVolumeObject* volume ):
-    m_noise( NULL )
+    m_noise( NULL ),
+    m_method( StandardLIC ),
+    m_min_hits( 1 )
 {
     const kvs::Vector3ui& r = volume->resolution();
     m_length = kvs::Math::Max<double>( r.x(), r.y(), r.z() ) * 0.1;
@@ -51,11 +58,17 @@ LineIntegralConvolution::LineIntegralConvolution( const kvs::StructuredVolumeObj
  *  @brief  Constructs a new LineIntegralConvolution class.
  *  @param  volume [in] pointer to the input volume data
  *  @param  length [in] strem length
+ *  @param  method [in] convolution method
  */
 /*===========================================================================*/
-LineIntegralConvolution::LineIntegralConvolution( const kvs::StructuredVolumeObject* volume, const double length ):
+LineIntegralConvolution::LineIntegralConvolution(
+    const kvs::StructuredVolumeObject* volume,
+    const double length,
+    const Method method ):
     m_length( length ),
-    m_noise( NULL )
+    m_noise( NULL ),
+    m_method( method ),
+    m_min_hits( 1 )
 {
     this->exec( volume );
 }
@@ -163,6 +176,7 @@ void LineIntegralConvolution::create_noise_volume( const kvs::StructuredVolumeOb
     }
 
     // Copy the white noise volume to m_noise.
+    if ( m_noise ) { delete m_noise; }
     m_noise = new kvs::StructuredVolumeObject();
     m_noise->setVeclen( 1 );
     m_noise->setValues( kvs::AnyValueArray( data ) );
@@ -179,133 +193,282 @@ void LineIntegralConvolution::create_noise_volume( const kvs::StructuredVolumeOb
 template <typename T>
 void LineIntegralConvolution::convolution( const kvs::StructuredVolumeObject* volume )
 {
-    kvs::Vector3<T> u;         // vector of node
-    kvs::Vector3<T> p;         // position of node
-    kvs::Vector3<T> travel_t;  //
-    kvs::Vector3<T> entry_pos; //
-
-    const kvs::UInt8*           noise_data = static_cast<const kvs::UInt8*>( m_noise->values().data() );
-    const T*                    src_data = static_cast<const T*>( volume->values().data() );
-
     kvs::ValueArray<kvs::UInt8> dst_data( volume->numberOfNodes() );
+    if ( m_method == FastLIC )
+    {
+        this->fast_convolution<T>( volume, dst_data );
+    }
+    else
+    {
+        const kvs::UInt8*           noise_data = static_cast<const kvs::UInt8*>( m_noise->values().data() );
+        const T*                    src_data = static_cast<const T*>( volume->values().data() );
 
-    const kvs::Vector3ui resol( volume->resolution() );
+        const kvs::Vector3ui resol( volume->resolution() );
+        const bool planar = ( resol.z() == 1 );
 
-    unsigned int counter = 0;
-    for( size_t k = 0; k < resol.z(); k++ )
-    {
-        for( size_t j = 0; j < resol.y(); j++ )
+        // The slabs of the volume are processed in parallel.
+        const size_t resol_z = resol.z();
+        KVS_OMP_PARALLEL_FOR( schedule(dynamic) )
+        for( size_t k = 0; k < resol_z; k++ )
         {
-            for( size_t i = 0; i < resol.x(); i++ )
+            kvs::Vector3<T> u;         // vector of node
+            kvs::Vector3<T> p;         // position of node
+            kvs::Vector3<T> travel_t;  //
+            kvs::Vector3<T> entry_pos; //
+
+            unsigned int counter = k * resol.x() * resol.y();
+            for( size_t j = 0; j < resol.y(); j++ )
             {
-                int i_c = i;
-                int j_c = j;
-                int k_c = k;
+                for( size_t i = 0; i < resol.x(); i++ )
+                {
+                    int i_c = i;
+                    int j_c = j;
+                    int k_c = k;
 
-                T acc_length = T(0);
-                T acc_data   = T(0);
+                    T acc_length = T(0);
+                    T acc_data   = T(0);
 
-                unsigned int loc_c = counter;
+                    unsigned int loc_c = counter;
 
-                for( int m = 1; m > -2; m -= 2  )
-                {
-                    i_c = i;
-                    j_c = j;
-                    k_c = k;
+                    for( int m = 1; m > -2; m -= 2  )
+                    {
+                        i_c = i;
+                        j_c = j;
+                        k_c = k;
 
-                    entry_pos[0] = T( i + 0.5 );
-                    entry_pos[1] = T( j + 0.5 );
-                    entry_pos[2] = T( k + 0.5 );
+                        entry_pos[0] = T( i + 0.5 );
+                        entry_pos[1] = T( j + 0.5 );
+                        entry_pos[2] = T( k + 0.5 );
 
-                    loc_c = counter;
+                        loc_c = counter;
 
-                    while( acc_length < m_length )
-                    {
-                        T   t_min = 1.0e+10;
-                        int l_min = -1;
-                        int inc;
+                        while( acc_length < m_length )
+                        {
+                            T   t_min = 1.0e+10;
+                            int l_min = -1;
+                            int inc;
 
-                        int scalar = noise_data[loc_c];
+                            int scalar = noise_data[loc_c];
 
-                        u = (T)m * kvs::Vector3<T>( src_data + 3 * loc_c );
+                            u = (T)m * kvs::Vector3<T>( src_data + 3 * loc_c );
+                            if( planar ) u[2] = T(0);
 
-                        p[0] = T( i_c );
-                        p[1] = T( j_c );
-                        p[2] = T( k_c );
+                            p[0] = T( i_c );
+                            p[1] = T( j_c );
+                            p[2] = T( k_c );
 
-                        for( int l = 0; l < 3; l++ )
-                        {
-                            if( kvs::Math::IsZero( u[l] ) )
+                            for( int l = 0; l < 3; l++ )
                             {
-                                travel_t[l] = T( 1.1e+10 );
+                                if( kvs::Math::IsZero( u[l] ) )
+                                {
+                                    travel_t[l] = T( 1.1e+10 );
+                                }
+                                else if( u[l] < T(0) )
+                                {
+                                    travel_t[l] = ( p[l] - entry_pos[l] ) / u[l];
+                                }
+                                else
+                                {
+                                    travel_t[l] = ( p[l] + 1 - entry_pos[l] ) / u[l];
+                                }
+
+                                if( travel_t[l] < t_min )
+                                {
+                                    t_min = travel_t[l];
+                                    l_min = l;
+                                }
                             }
-                            else if( u[l] < T(0) )
+
+                            if( l_min == -1 ) break;
+
+                            entry_pos += u * t_min;
+
+                            inc = u[l_min] < T(0) ? -1 : 1;
+
+                            if( l_min == 0 )
                             {
-                                travel_t[l] = ( p[l] - entry_pos[l] ) / u[l];
+                                loc_c += inc;
+                                i_c   += inc;
                             }
-                            else
+                            else if( l_min == 1 )
                             {
-                                travel_t[l] = ( p[l] + 1 - entry_pos[l] ) / u[l];
+                                loc_c += inc * resol.x();
+                                j_c   += inc;
                             }
-
-                            if( travel_t[l] < t_min )
+                            else if( l_min == 2 )
                             {
-                                t_min = travel_t[l];
-                                l_min = l;
+                                loc_c += inc * resol.x() * resol.y();
+                                k_c   += inc;
                             }
-                        }
 
-                        if( l_min == -1 ) break;
+                            T length = t_min * static_cast<T>( u.length() );
 
-                        entry_pos += u * t_min;
+                            /* For small length (close to 0.0) it enters in a infinite loop */
+                            if( kvs::Math::IsZero( length ) ) length = T( 1.1e+10 );
 
-                        inc = u[l_min] < T(0) ? -1 : 1;
+                            if( acc_length < 1.1e-10 ) acc_length = T(0);
 
-                        if( l_min == 0 )
-                        {
-                            loc_c += inc;
-                            i_c   += inc;
-                        }
-                        else if( l_min == 1 )
-                        {
-                            loc_c += inc * resol.x();
-                            j_c   += inc;
-                        }
-                        else if( l_min == 2 )
-                        { 
-                            loc_c += inc * resol.x() * resol.y();
-                            k_c   += inc;
+                            acc_data   += length * scalar;
+                            acc_length += length;
+
+                            if( i_c < 0 || i_c >= static_cast<int>(resol.x()) ||
+                                j_c < 0 || j_c >= static_cast<int>(resol.y()) ||
+                                k_c < 0 || k_c >= static_cast<int>(resol.z()) ) break;
                         }
+                    }
 
-                        T length = t_min * static_cast<T>( u.length() );
+                    acc_data /= acc_length;
+                    dst_data[counter] = (kvs::UInt8)( (int)(acc_data) % 256 );
 
-                        /* For small length (close to 0.0) it enters in a infinite loop */
-                        if( kvs::Math::IsZero( length ) ) length = T( 1.1e+10 );
+                    counter++;
+                }
+            }
+        }
+    }
 
-                        if( acc_length < 1.1e-10 ) acc_length = T(0);
+    SuperClass::setGridType( volume->gridType() );
+    SuperClass::setVeclen( 1 );
+    SuperClass::setResolution( volume->resolution() );
+    SuperClass::setValues( kvs::AnyValueArray( dst_data ) );
+    SuperClass::setMinMaxValues( 0, 255 );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Convolution by the fast LIC.
+ *  @param  volume [i] pointer to a uniform volume data
+ *  @param  dst_data [out] convolved values
+ *
+ *  Streamlines are traced by the midpoint method with the step of a half
+ *  voxel on the vector field interpolated trilinearly between the voxel
+ *  centers. A streamline is seeded at the center of each voxel, in the index
+ *  order, that has been covered by less than the min. number of hits, and is
+ *  traced up to three times the stream length in both directions. The noise
+ *  sampled along it is averaged by a moving box window of the stream length,
+ *  and the average is accumulated into the voxel of each sample.
+ */
+/*===========================================================================*/
+template <typename T>
+void LineIntegralConvolution::fast_convolution(
+    const kvs::StructuredVolumeObject* volume,
+    kvs::ValueArray<kvs::UInt8>& dst_data )
+{
+    const kvs::UInt8* noise_data = static_cast<const kvs::UInt8*>( m_noise->values().data() );
+    const T* src_data = static_cast<const T*>( volume->values().data() );
 
-                        acc_data   += length * scalar;
-                        acc_length += length;
+    const kvs::Vector3ui resol( volume->resolution() );
+    const bool planar = ( resol.z() == 1 );
+    const size_t nnodes = volume->numberOfNodes();
+    const size_t min_hits = kvs::Math::Max( m_min_hits, size_t(1) );
+
+    const double step = 0.5;
+    const size_t window = kvs::Math::Max( static_cast<size_t>( m_length / step ), size_t(1) );
+    const size_t max_steps = window * 3;
+
+    std::vector<double> acc_data( nnodes, 0.0 );
+    std::vector<size_t> hits( nnodes, 0 );
+    std::vector<kvs::UInt32> forward_nodes;
+    std::vector<kvs::UInt32> backward_nodes;
+    std::vector<kvs::UInt32> nodes;
+    std::vector<double> prefix;
+
+    for ( size_t seed = 0; seed < nnodes; seed++ )
+    {
+        if ( hits[ seed ] >= min_hits ) continue;
 
-                        if( i_c < 0 || i_c >= static_cast<int>(resol.x()) ||
-                            j_c < 0 || j_c >= static_cast<int>(resol.y()) ||
-                            k_c < 0 || k_c >= static_cast<int>(resol.z()) ) break;
+        const size_t i = seed % resol.x();
+        const size_t j = ( seed / resol.x() ) % resol.y();
+        const size_t k = seed / ( resol.x() * resol.y() );
+        const kvs::Vector3<double> seed_pos( i + 0.5, j + 0.5, k + 0.5 );
+
+        // Trace the streamline in both directions.
+        for ( int m = 1; m > -2; m -= 2 )
+        {
+            std::vector<kvs::UInt32>& line = ( m == 1 ) ? forward_nodes : backward_nodes;
+            line.clear();
+
+            kvs::Vector3<double> pos = seed_pos;
+            for ( size_t s = 0; s < max_steps; s++ )
+            {
+                // Vector at the position interpolated between the voxel centers.
+                kvs::Vector3<double> v[2];
+                kvs::Vector3<double> x = pos;
+                bool inside = true;
+                for ( int r = 0; r < 2 && inside; r++ )
+                {
+                    double c[3]; size_t c0[3]; size_t c1[3]; double w[3];
+                    for ( int l = 0; l < 3; l++ )
+                    {
+                        const double extent = static_cast<double>( resol[l] );
+                        if ( x[l] < 0.0 || x[l] >= extent ) { inside = false; break; }
+                        c[l] = kvs::Math::Clamp( x[l] - 0.5, 0.0, extent - 1.0 );
+                        c0[l] = static_cast<size_t>( c[l] );
+                        c1[l] = kvs::Math::Min( c0[l] + 1, static_cast<size_t>( resol[l] - 1 ) );
+                        w[l] = c[l] - static_cast<double>( c0[l] );
                     }
+                    if ( !inside ) break;
+
+                    kvs::Vector3<double> u( 0.0, 0.0, 0.0 );
+                    for ( int n = 0; n < 8; n++ )
+                    {
+                        const size_t ii = ( n & 1 ) ? c1[0] : c0[0];
+                        const size_t jj = ( n & 2 ) ? c1[1] : c0[1];
+                        const size_t kk = ( n & 4 ) ? c1[2] : c0[2];
+                        const double weight =
+                            ( ( n & 1 ) ? w[0] : 1.0 - w[0] ) *
+                            ( ( n & 2 ) ? w[1] : 1.0 - w[1] ) *
+                            ( ( n & 4 ) ? w[2] : 1.0 - w[2] );
+                        const T* src = src_data + 3 * ( ( kk * resol.y() + jj ) * resol.x() + ii );
+                        u += weight * kvs::Vector3<double>( src[0], src[1], src[2] );
+                    }
+                    if ( planar ) u[2] = 0.0;
+
+                    const double length = u.length();
+                    if ( kvs::Math::IsZero( length ) ) { inside = false; break; }
+                    v[r] = u * ( m * step / length );
+                    x = pos + v[r] * 0.5;
                 }
 
-                acc_data /= acc_length;
-                dst_data[counter] = (kvs::UInt8)( (int)(acc_data) % 256 );
+                if ( !inside ) break;
+
+                pos += v[1];
+                if ( pos.x() < 0.0 || pos.x() >= resol.x() ||
+                     pos.y() < 0.0 || pos.y() >= resol.y() ||
+                     pos.z() < 0.0 || pos.z() >= resol.z() ) break;
 
-                counter++;
+                const size_t ii = static_cast<size_t>( pos.x() );
+                const size_t jj = static_cast<size_t>( pos.y() );
+                const size_t kk = static_cast<size_t>( pos.z() );
+                line.push_back( static_cast<kvs::UInt32>( ( kk * resol.y() + jj ) * resol.x() + ii ) );
             }
         }
+
+        // Voxels of the samples along the streamline from the backward end.
+        nodes.assign( backward_nodes.rbegin(), backward_nodes.rend() );
+        nodes.push_back( static_cast<kvs::UInt32>( seed ) );
+        nodes.insert( nodes.end(), forward_nodes.begin(), forward_nodes.end() );
+
+        // Moving-window average of the noise with the prefix sum.
+        const size_t nsamples = nodes.size();
+        prefix.resize( nsamples + 1 );
+        prefix[0] = 0.0;
+        for ( size_t s = 0; s < nsamples; s++ ) { prefix[ s + 1 ] = prefix[s] + noise_data[ nodes[s] ]; }
+
+        for ( size_t s = 0; s < nsamples; s++ )
+        {
+            const size_t lower = s > window ? s - window : 0;
+            const size_t upper = kvs::Math::Min( s + window + 1, nsamples );
+            acc_data[ nodes[s] ] += ( prefix[ upper ] - prefix[ lower ] ) / static_cast<double>( upper - lower );
+            hits[ nodes[s] ]++;
+        }
     }
 
-    SuperClass::setGridType( volume->gridType() );
-    SuperClass::setVeclen( 1 );
-    SuperClass::setResolution( volume->resolution() );
-    SuperClass::setValues( kvs::AnyValueArray( dst_data ) );
-    SuperClass::setMinMaxValues( 0, 255 );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < nnodes; i++ )
+    {
+        const double value = hits[i] > 0 ? acc_data[i] / static_cast<double>( hits[i] ) : 0.0;
+        dst_data[i] = static_cast<kvs::UInt8>( kvs::Math::Clamp( value, 0.0, 255.0 ) );
+    }
 }
 
 } // end of namespace kvs
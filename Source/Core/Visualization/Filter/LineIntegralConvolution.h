@@ -26,6 +26,15 @@ namespace kvs
 /*===========================================================================*/
 /**
  *  @brief  LIC class.
+ *
+ *  StandardLIC convolves the noise along a streamline traced from every
+ *  voxel, and the voxels are processed in parallel. FastLIC traces long
+ *  streamlines from the voxels that are not covered enough yet, and every
+ *  voxel on the streamline receives the moving-window average of the noise
+ *  along it (D. Stalling and H.-C. Hege, "Fast and Resolution Independent
+ *  Line Integral Convolution", SIGGRAPH 1995). A volume whose z resolution
+ *  is one is treated as a 2D image, and the z component of the vectors is
+ *  ignored.
  */
 /*===========================================================================*/
 class LineIntegralConvolution : public kvs::FilterBase, public kvs::StructuredVolumeObject
@@ -34,19 +43,33 @@ class LineIntegralConvolution : public kvs::FilterBase, public kvs::StructuredVo
     kvsModuleBaseClass( kvs::FilterBase );
     kvsModuleSuperClass( kvs::StructuredVolumeObject );
 
+public:
+
+    enum Method
+    {
+        StandardLIC, ///< streamline traced for each voxel
+        FastLIC ///< streamline shared by the voxels it covers
+    };
+
 protected:
 
     double m_length; ///< stream length
     kvs::StructuredVolumeObject* m_noise; ///< white noise volume
+    Method m_method; ///< convolution method
+    size_t m_min_hits; ///< min. number of the streamlines covering each voxel (FastLIC)
 
 public:
 
     LineIntegralConvolution();
     LineIntegralConvolution( const kvs::StructuredVolumeObject* volume );
-    LineIntegralConvolution( const kvs::StructuredVolumeObject* volume, const double length );
+    LineIntegralConvolution( const kvs::StructuredVolumeObject* volume, const double length, const Method method = StandardLIC );
     virtual ~LineIntegralConvolution();
 
     void setLength( const double length );
+    void setMethod( const Method method ) { m_method = method; }
+    void setMethodToStandardLIC() { this->setMethod( StandardLIC ); }
+    void setMethodToFastLIC() { this->setMethod( FastLIC ); }
+    void setMinimumNumberOfHits( const size_t min_hits ) { m_min_hits = min_hits; }
 
     SuperClass* exec( const kvs::ObjectBase* object );
 
@@ -56,6 +79,8 @@ protected:
     void create_noise_volume( const kvs::StructuredVolumeObject* volume );
     template <typename T>
     void convolution( const kvs::StructuredVolumeObject* volume );
+    template <typename T>
+    void fast_convolution( const kvs::StructuredVolumeObject* volume, kvs::ValueArray<kvs::UInt8>& dst_data );
 };
 
 } // end of namespace kvs
@@ -0,0 +1,116 @@
+/*****************************************************************************/
+/**
+ *  @file   ParallelSort.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <kvs/Type>
+#include <kvs/Math>
+#include <kvs/OpenMP>
+#include <kvs/ValueArray>
+
+
+namespace kvs
+{
+
+namespace detail
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Sorts the keys by sorting the chunks in parallel and merging them.
+ *  @param  keys [in/out] keys
+ */
+/*===========================================================================*/
+template <typename Key>
+inline void SortKeys( std::vector<Key>& keys )
+{
+    const size_t nkeys = keys.size();
+    const size_t nchunks = static_cast<size_t>( kvs::Math::Max( kvs::OpenMP::GetMaxThreads(), 1 ) );
+    if ( nchunks == 1 || nkeys < nchunks * 1024 )
+    {
+        std::sort( keys.begin(), keys.end() );
+        return;
+    }
+
+    std::vector<size_t> bounds( nchunks + 1 );
+    for ( size_t i = 0; i <= nchunks; i++ ) { bounds[i] = nkeys * i / nchunks; }
+
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < nchunks; i++ )
+    {
+        std::sort( keys.begin() + bounds[i], keys.begin() + bounds[i+1] );
+    }
+
+    std::vector<Key> buffer( nkeys );
+    for ( size_t width = 1; width < nchunks; width *= 2 )
+    {
+        const size_t nmerges = ( nchunks + 2 * width - 1 ) / ( 2 * width );
+        KVS_OMP_PARALLEL_FOR( schedule(static) )
+        for ( size_t m = 0; m < nmerges; m++ )
+        {
+            const size_t lower = bounds[ 2 * width * m ];
+            const size_t middle = bounds[ kvs::Math::Min( 2 * width * m + width, nchunks ) ];
+            const size_t upper = bounds[ kvs::Math::Min( 2 * width * ( m + 1 ), nchunks ) ];
+            std::merge(
+                keys.begin() + lower, keys.begin() + middle,
+                keys.begin() + middle, keys.begin() + upper,
+                buffer.begin() + lower );
+        }
+        keys.swap( buffer );
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Converts the flags to the exclusive prefix sum in parallel.
+ *  @param  flags [in/out] 0 or 1 for each element, replaced with the prefix sum
+ *  @return total of the flags
+ */
+/*===========================================================================*/
+inline kvs::UInt32 ExclusiveScan( kvs::ValueArray<kvs::UInt32>& flags )
+{
+    const size_t n = flags.size();
+    const size_t nthreads = static_cast<size_t>( kvs::Math::Max( kvs::OpenMP::GetMaxThreads(), 1 ) );
+    std::vector<size_t> bounds( nthreads + 1 );
+    for ( size_t t = 0; t <= nthreads; t++ ) { bounds[t] = n * t / nthreads; }
+
+    std::vector<kvs::UInt32> sums( nthreads + 1, 0 );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t t = 0; t < nthreads; t++ )
+    {
+        kvs::UInt32 sum = 0;
+        for ( size_t i = bounds[t]; i < bounds[t+1]; i++ ) { sum += flags[i]; }
+        sums[ t + 1 ] = sum;
+    }
+
+    for ( size_t t = 0; t < nthreads; t++ ) { sums[ t + 1 ] += sums[t]; }
+
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t t = 0; t < nthreads; t++ )
+    {
+        kvs::UInt32 sum = sums[t];
+        for ( size_t i = bounds[t]; i < bounds[t+1]; i++ )
+        {
+            const kvs::UInt32 flag = flags[i];
+            flags[i] = sum;
+            sum += flag;
+        }
+    }
+
+    return sums[ nthreads ];
+}
+
+} // end of namespace detail
+
+} // end of namespace kvs
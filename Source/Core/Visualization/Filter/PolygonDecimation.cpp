@@ -0,0 +1,1020 @@
+/*****************************************************************************/
+/**
+ *  @file   PolygonDecimation.cpp
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "PolygonDecimation.h"
+#include "ParallelSort.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <cmath>
+#include <kvs/Math>
+#include <kvs/OpenMP>
+#include <kvs/ValueArray>
+#include <kvs/Vector3>
+#include <kvs/RGBColor>
+
+
+namespace
+{
+
+/// Owner of the vertices shared by the blocks.
+const kvs::Int32 Locked = -1;
+
+/// Block of the cleanup pass, in which any vertex can be collapsed.
+const kvs::Int32 Global = -2;
+
+/*===========================================================================*/
+/**
+ *  @brief  Coordinate of the input vertex to weld the vertices.
+ */
+/*===========================================================================*/
+struct WeldKey
+{
+    kvs::Real32 x;
+    kvs::Real32 y;
+    kvs::Real32 z;
+    kvs::UInt32 index;
+
+    bool operator <( const WeldKey& other ) const
+    {
+        if ( x != other.x ) { return x < other.x; }
+        if ( y != other.y ) { return y < other.y; }
+        if ( z != other.z ) { return z < other.z; }
+        return index < other.index;
+    }
+
+    bool hasSamePosition( const WeldKey& other ) const
+    {
+        return x == other.x && y == other.y && z == other.z;
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Welds the vertices with the same coordinate.
+ *  @param  coords [in] coordinates of the input vertices
+ *  @param  ids [out] welded vertex of each input vertex
+ *  @param  representatives [out] first input vertex of each welded vertex
+ *  @return number of the welded vertices
+ *
+ *  The welded vertices are numbered in the order of their first input vertices.
+ */
+/*===========================================================================*/
+size_t Weld(
+    const kvs::ValueArray<kvs::Real32>& coords,
+    kvs::ValueArray<kvs::UInt32>& ids,
+    kvs::ValueArray<kvs::UInt32>& representatives )
+{
+    const size_t npoints = coords.size() / 3;
+    std::vector<WeldKey> keys( npoints );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < npoints; i++ )
+    {
+        keys[i].x = coords[ 3 * i + 0 ];
+        keys[i].y = coords[ 3 * i + 1 ];
+        keys[i].z = coords[ 3 * i + 2 ];
+        keys[i].index = static_cast<kvs::UInt32>( i );
+    }
+
+    kvs::detail::SortKeys( keys );
+
+    // The head of each group of the sorted keys is the first input vertex.
+    kvs::ValueArray<kvs::UInt32> heads( npoints );
+    kvs::UInt32 head = 0;
+    for ( size_t i = 0; i < npoints; i++ )
+    {
+        if ( i == 0 || !keys[i].hasSamePosition( keys[ i - 1 ] ) ) { head = keys[i].index; }
+        heads[ keys[i].index ] = head;
+    }
+
+    kvs::ValueArray<kvs::UInt32> ranks( npoints );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < npoints; i++ )
+    {
+        ranks[i] = ( heads[i] == i ) ? 1 : 0;
+    }
+
+    const size_t nvertices = kvs::detail::ExclusiveScan( ranks );
+
+    ids.allocate( npoints );
+    representatives.allocate( nvertices );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < npoints; i++ )
+    {
+        ids[i] = ranks[ heads[i] ];
+        if ( heads[i] == i ) { representatives[ ranks[i] ] = static_cast<kvs::UInt32>( i ); }
+    }
+
+    return nvertices;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the normal vector of the triangle.
+ *  @param  p0 [in] coordinate of the 1st vertex
+ *  @param  p1 [in] coordinate of the 2nd vertex
+ *  @param  p2 [in] coordinate of the 3rd vertex
+ *  @return normal vector whose length is twice the area
+ */
+/*===========================================================================*/
+inline kvs::Vec3d Normal( const kvs::Vec3d& p0, const kvs::Vec3d& p1, const kvs::Vec3d& p2 )
+{
+    return ( p1 - p0 ).cross( p2 - p0 );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if the triangle has the vertex.
+ */
+/*===========================================================================*/
+inline bool Contains( const kvs::UInt32* triangle, const kvs::UInt32 vertex )
+{
+    return triangle[0] == vertex || triangle[1] == vertex || triangle[2] == vertex;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Quadric error of the squared distances to the planes.
+ *
+ *  The quadric is the symmetric 4x4 matrix sum(w p p^T) of the planes
+ *  p = (a,b,c,d) with ax+by+cz+d = 0, stored as the upper triangle.
+ */
+/*===========================================================================*/
+class Quadric
+{
+private:
+
+    double m_a[10]; ///< a00, a01, a02, a03, a11, a12, a13, a22, a23, a33
+
+public:
+
+    Quadric() { std::fill( m_a, m_a + 10, 0.0 ); }
+
+    void addPlane( const kvs::Vec3d& n, const double d, const double w )
+    {
+        m_a[0] += w * n[0] * n[0];
+        m_a[1] += w * n[0] * n[1];
+        m_a[2] += w * n[0] * n[2];
+        m_a[3] += w * n[0] * d;
+        m_a[4] += w * n[1] * n[1];
+        m_a[5] += w * n[1] * n[2];
+        m_a[6] += w * n[1] * d;
+        m_a[7] += w * n[2] * n[2];
+        m_a[8] += w * n[2] * d;
+        m_a[9] += w * d * d;
+    }
+
+    Quadric& operator +=( const Quadric& other )
+    {
+        for ( int i = 0; i < 10; i++ ) { m_a[i] += other.m_a[i]; }
+        return *this;
+    }
+
+    double evaluate( const kvs::Vec3d& p ) const
+    {
+        const double x = p[0];
+        const double y = p[1];
+        const double z = p[2];
+        return
+            m_a[0] * x * x + 2.0 * m_a[1] * x * y + 2.0 * m_a[2] * x * z + 2.0 * m_a[3] * x +
+            m_a[4] * y * y + 2.0 * m_a[5] * y * z + 2.0 * m_a[6] * y +
+            m_a[7] * z * z + 2.0 * m_a[8] * z +
+            m_a[9];
+    }
+
+    bool minimize( kvs::Vec3d* p ) const
+    {
+        // Solve A p = -b by Cramer's rule, where A is the upper-left 3x3
+        // matrix and b is (a03,a13,a23). A nearly singular A (the planes are
+        // nearly parallel) has no unique minimum.
+        const double c00 = m_a[4] * m_a[7] - m_a[5] * m_a[5];
+        const double c01 = m_a[2] * m_a[5] - m_a[1] * m_a[7];
+        const double c02 = m_a[1] * m_a[5] - m_a[2] * m_a[4];
+        const double c11 = m_a[0] * m_a[7] - m_a[2] * m_a[2];
+        const double c12 = m_a[1] * m_a[2] - m_a[0] * m_a[5];
+        const double c22 = m_a[0] * m_a[4] - m_a[1] * m_a[1];
+        const double det = m_a[0] * c00 + m_a[1] * c01 + m_a[2] * c02;
+        const double trace = m_a[0] + m_a[4] + m_a[7];
+        if ( !( std::fabs( det ) > 1.0e-6 * trace * trace * trace ) ) { return false; }
+
+        const double bx = -m_a[3];
+        const double by = -m_a[6];
+        const double bz = -m_a[8];
+        *p = kvs::Vec3d(
+            ( c00 * bx + c01 * by + c02 * bz ) / det,
+            ( c01 * bx + c11 * by + c12 * bz ) / det,
+            ( c02 * bx + c12 * by + c22 * bz ) / det );
+        return true;
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Collapse of the edge (vertex1 is merged into vertex0).
+ */
+/*===========================================================================*/
+struct Candidate
+{
+    double cost; ///< quadric error at the position
+    kvs::UInt32 vertex0; ///< vertex to be kept
+    kvs::UInt32 vertex1; ///< vertex to be removed
+    kvs::UInt32 stamp0; ///< stamp of vertex0 when the candidate is made
+    kvs::UInt32 stamp1; ///< stamp of vertex1 when the candidate is made
+    kvs::Real32 position[3]; ///< position of the merged vertex
+    kvs::Real32 t; ///< parameter of the position along the edge from vertex0
+};
+
+struct CandidateGreater
+{
+    bool operator ()( const Candidate& a, const Candidate& b ) const
+    {
+        if ( a.cost != b.cost ) { return a.cost > b.cost; }
+        if ( a.vertex0 != b.vertex0 ) { return a.vertex0 > b.vertex0; }
+        return a.vertex1 > b.vertex1;
+    }
+};
+
+struct IsDead
+{
+    const std::vector<kvs::UInt8>* alive;
+    IsDead( const std::vector<kvs::UInt8>* a ): alive( a ) {}
+    bool operator ()( const kvs::UInt32 triangle ) const { return ( *alive )[ triangle ] == 0; }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Triangle mesh to be decimated.
+ *
+ *  decimate() only collapses the edges between the vertices owned by the
+ *  block, and only reads the other vertices, so that the blocks can be
+ *  decimated in parallel. The triangles around a vertex (star) can contain
+ *  removed triangles.
+ */
+/*===========================================================================*/
+class Mesh
+{
+public:
+
+    std::vector<kvs::Real32> coords; ///< coordinates of the vertices
+    std::vector<kvs::UInt32> triangles; ///< vertex indices of the triangles
+    std::vector<kvs::UInt8> alive; ///< 1 if the triangle is not removed
+    std::vector< std::vector<kvs::UInt32> > stars; ///< triangles around each vertex
+    std::vector<Quadric> quadrics; ///< quadric of each vertex
+    std::vector<kvs::Int32> owners; ///< block owning each vertex (or Locked)
+    std::vector<kvs::UInt32> stamps; ///< incremented when the vertex is changed
+    std::vector<kvs::UInt8> boundaries; ///< 1 if the vertex is on the boundary
+    std::vector<kvs::Real32> attributes; ///< interpolated attributes of the vertices
+    size_t nattributes; ///< number of the attributes per vertex
+    double max_error; ///< max. quadric error (0: unlimited)
+
+    Mesh(): nattributes( 0 ), max_error( 0.0 ) {}
+
+    void setup( const double boundary_weight );
+    size_t decimate(
+        const kvs::UInt32* seeds,
+        const size_t nseeds,
+        const kvs::Int32 block,
+        size_t ntriangles,
+        const size_t target );
+
+private:
+
+    kvs::Vec3d position( const kvs::UInt32 vertex ) const
+    {
+        const kvs::Real32* p = &coords[ 3 * vertex ];
+        return kvs::Vec3d( p[0], p[1], p[2] );
+    }
+
+    bool is_free( const kvs::UInt32 vertex, const kvs::Int32 block ) const
+    {
+        return block == ::Global || owners[ vertex ] == block;
+    }
+
+    size_t count_triangles( const kvs::UInt32 vertex0, const kvs::UInt32 vertex1 ) const;
+    void gather_neighbors( const kvs::UInt32 vertex, std::vector<kvs::UInt32>& neighbors ) const;
+    void make_candidate( const kvs::UInt32 vertex0, const kvs::UInt32 vertex1, Candidate* candidate ) const;
+    bool is_valid_move( const kvs::UInt32 vertex, const kvs::UInt32 other, const kvs::Vec3d& p ) const;
+    size_t collapse( const Candidate& candidate, std::vector<kvs::UInt32>& buffer0, std::vector<kvs::UInt32>& buffer1 );
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Builds the stars, the boundary flags and the quadrics.
+ *  @param  boundary_weight [in] weight of the planes along the boundary edges
+ *
+ *  The triangles must be set with the alive flags. The quadric of a vertex
+ *  is the sum of the planes of the triangles around it weighted by the
+ *  area, and the planes perpendicular to the triangles along the boundary
+ *  edges weighted by the squared length of the edge times boundary_weight.
+ */
+/*===========================================================================*/
+void Mesh::setup( const double boundary_weight )
+{
+    const size_t nvertices = coords.size() / 3;
+    const size_t ntriangles = triangles.size() / 3;
+    stars.assign( nvertices, std::vector<kvs::UInt32>() );
+    for ( size_t i = 0; i < ntriangles; i++ )
+    {
+        if ( !alive[i] ) { continue; }
+        for ( size_t k = 0; k < 3; k++ ) { stars[ triangles[ 3 * i + k ] ].push_back( static_cast<kvs::UInt32>( i ) ); }
+    }
+
+    quadrics.assign( nvertices, Quadric() );
+    stamps.assign( nvertices, 0 );
+    boundaries.assign( nvertices, 0 );
+
+    KVS_OMP_PARALLEL_FOR( schedule(dynamic, 1024) )
+    for ( size_t i = 0; i < nvertices; i++ )
+    {
+        const kvs::UInt32 vertex = static_cast<kvs::UInt32>( i );
+        const std::vector<kvs::UInt32>& star = stars[i];
+        for ( size_t j = 0; j < star.size(); j++ )
+        {
+            const kvs::UInt32* triangle = &triangles[ 3 * star[j] ];
+            const kvs::Vec3d p0 = this->position( triangle[0] );
+            const kvs::Vec3d n = ::Normal( p0, this->position( triangle[1] ), this->position( triangle[2] ) );
+            const double length = n.length();
+            if ( length <= 0.0 ) { continue; }
+
+            const kvs::Vec3d normal = n / length;
+            quadrics[i].addPlane( normal, -normal.dot( p0 ), 0.5 * length );
+
+            const size_t k = triangle[0] == vertex ? 0 : ( triangle[1] == vertex ? 1 : 2 );
+            for ( size_t e = 1; e < 3; e++ )
+            {
+                const kvs::UInt32 other = triangle[ ( k + e ) % 3 ];
+                if ( this->count_triangles( vertex, other ) != 1 ) { continue; }
+
+                boundaries[i] = 1;
+                if ( boundary_weight <= 0.0 ) { continue; }
+
+                const kvs::Vec3d p = this->position( vertex );
+                const kvs::Vec3d edge = this->position( other ) - p;
+                const kvs::Vec3d m = edge.cross( normal );
+                const double m_length = m.length();
+                if ( m_length <= 0.0 ) { continue; }
+
+                const kvs::Vec3d plane = m / m_length;
+                quadrics[i].addPlane( plane, -plane.dot( p ), boundary_weight * edge.dot( edge ) );
+            }
+        }
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Decimates the triangles of the block.
+ *  @param  seeds [in] triangles whose edges are the initial candidates
+ *  @param  nseeds [in] number of the seeds
+ *  @param  block [in] block index (or Global)
+ *  @param  ntriangles [in] current number of the triangles
+ *  @param  target [in] target number of the triangles
+ *  @return number of the triangles after the decimation
+ */
+/*===========================================================================*/
+size_t Mesh::decimate(
+    const kvs::UInt32* seeds,
+    const size_t nseeds,
+    const kvs::Int32 block,
+    size_t ntriangles,
+    const size_t target )
+{
+    if ( ntriangles <= target ) { return ntriangles; }
+
+    std::vector< std::pair<kvs::UInt32,kvs::UInt32> > edges;
+    edges.reserve( nseeds * 3 );
+    for ( size_t i = 0; i < nseeds; i++ )
+    {
+        if ( !alive[ seeds[i] ] ) { continue; }
+        const kvs::UInt32* triangle = &triangles[ 3 * seeds[i] ];
+        for ( size_t k = 0; k < 3; k++ )
+        {
+            const kvs::UInt32 v0 = triangle[k];
+            const kvs::UInt32 v1 = triangle[ ( k + 1 ) % 3 ];
+            if ( !this->is_free( v0, block ) || !this->is_free( v1, block ) ) { continue; }
+            edges.push_back( std::make_pair( kvs::Math::Min( v0, v1 ), kvs::Math::Max( v0, v1 ) ) );
+        }
+    }
+    std::sort( edges.begin(), edges.end() );
+    edges.erase( std::unique( edges.begin(), edges.end() ), edges.end() );
+
+    std::vector<Candidate> heap( edges.size() );
+    for ( size_t i = 0; i < edges.size(); i++ )
+    {
+        this->make_candidate( edges[i].first, edges[i].second, &heap[i] );
+    }
+    std::vector< std::pair<kvs::UInt32,kvs::UInt32> >().swap( edges );
+    std::make_heap( heap.begin(), heap.end(), ::CandidateGreater() );
+
+    std::vector<kvs::UInt32> buffer0;
+    std::vector<kvs::UInt32> buffer1;
+    while ( ntriangles > target && !heap.empty() )
+    {
+        std::pop_heap( heap.begin(), heap.end(), ::CandidateGreater() );
+        const Candidate candidate = heap.back();
+        heap.pop_back();
+
+        // The candidates made before the change of the vertices are discarded.
+        if ( stamps[ candidate.vertex0 ] != candidate.stamp0 ) { continue; }
+        if ( stamps[ candidate.vertex1 ] != candidate.stamp1 ) { continue; }
+        if ( max_error > 0.0 && candidate.cost > max_error ) { break; }
+
+        const size_t nremoved = this->collapse( candidate, buffer0, buffer1 );
+        if ( nremoved == 0 ) { continue; }
+        ntriangles -= kvs::Math::Min( nremoved, ntriangles );
+
+        const kvs::UInt32 vertex = candidate.vertex0;
+        this->gather_neighbors( vertex, buffer0 );
+        for ( size_t i = 0; i < buffer0.size(); i++ )
+        {
+            const kvs::UInt32 other = buffer0[i];
+            if ( !this->is_free( other, block ) ) { continue; }
+
+            Candidate c;
+            this->make_candidate( kvs::Math::Min( vertex, other ), kvs::Math::Max( vertex, other ), &c );
+            heap.push_back( c );
+            std::push_heap( heap.begin(), heap.end(), ::CandidateGreater() );
+        }
+    }
+
+    return ntriangles;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the number of the triangles sharing the edge.
+ */
+/*===========================================================================*/
+size_t Mesh::count_triangles( const kvs::UInt32 vertex0, const kvs::UInt32 vertex1 ) const
+{
+    size_t counter = 0;
+    const std::vector<kvs::UInt32>& star = stars[ vertex0 ];
+    for ( size_t i = 0; i < star.size(); i++ )
+    {
+        if ( alive[ star[i] ] && ::Contains( &triangles[ 3 * star[i] ], vertex1 ) ) { counter++; }
+    }
+    return counter;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Gathers the vertices adjacent to the vertex in ascending order.
+ */
+/*===========================================================================*/
+void Mesh::gather_neighbors( const kvs::UInt32 vertex, std::vector<kvs::UInt32>& neighbors ) const
+{
+    neighbors.clear();
+    const std::vector<kvs::UInt32>& star = stars[ vertex ];
+    for ( size_t i = 0; i < star.size(); i++ )
+    {
+        if ( !alive[ star[i] ] ) { continue; }
+        const kvs::UInt32* triangle = &triangles[ 3 * star[i] ];
+        for ( size_t k = 0; k < 3; k++ )
+        {
+            if ( triangle[k] != vertex ) { neighbors.push_back( triangle[k] ); }
+        }
+    }
+    std::sort( neighbors.begin(), neighbors.end() );
+    neighbors.erase( std::unique( neighbors.begin(), neighbors.end() ), neighbors.end() );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Makes the collapse of the edge.
+ *  @param  vertex0 [in] vertex to be kept
+ *  @param  vertex1 [in] vertex to be removed
+ *  @param  candidate [out] collapse
+ *
+ *  The merged vertex is placed at the minimum of the sum of the quadrics, or
+ *  at the best of the end points and the midpoint if the minimum is not unique.
+ */
+/*===========================================================================*/
+void Mesh::make_candidate( const kvs::UInt32 vertex0, const kvs::UInt32 vertex1, Candidate* candidate ) const
+{
+    Quadric q = quadrics[ vertex0 ];
+    q += quadrics[ vertex1 ];
+
+    const kvs::Vec3d p0 = this->position( vertex0 );
+    const kvs::Vec3d p1 = this->position( vertex1 );
+    kvs::Vec3d p;
+    double cost = 0.0;
+    if ( q.minimize( &p ) )
+    {
+        cost = q.evaluate( p );
+    }
+    else
+    {
+        const kvs::Vec3d pm = ( p0 + p1 ) * 0.5;
+        const double e0 = q.evaluate( p0 );
+        const double e1 = q.evaluate( p1 );
+        const double em = q.evaluate( pm );
+        if ( e0 <= e1 && e0 <= em ) { p = p0; cost = e0; }
+        else if ( e1 <= em ) { p = p1; cost = e1; }
+        else { p = pm; cost = em; }
+    }
+
+    const kvs::Vec3d edge = p1 - p0;
+    const double length2 = edge.dot( edge );
+    const double t = length2 > 0.0 ? ( p - p0 ).dot( edge ) / length2 : 0.0;
+
+    candidate->cost = kvs::Math::Max( cost, 0.0 );
+    candidate->vertex0 = vertex0;
+    candidate->vertex1 = vertex1;
+    candidate->stamp0 = stamps[ vertex0 ];
+    candidate->stamp1 = stamps[ vertex1 ];
+    candidate->position[0] = static_cast<kvs::Real32>( p[0] );
+    candidate->position[1] = static_cast<kvs::Real32>( p[1] );
+    candidate->position[2] = static_cast<kvs::Real32>( p[2] );
+    candidate->t = static_cast<kvs::Real32>( kvs::Math::Clamp( t, 0.0, 1.0 ) );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if the triangles around the vertex are not flipped by the move.
+ *  @param  vertex [in] vertex to be moved
+ *  @param  other [in] other vertex of the collapsed edge
+ *  @param  p [in] new position of the vertex
+ */
+/*===========================================================================*/
+bool Mesh::is_valid_move( const kvs::UInt32 vertex, const kvs::UInt32 other, const kvs::Vec3d& p ) const
+{
+    const std::vector<kvs::UInt32>& star = stars[ vertex ];
+    for ( size_t i = 0; i < star.size(); i++ )
+    {
+        if ( !alive[ star[i] ] ) { continue; }
+        const kvs::UInt32* triangle = &triangles[ 3 * star[i] ];
+        if ( ::Contains( triangle, other ) ) { continue; }
+
+        kvs::Vec3d q[3];
+        for ( size_t k = 0; k < 3; k++ ) { q[k] = this->position( triangle[k] ); }
+        const kvs::Vec3d n_old = ::Normal( q[0], q[1], q[2] );
+        for ( size_t k = 0; k < 3; k++ ) { if ( triangle[k] == vertex ) { q[k] = p; } }
+        const kvs::Vec3d n_new = ::Normal( q[0], q[1], q[2] );
+        if ( n_old.dot( n_new ) <= 0.0 ) { return false; }
+    }
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Collapses the edge.
+ *  @param  candidate [in] collapse
+ *  @param  buffer0 [in] work buffer
+ *  @param  buffer1 [in] work buffer
+ *  @return number of the removed triangles (0 if the collapse is rejected)
+ *
+ *  The collapse is rejected if the edge is non-manifold, if it connects two
+ *  boundary vertices through the interior, if the link condition (the common
+ *  neighbors of the end points are the opposite vertices of the edge) is
+ *  not satisfied, or if a triangle would be flipped.
+ */
+/*===========================================================================*/
+size_t Mesh::collapse(
+    const Candidate& candidate,
+    std::vector<kvs::UInt32>& buffer0,
+    std::vector<kvs::UInt32>& buffer1 )
+{
+    const kvs::UInt32 vertex0 = candidate.vertex0;
+    const kvs::UInt32 vertex1 = candidate.vertex1;
+    const size_t nshared = this->count_triangles( vertex1, vertex0 );
+    if ( nshared == 0 || nshared > 2 ) { return 0; }
+    if ( nshared == 2 && boundaries[ vertex0 ] && boundaries[ vertex1 ] ) { return 0; }
+
+    this->gather_neighbors( vertex0, buffer0 );
+    this->gather_neighbors( vertex1, buffer1 );
+    size_t ncommons = 0;
+    for ( size_t i = 0, j = 0; i < buffer0.size() && j < buffer1.size(); )
+    {
+        if ( buffer0[i] < buffer1[j] ) { i++; }
+        else if ( buffer1[j] < buffer0[i] ) { j++; }
+        else { ncommons++; i++; j++; }
+    }
+    if ( ncommons != nshared ) { return 0; }
+
+    const kvs::Vec3d p( candidate.position[0], candidate.position[1], candidate.position[2] );
+    if ( !this->is_valid_move( vertex0, vertex1, p ) ) { return 0; }
+    if ( !this->is_valid_move( vertex1, vertex0, p ) ) { return 0; }
+
+    // The shared triangles are removed and the others are moved to vertex0.
+    std::vector<kvs::UInt32>& star0 = stars[ vertex0 ];
+    std::vector<kvs::UInt32>& star1 = stars[ vertex1 ];
+    for ( size_t i = 0; i < star1.size(); i++ )
+    {
+        const kvs::UInt32 index = star1[i];
+        if ( !alive[ index ] ) { continue; }
+
+        kvs::UInt32* triangle = &triangles[ 3 * index ];
+        if ( ::Contains( triangle, vertex0 ) )
+        {
+            alive[ index ] = 0;
+            continue;
+        }
+
+        for ( size_t k = 0; k < 3; k++ ) { if ( triangle[k] == vertex1 ) { triangle[k] = vertex0; } }
+        star0.push_back( index );
+    }
+    std::vector<kvs::UInt32>().swap( star1 );
+    star0.erase( std::remove_if( star0.begin(), star0.end(), ::IsDead( &alive ) ), star0.end() );
+
+    for ( size_t k = 0; k < 3; k++ ) { coords[ 3 * vertex0 + k ] = candidate.position[k]; }
+    quadrics[ vertex0 ] += quadrics[ vertex1 ];
+    boundaries[ vertex0 ] = boundaries[ vertex0 ] | boundaries[ vertex1 ];
+
+    const kvs::Real32 t = candidate.t;
+    kvs::Real32* a0 = nattributes > 0 ? &attributes[ vertex0 * nattributes ] : NULL;
+    const kvs::Real32* a1 = nattributes > 0 ? &attributes[ vertex1 * nattributes ] : NULL;
+    for ( size_t k = 0; k < nattributes; k++ ) { a0[k] = ( 1.0f - t ) * a0[k] + t * a1[k]; }
+
+    stamps[ vertex0 ]++;
+    stamps[ vertex1 ]++;
+    return nshared;
+}
+
+} // end of namespace
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new PolygonDecimation class.
+ */
+/*===========================================================================*/
+PolygonDecimation::PolygonDecimation():
+    m_target_ntriangles( 0 ),
+    m_target_ratio( 0.5f ),
+    m_max_error( 0.0 ),
+    m_boundary_weight( 1000.0 ),
+    m_block_size( 65536 )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new PolygonDecimation class.
+ *  @param  object [in] pointer to the triangle polygon object
+ *  @param  ratio [in] target ratio of the number of the triangles
+ */
+/*===========================================================================*/
+PolygonDecimation::PolygonDecimation( const kvs::PolygonObject* object, const float ratio ):
+    m_target_ntriangles( 0 ),
+    m_target_ratio( ratio ),
+    m_max_error( 0.0 ),
+    m_boundary_weight( 1000.0 ),
+    m_block_size( 65536 )
+{
+    this->exec( object );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Destroys the PolygonDecimation class.
+ */
+/*===========================================================================*/
+PolygonDecimation::~PolygonDecimation()
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Executes the decimation.
+ *  @param  object [in] pointer to the triangle polygon object
+ *  @return pointer to the decimated polygon object
+ */
+/*===========================================================================*/
+PolygonDecimation::SuperClass* PolygonDecimation::exec( const kvs::ObjectBase* object )
+{
+    if ( !object )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input object is NULL.");
+        return NULL;
+    }
+
+    const kvs::PolygonObject* polygon = kvs::PolygonObject::DownCast( object );
+    if ( !polygon )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input object is not polygon object.");
+        return NULL;
+    }
+
+    if ( polygon->polygonType() != kvs::PolygonObject::Triangle )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Polygon type is not triangle.");
+        return NULL;
+    }
+
+    const size_t ninput_vertices = polygon->numberOfVertices();
+    const bool indexed = polygon->numberOfConnections() > 0;
+    const size_t ntriangles = indexed ? polygon->numberOfConnections() : ninput_vertices / 3;
+    const bool has_vertex_color =
+        polygon->colorType() == kvs::PolygonObject::VertexColor &&
+        polygon->numberOfColors() == ninput_vertices && ninput_vertices > 1;
+    const bool has_polygon_color =
+        polygon->colorType() == kvs::PolygonObject::PolygonColor &&
+        polygon->numberOfColors() == ntriangles && ntriangles > 1;
+    const bool has_vertex_normal =
+        polygon->normalType() == kvs::PolygonObject::VertexNormal &&
+        polygon->numberOfNormals() == ninput_vertices;
+    const bool has_polygon_normal = polygon->numberOfNormals() > 0 && !has_vertex_normal;
+    const bool has_polygon_opacity = polygon->numberOfOpacities() == ntriangles && ntriangles > 1;
+
+    // The vertices of the unindexed triangles are welded.
+    ::Mesh mesh;
+    kvs::ValueArray<kvs::UInt32> representatives;
+    const kvs::ValueArray<kvs::Real32>& input_coords = polygon->coords();
+    if ( indexed )
+    {
+        mesh.triangles.assign( polygon->connections().begin(), polygon->connections().end() );
+        representatives.allocate( ninput_vertices );
+        for ( size_t i = 0; i < ninput_vertices; i++ ) { representatives[i] = static_cast<kvs::UInt32>( i ); }
+    }
+    else
+    {
+        kvs::ValueArray<kvs::UInt32> ids;
+        ::Weld( input_coords, ids, representatives );
+        mesh.triangles.assign( ids.begin(), ids.begin() + ntriangles * 3 );
+    }
+
+    const size_t nvertices = representatives.size();
+    mesh.coords.resize( nvertices * 3 );
+    mesh.nattributes = ( has_vertex_color ? 3 : 0 ) + ( has_vertex_normal ? 3 : 0 );
+    mesh.attributes.resize( nvertices * mesh.nattributes );
+    const size_t nattributes = mesh.nattributes;
+    const size_t normal_offset = has_vertex_color ? 3 : 0;
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < nvertices; i++ )
+    {
+        const size_t index = representatives[i];
+        for ( size_t k = 0; k < 3; k++ )
+        {
+            mesh.coords[ 3 * i + k ] = input_coords[ 3 * index + k ];
+            if ( has_vertex_color ) { mesh.attributes[ i * nattributes + k ] = polygon->colors()[ 3 * index + k ]; }
+            if ( has_vertex_normal ) { mesh.attributes[ i * nattributes + normal_offset + k ] = polygon->normals()[ 3 * index + k ]; }
+        }
+    }
+
+    // The triangles with duplicated vertices are removed.
+    mesh.alive.resize( ntriangles );
+    size_t nalive = 0;
+    for ( size_t i = 0; i < ntriangles; i++ )
+    {
+        const kvs::UInt32* triangle = &mesh.triangles[ 3 * i ];
+        const bool valid = triangle[0] != triangle[1] && triangle[1] != triangle[2] && triangle[2] != triangle[0];
+        mesh.alive[i] = valid ? 1 : 0;
+        if ( valid ) { nalive++; }
+    }
+
+    mesh.max_error = m_max_error;
+    mesh.setup( m_boundary_weight );
+
+    const size_t target = m_target_ntriangles > 0 ?
+        m_target_ntriangles :
+        static_cast<size_t>( kvs::Math::Max( m_target_ratio, 0.0f ) * nalive + 0.5f );
+
+    // The triangles are divided into the blocks of the grid by the centroid.
+    kvs::Vec3 min_coord( 0, 0, 0 );
+    kvs::Vec3 max_coord( 0, 0, 0 );
+    for ( size_t i = 0; i < nvertices; i++ )
+    {
+        const kvs::Vec3 p( &mesh.coords[ 3 * i ] );
+        if ( i == 0 ) { min_coord = max_coord = p; continue; }
+        for ( int k = 0; k < 3; k++ )
+        {
+            min_coord[k] = kvs::Math::Min( min_coord[k], p[k] );
+            max_coord[k] = kvs::Math::Max( max_coord[k], p[k] );
+        }
+    }
+
+    const size_t nwanted = kvs::Math::Max( nalive / kvs::Math::Max( m_block_size, size_t(1) ), size_t(1) );
+    const size_t dim = static_cast<size_t>( std::ceil( std::pow( static_cast<double>( nwanted ), 1.0 / 3.0 ) - 1.0e-9 ) );
+    const size_t nblocks = dim * dim * dim;
+    std::vector<kvs::UInt32> block_ids( ntriangles, 0 );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < ntriangles; i++ )
+    {
+        if ( !mesh.alive[i] ) { continue; }
+        size_t cell[3];
+        for ( int k = 0; k < 3; k++ )
+        {
+            const float c =
+                ( mesh.coords[ 3 * mesh.triangles[ 3 * i + 0 ] + k ] +
+                  mesh.coords[ 3 * mesh.triangles[ 3 * i + 1 ] + k ] +
+                  mesh.coords[ 3 * mesh.triangles[ 3 * i + 2 ] + k ] ) / 3.0f;
+            const float extent = max_coord[k] - min_coord[k];
+            const float x = extent > 0.0f ? ( c - min_coord[k] ) / extent * dim : 0.0f;
+            cell[k] = kvs::Math::Min( static_cast<size_t>( kvs::Math::Max( x, 0.0f ) ), dim - 1 );
+        }
+        block_ids[i] = static_cast<kvs::UInt32>( ( cell[2] * dim + cell[1] ) * dim + cell[0] );
+    }
+
+    std::vector<size_t> offsets( nblocks + 1, 0 );
+    for ( size_t i = 0; i < ntriangles; i++ ) { if ( mesh.alive[i] ) { offsets[ block_ids[i] + 1 ]++; } }
+    for ( size_t b = 0; b < nblocks; b++ ) { offsets[ b + 1 ] += offsets[b]; }
+    std::vector<kvs::UInt32> block_triangles( nalive );
+    std::vector<size_t> positions( offsets.begin(), offsets.end() - 1 );
+    for ( size_t i = 0; i < ntriangles; i++ )
+    {
+        if ( mesh.alive[i] ) { block_triangles[ positions[ block_ids[i] ]++ ] = static_cast<kvs::UInt32>( i ); }
+    }
+
+    // A vertex is owned by the block if all the triangles around it are in
+    // the block, otherwise it is locked in the parallel decimation.
+    mesh.owners.resize( nvertices );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < nvertices; i++ )
+    {
+        const std::vector<kvs::UInt32>& star = mesh.stars[i];
+        kvs::Int32 owner = star.empty() ? ::Locked : static_cast<kvs::Int32>( block_ids[ star[0] ] );
+        for ( size_t j = 1; j < star.size() && owner != ::Locked; j++ )
+        {
+            if ( static_cast<kvs::Int32>( block_ids[ star[j] ] ) != owner ) { owner = ::Locked; }
+        }
+        mesh.owners[i] = owner;
+    }
+
+    // The triangles around the locked vertices are left to the cleanup pass,
+    // so that a block only reduces the other triangles by the target ratio.
+    const double ratio = nalive > 0 ? static_cast<double>( target ) / nalive : 0.0;
+    std::vector<size_t> remains( nblocks, 0 );
+    KVS_OMP_PARALLEL_FOR( schedule(dynamic) )
+    for ( size_t b = 0; b < nblocks; b++ )
+    {
+        const size_t n = offsets[ b + 1 ] - offsets[b];
+        if ( n == 0 ) { continue; }
+
+        size_t ninteriors = 0;
+        for ( size_t i = offsets[b]; i < offsets[ b + 1 ]; i++ )
+        {
+            const kvs::UInt32* triangle = &mesh.triangles[ 3 * block_triangles[i] ];
+            if ( mesh.owners[ triangle[0] ] != ::Locked &&
+                 mesh.owners[ triangle[1] ] != ::Locked &&
+                 mesh.owners[ triangle[2] ] != ::Locked ) { ninteriors++; }
+        }
+
+        const size_t nremoved = static_cast<size_t>( ninteriors * ( 1.0 - kvs::Math::Min( ratio, 1.0 ) ) + 0.5 );
+        remains[b] = mesh.decimate( &block_triangles[ offsets[b] ], n, static_cast<kvs::Int32>( b ), n, n - nremoved );
+    }
+
+    nalive = 0;
+    for ( size_t b = 0; b < nblocks; b++ ) { nalive += remains[b]; }
+
+    // The cleanup pass starts from the triangles around the locked vertices,
+    // and from all the triangles if the target is not reached yet.
+    if ( nblocks > 1 && nalive > target )
+    {
+        std::vector<kvs::UInt32> seeds;
+        for ( size_t i = 0; i < ntriangles; i++ )
+        {
+            if ( !mesh.alive[i] ) { continue; }
+            const kvs::UInt32* triangle = &mesh.triangles[ 3 * i ];
+            if ( mesh.owners[ triangle[0] ] == ::Locked ||
+                 mesh.owners[ triangle[1] ] == ::Locked ||
+                 mesh.owners[ triangle[2] ] == ::Locked )
+            {
+                seeds.push_back( static_cast<kvs::UInt32>( i ) );
+            }
+        }
+        nalive = mesh.decimate( seeds.empty() ? NULL : &seeds[0], seeds.size(), ::Global, nalive, target );
+
+        if ( nalive > target )
+        {
+            seeds.clear();
+            for ( size_t i = 0; i < ntriangles; i++ )
+            {
+                if ( mesh.alive[i] ) { seeds.push_back( static_cast<kvs::UInt32>( i ) ); }
+            }
+            nalive = mesh.decimate( seeds.empty() ? NULL : &seeds[0], seeds.size(), ::Global, nalive, target );
+        }
+    }
+
+    // The remaining triangles and their vertices are packed in the original order.
+    kvs::ValueArray<kvs::UInt32> vertex_ids( nvertices );
+    vertex_ids.fill( 0 );
+    for ( size_t i = 0; i < ntriangles; i++ )
+    {
+        if ( !mesh.alive[i] ) { continue; }
+        for ( size_t k = 0; k < 3; k++ ) { vertex_ids[ mesh.triangles[ 3 * i + k ] ] = 1; }
+    }
+    std::vector<kvs::UInt8> used( vertex_ids.begin(), vertex_ids.end() );
+    const size_t noutput_vertices = kvs::detail::ExclusiveScan( vertex_ids );
+
+    kvs::ValueArray<kvs::UInt32> triangle_ids( ntriangles );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < ntriangles; i++ ) { triangle_ids[i] = mesh.alive[i]; }
+    const size_t noutput_triangles = kvs::detail::ExclusiveScan( triangle_ids );
+
+    kvs::ValueArray<kvs::Real32> coords( noutput_vertices * 3 );
+    kvs::ValueArray<kvs::UInt8> vertex_colors( has_vertex_color ? noutput_vertices * 3 : 0 );
+    kvs::ValueArray<kvs::Real32> vertex_normals( has_vertex_normal ? noutput_vertices * 3 : 0 );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < nvertices; i++ )
+    {
+        if ( !used[i] ) { continue; }
+        const size_t index = vertex_ids[i];
+        for ( size_t k = 0; k < 3; k++ ) { coords[ 3 * index + k ] = mesh.coords[ 3 * i + k ]; }
+
+        const kvs::Real32* a = nattributes > 0 ? &mesh.attributes[ i * nattributes ] : NULL;
+        if ( has_vertex_color )
+        {
+            for ( size_t k = 0; k < 3; k++ )
+            {
+                vertex_colors[ 3 * index + k ] = static_cast<kvs::UInt8>( kvs::Math::Clamp( a[k] + 0.5f, 0.0f, 255.0f ) );
+            }
+        }
+        if ( has_vertex_normal )
+        {
+            const kvs::Vec3 n( a[ normal_offset + 0 ], a[ normal_offset + 1 ], a[ normal_offset + 2 ] );
+            const kvs::Real32 length = n.length();
+            const kvs::Vec3 normal = length > 0.0f ? n / length : n;
+            for ( size_t k = 0; k < 3; k++ ) { vertex_normals[ 3 * index + k ] = normal[k]; }
+        }
+    }
+
+    kvs::ValueArray<kvs::UInt32> connections( noutput_triangles * 3 );
+    kvs::ValueArray<kvs::UInt8> polygon_colors( has_polygon_color ? noutput_triangles * 3 : 0 );
+    kvs::ValueArray<kvs::Real32> polygon_normals( has_polygon_normal ? noutput_triangles * 3 : 0 );
+    kvs::ValueArray<kvs::UInt8> opacities( has_polygon_opacity ? noutput_triangles : 0 );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < ntriangles; i++ )
+    {
+        if ( !mesh.alive[i] ) { continue; }
+        const size_t index = triangle_ids[i];
+        for ( size_t k = 0; k < 3; k++ ) { connections[ 3 * index + k ] = vertex_ids[ mesh.triangles[ 3 * i + k ] ]; }
+
+        if ( has_polygon_color )
+        {
+            for ( size_t k = 0; k < 3; k++ ) { polygon_colors[ 3 * index + k ] = polygon->colors()[ 3 * i + k ]; }
+        }
+        if ( has_polygon_normal )
+        {
+            const kvs::UInt32* triangle = &mesh.triangles[ 3 * i ];
+            const kvs::Vec3 p0( &mesh.coords[ 3 * triangle[0] ] );
+            const kvs::Vec3 p1( &mesh.coords[ 3 * triangle[1] ] );
+            const kvs::Vec3 p2( &mesh.coords[ 3 * triangle[2] ] );
+            const kvs::Vec3 n = ( p1 - p0 ).cross( p2 - p0 );
+            const kvs::Real32 length = n.length();
+            const kvs::Vec3 normal = length > 0.0f ? n / length : n;
+            for ( size_t k = 0; k < 3; k++ ) { polygon_normals[ 3 * index + k ] = normal[k]; }
+        }
+        if ( has_polygon_opacity ) { opacities[ index ] = polygon->opacity( i ); }
+    }
+
+    SuperClass::setPolygonTypeToTriangle();
+    SuperClass::setCoords( coords );
+    SuperClass::setConnections( connections );
+    if ( has_vertex_color )
+    {
+        SuperClass::setColorTypeToVertex();
+        SuperClass::setColors( vertex_colors );
+    }
+    else if ( has_polygon_color )
+    {
+        SuperClass::setColorTypeToPolygon();
+        SuperClass::setColors( polygon_colors );
+    }
+    else
+    {
+        SuperClass::setColorType( polygon->colorType() );
+        if ( polygon->numberOfColors() > 0 ) { SuperClass::setColor( polygon->color(0) ); }
+    }
+
+    if ( has_vertex_normal )
+    {
+        SuperClass::setNormalTypeToVertex();
+        SuperClass::setNormals( vertex_normals );
+    }
+    else if ( has_polygon_normal )
+    {
+        SuperClass::setNormalTypeToPolygon();
+        SuperClass::setNormals( polygon_normals );
+    }
+    else
+    {
+        SuperClass::setNormalType( polygon->normalType() );
+    }
+
+    if ( has_polygon_opacity ) { SuperClass::setOpacities( opacities ); }
+    else if ( polygon->numberOfOpacities() > 0 ) { SuperClass::setOpacity( polygon->opacity(0) ); }
+
+    SuperClass::setMinMaxObjectCoords( polygon->minObjectCoord(), polygon->maxObjectCoord() );
+    SuperClass::setMinMaxExternalCoords( polygon->minExternalCoord(), polygon->maxExternalCoord() );
+
+    BaseClass::setSuccess( true );
+    return this;
+}
+
+} // end of namespace kvs
@@ -0,0 +1,79 @@
+/*****************************************************************************/
+/**
+ *  @file   PolygonDecimation.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVS__POLYGON_DECIMATION_H_INCLUDE
+#define KVS__POLYGON_DECIMATION_H_INCLUDE
+
+#include <kvs/PolygonObject>
+#include <kvs/FilterBase>
+#include <kvs/Module>
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Polygon decimation class by the quadric error metrics.
+ *
+ *  The edges of a triangle polygon are collapsed in the order of the quadric
+ *  error (Garland and Heckbert) until the number of the triangles reaches the
+ *  target or the error exceeds the max. error. The input vertices with the
+ *  same coordinate are welded, and the output is an indexed triangle polygon
+ *  with the vertex colors and normals interpolated along the collapsed edges
+ *  and the polygon colors and opacities inherited from the input triangles.
+ *
+ *  The triangles are divided into spatial blocks, and the blocks are
+ *  decimated in parallel with the vertices shared by the blocks locked. Then
+ *  the edges around the locked vertices are decimated serially. The result
+ *  does not depend on the number of threads.
+ */
+/*===========================================================================*/
+class PolygonDecimation : public kvs::FilterBase, public kvs::PolygonObject
+{
+    kvsModule( kvs::PolygonDecimation, Filter );
+    kvsModuleBaseClass( kvs::FilterBase );
+    kvsModuleSuperClass( kvs::PolygonObject );
+
+private:
+
+    size_t m_target_ntriangles; ///< target number of the triangles (0: given by the ratio)
+    float m_target_ratio; ///< target ratio of the number of the triangles
+    double m_max_error; ///< max. quadric error of the collapse (0: unlimited)
+    double m_boundary_weight; ///< weight of the quadrics to preserve the boundary edges
+    size_t m_block_size; ///< number of the triangles per block
+
+public:
+
+    PolygonDecimation();
+    PolygonDecimation( const kvs::PolygonObject* object, const float ratio );
+    virtual ~PolygonDecimation();
+
+    size_t targetNumberOfTriangles() const { return m_target_ntriangles; }
+    float targetRatio() const { return m_target_ratio; }
+    double maxError() const { return m_max_error; }
+    double boundaryWeight() const { return m_boundary_weight; }
+    size_t blockSize() const { return m_block_size; }
+
+    void setTargetNumberOfTriangles( const size_t ntriangles ) { m_target_ntriangles = ntriangles; }
+    void setTargetRatio( const float ratio ) { m_target_ntriangles = 0; m_target_ratio = ratio; }
+    void setMaxError( const double error ) { m_max_error = error; }
+    void setBoundaryWeight( const double weight ) { m_boundary_weight = weight; }
+    void setBlockSize( const size_t ntriangles ) { m_block_size = ntriangles; }
+
+    SuperClass* exec( const kvs::ObjectBase* object );
+};
+
+} // end of namespace kvs
+
+#endif // KVS__POLYGON_DECIMATION_H_INCLUDE
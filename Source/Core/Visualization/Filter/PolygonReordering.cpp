@@ -0,0 +1,618 @@
+/*****************************************************************************/
+/**
+ *  @file   PolygonReordering.cpp
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "PolygonReordering.h"
+#include "ParallelSort.h"
+#include "SpaceFillingCurve.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <kvs/Math>
+#include <kvs/Value>
+#include <kvs/Vector3>
+#include <kvs/OpenMP>
+
+
+namespace
+{
+
+/// Vertex or triangle index not assigned yet.
+const kvs::UInt32 Unassigned = 0xFFFFFFFFu;
+
+/// Parameters of the vertex score by Forsyth.
+const float CacheDecayPower = 1.5f;
+const float LastTriangleScore = 0.75f;
+const float ValenceBoostScale = 2.0f;
+const float ValenceBoostPower = 0.5f;
+
+/// Number of the tabulated valence scores.
+const size_t MaxValence = 64;
+
+/*===========================================================================*/
+/**
+ *  @brief  Vertex score table of the cache position and the valence.
+ */
+/*===========================================================================*/
+class VertexScore
+{
+private:
+
+    std::vector<float> m_cache_scores; ///< score of each cache position
+    std::vector<float> m_valence_scores; ///< score of each number of the remaining triangles
+
+public:
+
+    VertexScore( const size_t cache_size ):
+        m_cache_scores( cache_size ),
+        m_valence_scores( ::MaxValence )
+    {
+        // The vertices of the last triangle have the same fixed score, so
+        // that the order of the emitted vertices does not matter.
+        for ( size_t i = 0; i < cache_size; i++ )
+        {
+            if ( i < 3 ) { m_cache_scores[i] = ::LastTriangleScore; continue; }
+            const float scale = 1.0f / static_cast<float>( cache_size - 3 );
+            m_cache_scores[i] = std::pow( 1.0f - static_cast<float>( i - 3 ) * scale, ::CacheDecayPower );
+        }
+
+        // The vertices with fewer remaining triangles are boosted to remove
+        // the lone vertices quickly.
+        m_valence_scores[0] = 0.0f;
+        for ( size_t i = 1; i < ::MaxValence; i++ )
+        {
+            m_valence_scores[i] = ::ValenceBoostScale * std::pow( static_cast<float>( i ), -::ValenceBoostPower );
+        }
+    }
+
+    float operator ()( const kvs::Int32 position, const size_t valence ) const
+    {
+        if ( valence == 0 ) { return -1.0f; }
+        const float cache_score = position >= 0 ? m_cache_scores[ position ] : 0.0f;
+        const float valence_score = valence < ::MaxValence ?
+            m_valence_scores[ valence ] :
+            ::ValenceBoostScale * std::pow( static_cast<float>( valence ), -::ValenceBoostPower );
+        return cache_score + valence_score;
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Optimizes the order of the triangles of the cluster.
+ *  @param  connections [in] vertex indices of the triangles of the cluster
+ *  @param  ntriangles [in] number of the triangles of the cluster
+ *  @param  score [in] vertex score table
+ *  @param  cache_size [in] number of the vertices in the cache
+ *  @param  order [out] triangle indices (in the cluster) in the optimized order
+ */
+/*===========================================================================*/
+void OptimizeCluster(
+    const kvs::UInt32* connections,
+    const size_t ntriangles,
+    const VertexScore& score,
+    const size_t cache_size,
+    kvs::UInt32* order )
+{
+    // Local vertex indices of the cluster.
+    const size_t nslots = ntriangles * 3;
+    std::vector<kvs::UInt32> vertices( connections, connections + nslots );
+    std::sort( vertices.begin(), vertices.end() );
+    vertices.erase( std::unique( vertices.begin(), vertices.end() ), vertices.end() );
+    const size_t nvertices = vertices.size();
+
+    std::vector<kvs::UInt32> locals( nslots );
+    std::vector<kvs::UInt32> offsets( nvertices + 1, 0 );
+    for ( size_t i = 0; i < nslots; i++ )
+    {
+        locals[i] = static_cast<kvs::UInt32>( std::lower_bound( vertices.begin(), vertices.end(), connections[i] ) - vertices.begin() );
+        offsets[ locals[i] + 1 ]++;
+    }
+    for ( size_t i = 0; i < nvertices; i++ ) { offsets[ i + 1 ] += offsets[i]; }
+
+    // Triangles around each vertex. The first valences[v] of them are not emitted yet.
+    std::vector<kvs::UInt32> valences( nvertices, 0 );
+    std::vector<kvs::UInt32> adjacency( nslots );
+    for ( size_t i = 0; i < nslots; i++ )
+    {
+        const kvs::UInt32 v = locals[i];
+        adjacency[ offsets[v] + valences[v]++ ] = static_cast<kvs::UInt32>( i / 3 );
+    }
+
+    std::vector<kvs::Int32> positions( nvertices, -1 );
+    std::vector<float> vertex_scores( nvertices );
+    for ( size_t i = 0; i < nvertices; i++ ) { vertex_scores[i] = score( -1, valences[i] ); }
+
+    std::vector<float> triangle_scores( ntriangles );
+    std::vector<kvs::UInt8> emitted( ntriangles, 0 );
+    kvs::UInt32 best = ::Unassigned;
+    for ( size_t i = 0; i < ntriangles; i++ )
+    {
+        const kvs::UInt32* t = &locals[ 3 * i ];
+        triangle_scores[i] = vertex_scores[ t[0] ] + vertex_scores[ t[1] ] + vertex_scores[ t[2] ];
+        if ( best == ::Unassigned || triangle_scores[i] > triangle_scores[ best ] ) { best = static_cast<kvs::UInt32>( i ); }
+    }
+
+    std::vector<kvs::UInt32> cache;
+    std::vector<kvs::UInt32> next_cache;
+    cache.reserve( cache_size + 3 );
+    next_cache.reserve( cache_size + 3 );
+    size_t cursor = 0;
+    for ( size_t counter = 0; counter < ntriangles; counter++ )
+    {
+        // The first remaining triangle is taken if no triangle around the
+        // cached vertices remains.
+        if ( best == ::Unassigned )
+        {
+            while ( emitted[ cursor ] ) { cursor++; }
+            best = static_cast<kvs::UInt32>( cursor );
+        }
+
+        const kvs::UInt32 triangle = best;
+        const kvs::UInt32* t = &locals[ 3 * triangle ];
+        emitted[ triangle ] = 1;
+        order[ counter ] = triangle;
+
+        // The triangle is removed from the remaining triangles of the vertices.
+        next_cache.clear();
+        for ( size_t k = 0; k < 3; k++ )
+        {
+            const kvs::UInt32 v = t[k];
+            kvs::UInt32* adjacent = &adjacency[ offsets[v] ];
+            const kvs::UInt32 last = --valences[v];
+            for ( kvs::UInt32 j = 0; j <= last; j++ )
+            {
+                if ( adjacent[j] == triangle ) { std::swap( adjacent[j], adjacent[ last ] ); break; }
+            }
+            if ( std::find( next_cache.begin(), next_cache.end(), v ) == next_cache.end() ) { next_cache.push_back( v ); }
+        }
+
+        // The vertices of the triangle are moved to the front of the LRU cache.
+        for ( size_t i = 0; i < cache.size(); i++ )
+        {
+            const kvs::UInt32 v = cache[i];
+            if ( v != t[0] && v != t[1] && v != t[2] ) { next_cache.push_back( v ); }
+        }
+
+        // The scores of the cached and evicted vertices are updated.
+        for ( size_t i = 0; i < next_cache.size(); i++ )
+        {
+            const kvs::UInt32 v = next_cache[i];
+            positions[v] = i < cache_size ? static_cast<kvs::Int32>( i ) : -1;
+            const float s = score( positions[v], valences[v] );
+            const float delta = s - vertex_scores[v];
+            vertex_scores[v] = s;
+            for ( size_t j = offsets[v]; j < offsets[v] + valences[v]; j++ )
+            {
+                triangle_scores[ adjacency[j] ] += delta;
+            }
+        }
+
+        if ( next_cache.size() > cache_size ) { next_cache.resize( cache_size ); }
+        cache.swap( next_cache );
+
+        // The next triangle is the best one around the cached vertices.
+        best = ::Unassigned;
+        for ( size_t i = 0; i < cache.size(); i++ )
+        {
+            const kvs::UInt32 v = cache[i];
+            for ( size_t j = offsets[v]; j < offsets[v] + valences[v]; j++ )
+            {
+                const kvs::UInt32 candidate = adjacency[j];
+                if ( best == ::Unassigned || triangle_scores[ candidate ] > triangle_scores[ best ] ) { best = candidate; }
+            }
+        }
+    }
+}
+
+} // end of namespace
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the average cache miss ratio of the triangles.
+ *  @param  connections [in] vertex indices of the triangles
+ *  @param  nvertices [in] number of the vertices
+ *  @param  cache_size [in] number of the vertices in the FIFO cache
+ *  @return number of the cache misses per triangle
+ */
+/*===========================================================================*/
+double PolygonReordering::CalculateACMR(
+    const kvs::ValueArray<kvs::UInt32>& connections,
+    const size_t nvertices,
+    const size_t cache_size )
+{
+    const size_t ntriangles = connections.size() / 3;
+    if ( ntriangles == 0 ) { return 0.0; }
+
+    // A vertex is in the cache if it is loaded by one of the last misses.
+    std::vector<size_t> loaded( nvertices, size_t(-1) );
+    size_t nmisses = 0;
+    for ( size_t i = 0; i < connections.size(); i++ )
+    {
+        const kvs::UInt32 v = connections[i];
+        if ( loaded[v] == size_t(-1) || nmisses - loaded[v] >= cache_size )
+        {
+            loaded[v] = nmisses++;
+        }
+    }
+
+    return static_cast<double>( nmisses ) / ntriangles;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new PolygonReordering class.
+ */
+/*===========================================================================*/
+PolygonReordering::PolygonReordering():
+    m_cache_size( 32 ),
+    m_cluster_size( 65536 ),
+    m_input_acmr( 0.0 ),
+    m_output_acmr( 0.0 )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new PolygonReordering class.
+ *  @param  polygon [in] pointer to the triangle polygon object
+ *  @param  cache_size [in] number of the vertices in the cache
+ */
+/*===========================================================================*/
+PolygonReordering::PolygonReordering(
+    const kvs::PolygonObject* polygon,
+    const size_t cache_size ):
+    m_cache_size( cache_size ),
+    m_cluster_size( 65536 ),
+    m_input_acmr( 0.0 ),
+    m_output_acmr( 0.0 )
+{
+    this->exec( polygon );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Destroys the PolygonReordering class.
+ */
+/*===========================================================================*/
+PolygonReordering::~PolygonReordering()
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Executes the reordering.
+ *  @param  object [in] pointer to the triangle polygon object
+ *  @return pointer to the reordered polygon object
+ */
+/*===========================================================================*/
+PolygonReordering::SuperClass* PolygonReordering::exec( const kvs::ObjectBase* object )
+{
+    if ( !object )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input object is NULL.");
+        return NULL;
+    }
+
+    const kvs::PolygonObject* polygon = kvs::PolygonObject::DownCast( object );
+    if ( !polygon )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input object is not polygon object.");
+        return NULL;
+    }
+
+    if ( polygon->polygonType() != kvs::PolygonObject::Triangle )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Polygon type is not triangle.");
+        return NULL;
+    }
+
+    if ( polygon->numberOfConnections() == 0 )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Polygon object has no connections.");
+        return NULL;
+    }
+
+    if ( m_cache_size < 4 || m_cache_size > MaxCacheSize )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Cache size must be between 4 and %d.", int( MaxCacheSize ) );
+        return NULL;
+    }
+
+    const size_t nvertices = polygon->numberOfVertices();
+    m_input_acmr = CalculateACMR( polygon->connections(), nvertices, m_cache_size );
+
+    this->sort_triangles( polygon );
+    this->renumber_vertices( polygon );
+    this->remap( polygon );
+
+    m_output_acmr = CalculateACMR( SuperClass::connections(), nvertices, m_cache_size );
+
+    BaseClass::setSuccess( true );
+    return this;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sorts the triangles by the vertex cache optimization of each cluster.
+ *  @param  polygon [in] pointer to the triangle polygon object
+ */
+/*===========================================================================*/
+void PolygonReordering::sort_triangles( const kvs::PolygonObject* polygon )
+{
+    const size_t ntriangles = polygon->numberOfConnections();
+    const size_t cluster_size = kvs::Math::Max( m_cluster_size, size_t(1) );
+    const size_t nclusters = ( ntriangles + cluster_size - 1 ) / cluster_size;
+    const kvs::UInt32* connections = polygon->connections().data();
+    const kvs::Real32* coords = polygon->coords().data();
+    const size_t cache_size = m_cache_size;
+    const ::VertexScore score( cache_size );
+
+    // The triangles are sorted by the Morton key of their centroids, so that
+    // the clusters are compact for any input order.
+    std::vector<kvs::detail::CurveKey> keys( ntriangles );
+    if ( nclusters > 1 )
+    {
+        std::vector<kvs::Real32> centroids( ntriangles * 3 );
+        kvs::Vec3 min_coord( kvs::Value<kvs::Real32>::Max(), kvs::Value<kvs::Real32>::Max(), kvs::Value<kvs::Real32>::Max() );
+        kvs::Vec3 max_coord( -kvs::Value<kvs::Real32>::Max(), -kvs::Value<kvs::Real32>::Max(), -kvs::Value<kvs::Real32>::Max() );
+        KVS_OMP_PARALLEL()
+        {
+            kvs::Vec3 local_min( min_coord );
+            kvs::Vec3 local_max( max_coord );
+            KVS_OMP_FOR( schedule(static) )
+            for ( size_t i = 0; i < ntriangles; i++ )
+            {
+                const kvs::UInt32* triangle = connections + 3 * i;
+                const kvs::Vec3 centroid =
+                    ( kvs::Vec3( coords + 3 * triangle[0] ) +
+                      kvs::Vec3( coords + 3 * triangle[1] ) +
+                      kvs::Vec3( coords + 3 * triangle[2] ) ) / 3.0f;
+                for ( int k = 0; k < 3; k++ )
+                {
+                    centroids[ 3 * i + k ] = centroid[k];
+                    local_min[k] = kvs::Math::Min( local_min[k], centroid[k] );
+                    local_max[k] = kvs::Math::Max( local_max[k], centroid[k] );
+                }
+            }
+
+            KVS_OMP_CRITICAL()
+            {
+                for ( int k = 0; k < 3; k++ )
+                {
+                    min_coord[k] = kvs::Math::Min( min_coord[k], local_min[k] );
+                    max_coord[k] = kvs::Math::Max( max_coord[k], local_max[k] );
+                }
+            }
+        }
+
+        const kvs::Real32 resolution = static_cast<kvs::Real32>( ( 1u << kvs::detail::CurveKeyBits ) - 1 );
+        kvs::Vec3 scale( 0.0f, 0.0f, 0.0f );
+        for ( int k = 0; k < 3; k++ )
+        {
+            const kvs::Real32 extent = max_coord[k] - min_coord[k];
+            scale[k] = extent > 0.0f ? resolution / extent : 0.0f;
+        }
+
+        KVS_OMP_PARALLEL_FOR( schedule(static) )
+        for ( size_t i = 0; i < ntriangles; i++ )
+        {
+            kvs::UInt32 q[3];
+            for ( int k = 0; k < 3; k++ )
+            {
+                const kvs::Real32 t = ( centroids[ 3 * i + k ] - min_coord[k] ) * scale[k];
+                q[k] = static_cast<kvs::UInt32>( kvs::Math::Clamp( t, 0.0f, resolution ) );
+            }
+            keys[i].key = kvs::detail::MortonKey( q[0], q[1], q[2] );
+            keys[i].index = static_cast<kvs::UInt32>( i );
+        }
+
+        kvs::detail::SortKeys( keys );
+    }
+    else
+    {
+        for ( size_t i = 0; i < ntriangles; i++ ) { keys[i].index = static_cast<kvs::UInt32>( i ); }
+    }
+
+    m_triangle_permutation.allocate( ntriangles );
+    KVS_OMP_PARALLEL()
+    {
+        std::vector<kvs::UInt32> cluster;
+        KVS_OMP_FOR( schedule(dynamic) )
+        for ( size_t i = 0; i < nclusters; i++ )
+        {
+            const size_t begin = i * cluster_size;
+            const size_t end = kvs::Math::Min( begin + cluster_size, ntriangles );
+            cluster.resize( ( end - begin ) * 3 );
+            for ( size_t j = begin; j < end; j++ )
+            {
+                const kvs::UInt32* triangle = connections + 3 * keys[j].index;
+                for ( size_t k = 0; k < 3; k++ ) { cluster[ 3 * ( j - begin ) + k ] = triangle[k]; }
+            }
+
+            kvs::UInt32* order = m_triangle_permutation.data() + begin;
+            ::OptimizeCluster( &cluster[0], end - begin, score, cache_size, order );
+            for ( size_t j = 0; j < end - begin; j++ ) { order[j] = keys[ begin + order[j] ].index; }
+        }
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Renumbers the vertices in the first-use order of the sorted triangles.
+ *  @param  polygon [in] pointer to the triangle polygon object
+ */
+/*===========================================================================*/
+void PolygonReordering::renumber_vertices( const kvs::PolygonObject* polygon )
+{
+    const size_t nvertices = polygon->numberOfVertices();
+    const size_t ntriangles = polygon->numberOfConnections();
+    const kvs::UInt32* connections = polygon->connections().data();
+
+    std::vector<kvs::UInt32> new_index( nvertices, ::Unassigned );
+    m_vertex_permutation.allocate( nvertices );
+
+    kvs::UInt32 counter = 0;
+    for ( size_t i = 0; i < ntriangles; i++ )
+    {
+        const kvs::UInt32* triangle = connections + m_triangle_permutation[i] * 3;
+        for ( size_t j = 0; j < 3; j++ )
+        {
+            const kvs::UInt32 id = triangle[j];
+            if ( new_index[id] == ::Unassigned )
+            {
+                new_index[id] = counter;
+                m_vertex_permutation[ counter++ ] = id;
+            }
+        }
+    }
+
+    // Vertices which are not referenced by any triangle.
+    for ( size_t i = 0; i < nvertices; i++ )
+    {
+        if ( new_index[i] == ::Unassigned )
+        {
+            m_vertex_permutation[ counter++ ] = static_cast<kvs::UInt32>( i );
+        }
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Remaps the connections and the vertex and polygon attributes with the permutations.
+ *  @param  polygon [in] pointer to the triangle polygon object
+ */
+/*===========================================================================*/
+void PolygonReordering::remap( const kvs::PolygonObject* polygon )
+{
+    const size_t nvertices = polygon->numberOfVertices();
+    const size_t ntriangles = polygon->numberOfConnections();
+
+    // Inverse of the vertex permutation.
+    std::vector<kvs::UInt32> new_index( nvertices );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < nvertices; i++ )
+    {
+        new_index[ m_vertex_permutation[i] ] = static_cast<kvs::UInt32>( i );
+    }
+
+    const kvs::UInt32* src_connections = polygon->connections().data();
+    kvs::ValueArray<kvs::UInt32> connections( ntriangles * 3 );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < ntriangles; i++ )
+    {
+        const kvs::UInt32* src = src_connections + m_triangle_permutation[i] * 3;
+        kvs::UInt32* dst = connections.data() + i * 3;
+        for ( size_t j = 0; j < 3; j++ ) { dst[j] = new_index[ src[j] ]; }
+    }
+
+    const kvs::Real32* src_coords = polygon->coords().data();
+    kvs::ValueArray<kvs::Real32> coords( nvertices * 3 );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < nvertices; i++ )
+    {
+        const kvs::Real32* src = src_coords + 3 * m_vertex_permutation[i];
+        kvs::Real32* dst = coords.data() + 3 * i;
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+    }
+
+    // The colors and normals are permuted as the vertices or the triangles
+    // if they are given for each of them, otherwise they are shared as is.
+    kvs::ValueArray<kvs::UInt8> colors = polygon->colors();
+    const Permutation* color_permutation =
+        polygon->numberOfColors() == nvertices && polygon->colorType() == kvs::PolygonObject::VertexColor ? &m_vertex_permutation :
+        polygon->numberOfColors() == ntriangles && polygon->colorType() == kvs::PolygonObject::PolygonColor ? &m_triangle_permutation :
+        NULL;
+    if ( color_permutation && color_permutation->size() > 1 )
+    {
+        const size_t ncolors = color_permutation->size();
+        const kvs::UInt8* src_colors = polygon->colors().data();
+        colors.allocate( ncolors * 3 );
+        KVS_OMP_PARALLEL_FOR( schedule(static) )
+        for ( size_t i = 0; i < ncolors; i++ )
+        {
+            const kvs::UInt8* src = src_colors + 3 * ( *color_permutation )[i];
+            kvs::UInt8* dst = colors.data() + 3 * i;
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+        }
+    }
+
+    kvs::ValueArray<kvs::Real32> normals = polygon->normals();
+    const Permutation* normal_permutation =
+        polygon->numberOfNormals() == nvertices && polygon->normalType() == kvs::PolygonObject::VertexNormal ? &m_vertex_permutation :
+        polygon->numberOfNormals() == ntriangles && polygon->normalType() == kvs::PolygonObject::PolygonNormal ? &m_triangle_permutation :
+        NULL;
+    if ( normal_permutation )
+    {
+        const size_t nnormals = normal_permutation->size();
+        const kvs::Real32* src_normals = polygon->normals().data();
+        normals.allocate( nnormals * 3 );
+        KVS_OMP_PARALLEL_FOR( schedule(static) )
+        for ( size_t i = 0; i < nnormals; i++ )
+        {
+            const kvs::Real32* src = src_normals + 3 * ( *normal_permutation )[i];
+            kvs::Real32* dst = normals.data() + 3 * i;
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+        }
+    }
+
+    kvs::ValueArray<kvs::UInt8> opacities = polygon->opacities();
+    if ( polygon->numberOfOpacities() == ntriangles && ntriangles > 1 )
+    {
+        const kvs::UInt8* src_opacities = polygon->opacities().data();
+        opacities.allocate( ntriangles );
+        KVS_OMP_PARALLEL_FOR( schedule(static) )
+        for ( size_t i = 0; i < ntriangles; i++ )
+        {
+            opacities[i] = src_opacities[ m_triangle_permutation[i] ];
+        }
+    }
+
+    if ( polygon->hasMinMaxExternalCoords() )
+    {
+        const kvs::Vector3f min_coord( polygon->minExternalCoord() );
+        const kvs::Vector3f max_coord( polygon->maxExternalCoord() );
+        SuperClass::setMinMaxExternalCoords( min_coord, max_coord );
+    }
+
+    if ( polygon->hasMinMaxObjectCoords() )
+    {
+        const kvs::Vector3f min_coord( polygon->minObjectCoord() );
+        const kvs::Vector3f max_coord( polygon->maxObjectCoord() );
+        SuperClass::setMinMaxObjectCoords( min_coord, max_coord );
+    }
+
+    SuperClass::setPolygonType( polygon->polygonType() );
+    SuperClass::setColorType( polygon->colorType() );
+    SuperClass::setNormalType( polygon->normalType() );
+    SuperClass::setCoords( coords );
+    SuperClass::setColors( colors );
+    SuperClass::setNormals( normals );
+    SuperClass::setConnections( connections );
+    SuperClass::setOpacities( opacities );
+}
+
+} // end of namespace kvs
@@ -0,0 +1,101 @@
+/*****************************************************************************/
+/**
+ *  @file   PolygonReordering.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVS__POLYGON_REORDERING_H_INCLUDE
+#define KVS__POLYGON_REORDERING_H_INCLUDE
+
+#include <kvs/PolygonObject>
+#include <kvs/FilterBase>
+#include <kvs/ValueArray>
+#include <kvs/Type>
+#include <kvs/Module>
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Reordering class of the triangles and vertices of polygon for vertex cache.
+ *
+ *  The triangles of an indexed triangle polygon are reordered by Forsyth's
+ *  linear-speed vertex cache optimization, which greedily emits the triangle
+ *  with the highest score given by the positions of its vertices in a
+ *  simulated LRU cache and the numbers of their remaining triangles. The
+ *  triangles are sorted by the Morton key of their centroids and optimized
+ *  in clusters of consecutive sorted triangles in parallel.
+ *  Then the vertices are renumbered in the order they are first referenced
+ *  (vertices referenced by no triangle follow in their original order), and
+ *  the coordinates, colors, normals and opacities are remapped accordingly.
+ *
+ *  The average cache miss ratio (ACMR, the number of the vertex cache misses
+ *  per triangle) of a FIFO cache of the same size is calculated for the
+ *  input and the output.
+ */
+/*===========================================================================*/
+class PolygonReordering : public kvs::FilterBase, public kvs::PolygonObject
+{
+    kvsModule( kvs::PolygonReordering, Filter );
+    kvsModuleBaseClass( kvs::FilterBase );
+    kvsModuleSuperClass( kvs::PolygonObject );
+
+public:
+
+    typedef kvs::ValueArray<kvs::UInt32> Permutation;
+
+    enum { MaxCacheSize = 64 };
+
+private:
+
+    size_t m_cache_size; ///< number of the vertices in the cache
+    size_t m_cluster_size; ///< number of the triangles per cluster
+    Permutation m_triangle_permutation; ///< original triangle index of each new triangle
+    Permutation m_vertex_permutation; ///< original vertex index of each new vertex
+    double m_input_acmr; ///< ACMR of the input triangles
+    double m_output_acmr; ///< ACMR of the reordered triangles
+
+public:
+
+    static double CalculateACMR(
+        const kvs::ValueArray<kvs::UInt32>& connections,
+        const size_t nvertices,
+        const size_t cache_size );
+
+public:
+
+    PolygonReordering();
+    PolygonReordering( const kvs::PolygonObject* polygon, const size_t cache_size = 32 );
+    virtual ~PolygonReordering();
+
+    SuperClass* exec( const kvs::ObjectBase* object );
+
+    size_t cacheSize() const { return m_cache_size; }
+    size_t clusterSize() const { return m_cluster_size; }
+    const Permutation& trianglePermutation() const { return m_triangle_permutation; }
+    const Permutation& vertexPermutation() const { return m_vertex_permutation; }
+    double inputACMR() const { return m_input_acmr; }
+    double outputACMR() const { return m_output_acmr; }
+
+    void setCacheSize( const size_t cache_size ) { m_cache_size = cache_size; }
+    void setClusterSize( const size_t ntriangles ) { m_cluster_size = ntriangles; }
+
+private:
+
+    void sort_triangles( const kvs::PolygonObject* polygon );
+    void renumber_vertices( const kvs::PolygonObject* polygon );
+    void remap( const kvs::PolygonObject* polygon );
+};
+
+} // end of namespace kvs
+
+#endif // KVS__POLYGON_REORDERING_H_INCLUDE
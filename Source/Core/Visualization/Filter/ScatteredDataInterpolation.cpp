@@ -0,0 +1,324 @@
+/*****************************************************************************/
+/**
+ *  @file   ScatteredDataInterpolation.cpp
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "ScatteredDataInterpolation.h"
+#include <cmath>
+#include <vector>
+#include <kvs/Math>
+#include <kvs/OpenMP>
+#include <kvs/TypeDispatch>
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Functor to convert the sample values to Real32.
+ */
+/*===========================================================================*/
+struct ScatteredDataInterpolation::ValueConverter
+{
+    size_t nvalues;
+    kvs::ValueArray<kvs::Real32>* result;
+
+    ValueConverter( const size_t n, kvs::ValueArray<kvs::Real32>* r ): nvalues( n ), result( r ) {}
+
+    template <typename T>
+    void operator ()( const T* src ) const
+    {
+        kvs::ValueArray<kvs::Real32> dst( nvalues );
+
+        KVS_OMP_PARALLEL_FOR( schedule(static) )
+        for ( size_t i = 0; i < nvalues; i++ )
+        {
+            dst[i] = static_cast<kvs::Real32>( src[i] );
+        }
+
+        *result = dst;
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new ScatteredDataInterpolation class.
+ */
+/*===========================================================================*/
+ScatteredDataInterpolation::ScatteredDataInterpolation():
+    m_resolution( 64, 64, 64 ),
+    m_has_bounds( false ),
+    m_min_coord( 0, 0, 0 ),
+    m_max_coord( 0, 0, 0 ),
+    m_nneighbors( 8 ),
+    m_radius( 0.0f ),
+    m_power( 2.0f ),
+    m_sample_veclen( 0 ),
+    m_veclen( 0 )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new ScatteredDataInterpolation class.
+ *  @param  volume [in] pointer to the unstructured volume object
+ *  @param  resolution [in] resolution of the grid
+ */
+/*===========================================================================*/
+ScatteredDataInterpolation::ScatteredDataInterpolation(
+    const kvs::UnstructuredVolumeObject* volume,
+    const kvs::Vec3ui& resolution ):
+    m_resolution( resolution ),
+    m_has_bounds( false ),
+    m_min_coord( 0, 0, 0 ),
+    m_max_coord( 0, 0, 0 ),
+    m_nneighbors( 8 ),
+    m_radius( 0.0f ),
+    m_power( 2.0f ),
+    m_sample_veclen( 0 ),
+    m_veclen( 0 )
+{
+    this->exec( volume );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Destroys the ScatteredDataInterpolation class.
+ */
+/*===========================================================================*/
+ScatteredDataInterpolation::~ScatteredDataInterpolation()
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets the bounds of the grid.
+ *  @param  min_coord [in] min. coordinate
+ *  @param  max_coord [in] max. coordinate
+ */
+/*===========================================================================*/
+void ScatteredDataInterpolation::setBounds( const kvs::Vec3& min_coord, const kvs::Vec3& max_coord )
+{
+    m_has_bounds = true;
+    m_min_coord = min_coord;
+    m_max_coord = max_coord;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets the sample values for the vertices of point object.
+ *  @param  values [in] sample values
+ *  @param  veclen [in] vector length of the values
+ */
+/*===========================================================================*/
+void ScatteredDataInterpolation::setSampleValues( const kvs::AnyValueArray& values, const size_t veclen )
+{
+    m_sample_values = values;
+    m_sample_veclen = veclen;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Executes the interpolation onto the uniform grid.
+ *  @param  object [in] pointer to the point object or unstructured volume object
+ *  @return pointer to the structured volume object
+ */
+/*===========================================================================*/
+ScatteredDataInterpolation::SuperClass* ScatteredDataInterpolation::exec( const kvs::ObjectBase* object )
+{
+    if ( !object )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input object is NULL.");
+        return NULL;
+    }
+
+    if ( !this->attachSource( object ) )
+    {
+        BaseClass::setSuccess( false );
+        return NULL;
+    }
+
+    if ( m_resolution.x() < 2 || m_resolution.y() < 2 || m_resolution.z() < 2 )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Resolution of the grid must be 2 or more.");
+        return NULL;
+    }
+
+    const kvs::Vec3 min_coord = m_has_bounds ? m_min_coord : object->minObjectCoord();
+    const kvs::Vec3 max_coord = m_has_bounds ? m_max_coord : object->maxObjectCoord();
+    const size_t nx = m_resolution.x();
+    const size_t ny = m_resolution.y();
+    const size_t nz = m_resolution.z();
+    const kvs::Vec3 pitch(
+        ( max_coord.x() - min_coord.x() ) / static_cast<float>( nx - 1 ),
+        ( max_coord.y() - min_coord.y() ) / static_cast<float>( ny - 1 ),
+        ( max_coord.z() - min_coord.z() ) / static_cast<float>( nz - 1 ) );
+
+    const size_t veclen = m_veclen;
+    const size_t nnodes = nx * ny * nz;
+    kvs::ValueArray<kvs::Real32> values( nnodes * veclen );
+    KVS_OMP_PARALLEL()
+    {
+        std::vector<kvs::KdTree::Neighbor> neighbors;
+
+        KVS_OMP_FOR( schedule(dynamic) )
+        for ( size_t k = 0; k < nz; k++ )
+        {
+            for ( size_t j = 0; j < ny; j++ )
+            {
+                for ( size_t i = 0; i < nx; i++ )
+                {
+                    const kvs::Vec3 point(
+                        min_coord.x() + pitch.x() * i,
+                        min_coord.y() + pitch.y() * j,
+                        min_coord.z() + pitch.z() * k );
+                    const size_t index = ( k * ny + j ) * nx + i;
+                    this->interpolate_at( point, neighbors, values.data() + index * veclen );
+                }
+            }
+        }
+    }
+
+    SuperClass::setGridTypeToUniform();
+    SuperClass::setVeclen( veclen );
+    SuperClass::setResolution( m_resolution );
+    SuperClass::setValues( kvs::AnyValueArray( values ) );
+    SuperClass::updateMinMaxValues();
+    SuperClass::updateMinMaxCoords();
+    SuperClass::setMinMaxExternalCoords( min_coord, max_coord );
+
+    BaseClass::setSuccess( true );
+    return this;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Builds the k-d tree of the samples.
+ *  @param  object [in] pointer to the point object or unstructured volume object
+ *  @return true, if the samples are available
+ */
+/*===========================================================================*/
+bool ScatteredDataInterpolation::attachSource( const kvs::ObjectBase* object )
+{
+    kvs::ValueArray<kvs::Real32> coords;
+    kvs::AnyValueArray values;
+    size_t veclen = 0;
+    if ( const kvs::PointObject* point = kvs::PointObject::DownCast( object ) )
+    {
+        coords = point->decodedCoords();
+        values = m_sample_values;
+        veclen = m_sample_veclen;
+    }
+    else if ( const kvs::UnstructuredVolumeObject* volume = kvs::UnstructuredVolumeObject::DownCast( object ) )
+    {
+        coords = volume->coords();
+        values = volume->values();
+        veclen = volume->veclen();
+    }
+    else
+    {
+        kvsMessageError("Input object is not supported.");
+        return false;
+    }
+
+    const size_t nsamples = coords.size() / 3;
+    if ( nsamples == 0 || veclen == 0 || values.size() != nsamples * veclen )
+    {
+        kvsMessageError("Number of the coordinates or values is invalid.");
+        return false;
+    }
+
+    if ( !kvs::DispatchValues( values, ValueConverter( values.size(), &m_samples ) ) )
+    {
+        kvsMessageError("Unsupported data type '%s'.", values.typeInfo()->typeName() );
+        return false;
+    }
+
+    m_veclen = veclen;
+    m_tree.build( coords );
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Interpolates the values at the points.
+ *  @param  coords [in] coordinates of the points (x,y,z,x,y,z,...)
+ *  @return interpolated values (Real32 x veclen for each point)
+ */
+/*===========================================================================*/
+kvs::ValueArray<kvs::Real32> ScatteredDataInterpolation::interpolate( const kvs::ValueArray<kvs::Real32>& coords ) const
+{
+    const size_t veclen = m_veclen;
+    const size_t npoints = coords.size() / 3;
+    kvs::ValueArray<kvs::Real32> values( npoints * veclen );
+    KVS_OMP_PARALLEL()
+    {
+        std::vector<kvs::KdTree::Neighbor> neighbors;
+
+        KVS_OMP_FOR( schedule(dynamic, 64) )
+        for ( size_t i = 0; i < npoints; i++ )
+        {
+            const kvs::Vec3 point( coords.data() + i * 3 );
+            this->interpolate_at( point, neighbors, values.data() + i * veclen );
+        }
+    }
+
+    return values;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Interpolates the value at the point.
+ *  @param  point [in] coordinate of the point
+ *  @param  neighbors [in] work buffer for the search
+ *  @param  value [out] interpolated value (veclen components)
+ *
+ *  The value is sum(w_i v_i)/sum(w_i) with w_i = 1/d_i^p over the found
+ *  samples. The value of a sample coinciding with the point is returned as
+ *  is, and zero is returned if no sample is found.
+ */
+/*===========================================================================*/
+void ScatteredDataInterpolation::interpolate_at(
+    const kvs::Vec3& point,
+    std::vector<kvs::KdTree::Neighbor>& neighbors,
+    kvs::Real32* value ) const
+{
+    const size_t veclen = m_veclen;
+    for ( size_t j = 0; j < veclen; j++ ) { value[j] = 0.0f; }
+
+    const size_t n = m_tree.search( point, m_nneighbors, m_radius, neighbors );
+    if ( n == 0 ) { return; }
+
+    if ( neighbors[0].distance2 <= 0.0f )
+    {
+        const kvs::Real32* s = m_samples.data() + neighbors[0].index * veclen;
+        for ( size_t j = 0; j < veclen; j++ ) { value[j] = s[j]; }
+        return;
+    }
+
+    const kvs::Real32 half_power = m_power * 0.5f;
+    kvs::Real32 sum = 0.0f;
+    for ( size_t i = 0; i < n; i++ )
+    {
+        const kvs::Real32 d2 = neighbors[i].distance2;
+        const kvs::Real32 w = ( half_power == 1.0f ) ? 1.0f / d2 : 1.0f / std::pow( d2, half_power );
+        const kvs::Real32* s = m_samples.data() + neighbors[i].index * veclen;
+        for ( size_t j = 0; j < veclen; j++ ) { value[j] += w * s[j]; }
+        sum += w;
+    }
+
+    for ( size_t j = 0; j < veclen; j++ ) { value[j] /= sum; }
+}
+
+} // end of namespace kvs
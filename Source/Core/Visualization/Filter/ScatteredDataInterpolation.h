@@ -0,0 +1,102 @@
+/*****************************************************************************/
+/**
+ *  @file   ScatteredDataInterpolation.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVS__SCATTERED_DATA_INTERPOLATION_H_INCLUDE
+#define KVS__SCATTERED_DATA_INTERPOLATION_H_INCLUDE
+
+#include <kvs/StructuredVolumeObject>
+#include <kvs/PointObject>
+#include <kvs/UnstructuredVolumeObject>
+#include <kvs/FilterBase>
+#include <kvs/AnyValueArray>
+#include <kvs/ValueArray>
+#include <kvs/KdTree>
+#include <kvs/Vector3>
+#include <kvs/Type>
+#include <kvs/Module>
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Scattered data interpolation class by inverse distance weighting.
+ *
+ *  The values of scattered samples (the vertices of a point object with
+ *  the values given by setSampleValues(), or the nodes of an unstructured
+ *  volume) are interpolated onto the nodes of a uniform grid by Shepard's
+ *  method with the k nearest samples within the radius, which are found by
+ *  a k-d tree.
+ *  The values can have any veclen, e.g. 1 (scalar), 3 (vector) or 9 (tensor),
+ *  and are interpolated as Real32.
+ *
+ *  kvs::InverseDistanceWeighting is not used for the weighting, since it
+ *  stores the contributions of all the nodes before the evaluation, and
+ *  divides the normalized sum by the number of the contributions, which is
+ *  not Shepard's interpolant. Here the weights are normalized for each
+ *  point just after its search, without storing the neighbors.
+ */
+/*===========================================================================*/
+class ScatteredDataInterpolation : public kvs::FilterBase, public kvs::StructuredVolumeObject
+{
+    kvsModule( kvs::ScatteredDataInterpolation, Filter );
+    kvsModuleBaseClass( kvs::FilterBase );
+    kvsModuleSuperClass( kvs::StructuredVolumeObject );
+
+private:
+
+    kvs::Vec3ui m_resolution; ///< resolution of the grid
+    bool m_has_bounds; ///< true if the bounds are specified
+    kvs::Vec3 m_min_coord; ///< min. coordinate of the grid
+    kvs::Vec3 m_max_coord; ///< max. coordinate of the grid
+    size_t m_nneighbors; ///< max. number of the samples (0: unlimited)
+    kvs::Real32 m_radius; ///< search radius (0: unlimited)
+    kvs::Real32 m_power; ///< power parameter of the inverse distance
+    kvs::AnyValueArray m_sample_values; ///< sample values specified for point object
+    size_t m_sample_veclen; ///< veclen of the specified sample values
+    kvs::KdTree m_tree; ///< k-d tree of the samples
+    kvs::ValueArray<kvs::Real32> m_samples; ///< sample values converted to Real32
+    size_t m_veclen; ///< veclen of the samples
+
+public:
+
+    ScatteredDataInterpolation();
+    ScatteredDataInterpolation( const kvs::UnstructuredVolumeObject* volume, const kvs::Vec3ui& resolution );
+    virtual ~ScatteredDataInterpolation();
+
+    const kvs::Vec3ui& gridResolution() const { return m_resolution; }
+    size_t numberOfNeighbors() const { return m_nneighbors; }
+    kvs::Real32 radius() const { return m_radius; }
+    kvs::Real32 power() const { return m_power; }
+
+    void setGridResolution( const kvs::Vec3ui& resolution ) { m_resolution = resolution; }
+    void setBounds( const kvs::Vec3& min_coord, const kvs::Vec3& max_coord );
+    void setNumberOfNeighbors( const size_t nneighbors ) { m_nneighbors = nneighbors; }
+    void setRadius( const kvs::Real32 radius ) { m_radius = radius; }
+    void setPower( const kvs::Real32 power ) { m_power = power; }
+    void setSampleValues( const kvs::AnyValueArray& values, const size_t veclen );
+
+    SuperClass* exec( const kvs::ObjectBase* object );
+    bool attachSource( const kvs::ObjectBase* object );
+    kvs::ValueArray<kvs::Real32> interpolate( const kvs::ValueArray<kvs::Real32>& coords ) const;
+
+private:
+
+    struct ValueConverter;
+    void interpolate_at( const kvs::Vec3& point, std::vector<kvs::KdTree::Neighbor>& neighbors, kvs::Real32* value ) const;
+};
+
+} // end of namespace kvs
+
+#endif // KVS__SCATTERED_DATA_INTERPOLATION_H_INCLUDE
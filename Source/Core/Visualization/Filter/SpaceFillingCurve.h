@@ -0,0 +1,116 @@
+/*****************************************************************************/
+/**
+ *  @file   SpaceFillingCurve.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#pragma once
+#include <kvs/Type>
+
+
+namespace kvs
+{
+
+namespace detail
+{
+
+/// Number of bits of the quantized coordinate per axis (3 x 21 bits in a 64-bit key).
+const int CurveKeyBits = 21;
+
+/*===========================================================================*/
+/**
+ *  @brief  Pair of the space-filling-curve key and the element index.
+ */
+/*===========================================================================*/
+struct CurveKey
+{
+    kvs::UInt64 key; ///< space-filling-curve key
+    kvs::UInt32 index; ///< element index (e.g. cell or triangle)
+
+    bool operator <( const CurveKey& other ) const
+    {
+        return key < other.key || ( key == other.key && index < other.index );
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Spreads the lower 21 bits so that two zero bits follow each bit.
+ */
+/*===========================================================================*/
+inline kvs::UInt64 SpreadBits( const kvs::UInt32 value )
+{
+    kvs::UInt64 x = value & 0x1fffff;
+    x = ( x | x << 32 ) & 0x1f00000000ffffULL;
+    x = ( x | x << 16 ) & 0x1f0000ff0000ffULL;
+    x = ( x | x << 8 )  & 0x100f00f00f00f00fULL;
+    x = ( x | x << 4 )  & 0x10c30c30c30c30c3ULL;
+    x = ( x | x << 2 )  & 0x1249249249249249ULL;
+    return x;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the Morton key of the quantized coordinate.
+ */
+/*===========================================================================*/
+inline kvs::UInt64 MortonKey( const kvs::UInt32 x, const kvs::UInt32 y, const kvs::UInt32 z )
+{
+    return ( SpreadBits( x ) << 2 ) | ( SpreadBits( y ) << 1 ) | SpreadBits( z );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the Hilbert key of the quantized coordinate.
+ *
+ *  The coordinate is converted to the transposed Hilbert index by Skilling's
+ *  algorithm (J. Skilling, "Programming the Hilbert curve", 2004), whose bits
+ *  are then interleaved in the same way as the Morton key.
+ */
+/*===========================================================================*/
+inline kvs::UInt64 HilbertKey( const kvs::UInt32 x, const kvs::UInt32 y, const kvs::UInt32 z )
+{
+    kvs::UInt32 X[3] = { x, y, z };
+    const kvs::UInt32 M = 1u << ( CurveKeyBits - 1 );
+
+    // Inverse undo.
+    for ( kvs::UInt32 Q = M; Q > 1; Q >>= 1 )
+    {
+        const kvs::UInt32 P = Q - 1;
+        for ( int i = 0; i < 3; i++ )
+        {
+            if ( X[i] & Q ) { X[0] ^= P; }
+            else
+            {
+                const kvs::UInt32 t = ( X[0] ^ X[i] ) & P;
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+
+    // Gray encode.
+    X[1] ^= X[0];
+    X[2] ^= X[1];
+    kvs::UInt32 t = 0;
+    for ( kvs::UInt32 Q = M; Q > 1; Q >>= 1 )
+    {
+        if ( X[2] & Q ) { t ^= Q - 1; }
+    }
+    X[0] ^= t;
+    X[1] ^= t;
+    X[2] ^= t;
+
+    return MortonKey( X[0], X[1], X[2] );
+}
+
+} // end of namespace detail
+
+} // end of namespace kvs
@@ -13,80 +13,49 @@
  */
 /*****************************************************************************/
 #include "TetrahedraToTetrahedra.h"
+#include "ParallelSort.h"
 #include <algorithm>
-#include <map>
+#include <vector>
 #include <kvs/AnyValueArray>
+#include <kvs/Math>
+#include <kvs/OpenMP>
 
 
 namespace
 {
 
-/*===========================================================================*/
-/**
- *  @brief  ID map class for removing the duplicated nodes.
- */
-/*===========================================================================*/
-class IDMap
-{
-public:
-
-    typedef kvs::UInt32 Key;
-    typedef kvs::UInt32 Value;
-    typedef std::map<Key,Value> Bucket;
-
-private:
-
-    size_t m_index; ///< index of the connection ID
-    Bucket m_bucket; ///< bucket for the IDs
-
-public:
-
-    IDMap();
-
-    const Bucket& bucket() const;
-    void insert( const kvs::UInt32 id );
+/// Local node indices of the quadratic tetrahedron for each of the eight subdivided tetrahedra.
+const size_t SubdividedTetrahedra[8][4] = {
+    { 0, 4, 5, 6 },
+    { 4, 1, 7, 9 },
+    { 5, 7, 2, 8 },
+    { 6, 9, 8, 3 },
+    { 5, 6, 4, 9 },
+    { 5, 9, 4, 7 },
+    { 5, 8, 9, 7 },
+    { 5, 6, 9, 8 }
 };
 
-/*===========================================================================*/
-/**
- *  @brief  Constructs a new IDMap class.
- */
-/*===========================================================================*/
-IDMap::IDMap():
-    m_index( 0 )
-{
-}
-
-/*===========================================================================*/
-/**
- *  @brief  Returns the ID bucket.
- *  @return ID bucket
- */
-/*===========================================================================*/
-const IDMap::Bucket& IDMap::bucket() const
-{
-    return m_bucket;
-}
+/// Vertex pairs of the edges of the tetrahedron, in the order of the quadratic nodes 4 to 9.
+const size_t TetrahedronEdges[6][2] = {
+    { 0, 1 }, { 0, 2 }, { 0, 3 }, { 1, 2 }, { 2, 3 }, { 1, 3 }
+};
 
 /*===========================================================================*/
 /**
- *  @brief  Inserts a ID.
- *  @param  id [in] ID
+ *  @brief  Pair of the edge key (min. node index, max. node index) and the edge slot.
  */
 /*===========================================================================*/
-void IDMap::insert( const kvs::UInt32 id )
+struct EdgeKey
 {
-    const Key key = id;
-    const Value value = m_index;
+    kvs::UInt64 key; ///< (min. node index << 32) | max. node index
+    kvs::UInt32 slot; ///< cell index * 6 + local edge index
 
-    Bucket::iterator i = m_bucket.find( key );
-    Bucket::const_iterator last = m_bucket.end();
-    if ( i == last )
+    bool operator <( const EdgeKey& other ) const
     {
-        m_bucket.insert( Bucket::value_type( key, value ) );
-        m_index++;
+        return key < other.key || ( key == other.key && slot < other.slot );
     }
-}
+};
 
 } // end of namespace
 
@@ -152,7 +121,9 @@ TetrahedraToTetrahedra::SuperClass* TetrahedraToTetrahedra::exec( const kvs::Obj
         return NULL;
     }
 
-    if ( volume->cellType() == kvs::UnstructuredVolumeObject::QuadraticTetrahedra )
+    const bool quadratic = ( volume->cellType() == kvs::UnstructuredVolumeObject::QuadraticTetrahedra );
+    const bool linear = ( volume->cellType() == kvs::UnstructuredVolumeObject::Tetrahedra );
+    if ( quadratic || ( linear && m_method == TetrahedraToTetrahedra::Subdivision8 ) )
     {
         if ( m_method == TetrahedraToTetrahedra::Subdivision8 )
         {
@@ -218,74 +189,129 @@ void TetrahedraToTetrahedra::setMethod( const TetrahedraToTetrahedra::Method met
 
 /*===========================================================================*/
 /**
- *  @brief  Subdivides a qudratic tetrahedron into eight tetrahedra.
+ *  @brief  Subdivides a tetrahedron into eight tetrahedra.
  *  @param  volume [in] pointer to the volume data
+ *
+ *  The quadratic tetrahedron is subdivided with its own mid-edge nodes. For
+ *  the linear tetrahedron, the mid-edge nodes are inserted: the edges of all
+ *  the cells are sorted by their (min,max) node pairs in parallel, and the
+ *  unique edges are numbered in the sorted order after the original nodes,
+ *  so that the result does not depend on the number of threads.
  */
 /*===========================================================================*/
 template <typename T>
 void TetrahedraToTetrahedra::subdivide_8_tetrahedra( const kvs::UnstructuredVolumeObject* volume )
 {
-    // Quadratic tetrahedral cells.
-    const size_t tet2_ncells = volume->numberOfCells();
-    const kvs::UInt32* tet2_pconnections = volume->connections().data();
+    const size_t ncells = volume->numberOfCells();
+    const size_t nnodes = volume->numberOfNodes();
+    const size_t veclen = volume->veclen();
+    const kvs::UInt32* connections = volume->connections().data();
+    const bool linear = ( volume->cellType() == kvs::UnstructuredVolumeObject::Tetrahedra );
+
+    // Node indices of the mid-edge nodes for each edge slot (cell index * 6 + local edge index).
+    kvs::ValueArray<kvs::UInt32> edge_nodes;
+    kvs::ValueArray<kvs::UInt32> edge_heads; // first slot of each unique edge
+    size_t nedges = 0;
+    if ( linear )
+    {
+        const size_t nslots = ncells * 6;
+        std::vector< ::EdgeKey> keys( nslots );
+        KVS_OMP_PARALLEL_FOR( schedule(static) )
+        for ( size_t i = 0; i < ncells; i++ )
+        {
+            const kvs::UInt32* cell = connections + i * 4;
+            for ( size_t j = 0; j < 6; j++ )
+            {
+                const kvs::UInt64 id0 = cell[ ::TetrahedronEdges[j][0] ];
+                const kvs::UInt64 id1 = cell[ ::TetrahedronEdges[j][1] ];
+                keys[ i * 6 + j ].key = ( kvs::Math::Min( id0, id1 ) << 32 ) | kvs::Math::Max( id0, id1 );
+                keys[ i * 6 + j ].slot = static_cast<kvs::UInt32>( i * 6 + j );
+            }
+        }
+
+        kvs::detail::SortKeys( keys );
+
+        kvs::ValueArray<kvs::UInt32> ranks( nslots );
+        KVS_OMP_PARALLEL_FOR( schedule(static) )
+        for ( size_t i = 0; i < nslots; i++ )
+        {
+            ranks[i] = ( i == 0 || keys[i].key != keys[ i - 1 ].key ) ? 1 : 0;
+        }
 
-    // Tetrahedral cells.
+        nedges = kvs::detail::ExclusiveScan( ranks );
+
+        edge_nodes.allocate( nslots );
+        edge_heads.allocate( nedges );
+        KVS_OMP_PARALLEL_FOR( schedule(static) )
+        for ( size_t i = 0; i < nslots; i++ )
+        {
+            const bool head = ( i == 0 || keys[i].key != keys[ i - 1 ].key );
+            const kvs::UInt32 rank = head ? ranks[i] : ranks[i] - 1;
+            edge_nodes[ keys[i].slot ] = static_cast<kvs::UInt32>( nnodes + rank );
+            if ( head ) { edge_heads[ rank ] = keys[i].slot; }
+        }
+    }
+
+    // Tetrahedral cells written by the cell index.
     const size_t ndivisions = 8;
-    const size_t tet_ncells = tet2_ncells * ndivisions;
+    const size_t nnodes_per_cell = linear ? 4 : 10;
+    const size_t tet_ncells = ncells * ndivisions;
     kvs::ValueArray<kvs::UInt32> tet_connections( tet_ncells * 4 );
-    kvs::UInt32* tet_pconnections = tet_connections.data();
-    for ( size_t i = 0; i < tet2_ncells; i++ )
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < ncells; i++ )
+    {
+        kvs::UInt32 id[10];
+        const kvs::UInt32* cell = connections + i * nnodes_per_cell;
+        for ( size_t j = 0; j < nnodes_per_cell; j++ ) { id[j] = cell[j]; }
+        if ( linear )
+        {
+            for ( size_t j = 0; j < 6; j++ ) { id[ 4 + j ] = edge_nodes[ i * 6 + j ]; }
+        }
+
+        kvs::UInt32* tet = tet_connections.data() + i * ndivisions * 4;
+        for ( size_t j = 0; j < ndivisions; j++ )
+        {
+            tet[ j * 4 + 0 ] = id[ ::SubdividedTetrahedra[j][0] ];
+            tet[ j * 4 + 1 ] = id[ ::SubdividedTetrahedra[j][1] ];
+            tet[ j * 4 + 2 ] = id[ ::SubdividedTetrahedra[j][2] ];
+            tet[ j * 4 + 3 ] = id[ ::SubdividedTetrahedra[j][3] ];
+        }
+    }
+
+    // Coordinates and values of the mid-edge nodes are the averages of the edge ends.
+    kvs::ValueArray<kvs::Real32> tet_coords = volume->coords();
+    kvs::AnyValueArray tet_any_values = volume->values();
+    if ( linear )
     {
-        const kvs::UInt32 id0 = *(tet2_pconnections++);
-        const kvs::UInt32 id1 = *(tet2_pconnections++);
-        const kvs::UInt32 id2 = *(tet2_pconnections++);
-        const kvs::UInt32 id3 = *(tet2_pconnections++);
-        const kvs::UInt32 id4 = *(tet2_pconnections++);
-        const kvs::UInt32 id5 = *(tet2_pconnections++);
-        const kvs::UInt32 id6 = *(tet2_pconnections++);
-        const kvs::UInt32 id7 = *(tet2_pconnections++);
-        const kvs::UInt32 id8 = *(tet2_pconnections++);
-        const kvs::UInt32 id9 = *(tet2_pconnections++);
-
-        *(tet_pconnections++) = id0;
-        *(tet_pconnections++) = id4;
-        *(tet_pconnections++) = id5;
-        *(tet_pconnections++) = id6;
-
-        *(tet_pconnections++) = id4;
-        *(tet_pconnections++) = id1;
-        *(tet_pconnections++) = id7;
-        *(tet_pconnections++) = id9;
-
-        *(tet_pconnections++) = id5;
-        *(tet_pconnections++) = id7;
-        *(tet_pconnections++) = id2;
-        *(tet_pconnections++) = id8;
-
-        *(tet_pconnections++) = id6;
-        *(tet_pconnections++) = id9;
-        *(tet_pconnections++) = id8;
-        *(tet_pconnections++) = id3;
-
-        *(tet_pconnections++) = id5;
-        *(tet_pconnections++) = id6;
-        *(tet_pconnections++) = id4;
-        *(tet_pconnections++) = id9;
-
-        *(tet_pconnections++) = id5;
-        *(tet_pconnections++) = id9;
-        *(tet_pconnections++) = id4;
-        *(tet_pconnections++) = id7;
-
-        *(tet_pconnections++) = id5;
-        *(tet_pconnections++) = id8;
-        *(tet_pconnections++) = id9;
-        *(tet_pconnections++) = id7;
-
-        *(tet_pconnections++) = id5;
-        *(tet_pconnections++) = id6;
-        *(tet_pconnections++) = id9;
-        *(tet_pconnections++) = id8;
+        const kvs::Real32* coords = volume->coords().data();
+        const T* values = static_cast<const T*>( volume->values().data() );
+        tet_coords.allocate( ( nnodes + nedges ) * 3 );
+        kvs::ValueArray<T> tet_values( ( nnodes + nedges ) * veclen );
+        std::copy( coords, coords + nnodes * 3, tet_coords.begin() );
+        std::copy( values, values + nnodes * veclen, tet_values.begin() );
+
+        KVS_OMP_PARALLEL_FOR( schedule(static) )
+        for ( size_t i = 0; i < nedges; i++ )
+        {
+            const size_t slot = edge_heads[i];
+            const size_t edge = slot % 6;
+            const kvs::UInt32* cell = connections + ( slot / 6 ) * 4;
+            const size_t id0 = cell[ ::TetrahedronEdges[ edge ][0] ];
+            const size_t id1 = cell[ ::TetrahedronEdges[ edge ][1] ];
+            const size_t index = nnodes + i;
+            for ( size_t k = 0; k < 3; k++ )
+            {
+                tet_coords[ index * 3 + k ] = ( coords[ id0 * 3 + k ] + coords[ id1 * 3 + k ] ) * 0.5f;
+            }
+            for ( size_t k = 0; k < veclen; k++ )
+            {
+                const kvs::Real64 v0 = static_cast<kvs::Real64>( values[ id0 * veclen + k ] );
+                const kvs::Real64 v1 = static_cast<kvs::Real64>( values[ id1 * veclen + k ] );
+                tet_values[ index * veclen + k ] = static_cast<T>( ( v0 + v1 ) * 0.5 );
+            }
+        }
+
+        tet_any_values = kvs::AnyValueArray( tet_values );
     }
 
     if ( volume->hasMinMaxExternalCoords() )
@@ -309,80 +335,78 @@ void TetrahedraToTetrahedra::subdivide_8_tetrahedra( const kvs::UnstructuredVolu
         SuperClass::setMinMaxValues( min_value, max_value );
     }
 
-    SuperClass::setVeclen( volume->veclen() );
-    SuperClass::setNumberOfNodes( volume->numberOfNodes() );
+    SuperClass::setVeclen( veclen );
+    SuperClass::setNumberOfNodes( nnodes + nedges );
     SuperClass::setNumberOfCells( tet_ncells );
     SuperClass::setCellType( kvs::UnstructuredVolumeObject::Tetrahedra );
-    SuperClass::setCoords( volume->coords() );
+    SuperClass::setCoords( tet_coords );
     SuperClass::setConnections( tet_connections );
-    SuperClass::setValues( volume->values() );
+    SuperClass::setValues( tet_any_values );
 }
 
 /*===========================================================================*/
 /**
  *  @brief  Removes the quadratic nodes.
  *  @param  volume [in] pointer to the volume data
+ *
+ *  The vertex nodes referenced by the cells are marked and compacted by a
+ *  parallel prefix sum, so that they keep their original order.
  */
 /*===========================================================================*/
 template <typename T>
 void TetrahedraToTetrahedra::remove_quadratic_nodes( const kvs::UnstructuredVolumeObject* volume )
 {
     const size_t tet2_ncells = volume->numberOfCells();
+    const size_t tet2_nnodes = volume->numberOfNodes();
     const kvs::UInt32* tet2_pconnections = volume->connections().data();
     const T* tet2_pvalues = static_cast<const T*>( volume->values().data() );
     const kvs::Real32* tet2_pcoords = volume->coords().data();
 
-    ::IDMap id_map;
+    // Marks of the vertex nodes. The concurrent stores write the same value.
+    kvs::ValueArray<kvs::UInt32> new_ids( tet2_nnodes );
+    new_ids.fill( 0 );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
     for ( size_t i = 0; i < tet2_ncells; i++ )
     {
-        const kvs::UInt32 id0 = tet2_pconnections[ 10 * i + 0 ];
-        const kvs::UInt32 id1 = tet2_pconnections[ 10 * i + 1 ];
-        const kvs::UInt32 id2 = tet2_pconnections[ 10 * i + 2 ];
-        const kvs::UInt32 id3 = tet2_pconnections[ 10 * i + 3 ];
-
-        id_map.insert( id0 );
-        id_map.insert( id1 );
-        id_map.insert( id2 );
-        id_map.insert( id3 );
+        new_ids[ tet2_pconnections[ 10 * i + 0 ] ] = 1;
+        new_ids[ tet2_pconnections[ 10 * i + 1 ] ] = 1;
+        new_ids[ tet2_pconnections[ 10 * i + 2 ] ] = 1;
+        new_ids[ tet2_pconnections[ 10 * i + 3 ] ] = 1;
     }
 
+    const size_t tet_veclen = volume->veclen();
+    const size_t tet_nnodes = kvs::detail::ExclusiveScan( new_ids );
+
     const size_t tet_ncells = tet2_ncells;
     kvs::ValueArray<kvs::UInt32> tet_connections( tet_ncells * 4 );
-    kvs::UInt32* tet_pconnections = tet_connections.data();
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
     for ( size_t i = 0; i < tet2_ncells; i++ )
     {
-        const kvs::UInt32 id0 = tet2_pconnections[ 10 * i + 0 ];
-        const kvs::UInt32 id1 = tet2_pconnections[ 10 * i + 1 ];
-        const kvs::UInt32 id2 = tet2_pconnections[ 10 * i + 2 ];
-        const kvs::UInt32 id3 = tet2_pconnections[ 10 * i + 3 ];
-
-        *(tet_pconnections++) = id_map.bucket().find( id0 )->second;
-        *(tet_pconnections++) = id_map.bucket().find( id1 )->second;
-        *(tet_pconnections++) = id_map.bucket().find( id2 )->second;
-        *(tet_pconnections++) = id_map.bucket().find( id3 )->second;
+        tet_connections[ 4 * i + 0 ] = new_ids[ tet2_pconnections[ 10 * i + 0 ] ];
+        tet_connections[ 4 * i + 1 ] = new_ids[ tet2_pconnections[ 10 * i + 1 ] ];
+        tet_connections[ 4 * i + 2 ] = new_ids[ tet2_pconnections[ 10 * i + 2 ] ];
+        tet_connections[ 4 * i + 3 ] = new_ids[ tet2_pconnections[ 10 * i + 3 ] ];
     }
 
-    const size_t tet_veclen = volume->veclen();
-    const size_t tet_nnodes = id_map.bucket().size();
     kvs::ValueArray<T> tet_values( tet_nnodes * tet_veclen );
     kvs::ValueArray<kvs::Real32> tet_coords( tet_nnodes * 3 );
-    T* tet_pvalues = tet_values.data();
-    kvs::Real32* tet_pcoords = tet_coords.data();
-    ::IDMap::Bucket::const_iterator id = id_map.bucket().begin();
-    while ( id != id_map.bucket().end() )
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < tet2_nnodes; i++ )
     {
+        const size_t id = new_ids[i];
+        const bool used = ( i + 1 < tet2_nnodes ) ? new_ids[ i + 1 ] != id : id < tet_nnodes;
+        if ( !used ) { continue; }
+
         // Value array.
-        for ( size_t i = 0; i < tet_veclen; i++ )
+        for ( size_t j = 0; j < tet_veclen; j++ )
         {
-            tet_pvalues[ id->second * tet_veclen + i ] = tet2_pvalues[ id->first * tet_veclen + i ];
+            tet_values[ id * tet_veclen + j ] = tet2_pvalues[ i * tet_veclen + j ];
         }
 
         // Coordinate data array.
-        tet_pcoords[ id->second * 3 + 0 ] = tet2_pcoords[ id->first * 3 + 0 ];
-        tet_pcoords[ id->second * 3 + 1 ] = tet2_pcoords[ id->first * 3 + 1 ];
-        tet_pcoords[ id->second * 3 + 2 ] = tet2_pcoords[ id->first * 3 + 2 ];
-
-        ++id;
+        tet_coords[ id * 3 + 0 ] = tet2_pcoords[ i * 3 + 0 ];
+        tet_coords[ id * 3 + 1 ] = tet2_pcoords[ i * 3 + 1 ];
+        tet_coords[ id * 3 + 2 ] = tet2_pcoords[ i * 3 + 2 ];
     }
 
     if ( volume->hasMinMaxExternalCoords() )
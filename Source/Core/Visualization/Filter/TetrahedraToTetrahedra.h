@@ -38,7 +38,7 @@ public:
 
     enum Method
     {
-        Subdivision8, ///< subdivide a quadratic tetrahedron into eight linear tetrahedra
+        Subdivision8, ///< subdivide a (quadratic) tetrahedron into eight linear tetrahedra
         Removal ///< remove the quadratic nodes
     };
 
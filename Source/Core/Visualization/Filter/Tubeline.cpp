@@ -12,8 +12,12 @@
  */
 /*****************************************************************************/
 #include "Tubeline.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
 #include <kvs/Quaternion>
 #include <kvs/Math>
+#include <kvs/OpenMP>
 
 
 namespace
@@ -155,7 +159,7 @@ const kvs::ValueArray<kvs::UInt8> GetColorArray( const kvs::LineObject* line )
  *  @param  line [in] pointer to the line object
  *  @param  id1 [in] ID of the start vertex
  *  @param  id2 [in] ID of the end vertex
- *  @param  con_id [in]
+ *  @param  counter [in] number of the segments of the preceding lines
  *  @return color array
  */
 /*===========================================================================*/
@@ -163,7 +167,7 @@ const kvs::ValueArray<kvs::UInt8> GetColorArray(
     const kvs::LineObject* line,
     const size_t id1,
     const size_t id2,
-    const size_t con_id )
+    const size_t counter )
 {
     // Ponter to the color array of the line object.
     const kvs::UInt8* c = line->colors().data();
@@ -189,16 +193,6 @@ const kvs::ValueArray<kvs::UInt8> GetColorArray(
         if ( line->colorType() == kvs::LineObject::LineColor )
         {
             kvs::ValueArray<kvs::UInt8> colors( ncomponents * ncolors );
-
-            const kvs::UInt32* n = line->connections().data();
-
-            size_t counter = 0;
-            for ( size_t i = 0, index = 0; i < con_id; i++, index += 2 )
-            {
-                const size_t index_0 = n[ index + 0 ];
-                const size_t index_1 = n[ index + 1 ];
-                counter += index_1 - index_0;
-            }
             for ( size_t i = 0, index = 0; i < ncolors - 1; i++ , index += ncomponents )
             {
                 const size_t j = ( i + counter ) * ncomponents;
@@ -274,7 +268,7 @@ const kvs::ValueArray<kvs::Real32> GetSizeArray( const kvs::LineObject* line )
  *  @param  line [in] pointer to the line object
  *  @param  id1 [in] ID of the start vertex
  *  @param  id2 [in] ID of the end vertex
- *  @param  con_id [in]
+ *  @param  counter [in] number of the segments of the preceding lines
  *  @return size array
  */
 /*===========================================================================*/
@@ -282,7 +276,7 @@ const kvs::ValueArray<kvs::Real32> GetSizeArray(
     const kvs::LineObject* line,
     const size_t id1,
     const size_t id2,
-    const size_t con_id )
+    const size_t counter )
 {
     // Ponter to the size array of the line object.
     const kvs::Real32* s = line->sizes().data();
@@ -303,16 +297,6 @@ const kvs::ValueArray<kvs::Real32> GetSizeArray(
     else if ( line->numberOfSizes() > 1 )
     {
         kvs::ValueArray<kvs::Real32> sizes( nsizes );
-
-        const kvs::UInt32* n = line->connections().data();
-
-        size_t counter = 0;
-        for ( size_t i = 0, index = 0; i < con_id; i++, index += 2 )
-        {
-            const size_t index_0 = n[ index + 0 ];
-            const size_t index_1 = n[ index + 1 ];
-            counter += index_1 - index_0;
-        }
         for ( size_t i = 0; i < nsizes; i++ )
         {
             sizes[i] = s[ i + counter ];
@@ -377,6 +361,117 @@ size_t GetNumberOfVertices( const kvs::LineObject* line )
     return nvertices;
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Returns a number of the lines to be converted to tubes.
+ *  @param  line [in] pointer to the line object
+ *  @return number of the lines
+ */
+/*===========================================================================*/
+size_t GetNumberOfLines( const kvs::LineObject* line )
+{
+    switch ( line->lineType() )
+    {
+    case kvs::LineObject::Strip:
+    case kvs::LineObject::Uniline:
+        return 1;
+    case kvs::LineObject::Polyline:
+    case kvs::LineObject::Segment:
+        return line->numberOfConnections();
+    default:
+        return 0;
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns a number of the vertices of the line.
+ *  @param  line [in] pointer to the line object
+ *  @param  index [in] index of the line
+ *  @return number of the vertices
+ */
+/*===========================================================================*/
+size_t GetNumberOfLineVertices( const kvs::LineObject* line, const size_t index )
+{
+    if ( line->lineType() == kvs::LineObject::Polyline )
+    {
+        const kvs::UInt32* c = line->connections().data();
+        return c[ 2 * index + 1 ] - c[ 2 * index ] + 1;
+    }
+    else if ( line->lineType() == kvs::LineObject::Segment )
+    {
+        return 2;
+    }
+
+    return GetNumberOfVertices( line );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the vertex, size and color arrays of the line.
+ *  @param  line [in] pointer to the line object
+ *  @param  index [in] index of the line
+ *  @param  counter [in] number of the segments of the preceding lines
+ *  @param  vertices [out] vertex array
+ *  @param  sizes [out] size array
+ *  @param  colors [out] color array
+ */
+/*===========================================================================*/
+void GetLineArrays(
+    const kvs::LineObject* line,
+    const size_t index,
+    const size_t counter,
+    kvs::ValueArray<kvs::Real32>* vertices,
+    kvs::ValueArray<kvs::Real32>* sizes,
+    kvs::ValueArray<kvs::UInt8>* colors )
+{
+    const kvs::LineObject::LineType type = line->lineType();
+    if ( type == kvs::LineObject::Strip || type == kvs::LineObject::Uniline )
+    {
+        *vertices = GetVertexArray( line );
+        *sizes = GetSizeArray( line );
+        *colors = GetColorArray( line );
+        return;
+    }
+
+    const size_t id1 = line->connections()[ 2 * index + 0 ];
+    const size_t id2 = line->connections()[ 2 * index + 1 ];
+    *vertices = GetVertexArray( line, id1, id2 );
+    if ( type == kvs::LineObject::Polyline )
+    {
+        *sizes = GetSizeArray( line, id1, id2, counter );
+        *colors = GetColorArray( line, id1, id2, counter );
+        return;
+    }
+
+    // Segment.
+    kvs::ValueArray<kvs::Real32> line_sizes(1);
+    if ( line->numberOfSizes() == 1 ) line_sizes[0] = line->size(0);
+    else line_sizes[0] = line->size( index );
+    *sizes = line_sizes;
+
+    const size_t i0 = ( line->numberOfColors() == 1 ) ? 0 : ( line->colorType() == kvs::LineObject::VertexColor ) ? id1 : index;
+    const size_t i1 = ( line->numberOfColors() == 1 ) ? 0 : ( line->colorType() == kvs::LineObject::VertexColor ) ? id2 : index;
+    kvs::ValueArray<kvs::UInt8> line_colors(6);
+    line_colors[0] = line->color( i0 ).r();
+    line_colors[1] = line->color( i0 ).g();
+    line_colors[2] = line->color( i0 ).b();
+    line_colors[3] = line->color( i1 ).r();
+    line_colors[4] = line->color( i1 ).g();
+    line_colors[5] = line->color( i1 ).b();
+    *colors = line_colors;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns a size of the array, or zero if the index is out of range.
+ */
+/*===========================================================================*/
+inline kvs::Real32 SizeAt( const kvs::ValueArray<kvs::Real32>& sizes, const size_t index )
+{
+    return index < sizes.size() ? sizes[ index ] : 0.0f;
+}
+
 } // end of namespace
 
 
@@ -390,7 +485,8 @@ namespace kvs
 /*===========================================================================*/
 Tubeline::Tubeline( void ):
     kvs::FilterBase(),
-    m_ndivisions( 0 )
+    m_ndivisions( 0 ),
+    m_output_type( TubePolygons )
 {
 }
 
@@ -404,7 +500,8 @@ Tubeline::Tubeline( void ):
 Tubeline::Tubeline(
     const kvs::LineObject* line,
     const size_t ndivisions ):
-    m_ndivisions( ndivisions )
+    m_ndivisions( ndivisions ),
+    m_output_type( TubePolygons )
 {
     this->exec( line );
 }
@@ -458,27 +555,30 @@ Tubeline::SuperClass* Tubeline::exec( const kvs::ObjectBase* object )
     SuperClass::setMinMaxExternalCoords( line->minExternalCoord(), line->maxExternalCoord() );
 
     const kvs::LineObject::LineType type = line->lineType();
-    if ( type == kvs::LineObject::Strip )
-    {
-        this->filtering_strip( line );
-    }
-    else if ( type == kvs::LineObject::Uniline )
-    {
-        this->filtering_uniline( line );
-    }
-    else if ( type == kvs::LineObject::Polyline )
+    if ( type != kvs::LineObject::Strip &&
+         type != kvs::LineObject::Uniline &&
+         type != kvs::LineObject::Polyline &&
+         type != kvs::LineObject::Segment )
     {
-        this->filtering_polyline( line );
+        BaseClass::setSuccess( false );
+        kvsMessageError("Unknown line type.");
+        return NULL;
     }
-    else if ( type == kvs::LineObject::Segment )
+
+    if ( m_output_type == CompactFrames )
     {
-        this->filtering_segment( line );
+        this->filtering_frames( line );
     }
     else
     {
-        BaseClass::setSuccess( false );
-        kvsMessageError("Unknown line type.");
-        return NULL;
+        if ( m_ndivisions < 2 )
+        {
+            BaseClass::setSuccess( false );
+            kvsMessageError("Number of divisions must be 2 or more.");
+            return NULL;
+        }
+
+        this->filtering_tubes( line );
     }
 
     return this;
@@ -486,151 +586,82 @@ Tubeline::SuperClass* Tubeline::exec( const kvs::ObjectBase* object )
 
 /*===========================================================================*/
 /**
- *  @brief  Creates tube's polygon for the strip type of the line object.
- *  @param  line [in] pointer to the line object
- */
-/*===========================================================================*/
-void Tubeline::filtering_strip( const kvs::LineObject* line )
-{
-    const kvs::ValueArray<kvs::Real32> line_vertices = ::GetVertexArray( line );
-    const kvs::ValueArray<kvs::Real32> line_sizes = ::GetSizeArray( line );
-    const kvs::ValueArray<kvs::UInt8> line_colors = ::GetColorArray( line );
-    const size_t nvertices = ::GetNumberOfVertices( line );
-    const kvs::PolygonObject::ColorType color_type = ::GetColorType( line );
-
-    std::vector<kvs::Real32> vertices;
-    std::vector<kvs::UInt8> colors;
-    std::vector<kvs::UInt32> connections;
-    std::vector<kvs::Real32> normals;
-    this->calculate_tubes(
-        &vertices,
-        &colors,
-        &connections,
-        &normals,
-        line_vertices,
-        line_sizes,
-        line_colors,
-        nvertices,
-        color_type );
-
-    SuperClass::setCoords( kvs::ValueArray<kvs::Real32>( vertices ) );
-    SuperClass::setColors( kvs::ValueArray<kvs::UInt8>( colors ) );
-    SuperClass::setNormals( kvs::ValueArray<kvs::Real32>( normals ) );
-    SuperClass::setConnections( kvs::ValueArray<kvs::UInt32>( connections ) );
-    SuperClass::setOpacity( 255 );
-    SuperClass::setPolygonType( kvs::PolygonObject::Quadrangle );
-    SuperClass::setColorType( color_type );
-    SuperClass::setNormalType( kvs::PolygonObject::PolygonNormal );
-}
-
-/*===========================================================================*/
-/**
- *  @brief  Creates tube's polygon for the uniline type of the line object.
+ *  @brief  Creates tube's polygon for the line object.
  *  @param  line [in] pointer to the line object
+ *
+ *  A line of n vertices is converted to 2n-3 blocks, each of which has two
+ *  circles of the vertices and the quadrangles between them: the tube of
+ *  the first segment, and the tube and the joint for each of the others.
+ *  The blocks are placed by the prefix sums over the lines, and the lines
+ *  (or the segments of a single line) are processed in parallel.
  */
 /*===========================================================================*/
-void Tubeline::filtering_uniline( const kvs::LineObject* line )
+void Tubeline::filtering_tubes( const kvs::LineObject* line )
 {
-    const kvs::ValueArray<kvs::Real32> line_vertices = ::GetVertexArray( line );
-    const kvs::ValueArray<kvs::Real32> line_sizes = ::GetSizeArray( line );
-    const kvs::ValueArray<kvs::UInt8> line_colors = ::GetColorArray( line );
-    const size_t nvertices = ::GetNumberOfVertices( line );
     const kvs::PolygonObject::ColorType color_type = ::GetColorType( line );
+    const size_t ndivisions = m_ndivisions;
+    const size_t nlines = ::GetNumberOfLines( line );
+    const bool has_attributes = line->numberOfSizes() > 0 && line->numberOfColors() > 0;
+
+    // For polylines with the polygon color, the colors of the last block of
+    // each line are omitted.
+    const bool omit_last_colors =
+        line->lineType() == kvs::LineObject::Polyline &&
+        color_type != kvs::PolygonObject::VertexColor;
+
+    std::vector<size_t> counters( nlines );
+    std::vector<size_t> block_offsets( nlines + 1, 0 );
+    std::vector<size_t> color_offsets( nlines + 1, 0 );
+    for ( size_t i = 0, counter = 0; i < nlines; i++ )
+    {
+        const size_t nvertices = ::GetNumberOfLineVertices( line, i );
+        const size_t nblocks = ( has_attributes && nvertices >= 2 ) ? 2 * nvertices - 3 : 0;
+        const size_t ncolor_blocks = ( omit_last_colors && nblocks > 0 ) ? nblocks - 1 : nblocks;
+        counters[i] = counter;
+        counter += nvertices > 0 ? nvertices - 1 : 0;
+        block_offsets[ i + 1 ] = block_offsets[i] + nblocks;
+        color_offsets[ i + 1 ] = color_offsets[i] + ncolor_blocks;
+    }
 
-    std::vector<kvs::Real32> vertices;
-    std::vector<kvs::UInt8> colors;
-    std::vector<kvs::UInt32> connections;
-    std::vector<kvs::Real32> normals;
-    this->calculate_tubes(
-        &vertices,
-        &colors,
-        &connections,
-        &normals,
-        line_vertices,
-        line_sizes,
-        line_colors,
-        nvertices,
-        color_type );
-
-    SuperClass::setCoords( kvs::ValueArray<kvs::Real32>( vertices ) );
-    SuperClass::setColors( kvs::ValueArray<kvs::UInt8>( colors ) );
-    SuperClass::setNormals( kvs::ValueArray<kvs::Real32>( normals ) );
-    SuperClass::setConnections( kvs::ValueArray<kvs::UInt32>( connections ) );
-    SuperClass::setOpacity( 255 );
-    SuperClass::setPolygonType( kvs::PolygonObject::Quadrangle );
-    SuperClass::setColorType( color_type );
-    SuperClass::setNormalType( kvs::PolygonObject::PolygonNormal );
-}
-
-/*===========================================================================*/
-/**
- *  @brief  Creates tube's polygon for the polyline type of the line object.
- *  @param  line [in] pointer to the line object
- */
-/*===========================================================================*/
-void Tubeline::filtering_polyline( const kvs::LineObject* line )
-{
-    std::vector<kvs::Real32> vertices;
-    std::vector<kvs::UInt8> colors;
-    std::vector<kvs::UInt32> connections;
-    std::vector<kvs::Real32> normals;
-
-    const kvs::PolygonObject::ColorType color_type = ::GetColorType( line );
+    const size_t nblocks = block_offsets[ nlines ];
+    const size_t ncolors_per_block = ( color_type == kvs::PolygonObject::VertexColor ) ? ndivisions * 2 : ndivisions;
+    kvs::ValueArray<kvs::Real32> vertices( nblocks * ndivisions * 2 * 3 );
+    kvs::ValueArray<kvs::UInt8> colors( color_offsets[ nlines ] * ncolors_per_block * 3 );
+    kvs::ValueArray<kvs::UInt32> connections( nblocks * ndivisions * 4 );
+    kvs::ValueArray<kvs::Real32> normals( nblocks * ndivisions * 3 );
 
-    const kvs::UInt32* line_connections = line->connections().data();
-    const size_t line_nconnections = line->numberOfConnections();
-    for( size_t i = 0, index = 0; i < line_nconnections; i++, index += 2 )
+    const bool parallel_lines = nlines > 1;
+    KVS_OMP_PARALLEL_FOR( if(parallel_lines) schedule(dynamic) )
+    for ( size_t i = 0; i < nlines; i++ )
     {
-        const size_t id1 = line_connections[ index + 0 ];
-        const size_t id2 = line_connections[ index + 1 ];
-
-        const kvs::ValueArray<kvs::Real32> line_vertices = ::GetVertexArray( line, id1, id2 );
-        const kvs::ValueArray<kvs::Real32> line_sizes = ::GetSizeArray( line, id1, id2, i );
-        const kvs::ValueArray<kvs::UInt8> line_colors = ::GetColorArray( line, id1, id2, i );
-        const size_t nvertices = id2 - id1 + 1;
+        const size_t block = block_offsets[i];
+        const size_t nblocks_of_line = block_offsets[ i + 1 ] - block;
+        if ( nblocks_of_line == 0 ) continue;
 
-        if ( line_sizes.size() < 2 ) continue;
-        if ( line_colors.size() < 2 ) continue;
+        kvs::ValueArray<kvs::Real32> line_vertices;
+        kvs::ValueArray<kvs::Real32> line_sizes;
+        kvs::ValueArray<kvs::UInt8> line_colors;
+        ::GetLineArrays( line, i, counters[i], &line_vertices, &line_sizes, &line_colors );
 
-        std::vector<kvs::Real32> tmp_vertices;
-        std::vector<kvs::UInt8> tmp_colors;
-        std::vector<kvs::UInt32> tmp_connections;
-        std::vector<kvs::Real32> tmp_normals;
         this->calculate_tubes(
-            &tmp_vertices,
-            &tmp_colors,
-            &tmp_connections,
-            &tmp_normals,
+            vertices.data() + block * ndivisions * 2 * 3,
+            colors.data() + color_offsets[i] * ncolors_per_block * 3,
+            connections.data() + block * ndivisions * 4,
+            normals.data() + block * ndivisions * 3,
             line_vertices,
             line_sizes,
             line_colors,
-            nvertices,
-            color_type );
-
-        const kvs::UInt32 nv = static_cast<kvs::UInt32>( vertices.size() / 3 );
-
-        vertices.insert( vertices.end(), tmp_vertices.begin(), tmp_vertices.end() );
-        normals.insert( normals.end(), tmp_normals.begin(), tmp_normals.end() );
-
-        const size_t tmp_ncolors = ( color_type == kvs::PolygonObject::VertexColor ) ?
-            tmp_colors.size() :
-            tmp_colors.size() - m_ndivisions * 3;
-        for( size_t j = 0; j < tmp_ncolors; j++ )
-        {
-            colors.push_back( tmp_colors[j] );
-        }
-
-        const size_t tmp_connections_size = tmp_connections.size();
-        for ( size_t j = 0; j < tmp_connections_size; j++ )
-        {
-            connections.push_back( tmp_connections[j] + nv );
-        }
+            ::GetNumberOfLineVertices( line, i ),
+            color_type,
+            color_offsets[ i + 1 ] - color_offsets[i],
+            static_cast<kvs::UInt32>( block * ndivisions * 2 ),
+            !parallel_lines );
     }
 
-    SuperClass::setCoords( kvs::ValueArray<kvs::Real32>( vertices ) );
-    SuperClass::setColors( kvs::ValueArray<kvs::UInt8>( colors ) );
-    SuperClass::setNormals( kvs::ValueArray<kvs::Real32>( normals ) );
-    SuperClass::setConnections( kvs::ValueArray<kvs::UInt32>( connections ) );
+    SuperClass::setCoords( vertices );
+    SuperClass::setColors( colors );
+    SuperClass::setNormals( normals );
+    SuperClass::setConnections( connections );
     SuperClass::setOpacity( 255 );
     SuperClass::setPolygonType( kvs::PolygonObject::Quadrangle );
     SuperClass::setColorType( color_type );
@@ -639,215 +670,224 @@ void Tubeline::filtering_polyline( const kvs::LineObject* line )
 
 /*===========================================================================*/
 /**
- *  @brief  Creates tube's polygon for the segment type of the line object.
+ *  @brief  Calculates the frames at the vertices of the line object.
  *  @param  line [in] pointer to the line object
+ *
+ *  The normals are propagated along each line by the double reflection
+ *  method (W. Wang et al., "Computation of Rotation Minimizing Frames",
+ *  ACM TOG 27(1), 2008), starting from a normal perpendicular to the first
+ *  tangent. The binormal of the frame is the cross product of the tangent
+ *  and the normal.
  */
 /*===========================================================================*/
-void Tubeline::filtering_segment( const kvs::LineObject* line )
+void Tubeline::filtering_frames( const kvs::LineObject* line )
 {
-    std::vector<kvs::Real32> vertices;
-    std::vector<kvs::UInt8> colors;
-    std::vector<kvs::UInt32> connections;
-    std::vector<kvs::Real32> normals;
+    const size_t nlines = ::GetNumberOfLines( line );
 
-    const kvs::PolygonObject::ColorType color_type = ::GetColorType( line );
+    std::vector<size_t> counters( nlines );
+    m_frame_offsets.allocate( nlines + 1 );
+    m_frame_offsets[0] = 0;
+    for ( size_t i = 0, counter = 0; i < nlines; i++ )
+    {
+        const size_t nvertices = ::GetNumberOfLineVertices( line, i );
+        counters[i] = counter;
+        counter += nvertices > 0 ? nvertices - 1 : 0;
+        m_frame_offsets[ i + 1 ] = static_cast<kvs::UInt32>( m_frame_offsets[i] + nvertices );
+    }
 
-    const kvs::UInt32* line_connections = line->connections().data();
-    const size_t line_nconnections = line->numberOfConnections();
-    for( size_t i = 0, index = 0; i < line_nconnections; i++, index += 2 )
+    const size_t nframes = m_frame_offsets[ nlines ];
+    m_frame_coords.allocate( nframes * 3 );
+    m_frame_tangents.allocate( nframes * 3 );
+    m_frame_normals.allocate( nframes * 3 );
+    m_frame_radii.allocate( nframes );
+    m_frame_colors.allocate( nframes * 3 );
+    m_frame_radii.fill( 0.0f );
+    m_frame_colors.fill( 255 );
+
+    KVS_OMP_PARALLEL_FOR( if(nlines > 1) schedule(dynamic) )
+    for ( size_t i = 0; i < nlines; i++ )
     {
-        const size_t id1 = line_connections[ index + 0 ];
-        const size_t id2 = line_connections[ index + 1 ];
+        const size_t offset = m_frame_offsets[i];
+        const size_t nvertices = m_frame_offsets[ i + 1 ] - offset;
+        if ( nvertices == 0 ) continue;
 
-        const size_t nvertices = 2;
-        const kvs::ValueArray<kvs::Real32> line_vertices = ::GetVertexArray( line, id1, id2 );
-//        const kvs::Real32 line_size = ( line->nsizes() == 1 ) ? line->size(0) : line->size(i);
-        kvs::ValueArray<kvs::Real32> line_sizes(1);
-        if ( line->numberOfSizes() == 1 ) line_sizes[0] = line->size(0);
-        else line_sizes[0] = line->size(i);
-
-        kvs::ValueArray<kvs::UInt8> line_colors(6);
-        if ( line->numberOfColors() == 1 )
-        {
-            line_colors[0] = line->color(0).r();
-            line_colors[1] = line->color(0).g();
-            line_colors[2] = line->color(0).b();
-            line_colors[3] = line->color(0).r();
-            line_colors[4] = line->color(0).g();
-            line_colors[5] = line->color(0).b();
-        }
-        else
+        kvs::ValueArray<kvs::Real32> line_vertices;
+        kvs::ValueArray<kvs::Real32> line_sizes;
+        kvs::ValueArray<kvs::UInt8> line_colors;
+        ::GetLineArrays( line, i, counters[i], &line_vertices, &line_sizes, &line_colors );
+
+        kvs::Real32* coords = m_frame_coords.data() + offset * 3;
+        kvs::Real32* tangents = m_frame_tangents.data() + offset * 3;
+        kvs::Real32* normals = m_frame_normals.data() + offset * 3;
+        std::copy( line_vertices.begin(), line_vertices.begin() + nvertices * 3, coords );
+
+        for ( size_t j = 0; j < nvertices; j++ )
         {
-            if( color_type == kvs::PolygonObject::VertexColor )
+            if ( line_sizes.size() > 0 ) { m_frame_radii[ offset + j ] = line_sizes[ kvs::Math::Min( j, line_sizes.size() - 1 ) ]; }
+            if ( line_colors.size() >= ( j + 1 ) * 3 )
             {
-                line_colors[0] = line->color(id1).r();
-                line_colors[1] = line->color(id1).g();
-                line_colors[2] = line->color(id1).b();
-                line_colors[3] = line->color(id2).r();
-                line_colors[4] = line->color(id2).g();
-                line_colors[5] = line->color(id2).b();
-            }
-            else
-            {
-                line_colors[0] = line->color(i).r();
-                line_colors[1] = line->color(i).g();
-                line_colors[2] = line->color(i).b();
-                line_colors[3] = line->color(i).r();
-                line_colors[4] = line->color(i).g();
-                line_colors[5] = line->color(i).b();
+                for ( size_t k = 0; k < 3; k++ ) { m_frame_colors[ ( offset + j ) * 3 + k ] = line_colors[ j * 3 + k ]; }
             }
         }
 
-        std::vector<kvs::Real32> tmp_vertices;
-        std::vector<kvs::UInt8> tmp_colors;
-        std::vector<kvs::UInt32> tmp_connections;
-        std::vector<kvs::Real32> tmp_normals;
-        this->calculate_tubes(
-            &tmp_vertices,
-            &tmp_colors,
-            &tmp_connections,
-            &tmp_normals,
-            line_vertices,
-            line_sizes,
-            line_colors,
-            nvertices,
-            color_type );
+        // Tangents by the central differences.
+        kvs::Vector3f previous_tangent( 0.0f, 0.0f, 1.0f );
+        for ( size_t j = 0; j < nvertices; j++ )
+        {
+            const size_t j0 = j > 0 ? j - 1 : 0;
+            const size_t j1 = kvs::Math::Min( j + 1, nvertices - 1 );
+            const kvs::Vector3f d = kvs::Vector3f( coords + j1 * 3 ) - kvs::Vector3f( coords + j0 * 3 );
+            const float length = static_cast<float>( d.length() );
+            const kvs::Vector3f t = kvs::Math::IsZero( length ) ? previous_tangent : d / length;
+            tangents[ j * 3 + 0 ] = t.x();
+            tangents[ j * 3 + 1 ] = t.y();
+            tangents[ j * 3 + 2 ] = t.z();
+            previous_tangent = t;
+        }
 
-        vertices.insert( vertices.end(), tmp_vertices.begin(), tmp_vertices.end() );
-        normals.insert( normals.end(), tmp_normals.begin(), tmp_normals.end() );
-        colors.insert( colors.end(), tmp_colors.begin(), tmp_colors.end() );
+        // Initial normal perpendicular to the first tangent.
+        const kvs::Vector3f t0( tangents );
+        const kvs::Vector3f axis = ( std::fabs( t0.x() ) < 0.9f ) ? kvs::Vector3f( 1.0f, 0.0f, 0.0f ) : kvs::Vector3f( 0.0f, 1.0f, 0.0f );
+        kvs::Vector3f r = t0.cross( axis ).normalized();
+        normals[0] = r.x();
+        normals[1] = r.y();
+        normals[2] = r.z();
 
-        const kvs::UInt32 nv = static_cast<kvs::UInt32>( vertices.size() / 3 );
-        const size_t tmp_connections_size = tmp_connections.size();
-        for ( size_t j = 0; j < tmp_connections_size; j++ )
+        // Double reflection.
+        for ( size_t j = 0; j + 1 < nvertices; j++ )
         {
-            connections.push_back( tmp_connections[j] + nv );
+            const kvs::Vector3f v1 = kvs::Vector3f( coords + ( j + 1 ) * 3 ) - kvs::Vector3f( coords + j * 3 );
+            const kvs::Vector3f ti( tangents + j * 3 );
+            const kvs::Vector3f tj( tangents + ( j + 1 ) * 3 );
+            const float c1 = v1.dot( v1 );
+            kvs::Vector3f rl = r;
+            kvs::Vector3f tl = ti;
+            if ( !kvs::Math::IsZero( c1 ) )
+            {
+                rl = r - ( 2.0f / c1 ) * v1.dot( r ) * v1;
+                tl = ti - ( 2.0f / c1 ) * v1.dot( ti ) * v1;
+            }
+
+            const kvs::Vector3f v2 = tj - tl;
+            const float c2 = v2.dot( v2 );
+            r = kvs::Math::IsZero( c2 ) ? rl : rl - ( 2.0f / c2 ) * v2.dot( rl ) * v2;
+            r = ( r - r.dot( tj ) * tj ).normalized();
+            normals[ ( j + 1 ) * 3 + 0 ] = r.x();
+            normals[ ( j + 1 ) * 3 + 1 ] = r.y();
+            normals[ ( j + 1 ) * 3 + 2 ] = r.z();
         }
     }
-
-    SuperClass::setCoords( kvs::ValueArray<kvs::Real32>( vertices ) );
-    SuperClass::setColors( kvs::ValueArray<kvs::UInt8>( colors ) );
-    SuperClass::setNormals( kvs::ValueArray<kvs::Real32>( normals ) );
-    SuperClass::setConnections( kvs::ValueArray<kvs::UInt32>( connections ) );
-    SuperClass::setOpacity( 255 );
-    SuperClass::setPolygonType( kvs::PolygonObject::Quadrangle );
-    SuperClass::setColorType( ::GetColorType( line ) );
-    SuperClass::setNormalType( kvs::PolygonObject::PolygonNormal );
 }
 
 /*===========================================================================*/
 /**
  *  @brief  Calculates tubeline polygon.
- *  @param  vertices [out] pointer to the vertex array of the polygon object
- *  @param  colors [out] pointer to the color array of the polygon object
- *  @param  connections [out] pointer to the connection array of the polygon object
- *  @param  normals [out] pointer to the normal array of the polygon object
+ *  @param  vertices [out] pointer to the vertex array of the line's blocks
+ *  @param  colors [out] pointer to the color array of the line's blocks
+ *  @param  connections [out] pointer to the connection array of the line's blocks
+ *  @param  normals [out] pointer to the normal array of the line's blocks
  *  @param  line_vertices [in] vertex array of the line object
  *  @param  line_sizes [in] size array of the line object
  *  @param  line_colors [in] color array of the line object
  *  @param  nvertices [in] number of vertices
  *  @param  color_type [in] color type
+ *  @param  ncolor_blocks [in] number of the blocks whose colors are stored
+ *  @param  vertex_offset [in] index of the first vertex of the line's blocks
+ *  @param  parallel [in] if true, the segments are processed in parallel
+ *
+ *  Every segment recalculates the end circle of the previous segment for
+ *  its joint, so that the segments are independent of each other.
  */
 /*===========================================================================*/
 void Tubeline::calculate_tubes(
-    std::vector<kvs::Real32>* vertices,
-    std::vector<kvs::UInt8>* colors,
-    std::vector<kvs::UInt32>* connections,
-    std::vector<kvs::Real32>* normals,
-    const kvs::ValueArray<kvs::Real32> line_vertices,
-    const kvs::ValueArray<kvs::Real32> line_sizes,
-    const kvs::ValueArray<kvs::UInt8> line_colors,
+    kvs::Real32* vertices,
+    kvs::UInt8* colors,
+    kvs::UInt32* connections,
+    kvs::Real32* normals,
+    const kvs::ValueArray<kvs::Real32>& line_vertices,
+    const kvs::ValueArray<kvs::Real32>& line_sizes,
+    const kvs::ValueArray<kvs::UInt8>& line_colors,
     const size_t nvertices,
-    const kvs::PolygonObject::ColorType color_type )
+    const kvs::PolygonObject::ColorType color_type,
+    const size_t ncolor_blocks,
+    const kvs::UInt32 vertex_offset,
+    const bool parallel )
 {
-    // First tube position.
-    kvs::Vector3f start_position( line_vertices[0], line_vertices[1], line_vertices[2] );
-    kvs::Vector3f end_position( line_vertices[3], line_vertices[4], line_vertices[5] );
-
-    // Initiali raduis parameters.
-    kvs::Real32 pre_radius  = 0.0f;
-    kvs::Real32 radius = line_sizes[0];
-    kvs::Real32 post_radius = line_sizes[1];
-
-    // Calculate vertices that are composed of the circles (cross-sections).
-    std::vector<kvs::Vector3f> start_circle;
-    std::vector<kvs::Vector3f> end_circle;
-    this->calculate_circles(
-        &start_circle,
-        &end_circle,
-        start_position,
-        end_position,
-        radius,
-        pre_radius,
-        post_radius );
-
-    // Calculate colors at the cross-sections.
-    kvs::RGBColor start_color( line_colors[0], line_colors[1], line_colors[2] );
-    kvs::RGBColor end_color( line_colors[3], line_colors[4], line_colors[5] );
-
-    size_t vertex_number = 0;
-
-    this->set_vertices( vertices, start_circle, end_circle );
-    this->set_colors( colors, start_color, end_color, color_type );
-    this->set_connections_and_normals( connections, normals, start_circle, end_circle, vertex_number );
-
-    const size_t nloops = nvertices - 1;
-    for ( size_t i = 1, index = 3; i < nloops; i++, index += 3 )
+    const size_t nsegments = nvertices - 1;
+    KVS_OMP_PARALLEL( if(parallel) )
     {
-        // Update the tube position.
-        const kvs::Real32 v0_x = line_vertices[ index + 0 ];
-        const kvs::Real32 v0_y = line_vertices[ index + 1 ];
-        const kvs::Real32 v0_z = line_vertices[ index + 2 ];
-        const kvs::Real32 v1_x = line_vertices[ index + 3 ];
-        const kvs::Real32 v1_y = line_vertices[ index + 4 ];
-        const kvs::Real32 v1_z = line_vertices[ index + 5 ];
-        start_position = kvs::Vector3f( v0_x, v0_y, v0_z );
-        end_position = kvs::Vector3f( v1_x, v1_y, v1_z );
-
-        // Update the reduis parameters.
-        pre_radius = line_sizes[i-1];
-        radius = line_sizes[i];
-        post_radius = ( i == nvertices - 2 ) ? 0.0f : line_sizes[i+1];
-
-        // Save parameters for the pre-tube.
-        const std::vector<kvs::Vector3f> pre_end_circle = end_circle;
-        const kvs::RGBColor pre_end_color = end_color;
-
-        // Update the vertices of the tube's circles.
-        start_circle.clear();
-        end_circle.clear();
-        this->calculate_circles(
-            &start_circle,
-            &end_circle,
-            start_position,
-            end_position,
-            radius,
-            pre_radius,
-            post_radius );
-
-        // tube + joint
-        vertex_number = m_ndivisions * 2 * i + m_ndivisions * 2 * ( i - 1 );
-
-        // Update the colors of the circles.
-        const kvs::UInt8 c0_r = line_colors[ index + 0 ];
-        const kvs::UInt8 c0_g = line_colors[ index + 1 ];
-        const kvs::UInt8 c0_b = line_colors[ index + 2 ];
-        const kvs::UInt8 c1_r = line_colors[ index + 3 ];
-        const kvs::UInt8 c1_g = line_colors[ index + 4 ];
-        const kvs::UInt8 c1_b = line_colors[ index + 5 ];
-        start_color = kvs::RGBColor( c0_r, c0_g, c0_b );
-        end_color = ( i == nvertices-1 ) ? start_color : kvs::RGBColor( c1_r, c1_g, c1_b );
-
-        // Set the data of the polygon object.
-        this->set_vertices( vertices, start_circle, end_circle );
-        this->set_colors( colors, start_color, end_color, color_type );
-        this->set_connections_and_normals( connections, normals, start_circle, end_circle, vertex_number );
-
-        // Calculate joint tube.
-        vertex_number += m_ndivisions * 2;
-        this->set_vertices( vertices, pre_end_circle, start_circle );
-        this->set_colors( colors, pre_end_color, start_color, color_type );
-        this->set_connections_and_normals( connections, normals, pre_end_circle, start_circle, vertex_number );
+        std::vector<kvs::Vector3f> start_circle( m_ndivisions );
+        std::vector<kvs::Vector3f> end_circle( m_ndivisions );
+        std::vector<kvs::Vector3f> pre_start_circle( m_ndivisions );
+        std::vector<kvs::Vector3f> pre_end_circle( m_ndivisions );
+
+        KVS_OMP_FOR( schedule(static) )
+        for ( size_t i = 0; i < nsegments; i++ )
+        {
+            const size_t index = i * 3;
+
+            // Tube position.
+            const kvs::Vector3f start_position( line_vertices.data() + index );
+            const kvs::Vector3f end_position( line_vertices.data() + index + 3 );
+
+            // Radius parameters.
+            const kvs::Real32 pre_radius = ( i == 0 ) ? 0.0f : line_sizes[ i - 1 ];
+            const kvs::Real32 radius = line_sizes[i];
+            const kvs::Real32 post_radius =
+                ( i == 0 ) ? ::SizeAt( line_sizes, 1 ) :
+                ( i == nvertices - 2 ) ? 0.0f : line_sizes[ i + 1 ];
+
+            // Vertices of the tube's circles.
+            this->calculate_circles(
+                &start_circle[0],
+                &end_circle[0],
+                start_position,
+                end_position,
+                radius,
+                pre_radius,
+                post_radius );
+
+            // Colors of the circles.
+            const kvs::RGBColor start_color( line_colors[ index + 0 ], line_colors[ index + 1 ], line_colors[ index + 2 ] );
+            const kvs::RGBColor end_color( line_colors[ index + 3 ], line_colors[ index + 4 ], line_colors[ index + 5 ] );
+
+            if ( i == 0 )
+            {
+                this->set_block(
+                    vertices, colors, connections, normals, 0,
+                    &start_circle[0], &end_circle[0], start_color, end_color,
+                    color_type, 0 < ncolor_blocks, vertex_offset );
+                continue;
+            }
+
+            // End circle of the previous segment.
+            const size_t j = i - 1;
+            const kvs::Vector3f pre_start_position( line_vertices.data() + j * 3 );
+            const kvs::Real32 pre_pre_radius = ( j == 0 ) ? 0.0f : line_sizes[ j - 1 ];
+            const kvs::Real32 pre_post_radius =
+                ( j == 0 ) ? ::SizeAt( line_sizes, 1 ) :
+                ( j == nvertices - 2 ) ? 0.0f : line_sizes[ j + 1 ];
+            this->calculate_circles(
+                &pre_start_circle[0],
+                &pre_end_circle[0],
+                pre_start_position,
+                start_position,
+                line_sizes[j],
+                pre_pre_radius,
+                pre_post_radius );
+
+            // Tube and joint.
+            const size_t tube = 2 * i - 1;
+            const size_t joint = 2 * i;
+            this->set_block(
+                vertices, colors, connections, normals, tube,
+                &start_circle[0], &end_circle[0], start_color, end_color,
+                color_type, tube < ncolor_blocks, vertex_offset );
+            this->set_block(
+                vertices, colors, connections, normals, joint,
+                &pre_end_circle[0], &start_circle[0], start_color, start_color,
+                color_type, joint < ncolor_blocks, vertex_offset );
+        }
     }
 }
 
@@ -864,8 +904,8 @@ void Tubeline::calculate_tubes(
  */
 /*===========================================================================*/
 void Tubeline::calculate_circles(
-    std::vector<kvs::Vector3f>* start_circle,
-    std::vector<kvs::Vector3f>* end_circle,
+    kvs::Vector3f* start_circle,
+    kvs::Vector3f* end_circle,
     const kvs::Vector3f& start_position,
     const kvs::Vector3f& end_position,
     const float radius,
@@ -875,7 +915,6 @@ void Tubeline::calculate_circles(
     const kvs::Vector3f vec1 = end_position - start_position;
     const float length = static_cast<float>( vec1.length() );
 
-    //static kvs::Vector3f base( 0.0f, 0.0f, 1.0f ); ???
     const kvs::Vector3f base( 0.0f, 0.0f, 1.0f );
     const kvs::Vector3f axis = base.cross( vec1 );
     const float radian = static_cast<float>( std::acos( base.dot( vec1 ) / ( base.length() * vec1.length() ) ) );
@@ -898,104 +937,80 @@ void Tubeline::calculate_circles(
         const float x = radius * std::cos( rad );
         const float y = radius * std::sin( rad );
 
-        const kvs::Vector3f s_pos = mat * kvs::Vector3f( x, y, min_z ) + pos;
-        start_circle->push_back( s_pos );
-
-        const kvs::Vector3f e_pos = mat * kvs::Vector3f( x, y, max_z ) + pos;
-        end_circle->push_back( e_pos );
+        start_circle[i] = mat * kvs::Vector3f( x, y, min_z ) + pos;
+        end_circle[i] = mat * kvs::Vector3f( x, y, max_z ) + pos;
     }
 }
 
 /*===========================================================================*/
 /**
- *  @brief  Sets a vertex array.
+ *  @brief  Sets the vertices, colors, connections and normals of a block.
  *  @param  vertices [out] pointer to the vertex array
+ *  @param  colors [out] pointer to the color array
+ *  @param  connections [out] pointer to the connection array
+ *  @param  normals [out] pointer to the normal array
+ *  @param  block [in] index of the block
  *  @param  start_circle [in] vertex array of the start circle
  *  @param  end_circle [in] vertex array of the end circle
- */
-/*===========================================================================*/
-void Tubeline::set_vertices(
-    std::vector<kvs::Real32>* vertices,
-    const std::vector<kvs::Vector3f>& start_circle,
-    const std::vector<kvs::Vector3f>& end_circle )
-{
-    for ( size_t i = 0; i < m_ndivisions; i++ )
-    {
-        vertices->push_back( start_circle[i].x() );
-        vertices->push_back( start_circle[i].y() );
-        vertices->push_back( start_circle[i].z() );
-    }
-
-    for ( size_t i = 0; i < m_ndivisions; i++ )
-    {
-        vertices->push_back( end_circle[i].x() );
-        vertices->push_back( end_circle[i].y() );
-        vertices->push_back( end_circle[i].z() );
-    }
-}
-
-/*===========================================================================*/
-/**
- *  @brief  Sets a color array
- *  @param  colors [out] pointer to the color array
  *  @param  start_color [in] color of the start vertex
  *  @param  end_color [in] color of the end vertex
  *  @param  color_type [in] polygon color type
+ *  @param  with_colors [in] if true, the colors are stored
+ *  @param  vertex_offset [in] index of the first vertex of the line's blocks
  */
 /*===========================================================================*/
-void Tubeline::set_colors(
-    std::vector<kvs::UInt8>* colors,
+void Tubeline::set_block(
+    kvs::Real32* vertices,
+    kvs::UInt8* colors,
+    kvs::UInt32* connections,
+    kvs::Real32* normals,
+    const size_t block,
+    const kvs::Vector3f* start_circle,
+    const kvs::Vector3f* end_circle,
     const kvs::RGBColor& start_color,
     const kvs::RGBColor& end_color,
-    const kvs::PolygonObject::ColorType color_type )
+    const kvs::PolygonObject::ColorType color_type,
+    const bool with_colors,
+    const kvs::UInt32 vertex_offset )
 {
-    for ( size_t i = 0; i < m_ndivisions; i++ )
+    const size_t ndivisions = m_ndivisions;
+
+    kvs::Real32* v = vertices + block * ndivisions * 2 * 3;
+    for ( size_t i = 0; i < ndivisions; i++ )
     {
-        colors->push_back( start_color.r() );
-        colors->push_back( start_color.g() );
-        colors->push_back( start_color.b() );
+        *(v++) = start_circle[i].x();
+        *(v++) = start_circle[i].y();
+        *(v++) = start_circle[i].z();
     }
 
-    if( color_type == kvs::PolygonObject::VertexColor )
+    for ( size_t i = 0; i < ndivisions; i++ )
     {
-        for ( size_t i = 0; i < m_ndivisions; i++ )
-        {
-            colors->push_back( end_color.r() );
-            colors->push_back( end_color.g() );
-            colors->push_back( end_color.b() );
-        }
+        *(v++) = end_circle[i].x();
+        *(v++) = end_circle[i].y();
+        *(v++) = end_circle[i].z();
     }
-}
-
-/*===========================================================================*/
-/**
- *  @brief  Sets a connection array and a normal array.
- *  @param  connections [out] pointer to the connection array
- *  @param  normals [out] pointer to the normal array
- *  @param  start_circle [in] vertex array of the start circle
- *  @param  end_circle [in] vertex array of the end circle
- *  @param  vertex_number [in] vertex number
- */
-/*===========================================================================*/
-void Tubeline::set_connections_and_normals(
-    std::vector<kvs::UInt32>* connections,
-    std::vector<kvs::Real32>* normals,
-    const std::vector<kvs::Vector3f>& start_circle,
-    const std::vector<kvs::Vector3f>& end_circle,
-    const size_t vertex_number )
-{
-    // create vertex index list
-    std::vector<kvs::UInt32> v_ids;
-    std::vector<kvs::UInt32> n_ids;
 
-    for ( size_t i = 0; i < m_ndivisions; i++ )
+    if ( with_colors )
     {
-        const kvs::UInt32 index = static_cast<kvs::UInt32>( i );
-        v_ids.push_back( vertex_number + index );
-        n_ids.push_back( index );
+        const bool vertex_color = ( color_type == kvs::PolygonObject::VertexColor );
+        kvs::UInt8* c = colors + block * ndivisions * ( vertex_color ? 2 : 1 ) * 3;
+        for ( size_t i = 0; i < ndivisions; i++ )
+        {
+            *(c++) = start_color.r();
+            *(c++) = start_color.g();
+            *(c++) = start_color.b();
+        }
+
+        if ( vertex_color )
+        {
+            for ( size_t i = 0; i < ndivisions; i++ )
+            {
+                *(c++) = end_color.r();
+                *(c++) = end_color.g();
+                *(c++) = end_color.b();
+            }
+        }
     }
-    v_ids.push_back( vertex_number );
-    n_ids.push_back( 0 );
 
    /*  Simple example. Triangle pole.
     *
@@ -1004,23 +1019,27 @@ void Tubeline::set_connections_and_normals(
     *                       |
     *            base ------|--------- base + m_division
     *             /   \     |            /  \
-    *            /     base+2           /    base+2 + m_division 
-    *         base+1 -------------- base+1 + m_division 
+    *            /     base+2           /    base+2 + m_division
+    *         base+1 -------------- base+1 + m_division
     *
     */
-    for ( size_t i = 0; i < m_ndivisions; i++ )
+    const kvs::UInt32 base = static_cast<kvs::UInt32>( vertex_offset + block * ndivisions * 2 );
+    kvs::UInt32* n = connections + block * ndivisions * 4;
+    kvs::Real32* normal = normals + block * ndivisions * 3;
+    for ( size_t i = 0; i < ndivisions; i++ )
     {
-        connections->push_back( v_ids[i] + m_ndivisions );
-        connections->push_back( v_ids[i+1] + m_ndivisions );
-        connections->push_back( v_ids[i+1] );
-        connections->push_back( v_ids[i]   );
-
-        const kvs::Vector3f v1 = start_circle[n_ids[i+1]] - start_circle[n_ids[i]];
-        const kvs::Vector3f v2 = end_circle[n_ids[i+1]] - start_circle[n_ids[i]];
+        const size_t i1 = ( i + 1 ) % ndivisions;
+        *(n++) = static_cast<kvs::UInt32>( base + i + ndivisions );
+        *(n++) = static_cast<kvs::UInt32>( base + i1 + ndivisions );
+        *(n++) = static_cast<kvs::UInt32>( base + i1 );
+        *(n++) = static_cast<kvs::UInt32>( base + i );
+
+        const kvs::Vector3f v1 = start_circle[i1] - start_circle[i];
+        const kvs::Vector3f v2 = end_circle[i1] - start_circle[i];
         const kvs::Vector3f norm = -v1.cross( v2 );
-        normals->push_back( norm.x() );
-        normals->push_back( norm.y() );
-        normals->push_back( norm.z() );
+        *(normal++) = norm.x();
+        *(normal++) = norm.y();
+        *(normal++) = norm.z();
     }
 }
 
@@ -27,6 +27,13 @@ namespace kvs
 /*===========================================================================*/
 /**
  *  @brief  Create tubeline from line object.
+ *
+ *  The tubes of the lines (and of the segments of a single long line) are
+ *  generated in parallel into the arrays allocated beforehand by the prefix
+ *  sums of the numbers of the segments. With the CompactFrames output type,
+ *  the polygons are not generated; instead, a rotation-minimizing frame and
+ *  a radius are calculated for each vertex of the lines, from which a tube
+ *  impostor can be expanded on the fly.
  */
 /*===========================================================================*/
 class Tubeline : public kvs::FilterBase, public kvs::PolygonObject
@@ -35,9 +42,24 @@ class Tubeline : public kvs::FilterBase, public kvs::PolygonObject
     kvsModuleBaseClass( kvs::FilterBase );
     kvsModuleSuperClass( kvs::PolygonObject );
 
+public:
+
+    enum OutputType
+    {
+        TubePolygons, ///< quadrangles of the tubes
+        CompactFrames ///< frames and radii at the vertices of the lines
+    };
+
 protected:
 
     size_t m_ndivisions; ///< number of divisions of circle
+    OutputType m_output_type; ///< output type
+    kvs::ValueArray<kvs::UInt32> m_frame_offsets; ///< offset to the first frame of each line (nlines + 1)
+    kvs::ValueArray<kvs::Real32> m_frame_coords; ///< position of each frame
+    kvs::ValueArray<kvs::Real32> m_frame_tangents; ///< unit tangent of each frame
+    kvs::ValueArray<kvs::Real32> m_frame_normals; ///< unit normal of each frame (rotation-minimizing)
+    kvs::ValueArray<kvs::Real32> m_frame_radii; ///< tube radius at each frame
+    kvs::ValueArray<kvs::UInt8> m_frame_colors; ///< color at each frame
 
 public:
 
@@ -46,55 +68,63 @@ public:
     virtual ~Tubeline( void );
 
     void setNumberOfDivisions( const size_t ndivisions );
+    void setOutputType( const OutputType type ) { m_output_type = type; }
+    void setOutputTypeToTubePolygons() { this->setOutputType( TubePolygons ); }
+    void setOutputTypeToCompactFrames() { this->setOutputType( CompactFrames ); }
+
+    OutputType outputType() const { return m_output_type; }
+    const kvs::ValueArray<kvs::UInt32>& frameOffsets() const { return m_frame_offsets; }
+    const kvs::ValueArray<kvs::Real32>& frameCoords() const { return m_frame_coords; }
+    const kvs::ValueArray<kvs::Real32>& frameTangents() const { return m_frame_tangents; }
+    const kvs::ValueArray<kvs::Real32>& frameNormals() const { return m_frame_normals; }
+    const kvs::ValueArray<kvs::Real32>& frameRadii() const { return m_frame_radii; }
+    const kvs::ValueArray<kvs::UInt8>& frameColors() const { return m_frame_colors; }
 
     SuperClass* exec( const kvs::ObjectBase* object );
 
 protected:
 
-    void filtering_strip( const kvs::LineObject* line );
-    void filtering_uniline( const kvs::LineObject* line );
-    void filtering_polyline( const kvs::LineObject* line );
-    void filtering_segment( const kvs::LineObject* line );
+    void filtering_tubes( const kvs::LineObject* line );
+    void filtering_frames( const kvs::LineObject* line );
 
 protected:
 
     void calculate_tubes(
-        std::vector<kvs::Real32>* vertices,
-        std::vector<kvs::UInt8>* colors,
-        std::vector<kvs::UInt32>* connections,
-        std::vector<kvs::Real32>* normals,
-        const kvs::ValueArray<kvs::Real32> line_vertices,
-        const kvs::ValueArray<kvs::Real32> line_sizes,
-        const kvs::ValueArray<kvs::UInt8> line_colors,
+        kvs::Real32* vertices,
+        kvs::UInt8* colors,
+        kvs::UInt32* connections,
+        kvs::Real32* normals,
+        const kvs::ValueArray<kvs::Real32>& line_vertices,
+        const kvs::ValueArray<kvs::Real32>& line_sizes,
+        const kvs::ValueArray<kvs::UInt8>& line_colors,
         const size_t nvertices,
-        const kvs::PolygonObject::ColorType color_type );
+        const kvs::PolygonObject::ColorType color_type,
+        const size_t ncolor_blocks,
+        const kvs::UInt32 vertex_offset,
+        const bool parallel );
 
     void calculate_circles(
-        std::vector<kvs::Vector3f>* start_circle,
-        std::vector<kvs::Vector3f>* end_circle,
+        kvs::Vector3f* start_circle,
+        kvs::Vector3f* end_circle,
         const kvs::Vector3f& start_postion,
         const kvs::Vector3f& end_position,
         const float radius,
         const float pre_radius,
         const float post_radius );
 
-    void set_vertices(
-        std::vector<kvs::Real32>* vertices,
-        const std::vector<kvs::Vector3f>& start_circle,
-        const std::vector<kvs::Vector3f>& end_circle );
-
-    void set_colors(
-        std::vector<kvs::UInt8>* colors,
+    void set_block(
+        kvs::Real32* vertices,
+        kvs::UInt8* colors,
+        kvs::UInt32* connections,
+        kvs::Real32* normals,
+        const size_t block,
+        const kvs::Vector3f* start_circle,
+        const kvs::Vector3f* end_circle,
         const kvs::RGBColor& start_color,
         const kvs::RGBColor& end_color,
-        const kvs::PolygonObject::ColorType color_type );
-
-    void set_connections_and_normals(
-        std::vector<kvs::UInt32>* connections,
-        std::vector<kvs::Real32>* normals,
-        const std::vector<kvs::Vector3f>& start_circle,
-        const std::vector<kvs::Vector3f>& end_circle,
-        const size_t vertex_number );
+        const kvs::PolygonObject::ColorType color_type,
+        const bool with_colors,
+        const kvs::UInt32 vertex_offset );
 
 #if 1 // KVS_ENABLE_DEPRECATED
 public:
@@ -15,7 +15,8 @@
 #include "UnstructuredGradient.h"
 #include "InverseDistanceWeighting.h"
 #include <kvs/UnstructuredVolumeObject>
-#include <kvs/PrismaticCell>
+#include <kvs/CellByCellSampling>
+#include <kvs/OpenMP>
 
 
 namespace
@@ -81,7 +82,21 @@ UnstructuredGradient::UnstructuredGradient( const kvs::UnstructuredVolumeObject*
 UnstructuredGradient::SuperClass* UnstructuredGradient::exec( const kvs::ObjectBase* object )
 {
     const kvs::UnstructuredVolumeObject* volume = ::Cast( object );
-    if ( !volume ) { return NULL; }
+    if ( !volume )
+    {
+        BaseClass::setSuccess( false );
+        return NULL;
+    }
+
+    // The cell type is supported if its cell interpolator can be created.
+    kvs::CellBase* cell = kvs::CellByCellSampling::Cell( volume );
+    if ( !cell )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Not supported cell type.");
+        return NULL;
+    }
+    delete cell;
 
     if ( volume->veclen() == 1 )
     {
@@ -91,7 +106,14 @@ UnstructuredGradient::SuperClass* UnstructuredGradient::exec( const kvs::ObjectB
     {
         this->vector_gradient( volume );
     }
+    else
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input volume is neither scalar nor vector data.");
+        return NULL;
+    }
 
+    BaseClass::setSuccess( true );
     return this;
 }
 
@@ -103,26 +125,32 @@ UnstructuredGradient::SuperClass* UnstructuredGradient::exec( const kvs::ObjectB
 /*===========================================================================*/
 void UnstructuredGradient::scalar_gradient( const kvs::UnstructuredVolumeObject* volume )
 {
+    kvs::InverseDistanceWeighting<kvs::Vec3> idw( volume );
     const size_t ncells = volume->numberOfCells();
-    const size_t nnodes = volume->numberOfNodes();
-    const kvs::UInt32* connections = volume->connections().data();
 
-    kvs::InverseDistanceWeighting<kvs::Vec3> idw( nnodes );
-    kvs::PrismaticCell cell( volume );
-    const kvs::Vec3 center = cell.localCenter();
-    for ( size_t i = 0; i < ncells; i++ )
+    // Per-cell gradients and node-to-center distances. Each thread binds its
+    // own cell interpolator and writes only to the entries of its cells.
+    KVS_OMP_PARALLEL()
     {
-        cell.bindCell( i );
-        cell.setLocalPoint( center );
-        const kvs::Vec3 V = cell.gradientVector();
+        kvs::CellBase* cell = kvs::CellByCellSampling::Cell( volume );
+        const kvs::Vec3 center = cell->localCenter();
+        const size_t nnodes_per_cell = cell->numberOfCellNodes();
 
-        const kvs::Vec3 c = cell.center();
-        for ( size_t j = 0; j < cell.numberOfCellNodes(); j++ )
+        KVS_OMP_FOR( schedule(static) )
+        for ( size_t i = 0; i < ncells; i++ )
         {
-            const kvs::UInt32 id = *( connections++ );
-            const kvs::Real32 d = ( cell.coord(j) - c ).length();
-            idw.insert( id, V, d );
+            cell->bindCell( static_cast<kvs::UInt32>( i ) );
+            cell->setLocalPoint( center );
+            idw.setValue( i, cell->gradientVector() );
+
+            const kvs::Vec3 c = cell->center();
+            for ( size_t j = 0; j < nnodes_per_cell; j++ )
+            {
+                idw.setDistance( i, j, ( cell->coord(j) - c ).length() );
+            }
         }
+
+        delete cell;
     }
 
     SuperClass::shallowCopy( *volume );
@@ -139,26 +167,30 @@ void UnstructuredGradient::scalar_gradient( const kvs::UnstructuredVolumeObject*
 /*===========================================================================*/
 void UnstructuredGradient::vector_gradient( const kvs::UnstructuredVolumeObject* volume )
 {
+    kvs::InverseDistanceWeighting<kvs::Mat3> idw( volume );
     const size_t ncells = volume->numberOfCells();
-    const size_t nnodes = volume->numberOfNodes();
-    const kvs::UInt32* connections = volume->connections().data();
 
-    kvs::InverseDistanceWeighting<kvs::Mat3> idw( nnodes );
-    kvs::PrismaticCell cell( volume );
-    const kvs::Vec3 center = cell.localCenter();
-    for ( size_t i = 0; i < ncells; i++ )
+    KVS_OMP_PARALLEL()
     {
-        cell.bindCell( i );
-        cell.setLocalPoint( center );
-        const kvs::Mat3 T = cell.gradientTensor();
+        kvs::CellBase* cell = kvs::CellByCellSampling::Cell( volume );
+        const kvs::Vec3 center = cell->localCenter();
+        const size_t nnodes_per_cell = cell->numberOfCellNodes();
 
-        const kvs::Vec3 c = cell.center();
-        for ( size_t j = 0; j < cell.numberOfCellNodes(); j++ )
+        KVS_OMP_FOR( schedule(static) )
+        for ( size_t i = 0; i < ncells; i++ )
         {
-            const kvs::UInt32 id = *( connections++ );
-            const kvs::Real32 d = ( cell.coord(j) - c ).length();
-            idw.insert( id, T, d );
+            cell->bindCell( static_cast<kvs::UInt32>( i ) );
+            cell->setLocalPoint( center );
+            idw.setValue( i, cell->gradientTensor() );
+
+            const kvs::Vec3 c = cell->center();
+            for ( size_t j = 0; j < nnodes_per_cell; j++ )
+            {
+                idw.setDistance( i, j, ( cell->coord(j) - c ).length() );
+            }
         }
+
+        delete cell;
     }
 
     SuperClass::shallowCopy( *volume );
@@ -1,9 +1,10 @@
 #include "UnstructuredQCriterion.h"
 #include "InverseDistanceWeighting.h"
-#include <kvs/PrismaticCell>
 #include <map>
 #include <kvs/Type>
 #include <kvs/UnstructuredVolumeObject>
+#include <kvs/CellByCellSampling>
+#include <kvs/OpenMP>
 
 
 namespace
@@ -159,17 +160,38 @@ UnstructuredQCriterion::UnstructuredQCriterion( const kvs::UnstructuredVolumeObj
 UnstructuredQCriterion::SuperClass* UnstructuredQCriterion::exec( const kvs::ObjectBase* object )
 {
     const kvs::UnstructuredVolumeObject* volume = ::Cast( object );
-    if ( !volume ) { return NULL; }
+    if ( !volume )
+    {
+        BaseClass::setSuccess( false );
+        return NULL;
+    }
 
     if ( volume->veclen() == 3 )
     {
+        // The cell type is supported if its cell interpolator can be created.
+        kvs::CellBase* cell = kvs::CellByCellSampling::Cell( volume );
+        if ( !cell )
+        {
+            BaseClass::setSuccess( false );
+            kvsMessageError("Not supported cell type.");
+            return NULL;
+        }
+        delete cell;
+
         this->qvalues_from_vectors( volume );
     }
     else if ( volume->veclen() == 9 )
     {
         this->qvalues_from_tensors( volume );
     }
+    else
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input volume is neither vector nor tensor data.");
+        return NULL;
+    }
 
+    BaseClass::setSuccess( true );
     return this;
 }
 
@@ -181,27 +203,33 @@ UnstructuredQCriterion::SuperClass* UnstructuredQCriterion::exec( const kvs::Obj
 /*===========================================================================*/
 void UnstructuredQCriterion::qvalues_from_vectors( const kvs::UnstructuredVolumeObject* volume )
 {
-    const kvs::UInt32* connections = volume->connections().data();
+    kvs::InverseDistanceWeighting<kvs::Real32> idw( volume );
     const size_t ncells = volume->numberOfCells();
-    const size_t nnodes = volume->numberOfNodes();
 
-    kvs::InverseDistanceWeighting<kvs::Real32> idw( nnodes );
-    kvs::PrismaticCell cell( volume );
-    const kvs::Vec3 center = cell.localCenter();
-    for ( size_t i = 0; i < ncells; i++ )
+    // Each thread binds its own cell interpolator and writes only to the
+    // entries of its cells.
+    KVS_OMP_PARALLEL()
     {
-        cell.bindCell( i );
-        cell.setLocalPoint( center );
-        const kvs::Mat3 T = cell.gradientTensor();
-        const kvs::Real32 Q = ::Q( T );
+        kvs::CellBase* cell = kvs::CellByCellSampling::Cell( volume );
+        const kvs::Vec3 center = cell->localCenter();
+        const size_t nnodes_per_cell = cell->numberOfCellNodes();
 
-        const kvs::Vec3 c = cell.center();
-        for ( size_t j = 0; j < cell.numberOfCellNodes(); j++ )
+        KVS_OMP_FOR( schedule(static) )
+        for ( size_t i = 0; i < ncells; i++ )
         {
-            const kvs::UInt32 id = *( connections++ );
-            const kvs::Real32 d = ( cell.coord(j) - c ).length();
-            idw.insert( id, Q, d );
+            cell->bindCell( static_cast<kvs::UInt32>( i ) );
+            cell->setLocalPoint( center );
+            const kvs::Mat3 T = cell->gradientTensor();
+            idw.setValue( i, ::Q( T ) );
+
+            const kvs::Vec3 c = cell->center();
+            for ( size_t j = 0; j < nnodes_per_cell; j++ )
+            {
+                idw.setDistance( i, j, ( cell->coord(j) - c ).length() );
+            }
         }
+
+        delete cell;
     }
 
     SuperClass::shallowCopy( *volume );
@@ -221,6 +249,7 @@ void UnstructuredQCriterion::qvalues_from_tensors( const kvs::UnstructuredVolume
     const size_t nnodes = volume->numberOfNodes();
 
     kvs::ValueArray<kvs::Real32> values( nnodes );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
     for ( size_t i = 0; i < nnodes; i++ )
     {
         const kvs::Mat3 T = ::Tensor( volume, i );
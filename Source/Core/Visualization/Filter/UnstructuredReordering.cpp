@@ -0,0 +1,421 @@
+/*****************************************************************************/
+/**
+ *  @file   UnstructuredReordering.cpp
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "UnstructuredReordering.h"
+#include "ParallelSort.h"
+#include "SpaceFillingCurve.h"
+#include <vector>
+#include <algorithm>
+#include <kvs/Math>
+#include <kvs/Value>
+#include <kvs/OpenMP>
+#include <kvs/TypeDispatch>
+
+
+namespace
+{
+
+/// Node index not assigned yet.
+const kvs::UInt32 Unassigned = 0xFFFFFFFFu;
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if all the node indices of the connections are valid.
+ *  @param  connections [in] connections of the cells
+ *  @param  nnodes [in] number of nodes
+ *  @return true, if every node index is less than the number of nodes
+ */
+/*===========================================================================*/
+bool IsValidConnections( const kvs::ValueArray<kvs::UInt32>& connections, const size_t nnodes )
+{
+    const size_t n = connections.size();
+    const size_t nthreads = static_cast<size_t>( kvs::Math::Max( kvs::OpenMP::GetMaxThreads(), 1 ) );
+    std::vector<size_t> bounds( nthreads + 1 );
+    for ( size_t t = 0; t <= nthreads; t++ ) { bounds[t] = n * t / nthreads; }
+
+    std::vector<int> valid( nthreads, 1 );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t t = 0; t < nthreads; t++ )
+    {
+        for ( size_t i = bounds[t]; i < bounds[t+1]; i++ )
+        {
+            if ( connections[i] >= nnodes ) { valid[t] = 0; break; }
+        }
+    }
+
+    return std::find( valid.begin(), valid.end(), 0 ) == valid.end();
+}
+
+} // end of namespace
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Functor to reorder the node values with the value type.
+ */
+/*===========================================================================*/
+struct UnstructuredReordering::ValueReorderer
+{
+    const kvs::AnyValueArray& values;
+    const kvs::UnstructuredReordering::Permutation& permutation;
+    size_t veclen;
+    kvs::AnyValueArray* result;
+
+    ValueReorderer(
+        const kvs::AnyValueArray& v,
+        const kvs::UnstructuredReordering::Permutation& p,
+        const size_t n,
+        kvs::AnyValueArray* r ):
+        values( v ),
+        permutation( p ),
+        veclen( n ),
+        result( r ) {}
+
+    template <typename T>
+    void operator ()( kvs::TypeTag<T> ) const
+    {
+        const size_t nnodes = permutation.size();
+        const T* src = static_cast<const T*>( values.data() );
+        kvs::ValueArray<T> dst( nnodes * veclen );
+
+        KVS_OMP_PARALLEL_FOR( schedule(static) )
+        for ( size_t i = 0; i < nnodes; i++ )
+        {
+            const T* s = src + permutation[i] * veclen;
+            T* d = dst.data() + i * veclen;
+            for ( size_t j = 0; j < veclen; j++ ) { d[j] = s[j]; }
+        }
+
+        *result = kvs::AnyValueArray( dst );
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new UnstructuredReordering class.
+ */
+/*===========================================================================*/
+UnstructuredReordering::UnstructuredReordering():
+    m_curve( UnstructuredReordering::HilbertCurve )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new UnstructuredReordering class.
+ *  @param  volume [in] pointer to the unstructured volume object
+ *  @param  curve [in] space-filling curve
+ */
+/*===========================================================================*/
+UnstructuredReordering::UnstructuredReordering(
+    const kvs::UnstructuredVolumeObject* volume,
+    const Curve curve ):
+    m_curve( curve )
+{
+    this->exec( volume );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Destroys the UnstructuredReordering class.
+ */
+/*===========================================================================*/
+UnstructuredReordering::~UnstructuredReordering()
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Executes the reordering.
+ *  @param  object [in] pointer to the unstructured volume object
+ *  @return pointer to the reordered unstructured volume object
+ */
+/*===========================================================================*/
+UnstructuredReordering::SuperClass* UnstructuredReordering::exec( const kvs::ObjectBase* object )
+{
+    if ( !object )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input object is NULL.");
+        return NULL;
+    }
+
+    const kvs::UnstructuredVolumeObject* volume = kvs::UnstructuredVolumeObject::DownCast( object );
+    if ( !volume )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Input object is not supported.");
+        return NULL;
+    }
+
+    if ( volume->cellType() == kvs::UnstructuredVolumeObject::UnknownCellType )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Unknown cell type.");
+        return NULL;
+    }
+
+    if ( volume->connections().size() != volume->numberOfCells() * volume->numberOfCellNodes() ||
+         volume->coords().size() != volume->numberOfNodes() * 3 ||
+         volume->values().size() != volume->numberOfNodes() * volume->veclen() )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Number of the connections, coordinates or values is invalid.");
+        return NULL;
+    }
+
+    if ( volume->numberOfNodes() >= ::Unassigned )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Too many nodes.");
+        return NULL;
+    }
+
+    if ( volume->numberOfCells() > ::Unassigned )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Too many cells.");
+        return NULL;
+    }
+
+    if ( !::IsValidConnections( volume->connections(), volume->numberOfNodes() ) )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Node index of the connections is out of range.");
+        return NULL;
+    }
+
+    this->sort_cells( volume );
+    this->renumber_nodes( volume );
+    if ( !this->remap( volume ) )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Unsupported data type '%s' of the volume.",
+                        volume->values().typeInfo()->typeName() );
+        return NULL;
+    }
+
+    BaseClass::setSuccess( true );
+    return this;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sorts the cells by the curve key of their centroids.
+ *  @param  volume [in] pointer to the unstructured volume object
+ */
+/*===========================================================================*/
+void UnstructuredReordering::sort_cells( const kvs::UnstructuredVolumeObject* volume )
+{
+    const size_t ncells = volume->numberOfCells();
+    const size_t nnodes_per_cell = volume->numberOfCellNodes();
+    const kvs::UInt32* connections = volume->connections().data();
+    const kvs::Real32* coords = volume->coords().data();
+
+    // Centroids of the cells and their bounding box.
+    std::vector<kvs::Real32> centroids( ncells * 3 );
+    kvs::Vec3 min_coord( kvs::Value<kvs::Real32>::Max(), kvs::Value<kvs::Real32>::Max(), kvs::Value<kvs::Real32>::Max() );
+    kvs::Vec3 max_coord( -kvs::Value<kvs::Real32>::Max(), -kvs::Value<kvs::Real32>::Max(), -kvs::Value<kvs::Real32>::Max() );
+    KVS_OMP_PARALLEL()
+    {
+        kvs::Vec3 local_min( min_coord );
+        kvs::Vec3 local_max( max_coord );
+        KVS_OMP_FOR( schedule(static) )
+        for ( size_t i = 0; i < ncells; i++ )
+        {
+            kvs::Vec3 centroid( 0.0f, 0.0f, 0.0f );
+            const kvs::UInt32* cell = connections + i * nnodes_per_cell;
+            for ( size_t j = 0; j < nnodes_per_cell; j++ )
+            {
+                centroid += kvs::Vec3( coords + 3 * cell[j] );
+            }
+            centroid /= static_cast<kvs::Real32>( nnodes_per_cell );
+
+            for ( int k = 0; k < 3; k++ )
+            {
+                centroids[ 3 * i + k ] = centroid[k];
+                local_min[k] = kvs::Math::Min( local_min[k], centroid[k] );
+                local_max[k] = kvs::Math::Max( local_max[k], centroid[k] );
+            }
+        }
+
+        KVS_OMP_CRITICAL()
+        {
+            for ( int k = 0; k < 3; k++ )
+            {
+                min_coord[k] = kvs::Math::Min( min_coord[k], local_min[k] );
+                max_coord[k] = kvs::Math::Max( max_coord[k], local_max[k] );
+            }
+        }
+    }
+
+    // Curve keys of the quantized centroids.
+    const kvs::Real32 resolution = static_cast<kvs::Real32>( ( 1u << kvs::detail::CurveKeyBits ) - 1 );
+    kvs::Vec3 scale( 0.0f, 0.0f, 0.0f );
+    for ( int k = 0; k < 3; k++ )
+    {
+        const kvs::Real32 extent = max_coord[k] - min_coord[k];
+        scale[k] = extent > 0.0f ? resolution / extent : 0.0f;
+    }
+
+    const bool hilbert = ( m_curve == UnstructuredReordering::HilbertCurve );
+    std::vector<kvs::detail::CurveKey> keys( ncells );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < ncells; i++ )
+    {
+        kvs::UInt32 q[3];
+        for ( int k = 0; k < 3; k++ )
+        {
+            const kvs::Real32 t = ( centroids[ 3 * i + k ] - min_coord[k] ) * scale[k];
+            q[k] = static_cast<kvs::UInt32>( kvs::Math::Clamp( t, 0.0f, resolution ) );
+        }
+
+        keys[i].key = hilbert ? kvs::detail::HilbertKey( q[0], q[1], q[2] ) : kvs::detail::MortonKey( q[0], q[1], q[2] );
+        keys[i].index = static_cast<kvs::UInt32>( i );
+    }
+
+    kvs::detail::SortKeys( keys );
+
+    m_cell_permutation.allocate( ncells );
+    for ( size_t i = 0; i < ncells; i++ ) { m_cell_permutation[i] = keys[i].index; }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Renumbers the nodes in the first-touch order of the sorted cells.
+ *  @param  volume [in] pointer to the unstructured volume object
+ */
+/*===========================================================================*/
+void UnstructuredReordering::renumber_nodes( const kvs::UnstructuredVolumeObject* volume )
+{
+    const size_t nnodes = volume->numberOfNodes();
+    const size_t ncells = volume->numberOfCells();
+    const size_t nnodes_per_cell = volume->numberOfCellNodes();
+    const kvs::UInt32* connections = volume->connections().data();
+
+    std::vector<kvs::UInt32> new_index( nnodes, ::Unassigned );
+    m_node_permutation.allocate( nnodes );
+
+    kvs::UInt32 counter = 0;
+    for ( size_t i = 0; i < ncells; i++ )
+    {
+        const kvs::UInt32* cell = connections + m_cell_permutation[i] * nnodes_per_cell;
+        for ( size_t j = 0; j < nnodes_per_cell; j++ )
+        {
+            const kvs::UInt32 id = cell[j];
+            if ( new_index[id] == ::Unassigned )
+            {
+                new_index[id] = counter;
+                m_node_permutation[ counter++ ] = id;
+            }
+        }
+    }
+
+    // Nodes which are not referenced by any cell.
+    for ( size_t i = 0; i < nnodes; i++ )
+    {
+        if ( new_index[i] == ::Unassigned )
+        {
+            m_node_permutation[ counter++ ] = static_cast<kvs::UInt32>( i );
+        }
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Remaps the connections, coordinates and values with the permutations.
+ *  @param  volume [in] pointer to the unstructured volume object
+ *  @return false, if the value type is not supported
+ */
+/*===========================================================================*/
+bool UnstructuredReordering::remap( const kvs::UnstructuredVolumeObject* volume )
+{
+    const size_t nnodes = volume->numberOfNodes();
+    const size_t ncells = volume->numberOfCells();
+    const size_t nnodes_per_cell = volume->numberOfCellNodes();
+    const size_t veclen = volume->veclen();
+
+    // Inverse of the node permutation.
+    std::vector<kvs::UInt32> new_index( nnodes );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < nnodes; i++ )
+    {
+        new_index[ m_node_permutation[i] ] = static_cast<kvs::UInt32>( i );
+    }
+
+    const kvs::UInt32* src_connections = volume->connections().data();
+    kvs::ValueArray<kvs::UInt32> connections( ncells * nnodes_per_cell );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < ncells; i++ )
+    {
+        const kvs::UInt32* src = src_connections + m_cell_permutation[i] * nnodes_per_cell;
+        kvs::UInt32* dst = connections.data() + i * nnodes_per_cell;
+        for ( size_t j = 0; j < nnodes_per_cell; j++ ) { dst[j] = new_index[ src[j] ]; }
+    }
+
+    const kvs::Real32* src_coords = volume->coords().data();
+    kvs::ValueArray<kvs::Real32> coords( nnodes * 3 );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < nnodes; i++ )
+    {
+        const kvs::Real32* src = src_coords + 3 * m_node_permutation[i];
+        kvs::Real32* dst = coords.data() + 3 * i;
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+    }
+
+    kvs::AnyValueArray values;
+    if ( !kvs::DispatchType( volume->values().typeID(), ValueReorderer( volume->values(), m_node_permutation, veclen, &values ) ) )
+    {
+        return false;
+    }
+
+    if ( volume->hasMinMaxExternalCoords() )
+    {
+        const kvs::Vector3f min_coord( volume->minExternalCoord() );
+        const kvs::Vector3f max_coord( volume->maxExternalCoord() );
+        SuperClass::setMinMaxExternalCoords( min_coord, max_coord );
+    }
+
+    if ( volume->hasMinMaxObjectCoords() )
+    {
+        const kvs::Vector3f min_coord( volume->minObjectCoord() );
+        const kvs::Vector3f max_coord( volume->maxObjectCoord() );
+        SuperClass::setMinMaxObjectCoords( min_coord, max_coord );
+    }
+
+    if ( volume->hasMinMaxValues() )
+    {
+        const kvs::Real64 min_value( volume->minValue() );
+        const kvs::Real64 max_value( volume->maxValue() );
+        SuperClass::setMinMaxValues( min_value, max_value );
+    }
+
+    SuperClass::setLabel( volume->label() );
+    SuperClass::setUnit( volume->unit() );
+    SuperClass::setVeclen( veclen );
+    SuperClass::setNumberOfNodes( nnodes );
+    SuperClass::setNumberOfCells( ncells );
+    SuperClass::setCellType( volume->cellType() );
+    SuperClass::setCoords( coords );
+    SuperClass::setConnections( connections );
+    SuperClass::setValues( values );
+
+    return true;
+}
+
+} // end of namespace kvs
@@ -0,0 +1,85 @@
+/*****************************************************************************/
+/**
+ *  @file   UnstructuredReordering.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#ifndef KVS__UNSTRUCTURED_REORDERING_H_INCLUDE
+#define KVS__UNSTRUCTURED_REORDERING_H_INCLUDE
+
+#include <kvs/UnstructuredVolumeObject>
+#include <kvs/FilterBase>
+#include <kvs/ValueArray>
+#include <kvs/Type>
+#include <kvs/Module>
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Reordering class of the cells and nodes of unstructured volume for memory locality.
+ *
+ *  The cells are sorted by the space-filling-curve key of their centroids,
+ *  and the nodes are renumbered in the order they are first referenced by
+ *  the sorted cells (nodes referenced by no cell follow in their original
+ *  order). The connections, coordinates and values are remapped accordingly.
+ */
+/*===========================================================================*/
+class UnstructuredReordering : public kvs::FilterBase, public kvs::UnstructuredVolumeObject
+{
+    kvsModule( kvs::UnstructuredReordering, Filter );
+    kvsModuleBaseClass( kvs::FilterBase );
+    kvsModuleSuperClass( kvs::UnstructuredVolumeObject );
+
+public:
+
+    enum Curve
+    {
+        MortonCurve, ///< Z-order curve
+        HilbertCurve ///< Hilbert curve
+    };
+
+    typedef kvs::ValueArray<kvs::UInt32> Permutation;
+
+private:
+
+    Curve m_curve; ///< space-filling curve
+    Permutation m_cell_permutation; ///< original cell index of each new cell
+    Permutation m_node_permutation; ///< original node index of each new node
+
+public:
+
+    UnstructuredReordering();
+    UnstructuredReordering( const kvs::UnstructuredVolumeObject* volume, const Curve curve = HilbertCurve );
+    virtual ~UnstructuredReordering();
+
+    SuperClass* exec( const kvs::ObjectBase* object );
+
+    Curve curve() const { return m_curve; }
+    const Permutation& cellPermutation() const { return m_cell_permutation; }
+    const Permutation& nodePermutation() const { return m_node_permutation; }
+
+    void setCurve( const Curve curve ) { m_curve = curve; }
+    void setCurveToMorton() { this->setCurve( MortonCurve ); }
+    void setCurveToHilbert() { this->setCurve( HilbertCurve ); }
+
+private:
+
+    struct ValueReorderer;
+    void sort_cells( const kvs::UnstructuredVolumeObject* volume );
+    void renumber_nodes( const kvs::UnstructuredVolumeObject* volume );
+    bool remap( const kvs::UnstructuredVolumeObject* volume );
+};
+
+} // end of namespace kvs
+
+#endif // KVS__UNSTRUCTURED_REORDERING_H_INCLUDE
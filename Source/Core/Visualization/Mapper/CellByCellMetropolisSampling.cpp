@@ -20,6 +20,7 @@
 #include <kvs/TrilinearInterpolator>
 #include <kvs/Value>
 #include <kvs/CellBase>
+#include <kvs/TypeDispatch>
 #include "CellByCellSampling.h"
 
 
@@ -142,6 +143,19 @@ CellByCellMetropolisSampling::SuperClass* CellByCellMetropolisSampling::exec( co
     return this;
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Functor to call generate_particles with the value type of the volume.
+ */
+/*===========================================================================*/
+struct CellByCellMetropolisSampling::ParticleGenerator
+{
+    CellByCellMetropolisSampling* mapper;
+    const kvs::StructuredVolumeObject* volume;
+    ParticleGenerator( CellByCellMetropolisSampling* m, const kvs::StructuredVolumeObject* v ): mapper( m ), volume( v ) {}
+    template <typename T> void operator ()( kvs::TypeTag<T> ) const { mapper->generate_particles<T>( volume ); }
+};
+
 /*===========================================================================*/
 /**
  *  @brief  Mapping for the structured volume object.
@@ -156,16 +170,7 @@ void CellByCellMetropolisSampling::mapping( const kvs::StructuredVolumeObject* v
     BaseClass::setMinMaxCoords( volume, this );
 
     // Generate the particles.
-    const std::type_info& type = volume->values().typeInfo()->type();
-    if (      type == typeid( kvs::UInt8  ) ) this->generate_particles<kvs::UInt8>( volume );
-    else if ( type == typeid( kvs::UInt16 ) ) this->generate_particles<kvs::UInt16>( volume );
-    else if ( type == typeid( kvs::UInt32 ) ) this->generate_particles<kvs::UInt32>( volume );
-    else if ( type == typeid( kvs::Int8   ) ) this->generate_particles<kvs::Int8>( volume );
-    else if ( type == typeid( kvs::Int16  ) ) this->generate_particles<kvs::Int16>( volume );
-    else if ( type == typeid( kvs::Int32  ) ) this->generate_particles<kvs::Int32>( volume );
-    else if ( type == typeid( kvs::Real32 ) ) this->generate_particles<kvs::Real32>( volume );
-    else if ( type == typeid( kvs::Real64 ) ) this->generate_particles<kvs::Real64>( volume );
-    else
+    if ( !kvs::DispatchType( volume->values().typeID(), ParticleGenerator( this, volume ) ) )
     {
         BaseClass::setSuccess( false );
         kvsMessageError("Unsupported data type '%s'.", volume->values().typeInfo()->typeName() );
@@ -74,6 +74,7 @@ public:
 
 private:
 
+    struct ParticleGenerator;
     void mapping( const kvs::StructuredVolumeObject* volume );
     void mapping( const kvs::UnstructuredVolumeObject* volume );
     template <typename T>
@@ -206,24 +206,35 @@ private:
     kvs::ColorMap m_color_map; ///< color map
     kvs::ValueArray<kvs::Real32> m_coords; ///< coorinate value array
     kvs::ValueArray<kvs::Real32> m_normals; ///< normal vector array
-    kvs::ValueArray<kvs::UInt8> m_colors; ///< color value array
+    kvs::ValueArray<kvs::Real32> m_scalars; ///< scalar value array (mapped to the colors at once)
+    mutable kvs::ValueArray<kvs::UInt8> m_colors; ///< color value array (mapped at the first call of colors())
 
 public:
     ColoredParticles( const kvs::ColorMap& color_map ): m_color_map( color_map ) {}
     const kvs::ValueArray<kvs::Real32>& coords() const { return m_coords; }
     const kvs::ValueArray<kvs::Real32>& normals() const { return m_normals; }
-    const kvs::ValueArray<kvs::UInt8>& colors() const { return m_colors; }
+
+    const kvs::ValueArray<kvs::UInt8>& colors() const
+    {
+        // The colors are mapped once after all of the particles are pushed.
+        if ( m_colors.size() != m_scalars.size() * 3 )
+        {
+            m_colors.allocate( m_scalars.size() * 3 );
+            m_color_map.mapColors( m_scalars.data(), m_scalars.size(), m_colors.data() );
+        }
+        return m_colors;
+    }
 
     void allocate( const size_t nparticles )
     {
         m_coords.allocate( nparticles * 3 );
         m_normals.allocate( nparticles * 3 );
-        m_colors.allocate( nparticles * 3 );
+        m_scalars.allocate( nparticles );
+        m_colors.release();
     }
 
     void push( const size_t index, const Particle& particle )
     {
-        const kvs::RGBColor color = m_color_map.at( particle.scalar );
         const size_t index3 = index * 3;
         m_coords[ index3 + 0 ] = particle.coord.x();
         m_coords[ index3 + 1 ] = particle.coord.y();
@@ -231,9 +242,7 @@ public:
         m_normals[ index3 + 0 ] = particle.normal.x();
         m_normals[ index3 + 1 ] = particle.normal.y();
         m_normals[ index3 + 2 ] = particle.normal.z();
-        m_colors[ index3 + 0 ] = color.r();
-        m_colors[ index3 + 1 ] = color.g();
-        m_colors[ index3 + 2 ] = color.b();
+        m_scalars[ index ] = particle.scalar;
     }
 };
 
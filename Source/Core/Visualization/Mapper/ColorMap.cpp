@@ -17,6 +17,8 @@
 #include <kvs/RGBColor>
 #include <kvs/HSVColor>
 #include <kvs/Math>
+#include <kvs/OpenMP>
+#include <vector>
 
 
 namespace
@@ -24,6 +26,7 @@ namespace
 
 const size_t Resolution = 256;
 const size_t NumberOfChannels = 3;
+const size_t BatchSize = 256;
 
 struct Equal
 {
@@ -347,6 +350,77 @@ const kvs::RGBColor ColorMap::at( const float value ) const
     return kvs::RGBColor::Mix( c0, c1, v - s0 );
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Maps the values to the RGB colors in the same way as at().
+ *  @param  values [in] pointer to the values
+ *  @param  nvalues [in] number of the values
+ *  @param  colors [out] pointer to the color array (3 x nvalues)
+ */
+/*===========================================================================*/
+template <typename T>
+void ColorMap::mapColors( const T* values, const size_t nvalues, kvs::UInt8* colors ) const
+{
+    KVS_ASSERT( m_table.size() == ::NumberOfChannels * m_resolution );
+
+    // Normalized color table, as given by kvs::RGBColor::toVec3().
+    const size_t table_size = ::NumberOfChannels * m_resolution;
+    std::vector<kvs::Real32> normalized_table( table_size );
+    for ( size_t i = 0; i < table_size; ++i )
+    {
+        normalized_table[i] = static_cast<kvs::Real32>( m_table[i] ) / 255.0f;
+    }
+
+    const kvs::Real32* const table = &normalized_table[0];
+    const size_t last = m_resolution - 1;
+    const float r = static_cast<float>( last );
+    const float min_value = m_min_value;
+    const float max_value = m_max_value;
+    const float range = m_max_value - m_min_value;
+    const size_t nbatches = ( nvalues + ::BatchSize - 1 ) / ::BatchSize;
+
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t batch = 0; batch < nbatches; ++batch )
+    {
+        const size_t begin = batch * ::BatchSize;
+        const size_t size = kvs::Math::Min( ::BatchSize, nvalues - begin );
+
+        // Table coordinates of the batch (clamped to [0, resolution - 1]).
+        float coords[ ::BatchSize ];
+        for ( size_t i = 0; i < size; ++i )
+        {
+            const float value = static_cast<float>( values[ begin + i ] );
+            const float v = ( value - min_value ) / range * r;
+            coords[i] = !( value > min_value ) ? 0.0f : !( value < max_value ) ? r : v;
+        }
+
+        kvs::UInt8* color = colors + ::NumberOfChannels * begin;
+        for ( size_t i = 0; i < size; ++i )
+        {
+            const size_t s0 = static_cast<size_t>( coords[i] );
+            const size_t s1 = kvs::Math::Min( s0 + 1, last );
+            const float t = coords[i] - s0;
+
+            const kvs::Real32* c0 = table + ::NumberOfChannels * s0;
+            const kvs::Real32* c1 = table + ::NumberOfChannels * s1;
+            *( color++ ) = static_cast<kvs::UInt8>( kvs::Math::Round( kvs::Math::Mix( c0[0], c1[0], t ) * 255.0f ) );
+            *( color++ ) = static_cast<kvs::UInt8>( kvs::Math::Round( kvs::Math::Mix( c0[1], c1[1], t ) * 255.0f ) );
+            *( color++ ) = static_cast<kvs::UInt8>( kvs::Math::Round( kvs::Math::Mix( c0[2], c1[2], t ) * 255.0f ) );
+        }
+    }
+}
+
+template void ColorMap::mapColors<kvs::Int8  >( const kvs::Int8*   values, const size_t nvalues, kvs::UInt8* colors ) const;
+template void ColorMap::mapColors<kvs::Int16 >( const kvs::Int16*  values, const size_t nvalues, kvs::UInt8* colors ) const;
+template void ColorMap::mapColors<kvs::Int32 >( const kvs::Int32*  values, const size_t nvalues, kvs::UInt8* colors ) const;
+template void ColorMap::mapColors<kvs::Int64 >( const kvs::Int64*  values, const size_t nvalues, kvs::UInt8* colors ) const;
+template void ColorMap::mapColors<kvs::UInt8 >( const kvs::UInt8*  values, const size_t nvalues, kvs::UInt8* colors ) const;
+template void ColorMap::mapColors<kvs::UInt16>( const kvs::UInt16* values, const size_t nvalues, kvs::UInt8* colors ) const;
+template void ColorMap::mapColors<kvs::UInt32>( const kvs::UInt32* values, const size_t nvalues, kvs::UInt8* colors ) const;
+template void ColorMap::mapColors<kvs::UInt64>( const kvs::UInt64* values, const size_t nvalues, kvs::UInt8* colors ) const;
+template void ColorMap::mapColors<kvs::Real32>( const kvs::Real32* values, const size_t nvalues, kvs::UInt8* colors ) const;
+template void ColorMap::mapColors<kvs::Real64>( const kvs::Real64* values, const size_t nvalues, kvs::UInt8* colors ) const;
+
 /*==========================================================================*/
 /**
  *  @brief  Substitution operator =.
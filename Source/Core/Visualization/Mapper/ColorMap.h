@@ -84,6 +84,8 @@ public:
 
     const kvs::RGBColor operator []( const size_t index ) const;
     const kvs::RGBColor at( const float value ) const;
+    template <typename T>
+    void mapColors( const T* values, const size_t nvalues, kvs::UInt8* colors ) const;
     ColorMap& operator =( const ColorMap& rhs );
 };
 
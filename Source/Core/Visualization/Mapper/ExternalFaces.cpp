@@ -28,35 +28,26 @@ namespace
 
 /*===========================================================================*/
 /**
- *  @brief  Calculates color indices for the given nodes.
+ *  @brief  Gets the scalar values (magnitudes for vector data) of the given nodes.
  *  @param  value [in] pointer to the node value
- *  @param  min_value [in] minimum value of the node value
- *  @param  max_value [in] maximum value of the node value
  *  @param  veclen [in] vector length of the node data
- *  @param  colormap_resolution [in] resolution of the color map
  *  @param  node_index [in] node indices
- *  @param  color_level [out] pointer to the color indices
+ *  @param  node_value [out] pointer to the scalar values
  */
 /*===========================================================================*/
 template <const size_t N, typename T>
-inline void GetColorIndices(
+inline void GetNodeValues(
     const T* value,
-    const kvs::Real64 min_value,
-    const kvs::Real64 max_value,
     const size_t veclen,
-    const size_t colormap_resolution,
     const kvs::UInt32 node_index[N],
-    kvs::UInt32 (*color_index)[N] )
+    kvs::Real32 (*node_value)[N] )
 {
-    const kvs::Real64 normalize =
-        static_cast<kvs::Real64>( colormap_resolution - 1 ) / ( max_value - min_value );
-
     // Scalar data.
     if ( veclen == 1 )
     {
         for ( size_t i = 0; i < N; i++ )
         {
-            (*color_index)[i] = kvs::UInt32( normalize * ( kvs::Real64( value[ node_index[i] ] ) - min_value ) );
+            (*node_value)[i] = kvs::Real32( value[ node_index[i] ] );
         }
     }
     // Vector data.
@@ -74,12 +65,33 @@ inline void GetColorIndices(
 
         for ( size_t i = 0; i < N; i++ )
         {
-            magnitude[i] = std::sqrt( magnitude[i] );
-            (*color_index)[i] = kvs::UInt32( normalize * ( magnitude[i] - min_value ) );
+            (*node_value)[i] = kvs::Real32( std::sqrt( magnitude[i] ) );
         }
     }
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Maps the scalar values of the vertices to the colors.
+ *  @param  cmap [in] color map
+ *  @param  min_value [in] minimum value of the node value
+ *  @param  max_value [in] maximum value of the node value
+ *  @param  scalars [in] scalar values of the vertices
+ *  @param  colors [out] pointer to the color values of the vertices
+ */
+/*===========================================================================*/
+inline void MapColors(
+    const kvs::ColorMap& cmap,
+    const kvs::Real64 min_value,
+    const kvs::Real64 max_value,
+    const kvs::ValueArray<kvs::Real32>& scalars,
+    kvs::UInt8* colors )
+{
+    kvs::ColorMap color_map( cmap );
+    color_map.setRange( static_cast<float>( min_value ), static_cast<float>( max_value ) );
+    color_map.mapColors( scalars.data(), scalars.size(), colors );
+}
+
 /*===========================================================================*/
 /**
  *  @brief  Triangle face class.
@@ -668,11 +680,12 @@ void CalculateFaces(
     colors->allocate( nvertices * 3 );
     normals->allocate( nfaces * 3 );
     kvs::Real32* coord = coords->data();
-    kvs::UInt8* color = colors->data();
+    kvs::ValueArray<kvs::Real32> scalars( nvertices );
+    kvs::Real32* scalar = scalars.data();
     kvs::Real32* normal = normals->data();
 
     kvs::UInt32 node_index[3] = { 0, 0, 0 };
-    kvs::UInt32 color_level[3] = { 0, 0, 0 };
+    kvs::Real32 node_value[3] = { 0.0f, 0.0f, 0.0f };
 
     TriangleFaceMap::Bucket::const_iterator f = face_map.bucket().begin();
     TriangleFaceMap::Bucket::const_iterator last = face_map.bucket().end();
@@ -698,19 +711,13 @@ void CalculateFaces(
         *( coord++ ) = v2.y();
         *( coord++ ) = v2.z();
 
-        GetColorIndices<3>( value, min_value, max_value, veclen, cmap.resolution(), node_index, &color_level );
+        GetNodeValues<3>( value, veclen, node_index, &node_value );
         // c0
-        *( color++ ) = cmap[ color_level[0] ].r();
-        *( color++ ) = cmap[ color_level[0] ].g();
-        *( color++ ) = cmap[ color_level[0] ].b();
+        *( scalar++ ) = node_value[0];
         // c1
-        *( color++ ) = cmap[ color_level[1] ].r();
-        *( color++ ) = cmap[ color_level[1] ].g();
-        *( color++ ) = cmap[ color_level[1] ].b();
+        *( scalar++ ) = node_value[1];
         // c2
-        *( color++ ) = cmap[ color_level[2] ].r();
-        *( color++ ) = cmap[ color_level[2] ].g();
-        *( color++ ) = cmap[ color_level[2] ].b();
+        *( scalar++ ) = node_value[2];
 
         const kvs::Vector3f n( ( v1 - v0 ).cross( v2 - v0 ) );
         // n0
@@ -720,6 +727,8 @@ void CalculateFaces(
 
         f++;
     }
+
+    ::MapColors( cmap, min_value, max_value, scalars, colors->data() );
 }
 
 /*===========================================================================*/
@@ -759,11 +768,12 @@ void CalculateFaces(
     colors->allocate( nvertices * 3 );
     normals->allocate( nfaces * 3 );
     kvs::Real32* coord = coords->data();
-    kvs::UInt8* color = colors->data();
+    kvs::ValueArray<kvs::Real32> scalars( nvertices );
+    kvs::Real32* scalar = scalars.data();
     kvs::Real32* normal = normals->data();
 
     kvs::UInt32 node_index[4] = { 0, 0, 0, 0 };
-    kvs::UInt32 color_level[4] = { 0, 0, 0, 0 };
+    kvs::Real32 node_value[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
 
     QuadrangleFaceMap::Bucket::const_iterator f = face_map.bucket().begin();
     QuadrangleFaceMap::Bucket::const_iterator last = face_map.bucket().end();
@@ -804,32 +814,20 @@ void CalculateFaces(
         *( coord++ ) = v0.y();
         *( coord++ ) = v0.z();
 
-        GetColorIndices<4>( value, min_value, max_value, veclen, cmap.resolution(), node_index, &color_level );
+        GetNodeValues<4>( value, veclen, node_index, &node_value );
         // c0
-        *( color++ ) = cmap[ color_level[0] ].r();
-        *( color++ ) = cmap[ color_level[0] ].g();
-        *( color++ ) = cmap[ color_level[0] ].b();
+        *( scalar++ ) = node_value[0];
         // c1
-        *( color++ ) = cmap[ color_level[1] ].r();
-        *( color++ ) = cmap[ color_level[1] ].g();
-        *( color++ ) = cmap[ color_level[1] ].b();
+        *( scalar++ ) = node_value[1];
         // c2
-        *( color++ ) = cmap[ color_level[2] ].r();
-        *( color++ ) = cmap[ color_level[2] ].g();
-        *( color++ ) = cmap[ color_level[2] ].b();
+        *( scalar++ ) = node_value[2];
 
         // c2
-        *( color++ ) = cmap[ color_level[2] ].r();
-        *( color++ ) = cmap[ color_level[2] ].g();
-        *( color++ ) = cmap[ color_level[2] ].b();
+        *( scalar++ ) = node_value[2];
         // c3
-        *( color++ ) = cmap[ color_level[3] ].r();
-        *( color++ ) = cmap[ color_level[3] ].g();
-        *( color++ ) = cmap[ color_level[3] ].b();
+        *( scalar++ ) = node_value[3];
         // c0
-        *( color++ ) = cmap[ color_level[0] ].r();
-        *( color++ ) = cmap[ color_level[0] ].g();
-        *( color++ ) = cmap[ color_level[0] ].b();
+        *( scalar++ ) = node_value[0];
 
         const kvs::Vec3 n( ( v1 - v0 ).cross( v2 - v0 ) );
         // n0
@@ -844,6 +842,8 @@ void CalculateFaces(
 
         f++;
     }
+
+    ::MapColors( cmap, min_value, max_value, scalars, colors->data() );
 }
 
 } // end of namespace
@@ -1695,11 +1695,11 @@ void ExternalFaces::calculate_colors( const kvs::StructuredVolumeObject* volume
 
     const kvs::ColorMap cmap( BaseClass::colorMap() );
 
-    kvs::ValueArray<kvs::UInt8> colors( 3 * nexternal_vertices );
-    kvs::UInt8* color = colors.data();
+    kvs::ValueArray<kvs::Real32> scalars( nexternal_vertices );
+    kvs::Real32* scalar = scalars.data();
 
     kvs::UInt32 node_index[4];
-    kvs::UInt32 color_level[4];
+    kvs::Real32 node_value[4];
 
     // XY (Z=0) plane.
     {
@@ -1713,32 +1713,20 @@ void ExternalFaces::calculate_colors( const kvs::StructuredVolumeObject* volume
                 node_index[1] = node_index[0] + 1;
                 node_index[2] = node_index[1] + nnodes_per_line;
                 node_index[3] = node_index[0] + nnodes_per_line;
-                ::GetColorIndices<4>( value, min_value, max_value, veclen, cmap.resolution(), node_index, &color_level );
+                ::GetNodeValues<4>( value, veclen, node_index, &node_value );
                 // v3
-                *( color++ ) = cmap[ color_level[3] ].r();
-                *( color++ ) = cmap[ color_level[3] ].g();
-                *( color++ ) = cmap[ color_level[3] ].b();
+                *( scalar++ ) = node_value[3];
                 // v2
-                *( color++ ) = cmap[ color_level[2] ].r();
-                *( color++ ) = cmap[ color_level[2] ].g();
-                *( color++ ) = cmap[ color_level[2] ].b();
+                *( scalar++ ) = node_value[2];
                 // v1
-                *( color++ ) = cmap[ color_level[1] ].r();
-                *( color++ ) = cmap[ color_level[1] ].g();
-                *( color++ ) = cmap[ color_level[1] ].b();
+                *( scalar++ ) = node_value[1];
 
                 // v1
-                *( color++ ) = cmap[ color_level[1] ].r();
-                *( color++ ) = cmap[ color_level[1] ].g();
-                *( color++ ) = cmap[ color_level[1] ].b();
+                *( scalar++ ) = node_value[1];
                 // v0
-                *( color++ ) = cmap[ color_level[0] ].r();
-                *( color++ ) = cmap[ color_level[0] ].g();
-                *( color++ ) = cmap[ color_level[0] ].b();
+                *( scalar++ ) = node_value[0];
                 // v3
-                *( color++ ) = cmap[ color_level[3] ].r();
-                *( color++ ) = cmap[ color_level[3] ].g();
-                *( color++ ) = cmap[ color_level[3] ].b();
+                *( scalar++ ) = node_value[3];
             }
         }
     }
@@ -1755,32 +1743,20 @@ void ExternalFaces::calculate_colors( const kvs::StructuredVolumeObject* volume
                 node_index[1] = node_index[0] + 1;
                 node_index[2] = node_index[1] + nnodes_per_line;
                 node_index[3] = node_index[0] + nnodes_per_line;
-                ::GetColorIndices<4>( value, min_value, max_value, veclen, cmap.resolution(), node_index, &color_level );
+                ::GetNodeValues<4>( value, veclen, node_index, &node_value );
                 // v0
-                *( color++ ) = cmap[ color_level[0] ].r();
-                *( color++ ) = cmap[ color_level[0] ].g();
-                *( color++ ) = cmap[ color_level[0] ].b();
+                *( scalar++ ) = node_value[0];
                 // v1
-                *( color++ ) = cmap[ color_level[1] ].r();
-                *( color++ ) = cmap[ color_level[1] ].g();
-                *( color++ ) = cmap[ color_level[1] ].b();
+                *( scalar++ ) = node_value[1];
                 // v2
-                *( color++ ) = cmap[ color_level[2] ].r();
-                *( color++ ) = cmap[ color_level[2] ].g();
-                *( color++ ) = cmap[ color_level[2] ].b();
+                *( scalar++ ) = node_value[2];
 
                 // v2
-                *( color++ ) = cmap[ color_level[2] ].r();
-                *( color++ ) = cmap[ color_level[2] ].g();
-                *( color++ ) = cmap[ color_level[2] ].b();
+                *( scalar++ ) = node_value[2];
                 // v3
-                *( color++ ) = cmap[ color_level[3] ].r();
-                *( color++ ) = cmap[ color_level[3] ].g();
-                *( color++ ) = cmap[ color_level[3] ].b();
+                *( scalar++ ) = node_value[3];
                 // v0
-                *( color++ ) = cmap[ color_level[0] ].r();
-                *( color++ ) = cmap[ color_level[0] ].g();
-                *( color++ ) = cmap[ color_level[0] ].b();
+                *( scalar++ ) = node_value[0];
             }
         }
     }
@@ -1797,32 +1773,20 @@ void ExternalFaces::calculate_colors( const kvs::StructuredVolumeObject* volume
                 node_index[1] = node_index[0] + nnodes_per_slice;
                 node_index[2] = node_index[1] + nnodes_per_line;
                 node_index[3] = node_index[0] + nnodes_per_line;
-                ::GetColorIndices<4>( value, min_value, max_value, veclen, cmap.resolution(), node_index, &color_level );
+                ::GetNodeValues<4>( value, veclen, node_index, &node_value );
                 // v0
-                *( color++ ) = cmap[ color_level[0] ].r();
-                *( color++ ) = cmap[ color_level[0] ].g();
-                *( color++ ) = cmap[ color_level[0] ].b();
+                *( scalar++ ) = node_value[0];
                 // v1
-                *( color++ ) = cmap[ color_level[1] ].r();
-                *( color++ ) = cmap[ color_level[1] ].g();
-                *( color++ ) = cmap[ color_level[1] ].b();
+                *( scalar++ ) = node_value[1];
                 // v2
-                *( color++ ) = cmap[ color_level[2] ].r();
-                *( color++ ) = cmap[ color_level[2] ].g();
-                *( color++ ) = cmap[ color_level[2] ].b();
+                *( scalar++ ) = node_value[2];
 
                 // v2
-                *( color++ ) = cmap[ color_level[2] ].r();
-                *( color++ ) = cmap[ color_level[2] ].g();
-                *( color++ ) = cmap[ color_level[2] ].b();
+                *( scalar++ ) = node_value[2];
                 // v3
-                *( color++ ) = cmap[ color_level[3] ].r();
-                *( color++ ) = cmap[ color_level[3] ].g();
-                *( color++ ) = cmap[ color_level[3] ].b();
+                *( scalar++ ) = node_value[3];
                 // v0
-                *( color++ ) = cmap[ color_level[0] ].r();
-                *( color++ ) = cmap[ color_level[0] ].g();
-                *( color++ ) = cmap[ color_level[0] ].b();
+                *( scalar++ ) = node_value[0];
             }
         }
     }
@@ -1839,32 +1803,20 @@ void ExternalFaces::calculate_colors( const kvs::StructuredVolumeObject* volume
                 node_index[1] = node_index[0] + nnodes_per_slice;
                 node_index[2] = node_index[1] + nnodes_per_line;
                 node_index[3] = node_index[0] + nnodes_per_line;
-                ::GetColorIndices<4>( value, min_value, max_value, veclen, cmap.resolution(), node_index, &color_level );
+                ::GetNodeValues<4>( value, veclen, node_index, &node_value );
                 // v3
-                *( color++ ) = cmap[ color_level[3] ].r();
-                *( color++ ) = cmap[ color_level[3] ].g();
-                *( color++ ) = cmap[ color_level[3] ].b();
+                *( scalar++ ) = node_value[3];
                 // v2
-                *( color++ ) = cmap[ color_level[2] ].r();
-                *( color++ ) = cmap[ color_level[2] ].g();
-                *( color++ ) = cmap[ color_level[2] ].b();
+                *( scalar++ ) = node_value[2];
                 // v1
-                *( color++ ) = cmap[ color_level[1] ].r();
-                *( color++ ) = cmap[ color_level[1] ].g();
-                *( color++ ) = cmap[ color_level[1] ].b();
+                *( scalar++ ) = node_value[1];
 
                 // v1
-                *( color++ ) = cmap[ color_level[1] ].r();
-                *( color++ ) = cmap[ color_level[1] ].g();
-                *( color++ ) = cmap[ color_level[1] ].b();
+                *( scalar++ ) = node_value[1];
                 // v0
-                *( color++ ) = cmap[ color_level[0] ].r();
-                *( color++ ) = cmap[ color_level[0] ].g();
-                *( color++ ) = cmap[ color_level[0] ].b();
+                *( scalar++ ) = node_value[0];
                 // v3
-                *( color++ ) = cmap[ color_level[3] ].r();
-                *( color++ ) = cmap[ color_level[3] ].g();
-                *( color++ ) = cmap[ color_level[3] ].b();
+                *( scalar++ ) = node_value[3];
             }
         }
     }
@@ -1881,32 +1833,20 @@ void ExternalFaces::calculate_colors( const kvs::StructuredVolumeObject* volume
                 node_index[1] = node_index[0] + 1;
                 node_index[2] = node_index[1] + nnodes_per_slice;
                 node_index[3] = node_index[0] + nnodes_per_slice;
-                ::GetColorIndices<4>( value, min_value, max_value, veclen, cmap.resolution(), node_index, &color_level );
+                ::GetNodeValues<4>( value, veclen, node_index, &node_value );
                 // v0
-                *( color++ ) = cmap[ color_level[0] ].r();
-                *( color++ ) = cmap[ color_level[0] ].g();
-                *( color++ ) = cmap[ color_level[0] ].b();
+                *( scalar++ ) = node_value[0];
                 // v1
-                *( color++ ) = cmap[ color_level[1] ].r();
-                *( color++ ) = cmap[ color_level[1] ].g();
-                *( color++ ) = cmap[ color_level[1] ].b();
+                *( scalar++ ) = node_value[1];
                 // v2
-                *( color++ ) = cmap[ color_level[2] ].r();
-                *( color++ ) = cmap[ color_level[2] ].g();
-                *( color++ ) = cmap[ color_level[2] ].b();
+                *( scalar++ ) = node_value[2];
 
                 // v3
-                *( color++ ) = cmap[ color_level[3] ].r();
-                *( color++ ) = cmap[ color_level[3] ].g();
-                *( color++ ) = cmap[ color_level[3] ].b();
+                *( scalar++ ) = node_value[3];
                 // v2
-                *( color++ ) = cmap[ color_level[2] ].r();
-                *( color++ ) = cmap[ color_level[2] ].g();
-                *( color++ ) = cmap[ color_level[2] ].b();
+                *( scalar++ ) = node_value[2];
                 // v0
-                *( color++ ) = cmap[ color_level[0] ].r();
-                *( color++ ) = cmap[ color_level[0] ].g();
-                *( color++ ) = cmap[ color_level[0] ].b();
+                *( scalar++ ) = node_value[0];
             }
         }
     }
@@ -1923,36 +1863,27 @@ void ExternalFaces::calculate_colors( const kvs::StructuredVolumeObject* volume
                 node_index[1] = node_index[0] + 1;
                 node_index[2] = node_index[1] + nnodes_per_slice;
                 node_index[3] = node_index[0] + nnodes_per_slice;
-                ::GetColorIndices<4>( value, min_value, max_value, veclen, cmap.resolution(), node_index, &color_level );
+                ::GetNodeValues<4>( value, veclen, node_index, &node_value );
                 // v3
-                *( color++ ) = cmap[ color_level[3] ].r();
-                *( color++ ) = cmap[ color_level[3] ].g();
-                *( color++ ) = cmap[ color_level[3] ].b();
+                *( scalar++ ) = node_value[3];
                 // v2
-                *( color++ ) = cmap[ color_level[2] ].r();
-                *( color++ ) = cmap[ color_level[2] ].g();
-                *( color++ ) = cmap[ color_level[2] ].b();
+                *( scalar++ ) = node_value[2];
                 // v1
-                *( color++ ) = cmap[ color_level[1] ].r();
-                *( color++ ) = cmap[ color_level[1] ].g();
-                *( color++ ) = cmap[ color_level[1] ].b();
+                *( scalar++ ) = node_value[1];
 
                 // v1
-                *( color++ ) = cmap[ color_level[1] ].r();
-                *( color++ ) = cmap[ color_level[1] ].g();
-                *( color++ ) = cmap[ color_level[1] ].b();
+                *( scalar++ ) = node_value[1];
                 // v0
-                *( color++ ) = cmap[ color_level[0] ].r();
-                *( color++ ) = cmap[ color_level[0] ].g();
-                *( color++ ) = cmap[ color_level[0] ].b();
+                *( scalar++ ) = node_value[0];
                 // v3
-                *( color++ ) = cmap[ color_level[3] ].r();
-                *( color++ ) = cmap[ color_level[3] ].g();
-                *( color++ ) = cmap[ color_level[3] ].b();
+                *( scalar++ ) = node_value[3];
             }
         }
     }
 
+    kvs::ValueArray<kvs::UInt8> colors( 3 * nexternal_vertices );
+    ::MapColors( cmap, min_value, max_value, scalars, colors.data() );
+
     SuperClass::setColors( colors );
 }
 
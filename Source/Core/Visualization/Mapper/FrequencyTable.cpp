@@ -13,8 +13,11 @@
  */
 /****************************************************************************/
 #include "FrequencyTable.h"
+#include <vector>
+#include <cmath>
 #include <kvs/Type>
 #include <kvs/Value>
+#include <kvs/ValueStatistics>
 
 
 namespace kvs
@@ -293,15 +296,18 @@ void FrequencyTable::calculate_range( const kvs::ImageObject* image )
 /*==========================================================================*/
 void FrequencyTable::count_bin( const kvs::VolumeObjectBase* volume )
 {
-    const std::type_info& type = volume->values().typeInfo()->type();
-    if (      type == typeid( kvs::Int8 )   ) this->binning<kvs::Int8>( volume );
-    else if ( type == typeid( kvs::UInt8 )  ) this->binning<kvs::UInt8>( volume );
-    else if ( type == typeid( kvs::Int16 )  ) this->binning<kvs::Int16>( volume );
-    else if ( type == typeid( kvs::UInt16 ) ) this->binning<kvs::UInt16>( volume );
-    else if ( type == typeid( kvs::Int32 )  ) this->binning<kvs::Int32>( volume );
-    else if ( type == typeid( kvs::UInt32 ) ) this->binning<kvs::UInt32>( volume );
-    else if ( type == typeid( kvs::Real32 ) ) this->binning<kvs::Real32>( volume );
-    else if ( type == typeid( kvs::Real64 ) ) this->binning<kvs::Real64>( volume );
+    const std::vector<kvs::Real64> ignore_values( m_ignore_values.begin(), m_ignore_values.end() );
+    const kvs::Real64 width = ( m_max_range - m_min_range ) / kvs::Real64( m_nbins - 1 );
+    const size_t total_count = kvs::ValueStatistics::Histogram(
+        volume->values(),
+        volume->veclen(),
+        m_min_range,
+        width,
+        static_cast<size_t>( m_nbins ),
+        m_bin.data(),
+        ignore_values );
+
+    this->calculate_statistics( total_count );
 }
 
 /*==========================================================================*/
@@ -327,6 +333,26 @@ void FrequencyTable::count_bin( const kvs::ImageObject* image, const size_t chan
     }
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the max. count and the mean/variance of the bin counts.
+ *  @param  total_count [in] number of counted values
+ */
+/*===========================================================================*/
+void FrequencyTable::calculate_statistics( const size_t total_count )
+{
+    m_max_count = 0;
+    for ( size_t i = 0; i < m_nbins; i++ ) m_max_count = kvs::Math::Max( m_max_count, m_bin[i] );
+
+    m_mean = static_cast<kvs::Real64>( total_count ) / m_nbins;
+
+    kvs::Real64 sum = 0;
+    for ( size_t i = 0; i < m_nbins; i++ ) sum += kvs::Math::Square( m_bin[i] - m_mean );
+    m_variance = sum / m_nbins;
+
+    m_standard_deviation = std::sqrt( m_variance );
+}
+
 /*==========================================================================*/
 /**
  *  @brief  Tests which a value is the ignore value or not.
@@ -57,6 +57,7 @@ public:
 
 private:
 
+    struct SurfaceExtractor;
     void mapping( const kvs::StructuredVolumeObject* volume );
     template <typename T> void extract_surfaces( const kvs::StructuredVolumeObject* volume );
     template <typename T> void extract_surfaces_with_duplication( const kvs::StructuredVolumeObject* volume );
@@ -13,6 +13,7 @@
 /****************************************************************************/
 #include "MarchingHexahedra.h"
 #include "MarchingHexahedraTable.h"
+#include <kvs/TypeDispatch>
 
 
 namespace kvs
@@ -116,6 +117,19 @@ kvs::ObjectBase* MarchingHexahedra::exec( const kvs::ObjectBase* object )
     return this;
 }
 
+/*==========================================================================*/
+/**
+ *  @brief  Functor to call extract_surfaces with the value type of the volume.
+ */
+/*==========================================================================*/
+struct MarchingHexahedra::SurfaceExtractor
+{
+    MarchingHexahedra* mapper;
+    const kvs::UnstructuredVolumeObject* volume;
+    SurfaceExtractor( MarchingHexahedra* m, const kvs::UnstructuredVolumeObject* v ): mapper( m ), volume( v ) {}
+    template <typename T> void operator ()( kvs::TypeTag<T> ) const { mapper->extract_surfaces<T>( volume ); }
+};
+
 /*==========================================================================*/
 /**
  *  Extracts the surfaces.
@@ -137,18 +151,7 @@ void MarchingHexahedra::mapping( const kvs::UnstructuredVolumeObject* volume )
     BaseClass::setMinMaxCoords( volume, this );
 
     // Extract surfaces.
-    const std::type_info& type = volume->values().typeInfo()->type();
-    if (      type == typeid( kvs::Int8   ) ) this->extract_surfaces<kvs::Int8>( volume );
-    else if ( type == typeid( kvs::Int16  ) ) this->extract_surfaces<kvs::Int16>( volume );
-    else if ( type == typeid( kvs::Int32  ) ) this->extract_surfaces<kvs::Int32>( volume );
-    else if ( type == typeid( kvs::Int64  ) ) this->extract_surfaces<kvs::Int64>( volume );
-    else if ( type == typeid( kvs::UInt8  ) ) this->extract_surfaces<kvs::UInt8>( volume );
-    else if ( type == typeid( kvs::UInt16 ) ) this->extract_surfaces<kvs::UInt16>( volume );
-    else if ( type == typeid( kvs::UInt32 ) ) this->extract_surfaces<kvs::UInt32>( volume );
-    else if ( type == typeid( kvs::UInt64 ) ) this->extract_surfaces<kvs::UInt64>( volume );
-    else if ( type == typeid( kvs::Real32 ) ) this->extract_surfaces<kvs::Real32>( volume );
-    else if ( type == typeid( kvs::Real64 ) ) this->extract_surfaces<kvs::Real64>( volume );
-    else
+    if ( !kvs::DispatchType( volume->values().typeID(), SurfaceExtractor( this, volume ) ) )
     {
         kvsMessageError("Unsupported data type '%s' of the volume.",
                         volume->values().typeInfo()->typeName() );
@@ -14,6 +14,7 @@
 /****************************************************************************/
 #include "MarchingTetrahedra.h"
 #include "MarchingTetrahedraTable.h"
+#include <kvs/TypeDispatch>
 #include <kvs/IgnoreUnusedVariable>
 
 
@@ -104,6 +105,19 @@ MarchingTetrahedra::SuperClass* MarchingTetrahedra::exec( const kvs::ObjectBase*
     return this;
 }
 
+/*==========================================================================*/
+/**
+ *  @brief  Functor to call extract_surfaces with the value type of the volume.
+ */
+/*==========================================================================*/
+struct MarchingTetrahedra::SurfaceExtractor
+{
+    MarchingTetrahedra* mapper;
+    const kvs::UnstructuredVolumeObject* volume;
+    SurfaceExtractor( MarchingTetrahedra* m, const kvs::UnstructuredVolumeObject* v ): mapper( m ), volume( v ) {}
+    template <typename T> void operator ()( kvs::TypeTag<T> ) const { mapper->extract_surfaces<T>( volume ); }
+};
+
 /*==========================================================================*/
 /**
  *  @brief  Extracts the surfaces.
@@ -133,18 +147,7 @@ void MarchingTetrahedra::mapping( const kvs::UnstructuredVolumeObject* volume )
     BaseClass::setMinMaxCoords( volume, this );
 
     // Extract surfaces.
-    const std::type_info& type = volume->values().typeInfo()->type();
-    if (      type == typeid( kvs::Int8   ) ) this->extract_surfaces<kvs::Int8>( volume );
-    else if ( type == typeid( kvs::Int16  ) ) this->extract_surfaces<kvs::Int16>( volume );
-    else if ( type == typeid( kvs::Int32  ) ) this->extract_surfaces<kvs::Int32>( volume );
-    else if ( type == typeid( kvs::Int64  ) ) this->extract_surfaces<kvs::Int64>( volume );
-    else if ( type == typeid( kvs::UInt8  ) ) this->extract_surfaces<kvs::UInt8>( volume );
-    else if ( type == typeid( kvs::UInt16 ) ) this->extract_surfaces<kvs::UInt16>( volume );
-    else if ( type == typeid( kvs::UInt32 ) ) this->extract_surfaces<kvs::UInt32>( volume );
-    else if ( type == typeid( kvs::UInt64 ) ) this->extract_surfaces<kvs::UInt64>( volume );
-    else if ( type == typeid( kvs::Real32 ) ) this->extract_surfaces<kvs::Real32>( volume );
-    else if ( type == typeid( kvs::Real64 ) ) this->extract_surfaces<kvs::Real64>( volume );
-    else
+    if ( !kvs::DispatchType( volume->values().typeID(), SurfaceExtractor( this, volume ) ) )
     {
         BaseClass::setSuccess( false );
         kvsMessageError("Unsupported data type '%s'.", volume->values().typeInfo()->typeName() );
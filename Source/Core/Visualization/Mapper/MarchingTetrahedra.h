@@ -55,6 +55,7 @@ public:
 
 protected:
 
+    struct SurfaceExtractor;
     void mapping( const kvs::UnstructuredVolumeObject* volume );
     template <typename T> void extract_surfaces( const kvs::UnstructuredVolumeObject* volume );
     template <typename T> void extract_surfaces_with_duplication( const kvs::UnstructuredVolumeObject* volume );
@@ -15,12 +15,14 @@
 #include "OpacityMap.h"
 #include <kvs/Assert>
 #include <kvs/Math>
+#include <kvs/OpenMP>
 
 
 namespace
 {
 
 const size_t Resolution = 256;
+const size_t BatchSize = 256;
 
 struct Equal
 {
@@ -288,6 +290,65 @@ kvs::Real32 OpacityMap::at( const float value ) const
     return kvs::Math::Mix( a0, a1, v - s0 );
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Maps the values to the opacities in the same way as at().
+ *  @param  values [in] pointer to the values
+ *  @param  nvalues [in] number of the values
+ *  @param  opacities [out] pointer to the opacity array (nvalues)
+ */
+/*===========================================================================*/
+template <typename T>
+void OpacityMap::mapOpacities( const T* values, const size_t nvalues, kvs::Real32* opacities ) const
+{
+    KVS_ASSERT( m_table.size() == m_resolution );
+
+    const kvs::Real32* const table = m_table.data();
+    const size_t last = m_resolution - 1;
+    const float r = static_cast<float>( last );
+    const float min_value = m_min_value;
+    const float max_value = m_max_value;
+    const float range = m_max_value - m_min_value;
+    const size_t nbatches = ( nvalues + ::BatchSize - 1 ) / ::BatchSize;
+
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t batch = 0; batch < nbatches; ++batch )
+    {
+        const size_t begin = batch * ::BatchSize;
+        const size_t size = kvs::Math::Min( ::BatchSize, nvalues - begin );
+
+        // Table coordinates of the batch; the values out of the range are transparent.
+        float coords[ ::BatchSize ];
+        float inside[ ::BatchSize ];
+        for ( size_t i = 0; i < size; ++i )
+        {
+            const float value = static_cast<float>( values[ begin + i ] );
+            const bool is_inside = min_value <= value && value <= max_value;
+            coords[i] = is_inside && range > 0.0f ? ( value - min_value ) / range * r : 0.0f;
+            inside[i] = is_inside ? 1.0f : 0.0f;
+        }
+
+        kvs::Real32* opacity = opacities + begin;
+        for ( size_t i = 0; i < size; ++i )
+        {
+            const size_t s0 = static_cast<size_t>( coords[i] );
+            const size_t s1 = kvs::Math::Min( s0 + 1, last );
+            opacity[i] = inside[i] * kvs::Math::Mix( table[ s0 ], table[ s1 ], coords[i] - s0 );
+        }
+    }
+}
+
+template void OpacityMap::mapOpacities<kvs::Int8  >( const kvs::Int8*   values, const size_t nvalues, kvs::Real32* opacities ) const;
+template void OpacityMap::mapOpacities<kvs::Int16 >( const kvs::Int16*  values, const size_t nvalues, kvs::Real32* opacities ) const;
+template void OpacityMap::mapOpacities<kvs::Int32 >( const kvs::Int32*  values, const size_t nvalues, kvs::Real32* opacities ) const;
+template void OpacityMap::mapOpacities<kvs::Int64 >( const kvs::Int64*  values, const size_t nvalues, kvs::Real32* opacities ) const;
+template void OpacityMap::mapOpacities<kvs::UInt8 >( const kvs::UInt8*  values, const size_t nvalues, kvs::Real32* opacities ) const;
+template void OpacityMap::mapOpacities<kvs::UInt16>( const kvs::UInt16* values, const size_t nvalues, kvs::Real32* opacities ) const;
+template void OpacityMap::mapOpacities<kvs::UInt32>( const kvs::UInt32* values, const size_t nvalues, kvs::Real32* opacities ) const;
+template void OpacityMap::mapOpacities<kvs::UInt64>( const kvs::UInt64* values, const size_t nvalues, kvs::Real32* opacities ) const;
+template void OpacityMap::mapOpacities<kvs::Real32>( const kvs::Real32* values, const size_t nvalues, kvs::Real32* opacities ) const;
+template void OpacityMap::mapOpacities<kvs::Real64>( const kvs::Real64* values, const size_t nvalues, kvs::Real32* opacities ) const;
+
 /*==========================================================================*/
 /**
  *  Substitution operator =.
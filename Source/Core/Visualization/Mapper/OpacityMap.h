@@ -70,6 +70,8 @@ public:
 
     kvs::Real32 operator []( const size_t index ) const;
     kvs::Real32 at( const float value ) const;
+    template <typename T>
+    void mapOpacities( const T* values, const size_t nvalues, kvs::Real32* opacities ) const;
     OpacityMap& operator =( const OpacityMap& rhs );
 };
 
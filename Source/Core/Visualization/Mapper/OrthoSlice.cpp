@@ -13,7 +13,11 @@
  */
 /****************************************************************************/
 #include "OrthoSlice.h"
+#include <cmath>
 #include <kvs/Matrix33>
+#include <kvs/Math>
+#include <kvs/TypeDispatch>
+#include <kvs/OpenMP>
 
 
 namespace
@@ -35,7 +39,8 @@ namespace kvs
  */
 /*==========================================================================*/
 OrthoSlice::OrthoSlice():
-    m_aligned_axis( OrthoSlice::XAxis )
+    m_aligned_axis( OrthoSlice::XAxis ),
+    m_position( 0.0f )
 {
 }
 
@@ -53,12 +58,13 @@ OrthoSlice::OrthoSlice(
     const float                  position,
     const AlignedAxis            axis,
     const kvs::TransferFunction& transfer_function ):
-    kvs::SlicePlane(
-        volume,
-        ::Normal[axis] * position,
-        ::Normal[axis],
-        transfer_function )
+    kvs::SlicePlane(),
+    m_aligned_axis( axis ),
+    m_position( position )
 {
+    BaseClass::setTransferFunction( transfer_function );
+    this->setPlane( position, axis );
+    this->exec( volume );
 }
 
 /*===========================================================================*/
@@ -70,7 +76,221 @@ OrthoSlice::OrthoSlice(
 /*===========================================================================*/
 void OrthoSlice::setPlane( const float position, const kvs::OrthoSlice::AlignedAxis axis )
 {
+    m_aligned_axis = axis;
+    m_position = position;
     SuperClass::setPlane( ::Normal[axis] * position, ::Normal[axis] );
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Executes the ortho slice.
+ *  @param  object [in] pointer to the object (volume object)
+ *  @return pointer to the sliced plane (polygon object)
+ */
+/*===========================================================================*/
+kvs::PolygonObject* OrthoSlice::exec( const kvs::ObjectBase* object )
+{
+    const kvs::VolumeObjectBase* volume = object ? kvs::VolumeObjectBase::DownCast( object ) : NULL;
+    if ( !this->is_uniform_scalar( volume ) )
+    {
+        return SuperClass::exec( object );
+    }
+
+    BaseClass::attachVolume( volume );
+    BaseClass::setRange( volume );
+    BaseClass::setMinMaxCoords( volume, this );
+
+    BaseClass::setSuccess( true );
+    this->extract_uniform_slice( kvs::StructuredVolumeObject::DownCast( volume ) );
+
+    return this;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Functor to sample the slice values with the value type of the volume.
+ */
+/*===========================================================================*/
+struct OrthoSlice::SliceSampler
+{
+    size_t offset0; ///< offset to the lower grid slice
+    size_t offset1; ///< offset to the upper grid slice
+    kvs::Real32 ratio; ///< interpolation ratio between the grid slices
+    size_t nu; ///< number of nodes in the first in-plane axis
+    size_t nv; ///< number of nodes in the second in-plane axis
+    size_t stride_u; ///< stride of the first in-plane axis
+    size_t stride_v; ///< stride of the second in-plane axis
+    kvs::Real32* slice; ///< sampled values (nu x nv)
+
+    template <typename T>
+    void operator ()( const T* values ) const
+    {
+        const T* values0 = values + offset0;
+        const T* values1 = values + offset1;
+
+        KVS_OMP_PARALLEL_FOR( schedule(static) )
+        for ( size_t j = 0; j < nv; j++ )
+        {
+            const size_t row = j * stride_v;
+            kvs::Real32* dst = slice + j * nu;
+            if ( ratio == 0.0f )
+            {
+                for ( size_t i = 0; i < nu; i++ )
+                {
+                    dst[i] = static_cast<kvs::Real32>( values0[ row + i * stride_u ] );
+                }
+            }
+            else
+            {
+                for ( size_t i = 0; i < nu; i++ )
+                {
+                    const kvs::Real32 s0 = static_cast<kvs::Real32>( values0[ row + i * stride_u ] );
+                    const kvs::Real32 s1 = static_cast<kvs::Real32>( values1[ row + i * stride_u ] );
+                    dst[i] = s0 + ratio * ( s1 - s0 );
+                }
+            }
+        }
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if the volume is a scalar volume on a uniform grid.
+ *  @param  volume [in] pointer to the volume object
+ *  @return true if the slice can be taken directly from the value array
+ */
+/*===========================================================================*/
+bool OrthoSlice::is_uniform_scalar( const kvs::VolumeObjectBase* volume ) const
+{
+    if ( !volume ) { return false; }
+    if ( volume->veclen() != 1 ) { return false; }
+    if ( volume->volumeType() != kvs::VolumeObjectBase::Structured ) { return false; }
+
+    const kvs::StructuredVolumeObject* structured_volume = kvs::StructuredVolumeObject::DownCast( volume );
+    return structured_volume->gridType() == kvs::StructuredVolumeObject::Uniform;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Extracts the slice of the uniform grid volume.
+ *  @param  volume [in] pointer to the structured volume object
+ */
+/*===========================================================================*/
+void OrthoSlice::extract_uniform_slice( const kvs::StructuredVolumeObject* volume )
+{
+    const int axis = static_cast<int>( m_aligned_axis );
+    const int axis_u = ( axis == 0 ) ? 1 : 0;
+    const int axis_v = ( axis == 2 ) ? 1 : 2;
+
+    const kvs::Vec3ui resolution = volume->resolution();
+    const size_t stride[3] = {
+        1,
+        resolution.x(),
+        size_t( resolution.x() ) * resolution.y() };
+
+    SuperClass::setOpacity( 255 );
+    SuperClass::setPolygonType( kvs::PolygonObject::Triangle );
+    SuperClass::setColorType( kvs::PolygonObject::VertexColor );
+    SuperClass::setNormalType( kvs::PolygonObject::VertexNormal );
+
+    // The slice out of the volume is empty.
+    const float max_position = static_cast<float>( resolution[axis] - 1 );
+    if ( !( m_position >= 0.0f && m_position <= max_position ) )
+    {
+        SuperClass::setCoords( kvs::ValueArray<kvs::Real32>() );
+        SuperClass::setColors( kvs::ValueArray<kvs::UInt8>() );
+        SuperClass::setNormals( kvs::ValueArray<kvs::Real32>() );
+        SuperClass::setConnections( kvs::ValueArray<kvs::UInt32>() );
+        return;
+    }
+
+    const size_t nu = resolution[ axis_u ];
+    const size_t nv = resolution[ axis_v ];
+    const size_t nnodes = nu * nv;
+    const size_t k0 = static_cast<size_t>( std::floor( m_position ) );
+    const size_t k1 = kvs::Math::Min( k0 + 1, size_t( resolution[axis] - 1 ) );
+
+    // Sample the values on the slice.
+    kvs::ValueArray<kvs::Real32> slice( nnodes );
+    SliceSampler sampler;
+    sampler.offset0 = k0 * stride[ axis ];
+    sampler.offset1 = k1 * stride[ axis ];
+    sampler.ratio = m_position - static_cast<float>( k0 );
+    sampler.nu = nu;
+    sampler.nv = nv;
+    sampler.stride_u = stride[ axis_u ];
+    sampler.stride_v = stride[ axis_v ];
+    sampler.slice = slice.data();
+    if ( !kvs::DispatchValues( volume->values(), sampler ) )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError("Unsupported data type '%s'.", volume->values().typeInfo()->typeName() );
+        return;
+    }
+
+    // Map the values to the colors normalized by the value range of the
+    // volume, as for kvs::SlicePlane.
+    const kvs::Real64 min_value( volume->minValue() );
+    const kvs::Real64 max_value( volume->maxValue() );
+    const kvs::Real64 normalize_factor( 255.0 / ( max_value - min_value ) );
+    const kvs::ColorMap& color_map( BaseClass::transferFunction().colorMap() );
+    kvs::ValueArray<kvs::UInt8> colors( nnodes * 3 );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < nnodes; i++ )
+    {
+        const kvs::UInt8 index = static_cast<kvs::UInt8>( normalize_factor * ( slice[i] - min_value ) );
+        const kvs::RGBColor rgb = color_map[ index ];
+        colors[ 3 * i + 0 ] = rgb.r();
+        colors[ 3 * i + 1 ] = rgb.g();
+        colors[ 3 * i + 2 ] = rgb.b();
+    }
+
+    // Nodes of the slice in the index space, as for kvs::SlicePlane.
+    kvs::Vec3 normal( 0.0f, 0.0f, 0.0f );
+    normal[ axis ] = ( axis == 1 ) ? -1.0f : 1.0f;
+    kvs::ValueArray<kvs::Real32> coords( nnodes * 3 );
+    kvs::ValueArray<kvs::Real32> normals( nnodes * 3 );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t j = 0; j < nv; j++ )
+    {
+        for ( size_t i = 0; i < nu; i++ )
+        {
+            kvs::Real32* coord = coords.data() + 3 * ( j * nu + i );
+            coord[ axis ] = m_position;
+            coord[ axis_u ] = static_cast<kvs::Real32>( i );
+            coord[ axis_v ] = static_cast<kvs::Real32>( j );
+
+            kvs::Real32* n = normals.data() + 3 * ( j * nu + i );
+            n[0] = normal[0];
+            n[1] = normal[1];
+            n[2] = normal[2];
+        }
+    }
+
+    // Two triangles for each cell of the slice (wound around the normal).
+    const size_t ncells_u = nu > 0 ? nu - 1 : 0;
+    const size_t ncells_v = nv > 0 ? nv - 1 : 0;
+    kvs::ValueArray<kvs::UInt32> connections( ncells_u * ncells_v * 6 );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t j = 0; j < ncells_v; j++ )
+    {
+        for ( size_t i = 0; i < ncells_u; i++ )
+        {
+            const kvs::UInt32 v00 = static_cast<kvs::UInt32>( j * nu + i );
+            const kvs::UInt32 v10 = v00 + 1;
+            const kvs::UInt32 v01 = static_cast<kvs::UInt32>( v00 + nu );
+            const kvs::UInt32 v11 = v01 + 1;
+
+            kvs::UInt32* c = connections.data() + 6 * ( j * ncells_u + i );
+            c[0] = v00; c[1] = v10; c[2] = v11;
+            c[3] = v00; c[4] = v11; c[5] = v01;
+        }
+    }
+
+    SuperClass::setCoords( coords );
+    SuperClass::setColors( colors );
+    SuperClass::setNormals( normals );
+    SuperClass::setConnections( connections );
+}
+
 } // end of namespace kvs
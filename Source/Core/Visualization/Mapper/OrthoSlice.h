@@ -17,6 +17,7 @@
 
 #include <kvs/SlicePlane>
 #include <kvs/VolumeObjectBase>
+#include <kvs/StructuredVolumeObject>
 #include <kvs/Module>
 
 
@@ -26,11 +27,18 @@ namespace kvs
 /*==========================================================================*/
 /**
  *  Axis aligned slice plane class.
+ *
+ *  For a scalar volume on a uniform grid, the slice is taken directly from
+ *  the value array (linearly interpolated between the two nearest grid
+ *  slices) and output as a grid of triangles sharing the slice nodes, so
+ *  that no plane/cell intersection is needed. Other volumes are processed
+ *  by kvs::SlicePlane.
  */
 /*==========================================================================*/
 class OrthoSlice : public kvs::SlicePlane
 {
     kvsModule( kvs::OrthoSlice, Mapper );
+    kvsModuleBaseClass( kvs::MapperBase );
     kvsModuleSuperClass( kvs::SlicePlane );
 
 public:
@@ -45,6 +53,7 @@ public:
 protected:
 
     AlignedAxis m_aligned_axis; ///< aligned axis
+    float m_position; ///< position on the aligned axis
 
 public:
 
@@ -55,7 +64,18 @@ public:
         const AlignedAxis aligned_axis,
         const kvs::TransferFunction& transfer_function );
 
+    AlignedAxis alignedAxis() const { return m_aligned_axis; }
+    float position() const { return m_position; }
+
     void setPlane( const float position, const kvs::OrthoSlice::AlignedAxis axis );
+
+    kvs::PolygonObject* exec( const kvs::ObjectBase* object );
+
+protected:
+
+    struct SliceSampler;
+    bool is_uniform_scalar( const kvs::VolumeObjectBase* volume ) const;
+    void extract_uniform_slice( const kvs::StructuredVolumeObject* volume );
 };
 
 } // end of namespace kvs
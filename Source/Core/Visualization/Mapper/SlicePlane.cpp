@@ -18,6 +18,65 @@
 #include <kvs/MarchingHexahedraTable>
 #include <kvs/MarchingPyramidTable>
 #include <kvs/MarchingPrismTable>
+#include <kvs/TypeDispatch>
+#include <kvs/OpenMP>
+#include <kvs/Math>
+#include <cmath>
+#include <vector>
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Marching tables and node order of the cell types for the slice.
+ */
+/*===========================================================================*/
+template <size_t N, size_t M, const int (*Triangles)[M], const int (*Vertices)[2]>
+struct CellTableBase
+{
+    enum { NumberOfNodes = N };
+
+    static const int* TriangleID( const size_t table_index ) { return Triangles[ table_index ]; }
+    static const int* VertexID( const int edge_id ) { return Vertices[ edge_id ]; }
+
+    static size_t NumberOfTriangles( const size_t table_index )
+    {
+        size_t n = 0;
+        while ( Triangles[ table_index ][n] != -1 ) { n += 3; }
+        return n / 3;
+    }
+
+    static void Bind( const kvs::UInt32* connections, size_t* local_index )
+    {
+        for ( size_t i = 0; i < N; i++ ) { local_index[i] = connections[i]; }
+    }
+};
+
+typedef CellTableBase<4,7,kvs::MarchingTetrahedraTable::TriangleID,kvs::MarchingTetrahedraTable::VertexID> TetrahedraTable;
+typedef CellTableBase<5,13,kvs::MarchingPyramidTable::TriangleID,kvs::MarchingPyramidTable::VertexID> PyramidTable;
+typedef CellTableBase<6,10,kvs::MarchingPrismTable::TriangleID,kvs::MarchingPrismTable::VertexID> PrismTable;
+
+struct HexahedraTable :
+    public CellTableBase<8,16,kvs::MarchingHexahedraTable::TriangleID,kvs::MarchingHexahedraTable::VertexID>
+{
+    // The top and bottom faces are swapped in the marching hexahedra table.
+    static void Bind( const kvs::UInt32* connections, size_t* local_index )
+    {
+        local_index[4] = connections[0];
+        local_index[5] = connections[1];
+        local_index[6] = connections[2];
+        local_index[7] = connections[3];
+        local_index[0] = connections[4];
+        local_index[1] = connections[5];
+        local_index[2] = connections[6];
+        local_index[3] = connections[7];
+    }
+};
+
+} // end of namespace
+
 
 namespace kvs
 {
@@ -29,7 +88,9 @@ namespace kvs
 /*==========================================================================*/
 SlicePlane::SlicePlane():
     kvs::MapperBase(),
-    kvs::PolygonObject()
+    kvs::PolygonObject(),
+    m_span_min( 0.0f ),
+    m_span_width( 0.0f )
 {
 }
 
@@ -46,7 +107,9 @@ SlicePlane::SlicePlane(
     const kvs::Vector4f&         coefficients,
     const kvs::TransferFunction& transfer_function ):
     kvs::MapperBase( transfer_function ),
-    kvs::PolygonObject()
+    kvs::PolygonObject(),
+    m_span_min( 0.0f ),
+    m_span_width( 0.0f )
 {
     this->setPlane( coefficients );
     this->exec( volume );
@@ -67,7 +130,9 @@ SlicePlane::SlicePlane(
     const kvs::Vector3f&         normal,
     const kvs::TransferFunction& transfer_function ):
     kvs::MapperBase( transfer_function ),
-    kvs::PolygonObject()
+    kvs::PolygonObject(),
+    m_span_min( 0.0f ),
+    m_span_width( 0.0f )
 {
     this->setPlane( point, normal );
     this->exec( volume );
@@ -105,6 +170,112 @@ void SlicePlane::setPlane( const kvs::Vector3f& point, const kvs::Vector3f& norm
     m_coefficients = kvs::Vector4f( normal, -point.dot( normal ) );
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Builds the span index of the cells along the normal vector.
+ *  @param  volume [in] pointer to the unstructured volume object
+ *  @param  normal [in] normal vector of the slice planes
+ *
+ *  The range of the signed distance along the normal is divided into
+ *  buckets about as wide as the mean cell extent, and each bucket lists
+ *  the cells whose extent overlaps it. While the index is kept, the slice
+ *  planes parallel to the normal visit only the cells in the bucket of the
+ *  plane instead of all cells, which speeds up sweeping a plane through
+ *  the volume. The index refers to the coordinate and connection arrays of
+ *  the volume, and is ignored for the other volumes (rebuild it when the
+ *  arrays of the volume are replaced).
+ */
+/*===========================================================================*/
+void SlicePlane::buildSpanIndex(
+    const kvs::UnstructuredVolumeObject* volume,
+    const kvs::Vec3& normal )
+{
+    this->clearSpanIndex();
+
+    const size_t ncells = volume->numberOfCells();
+    const size_t nnodes = volume->numberOfCellNodes();
+    if ( ncells == 0 || nnodes == 0 || kvs::Math::IsZero( normal.length() ) ) return;
+
+    const kvs::Vec3 n = normal.normalized();
+    const kvs::Real32* coords = volume->coords().data();
+    const kvs::UInt32* connections = volume->connections().data();
+
+    // Extent of each cell along the normal.
+    std::vector<kvs::Real32> span_min( ncells );
+    std::vector<kvs::Real32> span_max( ncells );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < ncells; i++ )
+    {
+        const kvs::UInt32* cell = connections + i * nnodes;
+        kvs::Real32 dmin = n.dot( kvs::Vec3( coords + 3 * cell[0] ) );
+        kvs::Real32 dmax = dmin;
+        for ( size_t j = 1; j < nnodes; j++ )
+        {
+            const kvs::Real32 d = n.dot( kvs::Vec3( coords + 3 * cell[j] ) );
+            dmin = kvs::Math::Min( dmin, d );
+            dmax = kvs::Math::Max( dmax, d );
+        }
+        span_min[i] = dmin;
+        span_max[i] = dmax;
+    }
+
+    kvs::Real32 global_min = span_min[0];
+    kvs::Real32 global_max = span_max[0];
+    double total_extent = 0.0;
+    for ( size_t i = 0; i < ncells; i++ )
+    {
+        global_min = kvs::Math::Min( global_min, span_min[i] );
+        global_max = kvs::Math::Max( global_max, span_max[i] );
+        total_extent += span_max[i] - span_min[i];
+    }
+
+    // Bucket width about the mean cell extent (at most one bucket per cell).
+    const kvs::Real32 range = global_max - global_min;
+    kvs::Real32 width = static_cast<kvs::Real32>( total_extent / ncells );
+    width = kvs::Math::Max( width, range / static_cast<kvs::Real32>( ncells ) );
+    if ( !( width > 0.0f ) ) { width = 1.0f; }
+    const size_t nbuckets = static_cast<size_t>( range / width ) + 1;
+
+    // Cells overlapping each bucket in CSR form.
+    m_span_offsets.allocate( nbuckets + 1 );
+    m_span_offsets.fill( 0 );
+    for ( size_t i = 0; i < ncells; i++ )
+    {
+        const size_t b1 = kvs::Math::Min( static_cast<size_t>( std::floor( ( span_max[i] - global_min ) / width ) ), nbuckets - 1 );
+        const size_t b0 = kvs::Math::Min( static_cast<size_t>( std::floor( ( span_min[i] - global_min ) / width ) ), b1 );
+        for ( size_t b = b0; b <= b1; b++ ) { m_span_offsets[ b + 1 ]++; }
+    }
+    for ( size_t b = 0; b < nbuckets; b++ ) { m_span_offsets[ b + 1 ] += m_span_offsets[b]; }
+
+    m_span_cells.allocate( m_span_offsets[ nbuckets ] );
+    std::vector<kvs::UInt32> cursor( m_span_offsets.data(), m_span_offsets.data() + nbuckets );
+    for ( size_t i = 0; i < ncells; i++ )
+    {
+        const size_t b1 = kvs::Math::Min( static_cast<size_t>( std::floor( ( span_max[i] - global_min ) / width ) ), nbuckets - 1 );
+        const size_t b0 = kvs::Math::Min( static_cast<size_t>( std::floor( ( span_min[i] - global_min ) / width ) ), b1 );
+        for ( size_t b = b0; b <= b1; b++ ) { m_span_cells[ cursor[b]++ ] = static_cast<kvs::UInt32>( i ); }
+    }
+
+    m_span_normal = n;
+    m_span_coords = volume->coords();
+    m_span_connections = volume->connections();
+    m_span_min = global_min;
+    m_span_width = width;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Clears the span index.
+ */
+/*===========================================================================*/
+void SlicePlane::clearSpanIndex()
+{
+    m_span_offsets.release();
+    m_span_cells.release();
+    m_span_coords.release();
+    m_span_connections.release();
+}
+
 /*===========================================================================*/
 /**
  *  @brief  Executes the slice plane.
@@ -129,11 +300,26 @@ SlicePlane::SuperClass* SlicePlane::exec( const kvs::ObjectBase* object )
         return NULL;
     }
 
+    BaseClass::setSuccess( true );
     this->mapping( volume );
 
     return this;
 }
 
+/*==========================================================================*/
+/**
+ *  @brief  Functor to call extract_plane with the value type of the volume.
+ */
+/*==========================================================================*/
+template <typename VolumeObject>
+struct SlicePlane::PlaneExtractor
+{
+    SlicePlane* mapper;
+    const VolumeObject* volume;
+    PlaneExtractor( SlicePlane* m, const VolumeObject* v ): mapper( m ), volume( v ) {}
+    template <typename T> void operator ()( kvs::TypeTag<T> ) const { mapper->extract_plane<T>( volume ); }
+};
+
 /*==========================================================================*/
 /**
  *  @brief  Extracts the plane.
@@ -160,18 +346,7 @@ void SlicePlane::mapping( const kvs::VolumeObjectBase* volume )
         const kvs::StructuredVolumeObject* structured_volume =
             kvs::StructuredVolumeObject::DownCast( volume );
 
-        const std::type_info& type = structured_volume->values().typeInfo()->type();
-        if (      type == typeid( kvs::Int8   ) ) this->extract_plane<kvs::Int8>( structured_volume );
-        else if ( type == typeid( kvs::Int16  ) ) this->extract_plane<kvs::Int16>( structured_volume );
-        else if ( type == typeid( kvs::Int32  ) ) this->extract_plane<kvs::Int32>( structured_volume );
-        else if ( type == typeid( kvs::Int64  ) ) this->extract_plane<kvs::Int64>( structured_volume );
-        else if ( type == typeid( kvs::UInt8  ) ) this->extract_plane<kvs::UInt8>( structured_volume );
-        else if ( type == typeid( kvs::UInt16 ) ) this->extract_plane<kvs::UInt16>( structured_volume );
-        else if ( type == typeid( kvs::UInt32 ) ) this->extract_plane<kvs::UInt32>( structured_volume );
-        else if ( type == typeid( kvs::UInt64 ) ) this->extract_plane<kvs::UInt64>( structured_volume );
-        else if ( type == typeid( kvs::Real32 ) ) this->extract_plane<kvs::Real32>( structured_volume );
-        else if ( type == typeid( kvs::Real64 ) ) this->extract_plane<kvs::Real64>( structured_volume );
-        else
+        if ( !kvs::DispatchType( structured_volume->values().typeID(), PlaneExtractor<kvs::StructuredVolumeObject>( this, structured_volume ) ) )
         {
             BaseClass::setSuccess( false );
             kvsMessageError("Unsupported data type '%s'.", structured_volume->values().typeInfo()->typeName() );
@@ -182,18 +357,7 @@ void SlicePlane::mapping( const kvs::VolumeObjectBase* volume )
         const kvs::UnstructuredVolumeObject* unstructured_volume =
             kvs::UnstructuredVolumeObject::DownCast( volume );
 
-        const std::type_info& type = unstructured_volume->values().typeInfo()->type();
-        if (      type == typeid( kvs::Int8   ) ) this->extract_plane<kvs::Int8>( unstructured_volume );
-        else if ( type == typeid( kvs::Int16  ) ) this->extract_plane<kvs::Int16>( unstructured_volume );
-        else if ( type == typeid( kvs::Int32  ) ) this->extract_plane<kvs::Int32>( unstructured_volume );
-        else if ( type == typeid( kvs::Int64  ) ) this->extract_plane<kvs::Int64>( unstructured_volume );
-        else if ( type == typeid( kvs::UInt8  ) ) this->extract_plane<kvs::UInt8>( unstructured_volume );
-        else if ( type == typeid( kvs::UInt16 ) ) this->extract_plane<kvs::UInt16>( unstructured_volume );
-        else if ( type == typeid( kvs::UInt32 ) ) this->extract_plane<kvs::UInt32>( unstructured_volume );
-        else if ( type == typeid( kvs::UInt64 ) ) this->extract_plane<kvs::UInt64>( unstructured_volume );
-        else if ( type == typeid( kvs::Real32 ) ) this->extract_plane<kvs::Real32>( unstructured_volume );
-        else if ( type == typeid( kvs::Real64 ) ) this->extract_plane<kvs::Real64>( unstructured_volume );
-        else
+        if ( !kvs::DispatchType( unstructured_volume->values().typeID(), PlaneExtractor<kvs::UnstructuredVolumeObject>( this, unstructured_volume ) ) )
         {
             BaseClass::setSuccess( false );
             kvsMessageError("Unsupported data type '%s'.", unstructured_volume->values().typeInfo()->typeName() );
@@ -378,6 +542,7 @@ void SlicePlane::extract_plane(
         default: break;
     }
 }
+
 /*==========================================================================*/
 /**
  *  @brief  Extract a slice plane for a unstructured volume.
@@ -388,125 +553,7 @@ template <typename T>
 void SlicePlane::extract_tetrahedra_plane(
     const kvs::UnstructuredVolumeObject* volume )
 {
-    // Calculated the coordinate data array and the normal vector array.
-    std::vector<kvs::Real32> coords;
-    std::vector<kvs::Real32> normals;
-    std::vector<kvs::UInt8>  colors;
-
-    // Calculate min/max values of the node data.
-    if ( !volume->hasMinMaxValues() )
-    {
-        volume->updateMinMaxValues();
-    }
-
-    // Calculate a normalize factor.
-    const kvs::Real64 min_value( volume->minValue() );
-    const kvs::Real64 max_value( volume->maxValue() );
-    const kvs::Real64 normalize_factor( 255.0 / ( max_value - min_value ) );
-
-    // Refer the parameters of the unstructured volume object.
-    const kvs::Real32* volume_coords      = volume->coords().data();
-    const kvs::UInt32* volume_connections = volume->connections().data();
-    const size_t       ncells             = volume->numberOfCells();
-
-    const kvs::ColorMap& color_map( BaseClass::transferFunction().colorMap() );
-
-    // Extract surfaces.
-    size_t index = 0;
-    size_t local_index[4];
-    for ( kvs::UInt32 cell = 0; cell < ncells; ++cell, index += 4 )
-    {
-        // Calculate the indices of the target cell.
-        local_index[0] = volume_connections[ index ];
-        local_index[1] = volume_connections[ index + 1 ];
-        local_index[2] = volume_connections[ index + 2 ];
-        local_index[3] = volume_connections[ index + 3 ];
-
-        // Calculate the index of the reference table.
-        const size_t table_index = this->calculate_tetrahedra_table_index( local_index );
-        if ( table_index == 0 ) continue;
-        if ( table_index == 15 ) continue;
-
-        // Calculate the triangle polygons.
-        for ( size_t i = 0; MarchingTetrahedraTable::TriangleID[ table_index ][i] != -1; i += 3 )
-        {
-            // Refer the edge IDs from the TriangleTable using the table_index.
-            const int e0 = MarchingTetrahedraTable::TriangleID[table_index][i];
-            const int e1 = MarchingTetrahedraTable::TriangleID[table_index][i+1];
-            const int e2 = MarchingTetrahedraTable::TriangleID[table_index][i+2];
-
-            // Refer indices of the coordinate array from the VertexTable using the edgeIDs.
-            const size_t c0 = local_index[ MarchingTetrahedraTable::VertexID[e0][0] ];
-            const size_t c1 = local_index[ MarchingTetrahedraTable::VertexID[e0][1] ];
-            const size_t c2 = local_index[ MarchingTetrahedraTable::VertexID[e1][0] ];
-            const size_t c3 = local_index[ MarchingTetrahedraTable::VertexID[e1][1] ];
-            const size_t c4 = local_index[ MarchingTetrahedraTable::VertexID[e2][0] ];
-            const size_t c5 = local_index[ MarchingTetrahedraTable::VertexID[e2][1] ];
-
-            // Determine vertices for each edge.
-            const kvs::Vector3f v0( volume_coords + 3 * c0 );
-            const kvs::Vector3f v1( volume_coords + 3 * c1 );
-
-            const kvs::Vector3f v2( volume_coords + 3 * c2 );
-            const kvs::Vector3f v3( volume_coords + 3 * c3 );
-
-            const kvs::Vector3f v4( volume_coords + 3 * c4 );
-            const kvs::Vector3f v5( volume_coords + 3 * c5 );
-
-            // Calculate coordinates of the vertices which are composed
-            // of the triangle polygon.
-            const kvs::Vector3f vertex0( this->interpolate_vertex( v0, v1 ) );
-            coords.push_back( vertex0.x() );
-            coords.push_back( vertex0.y() );
-            coords.push_back( vertex0.z() );
-
-            const kvs::Vector3f vertex1( this->interpolate_vertex( v2, v3 ) );
-            coords.push_back( vertex1.x() );
-            coords.push_back( vertex1.y() );
-            coords.push_back( vertex1.z() );
-
-            const kvs::Vector3f vertex2( this->interpolate_vertex( v4, v5 ) );
-            coords.push_back( vertex2.x() );
-            coords.push_back( vertex2.y() );
-            coords.push_back( vertex2.z() );
-
-            const double value0 = this->interpolate_value<T>( volume, c0, c1 );
-            const double value1 = this->interpolate_value<T>( volume, c2, c3 );
-            const double value2 = this->interpolate_value<T>( volume, c4, c5 );
-
-            const kvs::UInt8 color0 =
-                static_cast<kvs::UInt8>( normalize_factor * ( value0 - min_value ) );
-            colors.push_back( color_map[ color0 ].r() );
-            colors.push_back( color_map[ color0 ].g() );
-            colors.push_back( color_map[ color0 ].b() );
-
-            const kvs::UInt8 color1 =
-                static_cast<kvs::UInt8>( normalize_factor * ( value1 - min_value ) );
-            colors.push_back( color_map[ color1 ].r() );
-            colors.push_back( color_map[ color1 ].g() );
-            colors.push_back( color_map[ color1 ].b() );
-
-            const kvs::UInt8 color2 =
-                static_cast<kvs::UInt8>( normalize_factor * ( value2 - min_value ) );
-            colors.push_back( color_map[ color2 ].r() );
-            colors.push_back( color_map[ color2 ].g() );
-            colors.push_back( color_map[ color2 ].b() );
-
-            // Calculate a normal vector for the triangle polygon.
-            const kvs::Vector3f normal( -( vertex2 - vertex0 ).cross( vertex1 - vertex0 ) );
-            normals.push_back( normal.x() );
-            normals.push_back( normal.y() );
-            normals.push_back( normal.z() );
-        } // end of loop-triangle
-    } // end of loop-cell
-
-    SuperClass::setCoords( kvs::ValueArray<kvs::Real32>( coords ) );
-    SuperClass::setColors( kvs::ValueArray<kvs::UInt8>( colors ) );
-    SuperClass::setNormals( kvs::ValueArray<kvs::Real32>( normals ) );
-    SuperClass::setOpacity( 255 );
-    SuperClass::setPolygonType( kvs::PolygonObject::Triangle );
-    SuperClass::setColorType( kvs::PolygonObject::VertexColor );
-    SuperClass::setNormalType( kvs::PolygonObject::PolygonNormal );
+    this->extract_cell_plane<T, ::TetrahedraTable>( volume );
 }
 
 /*==========================================================================*/
@@ -519,129 +566,7 @@ template <typename T>
 void SlicePlane::extract_hexahedra_plane(
     const kvs::UnstructuredVolumeObject* volume )
 {
-    // Calculated the coordinate data array and the normal vector array.
-    std::vector<kvs::Real32> coords;
-    std::vector<kvs::Real32> normals;
-    std::vector<kvs::UInt8>  colors;
-
-    // Calculate min/max values of the node data.
-    if ( !volume->hasMinMaxValues() )
-    {
-        volume->updateMinMaxValues();
-    }
-
-    // Calculate a normalize factor.
-    const kvs::Real64 min_value( volume->minValue() );
-    const kvs::Real64 max_value( volume->maxValue() );
-    const kvs::Real64 normalize_factor( 255.0 / ( max_value - min_value ) );
-
-    // Refer the parameters of the unstructured volume object.
-    const kvs::Real32* volume_coords      = volume->coords().data();
-    const kvs::UInt32* volume_connections = volume->connections().data();
-    const size_t       ncells             = volume->numberOfCells();
-
-    const kvs::ColorMap& color_map( BaseClass::transferFunction().colorMap() );
-
-    // Extract surfaces.
-    size_t index = 0;
-    size_t local_index[8];
-    for ( kvs::UInt32 cell = 0; cell < ncells; ++cell, index += 8 )
-    {
-        // Calculate the indices of the target cell.
-        local_index[4] = volume_connections[ index ];
-        local_index[5] = volume_connections[ index + 1 ];
-        local_index[6] = volume_connections[ index + 2 ];
-        local_index[7] = volume_connections[ index + 3 ];
-        local_index[0] = volume_connections[ index + 4 ];
-        local_index[1] = volume_connections[ index + 5 ];
-        local_index[2] = volume_connections[ index + 6 ];
-        local_index[3] = volume_connections[ index + 7 ];
-
-        // Calculate the index of the reference table.
-        const size_t table_index = this->calculate_hexahedra_table_index( local_index );
-        if ( table_index == 0 ) continue;
-        if ( table_index == 255 ) continue;
-
-        // Calculate the triangle polygons.
-        for ( size_t i = 0; MarchingHexahedraTable::TriangleID[ table_index ][i] != -1; i += 3 )
-        {
-            // Refer the edge IDs from the TriangleTable using the table_index.
-            const int e0 = MarchingHexahedraTable::TriangleID[table_index][i];
-            const int e1 = MarchingHexahedraTable::TriangleID[table_index][i+1];
-            const int e2 = MarchingHexahedraTable::TriangleID[table_index][i+2];
-
-            // Refer indices of the coordinate array from the VertexTable using the edgeIDs.
-            const size_t c0 = local_index[ MarchingHexahedraTable::VertexID[e0][0] ];
-            const size_t c1 = local_index[ MarchingHexahedraTable::VertexID[e0][1] ];
-            const size_t c2 = local_index[ MarchingHexahedraTable::VertexID[e1][0] ];
-            const size_t c3 = local_index[ MarchingHexahedraTable::VertexID[e1][1] ];
-            const size_t c4 = local_index[ MarchingHexahedraTable::VertexID[e2][0] ];
-            const size_t c5 = local_index[ MarchingHexahedraTable::VertexID[e2][1] ];
-
-            // Determine vertices for each edge.
-            const kvs::Vector3f v0( volume_coords + 3 * c0 );
-            const kvs::Vector3f v1( volume_coords + 3 * c1 );
-
-            const kvs::Vector3f v2( volume_coords + 3 * c2 );
-            const kvs::Vector3f v3( volume_coords + 3 * c3 );
-
-            const kvs::Vector3f v4( volume_coords + 3 * c4 );
-            const kvs::Vector3f v5( volume_coords + 3 * c5 );
-
-            // Calculate coordinates of the vertices which are composed
-            // of the triangle polygon.
-            const kvs::Vector3f vertex0( this->interpolate_vertex( v0, v1 ) );
-            coords.push_back( vertex0.x() );
-            coords.push_back( vertex0.y() );
-            coords.push_back( vertex0.z() );
-
-            const kvs::Vector3f vertex1( this->interpolate_vertex( v2, v3 ) );
-            coords.push_back( vertex1.x() );
-            coords.push_back( vertex1.y() );
-            coords.push_back( vertex1.z() );
-
-            const kvs::Vector3f vertex2( this->interpolate_vertex( v4, v5 ) );
-            coords.push_back( vertex2.x() );
-            coords.push_back( vertex2.y() );
-            coords.push_back( vertex2.z() );
-
-            const double value0 = this->interpolate_value<T>( volume, c0, c1 );
-            const double value1 = this->interpolate_value<T>( volume, c2, c3 );
-            const double value2 = this->interpolate_value<T>( volume, c4, c5 );
-
-            const kvs::UInt8 color0 =
-                static_cast<kvs::UInt8>( normalize_factor * ( value0 - min_value ) );
-            colors.push_back( color_map[ color0 ].r() );
-            colors.push_back( color_map[ color0 ].g() );
-            colors.push_back( color_map[ color0 ].b() );
-
-            const kvs::UInt8 color1 =
-                static_cast<kvs::UInt8>( normalize_factor * ( value1 - min_value ) );
-            colors.push_back( color_map[ color1 ].r() );
-            colors.push_back( color_map[ color1 ].g() );
-            colors.push_back( color_map[ color1 ].b() );
-
-            const kvs::UInt8 color2 =
-                static_cast<kvs::UInt8>( normalize_factor * ( value2 - min_value ) );
-            colors.push_back( color_map[ color2 ].r() );
-            colors.push_back( color_map[ color2 ].g() );
-            colors.push_back( color_map[ color2 ].b() );
-
-            // Calculate a normal vector for the triangle polygon.
-            const kvs::Vector3f normal( -( vertex2 - vertex0 ).cross( vertex1 - vertex0 ) );
-            normals.push_back( normal.x() );
-            normals.push_back( normal.y() );
-            normals.push_back( normal.z() );
-        } // end of loop-triangle
-    } // end of loop-cell
-
-    SuperClass::setCoords( kvs::ValueArray<kvs::Real32>( coords ) );
-    SuperClass::setColors( kvs::ValueArray<kvs::UInt8>( colors ) );
-    SuperClass::setNormals( kvs::ValueArray<kvs::Real32>( normals ) );
-    SuperClass::setOpacity( 255 );
-    SuperClass::setPolygonType( kvs::PolygonObject::Triangle );
-    SuperClass::setColorType( kvs::PolygonObject::VertexColor );
-    SuperClass::setNormalType( kvs::PolygonObject::PolygonNormal );
+    this->extract_cell_plane<T, ::HexahedraTable>( volume );
 }
 
 /*==========================================================================*/
@@ -654,129 +579,9 @@ template <typename T>
 void SlicePlane::extract_pyramid_plane(
     const kvs::UnstructuredVolumeObject* volume )
 {
-    // Calculated the coordinate data array and the normal vector array.
-    std::vector<kvs::Real32> coords;
-    std::vector<kvs::Real32> normals;
-    std::vector<kvs::UInt8>  colors;
-
-    // Calculate min/max values of the node data.
-    if ( !volume->hasMinMaxValues() )
-    {
-        volume->updateMinMaxValues();
-    }
-
-    // Calculate a normalize factor.
-    const kvs::Real64 min_value( volume->minValue() );
-    const kvs::Real64 max_value( volume->maxValue() );
-    const kvs::Real64 normalize_factor( 255.0 / ( max_value - min_value ) );
-
-    // Refer the parameters of the unstructured volume object.
-    const kvs::Real32* volume_coords      = volume->coords().data();
-    const kvs::UInt32* volume_connections = volume->connections().data();
-    const size_t       ncells             = volume->numberOfCells();
-
-    const kvs::ColorMap& color_map( BaseClass::transferFunction().colorMap() );
-
-    // Extract surfaces.
-    size_t index = 0;
-    size_t local_index[5];
-    for ( kvs::UInt32 cell = 0; cell < ncells; ++cell, index += 5 )
-    {
-        // Calculate the indices of the target cell.
-        local_index[0] = volume_connections[ index ];
-        local_index[1] = volume_connections[ index + 1 ];
-        local_index[2] = volume_connections[ index + 2 ];
-        local_index[3] = volume_connections[ index + 3 ];
-        local_index[4] = volume_connections[ index + 4 ];
-
-        // Calculate the index of the reference table.
-        const size_t table_index = this->calculate_pyramid_table_index( local_index );
-        if ( table_index == 0 ) continue;
-        if ( table_index == 31 ) continue;
-
-        // Calculate the triangle polygons.
-        for ( size_t i = 0; MarchingPyramidTable::TriangleID[ table_index ][i] != -1; i += 3 )
-        {
-            // Refer the edge IDs from the TriangleTable using the table_index.
-            const int e0 = MarchingPyramidTable::TriangleID[table_index][i];
-            const int e1 = MarchingPyramidTable::TriangleID[table_index][i+1];
-            const int e2 = MarchingPyramidTable::TriangleID[table_index][i+2];
-
-            // Refer indices of the coordinate array from the VertexTable using the edgeIDs.
-            const size_t c0 = local_index[ MarchingPyramidTable::VertexID[e0][0] ];
-            const size_t c1 = local_index[ MarchingPyramidTable::VertexID[e0][1] ];
-            const size_t c2 = local_index[ MarchingPyramidTable::VertexID[e1][0] ];
-            const size_t c3 = local_index[ MarchingPyramidTable::VertexID[e1][1] ];
-            const size_t c4 = local_index[ MarchingPyramidTable::VertexID[e2][0] ];
-            const size_t c5 = local_index[ MarchingPyramidTable::VertexID[e2][1] ];
-
-            // Determine vertices for each edge.
-            const kvs::Vector3f v0( volume_coords + 3 * c0 );
-            const kvs::Vector3f v1( volume_coords + 3 * c1 );
-
-            const kvs::Vector3f v2( volume_coords + 3 * c2 );
-            const kvs::Vector3f v3( volume_coords + 3 * c3 );
-
-            const kvs::Vector3f v4( volume_coords + 3 * c4 );
-            const kvs::Vector3f v5( volume_coords + 3 * c5 );
-
-            // Calculate coordinates of the vertices which are composed
-            // of the triangle polygon.
-            const kvs::Vector3f vertex0( this->interpolate_vertex( v0, v1 ) );
-            coords.push_back( vertex0.x() );
-            coords.push_back( vertex0.y() );
-            coords.push_back( vertex0.z() );
-
-            const kvs::Vector3f vertex1( this->interpolate_vertex( v2, v3 ) );
-            coords.push_back( vertex1.x() );
-            coords.push_back( vertex1.y() );
-            coords.push_back( vertex1.z() );
-
-            const kvs::Vector3f vertex2( this->interpolate_vertex( v4, v5 ) );
-            coords.push_back( vertex2.x() );
-            coords.push_back( vertex2.y() );
-            coords.push_back( vertex2.z() );
-
-            const double value0 = this->interpolate_value<T>( volume, c0, c1 );
-            const double value1 = this->interpolate_value<T>( volume, c2, c3 );
-            const double value2 = this->interpolate_value<T>( volume, c4, c5 );
-
-            const kvs::UInt8 color0 =
-                static_cast<kvs::UInt8>( normalize_factor * ( value0 - min_value ) );
-            colors.push_back( color_map[ color0 ].r() );
-            colors.push_back( color_map[ color0 ].g() );
-            colors.push_back( color_map[ color0 ].b() );
-
-            const kvs::UInt8 color1 =
-                static_cast<kvs::UInt8>( normalize_factor * ( value1 - min_value ) );
-            colors.push_back( color_map[ color1 ].r() );
-            colors.push_back( color_map[ color1 ].g() );
-            colors.push_back( color_map[ color1 ].b() );
-
-            const kvs::UInt8 color2 =
-                static_cast<kvs::UInt8>( normalize_factor * ( value2 - min_value ) );
-            colors.push_back( color_map[ color2 ].r() );
-            colors.push_back( color_map[ color2 ].g() );
-            colors.push_back( color_map[ color2 ].b() );
-
-            // Calculate a normal vector for the triangle polygon.
-            const kvs::Vector3f normal( -( vertex2 - vertex0 ).cross( vertex1 - vertex0 ) );
-            normals.push_back( normal.x() );
-            normals.push_back( normal.y() );
-            normals.push_back( normal.z() );
-        } // end of loop-triangle
-    } // end of loop-cell
-
-    SuperClass::setCoords( kvs::ValueArray<kvs::Real32>( coords ) );
-    SuperClass::setColors( kvs::ValueArray<kvs::UInt8>( colors ) );
-    SuperClass::setNormals( kvs::ValueArray<kvs::Real32>( normals ) );
-    SuperClass::setOpacity( 255 );
-    SuperClass::setPolygonType( kvs::PolygonObject::Triangle );
-    SuperClass::setColorType( kvs::PolygonObject::VertexColor );
-    SuperClass::setNormalType( kvs::PolygonObject::PolygonNormal );
+    this->extract_cell_plane<T, ::PyramidTable>( volume );
 }
 
-
 /*==========================================================================*/
 /**
  *  @brief  Extract a slice plane for a unstructured volume.
@@ -787,11 +592,25 @@ template <typename T>
 void SlicePlane::extract_prism_plane(
     const kvs::UnstructuredVolumeObject* volume )
 {
-    // Calculated the coordinate data array and the normal vector array.
-    std::vector<kvs::Real32> coords;
-    std::vector<kvs::Real32> normals;
-    std::vector<kvs::UInt8>  colors;
+    this->extract_cell_plane<T, ::PrismTable>( volume );
+}
 
+/*==========================================================================*/
+/**
+ *  @brief  Extract a slice plane for a unstructured volume in parallel.
+ *  @param  volume [in] pointer to the unstructured volume object
+ *
+ *  The candidate cells (all cells, or the cells in the span bucket of the
+ *  plane) are split into one chunk per thread. The first pass classifies
+ *  the cells and counts the triangles of each chunk, and the second pass
+ *  writes the triangles of each chunk at its prefix-sum offset, so that
+ *  the output is in the same order as the serial extraction.
+ */
+/*==========================================================================*/
+template <typename T, typename CellTable>
+void SlicePlane::extract_cell_plane(
+    const kvs::UnstructuredVolumeObject* volume )
+{
     // Calculate min/max values of the node data.
     if ( !volume->hasMinMaxValues() )
     {
@@ -806,110 +625,162 @@ void SlicePlane::extract_prism_plane(
     // Refer the parameters of the unstructured volume object.
     const kvs::Real32* volume_coords      = volume->coords().data();
     const kvs::UInt32* volume_connections = volume->connections().data();
-    const size_t       ncells             = volume->numberOfCells();
+    const size_t       nnodes             = CellTable::NumberOfNodes;
+    const size_t       full_index         = ( size_t(1) << nnodes ) - 1;
 
     const kvs::ColorMap& color_map( BaseClass::transferFunction().colorMap() );
 
-    // Extract surfaces.
-    size_t index = 0;
-    size_t local_index[6];
-    for ( kvs::UInt32 cell = 0; cell < ncells; ++cell, index += 6 )
+    // Select the candidate cells.
+    const kvs::UInt32* candidates = NULL;
+    size_t ncandidates = volume->numberOfCells();
+    this->select_span_cells( volume, &candidates, &ncandidates );
+
+    const size_t nthreads = static_cast<size_t>( kvs::Math::Max( kvs::OpenMP::GetMaxThreads(), 1 ) );
+    std::vector<size_t> bounds( nthreads + 1 );
+    for ( size_t t = 0; t <= nthreads; t++ ) { bounds[t] = ncandidates * t / nthreads; }
+
+    // Classify the cells and count the triangles of each chunk.
+    std::vector<size_t> offsets( nthreads + 1, 0 );
+    kvs::ValueArray<kvs::UInt8> table_indices( ncandidates );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t t = 0; t < nthreads; t++ )
     {
-        // Calculate the indices of the target cell.
-        local_index[0] = volume_connections[ index + 0 ];
-        local_index[1] = volume_connections[ index + 1 ];
-        local_index[2] = volume_connections[ index + 2 ];
-        local_index[3] = volume_connections[ index + 3 ];
-        local_index[4] = volume_connections[ index + 4 ];
-        local_index[5] = volume_connections[ index + 5 ];
-
-        // Calculate the index of the reference table.
-        const size_t table_index = this->calculate_prism_table_index( local_index );
-        if ( table_index == 0 ) continue;
-        if ( table_index == 63 ) continue;
-
-        // Calculate the triangle polygons.
-        for ( size_t i = 0; MarchingPrismTable::TriangleID[ table_index ][i] != -1; i += 3 )
+        size_t local_index[ CellTable::NumberOfNodes ];
+        size_t ntriangles = 0;
+        for ( size_t i = bounds[t]; i < bounds[t+1]; i++ )
         {
-            // Refer the edge IDs from the TriangleTable using the table_index.
-            const int e0 = MarchingPrismTable::TriangleID[table_index][i+0];
-            const int e1 = MarchingPrismTable::TriangleID[table_index][i+1];
-            const int e2 = MarchingPrismTable::TriangleID[table_index][i+2];
-
-            // Refer indices of the coordinate array from the VertexTable using the edgeIDs.
-            const size_t c0 = local_index[ MarchingPrismTable::VertexID[e0][0] ];
-            const size_t c1 = local_index[ MarchingPrismTable::VertexID[e0][1] ];
-            const size_t c2 = local_index[ MarchingPrismTable::VertexID[e1][0] ];
-            const size_t c3 = local_index[ MarchingPrismTable::VertexID[e1][1] ];
-            const size_t c4 = local_index[ MarchingPrismTable::VertexID[e2][0] ];
-            const size_t c5 = local_index[ MarchingPrismTable::VertexID[e2][1] ];
-
-            // Determine vertices for each edge.
-            const kvs::Vec3 v0( volume_coords + 3 * c0 );
-            const kvs::Vec3 v1( volume_coords + 3 * c1 );
-
-            const kvs::Vec3 v2( volume_coords + 3 * c2 );
-            const kvs::Vec3 v3( volume_coords + 3 * c3 );
-
-            const kvs::Vec3 v4( volume_coords + 3 * c4 );
-            const kvs::Vec3 v5( volume_coords + 3 * c5 );
-
-            // Calculate coordinates of the vertices which are composed
-            // of the triangle polygon.
-            const kvs::Vec3 vertex0( this->interpolate_vertex( v0, v1 ) );
-            coords.push_back( vertex0.x() );
-            coords.push_back( vertex0.y() );
-            coords.push_back( vertex0.z() );
-
-            const kvs::Vec3 vertex1( this->interpolate_vertex( v2, v3 ) );
-            coords.push_back( vertex1.x() );
-            coords.push_back( vertex1.y() );
-            coords.push_back( vertex1.z() );
-
-            const kvs::Vec3 vertex2( this->interpolate_vertex( v4, v5 ) );
-            coords.push_back( vertex2.x() );
-            coords.push_back( vertex2.y() );
-            coords.push_back( vertex2.z() );
-
-            const double value0 = this->interpolate_value<T>( volume, c0, c1 );
-            const double value1 = this->interpolate_value<T>( volume, c2, c3 );
-            const double value2 = this->interpolate_value<T>( volume, c4, c5 );
-
-            const kvs::UInt8 color0 =
-                static_cast<kvs::UInt8>( normalize_factor * ( value0 - min_value ) );
-            colors.push_back( color_map[ color0 ].r() );
-            colors.push_back( color_map[ color0 ].g() );
-            colors.push_back( color_map[ color0 ].b() );
-
-            const kvs::UInt8 color1 =
-                static_cast<kvs::UInt8>( normalize_factor * ( value1 - min_value ) );
-            colors.push_back( color_map[ color1 ].r() );
-            colors.push_back( color_map[ color1 ].g() );
-            colors.push_back( color_map[ color1 ].b() );
-
-            const kvs::UInt8 color2 =
-                static_cast<kvs::UInt8>( normalize_factor * ( value2 - min_value ) );
-            colors.push_back( color_map[ color2 ].r() );
-            colors.push_back( color_map[ color2 ].g() );
-            colors.push_back( color_map[ color2 ].b() );
-
-            // Calculate a normal vector for the triangle polygon.
-            const kvs::Vec3 normal( -( vertex2 - vertex0 ).cross( vertex1 - vertex0 ) );
-            normals.push_back( normal.x() );
-            normals.push_back( normal.y() );
-            normals.push_back( normal.z() );
-        } // end of loop-triangle
-    } // end of loop-cell
+            const size_t cell = candidates ? candidates[i] : i;
+            CellTable::Bind( volume_connections + cell * nnodes, local_index );
 
-    SuperClass::setCoords( kvs::ValueArray<kvs::Real32>( coords ) );
-    SuperClass::setColors( kvs::ValueArray<kvs::UInt8>( colors ) );
-    SuperClass::setNormals( kvs::ValueArray<kvs::Real32>( normals ) );
+            size_t table_index = 0;
+            for ( size_t j = 0; j < nnodes; j++ )
+            {
+                const kvs::Vec3 vertex( volume_coords + 3 * local_index[j] );
+                if ( this->substitute_plane_equation( vertex ) > 0.0f ) { table_index |= size_t(1) << j; }
+            }
+
+            table_indices[i] = static_cast<kvs::UInt8>( table_index );
+            if ( table_index == 0 || table_index == full_index ) continue;
+            ntriangles += CellTable::NumberOfTriangles( table_index );
+        }
+        offsets[ t + 1 ] = ntriangles;
+    }
+    for ( size_t t = 0; t < nthreads; t++ ) { offsets[ t + 1 ] += offsets[t]; }
+
+    const size_t ntriangles = offsets[ nthreads ];
+    kvs::ValueArray<kvs::Real32> coords( ntriangles * 9 );
+    kvs::ValueArray<kvs::UInt8> colors( ntriangles * 9 );
+    kvs::ValueArray<kvs::Real32> normals( ntriangles * 3 );
+
+    // Extract the triangles of each chunk.
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t t = 0; t < nthreads; t++ )
+    {
+        size_t local_index[ CellTable::NumberOfNodes ];
+        size_t triangle = offsets[t];
+        for ( size_t i = bounds[t]; i < bounds[t+1]; i++ )
+        {
+            const size_t table_index = table_indices[i];
+            if ( table_index == 0 || table_index == full_index ) continue;
+
+            const size_t cell = candidates ? candidates[i] : i;
+            CellTable::Bind( volume_connections + cell * nnodes, local_index );
+
+            const int* triangle_id = CellTable::TriangleID( table_index );
+            for ( size_t k = 0; triangle_id[k] != -1; k += 3, triangle++ )
+            {
+                kvs::Real32* coord = coords.data() + triangle * 9;
+                kvs::UInt8* color = colors.data() + triangle * 9;
+                kvs::Vec3 vertex[3];
+                for ( size_t l = 0; l < 3; l++ )
+                {
+                    // Refer indices of the coordinate array from the VertexTable using the edge ID.
+                    const int* vertex_id = CellTable::VertexID( triangle_id[ k + l ] );
+                    const size_t c0 = local_index[ vertex_id[0] ];
+                    const size_t c1 = local_index[ vertex_id[1] ];
+
+                    const kvs::Vec3 v0( volume_coords + 3 * c0 );
+                    const kvs::Vec3 v1( volume_coords + 3 * c1 );
+                    vertex[l] = this->interpolate_vertex( v0, v1 );
+                    coord[ 3 * l + 0 ] = vertex[l].x();
+                    coord[ 3 * l + 1 ] = vertex[l].y();
+                    coord[ 3 * l + 2 ] = vertex[l].z();
+
+                    const double value = this->interpolate_value<T>( volume, c0, c1 );
+                    const kvs::UInt8 index =
+                        static_cast<kvs::UInt8>( normalize_factor * ( value - min_value ) );
+                    const kvs::RGBColor rgb = color_map[ index ];
+                    color[ 3 * l + 0 ] = rgb.r();
+                    color[ 3 * l + 1 ] = rgb.g();
+                    color[ 3 * l + 2 ] = rgb.b();
+                }
+
+                // Calculate a normal vector for the triangle polygon.
+                const kvs::Vec3 normal( -( vertex[2] - vertex[0] ).cross( vertex[1] - vertex[0] ) );
+                kvs::Real32* n = normals.data() + triangle * 3;
+                n[0] = normal.x();
+                n[1] = normal.y();
+                n[2] = normal.z();
+            }
+        }
+    }
+
+    SuperClass::setCoords( coords );
+    SuperClass::setColors( colors );
+    SuperClass::setNormals( normals );
     SuperClass::setOpacity( 255 );
     SuperClass::setPolygonType( kvs::PolygonObject::Triangle );
     SuperClass::setColorType( kvs::PolygonObject::VertexColor );
     SuperClass::setNormalType( kvs::PolygonObject::PolygonNormal );
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Selects the cells in the span bucket of the current plane.
+ *  @param  volume [in] pointer to the unstructured volume object
+ *  @param  cells [out] pointer to the selected cell indices (NULL for all cells)
+ *  @param  ncells [out] number of the selected cells
+ */
+/*===========================================================================*/
+void SlicePlane::select_span_cells(
+    const kvs::UnstructuredVolumeObject* volume,
+    const kvs::UInt32** cells,
+    size_t* ncells ) const
+{
+    *cells = NULL;
+    *ncells = volume->numberOfCells();
+
+    if ( !this->hasSpanIndex() ) return;
+    // The index is usable only for the volume which it has been built for.
+    // The arrays are referenced by the index, so that their data is not
+    // reallocated at the same addresses while the index is kept.
+    if ( volume->coords().data() != m_span_coords.data() ) return;
+    if ( volume->connections().data() != m_span_connections.data() ) return;
+    if ( volume->connections().size() != m_span_connections.size() ) return;
+
+    // The index is usable only for the planes parallel to its normal.
+    const kvs::Vec3 normal( m_coefficients.x(), m_coefficients.y(), m_coefficients.z() );
+    const float length = normal.length();
+    if ( kvs::Math::IsZero( length ) ) return;
+
+    const float cosine = normal.dot( m_span_normal ) / length;
+    if ( kvs::Math::Abs( cosine ) < 1.0f - 1.0e-6f ) return;
+
+    // Signed distance of the plane along the index normal.
+    const float distance = -m_coefficients.w() / ( length * cosine );
+    const float bucket = std::floor( ( distance - m_span_min ) / m_span_width );
+    const size_t nbuckets = m_span_offsets.size() - 1;
+    if ( !( bucket >= 0.0f && bucket < static_cast<float>( nbuckets ) ) )
+    {
+        *ncells = 0;
+        return;
+    }
+
+    const size_t b = static_cast<size_t>( bucket );
+    *cells = m_span_cells.data() + m_span_offsets[b];
+    *ncells = m_span_offsets[ b + 1 ] - m_span_offsets[b];
+}
+
 /*===========================================================================*/
 /**
  *  @brief  Calculate a table index.
@@ -938,125 +809,6 @@ size_t SlicePlane::calculate_table_index(
 }
 
 
-/*==========================================================================*/
-/**
- *  @brief  Caluclate a table index.
- *  @param  local_index [in] indices of a target cell
- *  @return table index
- */
-/*==========================================================================*/
-size_t SlicePlane::calculate_tetrahedra_table_index(
-    const size_t* local_index ) const
-{
-    const kvs::Real32* const coords = BaseClass::volume()->coords().data();
-
-    const kvs::Vector3f vertex0( coords + 3 * local_index[0] );
-    const kvs::Vector3f vertex1( coords + 3 * local_index[1] );
-    const kvs::Vector3f vertex2( coords + 3 * local_index[2] );
-    const kvs::Vector3f vertex3( coords + 3 * local_index[3] );
-
-    size_t table_index = 0;
-    if ( this->substitute_plane_equation( vertex0 ) > 0.0 ) { table_index |= 1; }
-    if ( this->substitute_plane_equation( vertex1 ) > 0.0 ) { table_index |= 2; }
-    if ( this->substitute_plane_equation( vertex2 ) > 0.0 ) { table_index |= 4; }
-    if ( this->substitute_plane_equation( vertex3 ) > 0.0 ) { table_index |= 8; }
-
-    return table_index;
-}
-
-/*==========================================================================*/
-/**
- *  @brief  Caluclate a table index.
- *  @param  local_index [in] indices of a target cell
- *  @return table index
- */
-/*==========================================================================*/
-size_t SlicePlane::calculate_hexahedra_table_index(
-    const size_t* local_index ) const
-{
-    const kvs::Real32* const coords = BaseClass::volume()->coords().data();
-
-    const kvs::Vector3f vertex0( coords + 3 * local_index[0] );
-    const kvs::Vector3f vertex1( coords + 3 * local_index[1] );
-    const kvs::Vector3f vertex2( coords + 3 * local_index[2] );
-    const kvs::Vector3f vertex3( coords + 3 * local_index[3] );
-    const kvs::Vector3f vertex4( coords + 3 * local_index[4] );
-    const kvs::Vector3f vertex5( coords + 3 * local_index[5] );
-    const kvs::Vector3f vertex6( coords + 3 * local_index[6] );
-    const kvs::Vector3f vertex7( coords + 3 * local_index[7] );
-
-    size_t table_index = 0;
-    if ( this->substitute_plane_equation( vertex0 ) > 0.0 ) { table_index |=   1; }
-    if ( this->substitute_plane_equation( vertex1 ) > 0.0 ) { table_index |=   2; }
-    if ( this->substitute_plane_equation( vertex2 ) > 0.0 ) { table_index |=   4; }
-    if ( this->substitute_plane_equation( vertex3 ) > 0.0 ) { table_index |=   8; }
-    if ( this->substitute_plane_equation( vertex4 ) > 0.0 ) { table_index |=  16; }
-    if ( this->substitute_plane_equation( vertex5 ) > 0.0 ) { table_index |=  32; }
-    if ( this->substitute_plane_equation( vertex6 ) > 0.0 ) { table_index |=  64; }
-    if ( this->substitute_plane_equation( vertex7 ) > 0.0 ) { table_index |= 128; }
-
-    return table_index;
-}
-
-/*==========================================================================*/
-/**
- *  @brief  Caluclate a table index.
- *  @param  local_index [in] indices of a target cell
- *  @return table index
- */
-/*==========================================================================*/
-size_t SlicePlane::calculate_pyramid_table_index(
-    const size_t* local_index ) const
-{
-    const kvs::Real32* const coords = BaseClass::volume()->coords().data();
-
-    const kvs::Vector3f vertex0( coords + 3 * local_index[0] );
-    const kvs::Vector3f vertex1( coords + 3 * local_index[1] );
-    const kvs::Vector3f vertex2( coords + 3 * local_index[2] );
-    const kvs::Vector3f vertex3( coords + 3 * local_index[3] );
-    const kvs::Vector3f vertex4( coords + 3 * local_index[4] );
-
-    size_t table_index = 0;
-    if ( this->substitute_plane_equation( vertex0 ) > 0.0 ) { table_index |=  1; }
-    if ( this->substitute_plane_equation( vertex1 ) > 0.0 ) { table_index |=  2; }
-    if ( this->substitute_plane_equation( vertex2 ) > 0.0 ) { table_index |=  4; }
-    if ( this->substitute_plane_equation( vertex3 ) > 0.0 ) { table_index |=  8; }
-    if ( this->substitute_plane_equation( vertex4 ) > 0.0 ) { table_index |= 16; }
-
-    return table_index;
-}
-
-
-/*==========================================================================*/
-/**
- *  @brief  Caluclate a table index.
- *  @param  local_index [in] indices of a target cell
- *  @return table index
- */
-/*==========================================================================*/
-size_t SlicePlane::calculate_prism_table_index(
-    const size_t* local_index ) const
-{
-    const kvs::Real32* const coords = BaseClass::volume()->coords().data();
-
-    const kvs::Vec3 vertex0( coords + 3 * local_index[0] );
-    const kvs::Vec3 vertex1( coords + 3 * local_index[1] );
-    const kvs::Vec3 vertex2( coords + 3 * local_index[2] );
-    const kvs::Vec3 vertex3( coords + 3 * local_index[3] );
-    const kvs::Vec3 vertex4( coords + 3 * local_index[4] );
-    const kvs::Vec3 vertex5( coords + 3 * local_index[5] );
-
-    size_t table_index = 0;
-    if ( this->substitute_plane_equation( vertex0 ) > 0.0 ) { table_index |=  1; }
-    if ( this->substitute_plane_equation( vertex1 ) > 0.0 ) { table_index |=  2; }
-    if ( this->substitute_plane_equation( vertex2 ) > 0.0 ) { table_index |=  4; }
-    if ( this->substitute_plane_equation( vertex3 ) > 0.0 ) { table_index |=  8; }
-    if ( this->substitute_plane_equation( vertex4 ) > 0.0 ) { table_index |= 16; }
-    if ( this->substitute_plane_equation( vertex5 ) > 0.0 ) { table_index |= 32; }
-
-    return table_index;
-}
-
 /*==========================================================================*/
 /**
  *  @brief  Calculate a plane equation.
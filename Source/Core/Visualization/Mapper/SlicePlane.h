@@ -42,6 +42,13 @@ class SlicePlane : public kvs::MapperBase, public kvs::PolygonObject
 private:
 
     kvs::Vec4 m_coefficients; ///< coeficients of a slice plane
+    kvs::Vec3 m_span_normal; ///< normal vector of the span index
+    kvs::ValueArray<kvs::Real32> m_span_coords; ///< coordinates of the volume of the span index (shared)
+    kvs::ValueArray<kvs::UInt32> m_span_connections; ///< connections of the volume of the span index (shared)
+    kvs::Real32 m_span_min; ///< min. distance of the cells along the span normal
+    kvs::Real32 m_span_width; ///< width of the span buckets
+    kvs::ValueArray<kvs::UInt32> m_span_offsets; ///< offsets to the cells of each span bucket
+    kvs::ValueArray<kvs::UInt32> m_span_cells; ///< cells overlapping each span bucket
 
 public:
 
@@ -60,10 +67,15 @@ public:
     void setPlane( const kvs::Vec4& coefficients );
     void setPlane( const kvs::Vec3& point, const kvs::Vec3& normal );
 
+    void buildSpanIndex( const kvs::UnstructuredVolumeObject* volume, const kvs::Vec3& normal );
+    void clearSpanIndex();
+    bool hasSpanIndex() const { return m_span_offsets.size() > 0; }
+
     SuperClass* exec( const kvs::ObjectBase* object );
 
 protected:
 
+    template <typename VolumeObject> struct PlaneExtractor;
     void mapping( const kvs::VolumeObjectBase* volume );
     template <typename T> void extract_plane( const kvs::StructuredVolumeObject* volume );
     template <typename T> void extract_plane( const kvs::UnstructuredVolumeObject* volume );
@@ -71,11 +83,9 @@ protected:
     template <typename T> void extract_hexahedra_plane( const kvs::UnstructuredVolumeObject* volume );
     template <typename T> void extract_pyramid_plane( const kvs::UnstructuredVolumeObject* volume );
     template <typename T> void extract_prism_plane( const kvs::UnstructuredVolumeObject* volume );
+    template <typename T, typename CellTable> void extract_cell_plane( const kvs::UnstructuredVolumeObject* volume );
+    void select_span_cells( const kvs::UnstructuredVolumeObject* volume, const kvs::UInt32** cells, size_t* ncells ) const;
     size_t calculate_table_index( const size_t x, const size_t y, const size_t z ) const;
-    size_t calculate_tetrahedra_table_index( const size_t* local_index ) const;
-    size_t calculate_hexahedra_table_index( const size_t* local_index ) const;
-    size_t calculate_pyramid_table_index( const size_t* local_index ) const;
-    size_t calculate_prism_table_index( const size_t* local_index ) const;
     float substitute_plane_equation( const size_t x, const size_t y, const size_t z ) const;
     float substitute_plane_equation( const kvs::Vec3& vertex ) const;
     const kvs::Vec3 interpolate_vertex( const kvs::Vec3& vertex0, const kvs::Vec3& vertex1 ) const;
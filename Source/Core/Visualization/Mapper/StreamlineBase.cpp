@@ -65,7 +65,7 @@ void StreamlineBase::setSeedPoints( const kvs::PointObject* seed_points )
 void StreamlineBase::mapping( Integrator* integrator )
 {
     std::vector<kvs::Real32> coords;
-    std::vector<kvs::UInt8> colors;
+    std::vector<kvs::Real32> magnitudes;
     std::vector<kvs::UInt32> connections;
 
     for ( size_t i = 0; i < m_seed_points->numberOfVertices(); i++ )
@@ -76,13 +76,10 @@ void StreamlineBase::mapping( Integrator* integrator )
         kvs::Vec3 value = integrator->value( point );
         if ( this->isTerminatedByVectorLength( value ) ) { continue; }
 
-        kvs::RGBColor color = this->interpolatedColor( value );
         coords.push_back( point.x() );
         coords.push_back( point.y() );
         coords.push_back( point.z() );
-        colors.push_back( color.r() );
-        colors.push_back( color.g() );
-        colors.push_back( color.b() );
+        magnitudes.push_back( value.length() );
 
         const size_t id0 = coords.size() / 3 - 1;
         for ( size_t j = 0; !this->isTerminatedByIntegrationTimes(j); j++ )
@@ -93,13 +90,10 @@ void StreamlineBase::mapping( Integrator* integrator )
             value = integrator->value( point );
             if ( this->isTerminatedByVectorLength( value ) ) { break; }
 
-            color = this->interpolatedColor( value );
             coords.push_back( point.x() );
             coords.push_back( point.y() );
             coords.push_back( point.z() );
-            colors.push_back( color.r() );
-            colors.push_back( color.g() );
-            colors.push_back( color.b() );
+            magnitudes.push_back( value.length() );
         }
         const size_t id1 = coords.size() / 3 - 1;
 
@@ -110,19 +104,19 @@ void StreamlineBase::mapping( Integrator* integrator )
         }
     }
 
+    // The colors are mapped from the vector lengths at once.
+    const kvs::ColorMap& color_map = BaseClass::transferFunction().colorMap();
+    kvs::ValueArray<kvs::UInt8> colors( magnitudes.size() * 3 );
+    if ( !magnitudes.empty() ) { color_map.mapColors( &magnitudes[0], magnitudes.size(), colors.data() ); }
+
     SuperClass::setLineType( kvs::LineObject::Polyline );
     SuperClass::setColorType( kvs::LineObject::VertexColor );
     SuperClass::setCoords( kvs::ValueArray<kvs::Real32>( coords ) );
     SuperClass::setConnections( kvs::ValueArray<kvs::UInt32>( connections ) );
-    SuperClass::setColors( kvs::ValueArray<kvs::UInt8>( colors ) );
+    SuperClass::setColors( colors );
     SuperClass::setSize( 1.0f );
 }
 
-kvs::RGBColor StreamlineBase::interpolatedColor( const kvs::Vec3& value )
-{
-    return BaseClass::transferFunction().colorMap().at( value.length() );
-}
-
 bool StreamlineBase::isTerminatedByVectorLength( const kvs::Vec3& vector )
 {
     if ( m_enable_vector_length_condition )
@@ -118,7 +118,6 @@ public:
 protected:
 
     void mapping( Integrator* integrator );
-    kvs::RGBColor interpolatedColor( const kvs::Vec3& value );
     bool isTerminatedByVectorLength( const kvs::Vec3& vector );
     bool isTerminatedByIntegrationTimes( const size_t times );
 };
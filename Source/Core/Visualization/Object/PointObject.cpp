@@ -14,10 +14,14 @@
 /*****************************************************************************/
 #include "PointObject.h"
 #include <cstring>
+#include <vector>
 #include <kvs/KVSMLPointObject>
 #include <kvs/LineObject>
 #include <kvs/PolygonObject>
 #include <kvs/Assert>
+#include <kvs/Math>
+#include <kvs/Value>
+#include <kvs/OpenMP>
 
 
 namespace
@@ -44,7 +48,65 @@ kvs::KVSMLPointObject::WritingDataType GetWritingDataType( const bool ascii, con
     }
 }
 
-}
+/// Max. number of the palette colors of the encoded colors.
+const size_t MaxPaletteSize = 256;
+
+/*===========================================================================*/
+/**
+ *  @brief  Palette of the colors with a small open-addressing hash table.
+ */
+/*===========================================================================*/
+class Palette
+{
+private:
+
+    enum { TableSize = 1024 }; ///< number of the slots (4 times the max. palette size)
+    std::vector<kvs::UInt32> m_keys; ///< packed color + 1 of each slot (0: empty)
+    std::vector<kvs::UInt8> m_indices; ///< palette index of each slot
+    std::vector<kvs::UInt8> m_colors; ///< palette colors (r,g,b)
+
+public:
+
+    Palette(): m_keys( TableSize, 0 ), m_indices( TableSize, 0 ) {}
+
+    const std::vector<kvs::UInt8>& colors() const { return m_colors; }
+
+    bool insert( const kvs::UInt8* color )
+    {
+        const size_t slot = this->find_slot( color );
+        if ( m_keys[ slot ] != 0 ) { return true; }
+
+        const size_t size = m_colors.size() / 3;
+        if ( size >= ::MaxPaletteSize ) { return false; }
+
+        m_keys[ slot ] = Key( color );
+        m_indices[ slot ] = static_cast<kvs::UInt8>( size );
+        m_colors.insert( m_colors.end(), color, color + 3 );
+        return true;
+    }
+
+    kvs::UInt8 index( const kvs::UInt8* color ) const
+    {
+        return m_indices[ this->find_slot( color ) ];
+    }
+
+private:
+
+    static kvs::UInt32 Key( const kvs::UInt8* color )
+    {
+        return ( ( kvs::UInt32( color[0] ) << 16 ) | ( kvs::UInt32( color[1] ) << 8 ) | color[2] ) + 1;
+    }
+
+    size_t find_slot( const kvs::UInt8* color ) const
+    {
+        const kvs::UInt32 key = Key( color );
+        size_t slot = ( key * 2654435761u ) >> 22;
+        while ( m_keys[ slot ] != 0 && m_keys[ slot ] != key ) { slot = ( slot + 1 ) % TableSize; }
+        return slot;
+    }
+};
+
+} // end of namespace
 
 namespace kvs
 {
@@ -135,6 +197,21 @@ PointObject::PointObject( const kvs::PolygonObject& polygon )
 /*===========================================================================*/
 void PointObject::add( const PointObject& other )
 {
+    // The encoded objects are added as decoded, and the result is encoded
+    // again if this object is encoded.
+    if ( this->isEncoded() || other.isEncoded() )
+    {
+        const bool encoded = this->isEncoded();
+        kvs::PointObject decoded;
+        decoded.shallowCopy( other );
+        decoded.decode();
+
+        this->decode();
+        this->add( decoded );
+        if ( encoded ) { this->encode(); }
+        return;
+    }
+
     if ( this->coords().size() == 0 )
     {
         // Copy the object.
@@ -389,6 +466,12 @@ void PointObject::shallowCopy( const PointObject& other )
 {
     BaseClass::shallowCopy( other );
     m_sizes = other.sizes();
+    m_quantized_coords = other.quantizedCoords();
+    m_octahedral_normals = other.octahedralNormals();
+    m_color_indices = other.colorIndices();
+    m_palette = other.palette();
+    m_quantization_origin = other.quantizationOrigin();
+    m_quantization_step = other.quantizationStep();
 }
 
 /*===========================================================================*/
@@ -401,6 +484,12 @@ void PointObject::deepCopy( const PointObject& other )
 {
     BaseClass::deepCopy( other );
     m_sizes = other.sizes().clone();
+    m_quantized_coords = other.quantizedCoords().clone();
+    m_octahedral_normals = other.octahedralNormals().clone();
+    m_color_indices = other.colorIndices().clone();
+    m_palette = other.palette().clone();
+    m_quantization_origin = other.quantizationOrigin();
+    m_quantization_step = other.quantizationStep();
 }
 
 /*===========================================================================*/
@@ -412,6 +501,10 @@ void PointObject::clear()
 {
     BaseClass::clear();
     m_sizes.release();
+    m_quantized_coords.release();
+    m_octahedral_normals.release();
+    m_color_indices.release();
+    m_palette.release();
 }
 
 /*===========================================================================*/
@@ -426,6 +519,12 @@ void PointObject::print( std::ostream& os, const kvs::Indent& indent ) const
     os << indent << "Object type : " << "point object" << std::endl;
     BaseClass::print( os, indent );
     os << indent << "Number of sizes : " << this->numberOfSizes() << std::endl;
+    if ( this->isEncoded() )
+    {
+        os << indent << "Encoded vertices : " << this->numberOfEncodedVertices() << std::endl;
+        os << indent << "Encoded normal vectors : " << this->numberOfEncodedNormals() << std::endl;
+        os << indent << "Encoded colors : " << this->numberOfEncodedColors() << " (palette: " << m_palette.size() / 3 << ")" << std::endl;
+    }
 }
 
 /*===========================================================================*/
@@ -485,9 +584,9 @@ bool PointObject::write( const std::string& filename, const bool ascii, const bo
 {
     kvs::KVSMLPointObject kvsml;
     kvsml.setWritingDataType( ::GetWritingDataType( ascii, external ) );
-    kvsml.setCoords( this->coords() );
-    kvsml.setColors( this->colors() );
-    kvsml.setNormals( this->normals() );
+    kvsml.setCoords( this->decodedCoords() );
+    kvsml.setColors( this->decodedColors() );
+    kvsml.setNormals( this->decodedNormals() );
     kvsml.setSizes( this->sizes() );
 
     if ( this->hasMinMaxObjectCoords() )
@@ -515,6 +614,255 @@ void PointObject::setSize( const kvs::Real32 size )
     m_sizes[0] = size;
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Updates the min/max coordinates.
+ */
+/*===========================================================================*/
+void PointObject::updateMinMaxCoords()
+{
+    if ( !this->isEncoded() )
+    {
+        BaseClass::updateMinMaxCoords();
+        return;
+    }
+
+    // The quantization range is the bounding box of the encoded vertices.
+    const kvs::Vec3 min_coord( m_quantization_origin );
+    const kvs::Vec3 max_coord( m_quantization_origin + m_quantization_step * 65535.0f );
+    BaseClass::setMinMaxObjectCoords( min_coord, max_coord );
+    BaseClass::setMinMaxExternalCoords( min_coord, max_coord );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Encodes the vertex attributes in the compact form.
+ *
+ *  The coordinates are quantized to 16 bits in their bounding box, the
+ *  normal vectors of the vertices are encoded to 8+8 bits in the octahedral
+ *  form, and the colors of the vertices are replaced with the 8-bit indices
+ *  to the palette if there are 256 colors or less. The original arrays are
+ *  released, and the vertex attributes must be accessed by decodedCoord(),
+ *  decodedNormal() and decodedColor() (or decoded by decode()).
+ */
+/*===========================================================================*/
+void PointObject::encode()
+{
+    const size_t nvertices = this->numberOfVertices();
+    if ( this->isEncoded() || nvertices == 0 ) { return; }
+
+    if ( !BaseClass::hasMinMaxObjectCoords() ) { BaseClass::updateMinMaxCoords(); }
+
+    // Bounding box of the coordinates.
+    const kvs::Real32* coords = BaseClass::coords().data();
+    kvs::Vec3 min_coord( kvs::Value<kvs::Real32>::Max(), kvs::Value<kvs::Real32>::Max(), kvs::Value<kvs::Real32>::Max() );
+    kvs::Vec3 max_coord( -kvs::Value<kvs::Real32>::Max(), -kvs::Value<kvs::Real32>::Max(), -kvs::Value<kvs::Real32>::Max() );
+    KVS_OMP_PARALLEL()
+    {
+        kvs::Vec3 local_min( min_coord );
+        kvs::Vec3 local_max( max_coord );
+        KVS_OMP_FOR( schedule(static) )
+        for ( size_t i = 0; i < nvertices; i++ )
+        {
+            for ( int k = 0; k < 3; k++ )
+            {
+                local_min[k] = kvs::Math::Min( local_min[k], coords[ 3 * i + k ] );
+                local_max[k] = kvs::Math::Max( local_max[k], coords[ 3 * i + k ] );
+            }
+        }
+
+        KVS_OMP_CRITICAL()
+        {
+            for ( int k = 0; k < 3; k++ )
+            {
+                min_coord[k] = kvs::Math::Min( min_coord[k], local_min[k] );
+                max_coord[k] = kvs::Math::Max( max_coord[k], local_max[k] );
+            }
+        }
+    }
+
+    kvs::Vec3 scale( 0.0f, 0.0f, 0.0f );
+    for ( int k = 0; k < 3; k++ )
+    {
+        const kvs::Real32 extent = max_coord[k] - min_coord[k];
+        m_quantization_step[k] = extent / 65535.0f;
+        scale[k] = extent > 0.0f ? 65535.0f / extent : 0.0f;
+    }
+    m_quantization_origin = min_coord;
+
+    m_quantized_coords.allocate( nvertices * 3 );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < nvertices * 3; i++ )
+    {
+        const int k = static_cast<int>( i % 3 );
+        const kvs::Real32 q = ( coords[i] - min_coord[k] ) * scale[k] + 0.5f;
+        m_quantized_coords[i] = static_cast<kvs::UInt16>( kvs::Math::Clamp( q, 0.0f, 65535.0f ) );
+    }
+    BaseClass::setCoords( kvs::ValueArray<kvs::Real32>() );
+
+    if ( BaseClass::numberOfNormals() == nvertices )
+    {
+        const kvs::Real32* normals = BaseClass::normals().data();
+        m_octahedral_normals.allocate( nvertices );
+        KVS_OMP_PARALLEL_FOR( schedule(static) )
+        for ( size_t i = 0; i < nvertices; i++ )
+        {
+            m_octahedral_normals[i] = EncodeNormal( kvs::Vec3( normals + 3 * i ) );
+        }
+        BaseClass::setNormals( kvs::ValueArray<kvs::Real32>() );
+    }
+
+    if ( BaseClass::numberOfColors() == nvertices && nvertices > 1 )
+    {
+        const kvs::UInt8* colors = BaseClass::colors().data();
+        ::Palette palette;
+        bool indexed = true;
+        for ( size_t i = 0; i < nvertices && indexed; i++ )
+        {
+            indexed = palette.insert( colors + 3 * i );
+        }
+
+        if ( indexed )
+        {
+            m_palette = kvs::ValueArray<kvs::UInt8>( palette.colors() );
+            m_color_indices.allocate( nvertices );
+            KVS_OMP_PARALLEL_FOR( schedule(static) )
+            for ( size_t i = 0; i < nvertices; i++ )
+            {
+                m_color_indices[i] = palette.index( colors + 3 * i );
+            }
+            BaseClass::setColors( kvs::ValueArray<kvs::UInt8>() );
+        }
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Decodes the encoded vertex attributes to the original form.
+ */
+/*===========================================================================*/
+void PointObject::decode()
+{
+    if ( !this->isEncoded() ) { return; }
+
+    const kvs::ValueArray<kvs::Real32> coords = this->decodedCoords();
+    const kvs::ValueArray<kvs::Real32> normals = this->decodedNormals();
+    const kvs::ValueArray<kvs::UInt8> colors = this->decodedColors();
+    BaseClass::setCoords( coords );
+    BaseClass::setNormals( normals );
+    BaseClass::setColors( colors );
+
+    m_quantized_coords.release();
+    m_octahedral_normals.release();
+    m_color_indices.release();
+    m_palette.release();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the decoded coordinates.
+ *  @return coordinates (shared with this object if they are not encoded)
+ */
+/*===========================================================================*/
+kvs::ValueArray<kvs::Real32> PointObject::decodedCoords() const
+{
+    if ( m_quantized_coords.size() == 0 ) { return BaseClass::coords(); }
+
+    const size_t ncoords = m_quantized_coords.size();
+    const kvs::UInt16* q = m_quantized_coords.data();
+    const kvs::Real32 origin[3] = { m_quantization_origin[0], m_quantization_origin[1], m_quantization_origin[2] };
+    const kvs::Real32 step[3] = { m_quantization_step[0], m_quantization_step[1], m_quantization_step[2] };
+    kvs::ValueArray<kvs::Real32> coords( ncoords );
+    kvs::Real32* dst = coords.data();
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < ncoords / 3; i++ )
+    {
+        dst[ 3 * i + 0 ] = origin[0] + step[0] * q[ 3 * i + 0 ];
+        dst[ 3 * i + 1 ] = origin[1] + step[1] * q[ 3 * i + 1 ];
+        dst[ 3 * i + 2 ] = origin[2] + step[2] * q[ 3 * i + 2 ];
+    }
+
+    return coords;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the decoded normal vectors.
+ *  @return normal vectors (shared with this object if they are not encoded)
+ */
+/*===========================================================================*/
+kvs::ValueArray<kvs::Real32> PointObject::decodedNormals() const
+{
+    if ( m_octahedral_normals.size() == 0 ) { return BaseClass::normals(); }
+
+    const size_t nnormals = m_octahedral_normals.size();
+    kvs::ValueArray<kvs::Real32> normals( nnormals * 3 );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < nnormals; i++ )
+    {
+        const kvs::Vec3 n = DecodeNormal( m_octahedral_normals[i] );
+        normals[ 3 * i + 0 ] = n.x();
+        normals[ 3 * i + 1 ] = n.y();
+        normals[ 3 * i + 2 ] = n.z();
+    }
+
+    return normals;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the decoded colors.
+ *  @return colors (shared with this object if they are not encoded)
+ */
+/*===========================================================================*/
+kvs::ValueArray<kvs::UInt8> PointObject::decodedColors() const
+{
+    if ( m_color_indices.size() == 0 ) { return BaseClass::colors(); }
+
+    const size_t ncolors = m_color_indices.size();
+    kvs::ValueArray<kvs::UInt8> colors( ncolors * 3 );
+    KVS_OMP_PARALLEL_FOR( schedule(static) )
+    for ( size_t i = 0; i < ncolors; i++ )
+    {
+        const kvs::UInt8* c = m_palette.data() + 3 * m_color_indices[i];
+        colors[ 3 * i + 0 ] = c[0];
+        colors[ 3 * i + 1 ] = c[1];
+        colors[ 3 * i + 2 ] = c[2];
+    }
+
+    return colors;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Encodes the normal vector in the octahedral form.
+ *  @param  normal [in] normal vector
+ *  @return octahedral coordinates (u in the lower 8 bits, v in the upper 8 bits)
+ *
+ *  The normalized vector is projected onto the octahedron |x|+|y|+|z| = 1,
+ *  whose lower half is folded over the diagonals of the xy-square.
+ */
+/*===========================================================================*/
+kvs::UInt16 PointObject::EncodeNormal( const kvs::Vec3& normal )
+{
+    const float sum = std::fabs( normal.x() ) + std::fabs( normal.y() ) + std::fabs( normal.z() );
+    if ( !( sum > 0.0f ) ) { return EncodeNormal( kvs::Vec3( 0.0f, 0.0f, 1.0f ) ); }
+
+    float u = normal.x() / sum;
+    float v = normal.y() / sum;
+    if ( normal.z() < 0.0f )
+    {
+        const float au = std::fabs( u );
+        const float av = std::fabs( v );
+        u = u < 0.0f ? av - 1.0f : 1.0f - av;
+        v = v < 0.0f ? au - 1.0f : 1.0f - au;
+    }
+
+    const kvs::UInt16 iu = static_cast<kvs::UInt16>( kvs::Math::Clamp( ( u * 0.5f + 0.5f ) * 255.0f + 0.5f, 0.0f, 255.0f ) );
+    const kvs::UInt16 iv = static_cast<kvs::UInt16>( kvs::Math::Clamp( ( v * 0.5f + 0.5f ) * 255.0f + 0.5f, 0.0f, 255.0f ) );
+    return static_cast<kvs::UInt16>( iu | ( iv << 8 ) );
+}
+
 /*===========================================================================*/
 /**
  *  @brief  '<<' operator
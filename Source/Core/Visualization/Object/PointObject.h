@@ -14,6 +14,7 @@
 /****************************************************************************/
 #pragma once
 #include <ostream>
+#include <cmath>
 #include <kvs/GeometryObjectBase>
 #include <kvs/ValueArray>
 #include <kvs/Type>
@@ -43,6 +44,17 @@ class PointObject : public kvs::GeometryObjectBase
 private:
 
     kvs::ValueArray<kvs::Real32> m_sizes; ///< size array
+    kvs::ValueArray<kvs::UInt16> m_quantized_coords; ///< coordinates quantized to 16 bits (encoded)
+    kvs::ValueArray<kvs::UInt16> m_octahedral_normals; ///< normals in 8+8-bit octahedral form (encoded)
+    kvs::ValueArray<kvs::UInt8> m_color_indices; ///< palette indices of the colors (encoded)
+    kvs::ValueArray<kvs::UInt8> m_palette; ///< palette colors (r,g,b) (encoded)
+    kvs::Vec3 m_quantization_origin; ///< coordinate of the quantized value 0
+    kvs::Vec3 m_quantization_step; ///< coordinate step of the quantized value
+
+public:
+
+    static kvs::UInt16 EncodeNormal( const kvs::Vec3& normal );
+    static kvs::Vec3 DecodeNormal( const kvs::UInt16 code );
 
 public:
 
@@ -66,6 +78,29 @@ public:
     kvs::Real32 size( const size_t index = 0 ) const { return m_sizes[index]; }
     const kvs::ValueArray<kvs::Real32>& sizes() const { return m_sizes; }
 
+    void updateMinMaxCoords();
+    void encode();
+    void decode();
+
+    bool isEncoded() const { return m_quantized_coords.size() > 0; }
+    size_t numberOfEncodedVertices() const { return m_quantized_coords.size() / 3; }
+    size_t numberOfEncodedColors() const { return m_color_indices.size(); }
+    size_t numberOfEncodedNormals() const { return m_octahedral_normals.size(); }
+
+    const kvs::Vec3& quantizationOrigin() const { return m_quantization_origin; }
+    const kvs::Vec3& quantizationStep() const { return m_quantization_step; }
+    const kvs::ValueArray<kvs::UInt16>& quantizedCoords() const { return m_quantized_coords; }
+    const kvs::ValueArray<kvs::UInt16>& octahedralNormals() const { return m_octahedral_normals; }
+    const kvs::ValueArray<kvs::UInt8>& colorIndices() const { return m_color_indices; }
+    const kvs::ValueArray<kvs::UInt8>& palette() const { return m_palette; }
+
+    kvs::Vec3 decodedCoord( const size_t index ) const;
+    kvs::Vec3 decodedNormal( const size_t index ) const;
+    kvs::RGBColor decodedColor( const size_t index ) const;
+    kvs::ValueArray<kvs::Real32> decodedCoords() const;
+    kvs::ValueArray<kvs::Real32> decodedNormals() const;
+    kvs::ValueArray<kvs::UInt8> decodedColors() const;
+
 public:
     KVS_DEPRECATED( PointObject(
                         const kvs::ValueArray<kvs::Real32>& coords,
@@ -193,4 +228,70 @@ public:
     KVS_DEPRECATED( friend std::ostream& operator << ( std::ostream& os, const PointObject& object ) );
 };
 
+/*===========================================================================*/
+/**
+ *  @brief  Returns the decoded coordinate of the vertex.
+ *  @param  index [in] index of the vertex
+ *  @return coordinate
+ */
+/*===========================================================================*/
+inline kvs::Vec3 PointObject::decodedCoord( const size_t index ) const
+{
+    if ( m_quantized_coords.size() == 0 ) { return kvs::Vec3( BaseClass::coords().data() + 3 * index ); }
+
+    const kvs::UInt16* q = m_quantized_coords.data() + 3 * index;
+    return kvs::Vec3(
+        m_quantization_origin.x() + m_quantization_step.x() * q[0],
+        m_quantization_origin.y() + m_quantization_step.y() * q[1],
+        m_quantization_origin.z() + m_quantization_step.z() * q[2] );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the decoded normal vector of the vertex.
+ *  @param  index [in] index of the vertex
+ *  @return normal vector (normalized if it is encoded)
+ */
+/*===========================================================================*/
+inline kvs::Vec3 PointObject::decodedNormal( const size_t index ) const
+{
+    if ( m_octahedral_normals.size() == 0 ) { return kvs::Vec3( BaseClass::normals().data() + 3 * index ); }
+    return DecodeNormal( m_octahedral_normals[ index ] );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the decoded color of the vertex.
+ *  @param  index [in] index of the vertex
+ *  @return color
+ */
+/*===========================================================================*/
+inline kvs::RGBColor PointObject::decodedColor( const size_t index ) const
+{
+    if ( m_color_indices.size() == 0 ) { return kvs::RGBColor( BaseClass::colors().data() + 3 * index ); }
+    return kvs::RGBColor( m_palette.data() + 3 * m_color_indices[ index ] );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Decodes the normal vector in the octahedral form.
+ *  @param  code [in] octahedral coordinates (u in the lower 8 bits, v in the upper 8 bits)
+ *  @return normalized normal vector
+ */
+/*===========================================================================*/
+inline kvs::Vec3 PointObject::DecodeNormal( const kvs::UInt16 code )
+{
+    const float u = static_cast<float>( code & 0xff ) * ( 2.0f / 255.0f ) - 1.0f;
+    const float v = static_cast<float>( code >> 8 ) * ( 2.0f / 255.0f ) - 1.0f;
+    const float au = u < 0.0f ? -u : u;
+    const float av = v < 0.0f ? -v : v;
+    const float z = 1.0f - au - av;
+
+    // The lower hemisphere is folded over the diagonals.
+    const float x = z < 0.0f ? ( u < 0.0f ? av - 1.0f : 1.0f - av ) : u;
+    const float y = z < 0.0f ? ( v < 0.0f ? au - 1.0f : 1.0f - au ) : v;
+    const float length = std::sqrt( x * x + y * y + z * z );
+    return kvs::Vec3( x / length, y / length, z / length );
+}
+
 } // end of namespace kvs
@@ -16,6 +16,7 @@
 #include <kvs/Value>
 #include <kvs/Math>
 #include <kvs/KVSMLTableObject>
+#include <kvs/ValueStatistics>
 
 
 namespace
@@ -206,103 +207,13 @@ void TableObject::addColumn( const kvs::AnyValueArray& array, const std::string&
     m_table.pushBackColumn( array );
     m_labels.push_back( label );
 
-    kvs::Real64 min_value = kvs::Value<kvs::Real64>::Max();
-    kvs::Real64 max_value = kvs::Value<kvs::Real64>::Min();
-    const std::type_info& type = array.typeInfo()->type();
-    if ( type == typeid( kvs::Int8 ) )
+    kvs::Real64 min_value = 0.0;
+    kvs::Real64 max_value = 0.0;
+    if ( array.typeInfo()->type() != typeid( std::string ) )
     {
-        const kvs::Int8* value = static_cast<const kvs::Int8*>( array.data() );
-        for( size_t i = 0; i < array.size(); i++ )
-        {
-            min_value = kvs::Math::Min( min_value, kvs::Real64( value[i] ) );
-            max_value = kvs::Math::Max( max_value, kvs::Real64( value[i] ) );
-        }
-    }
-    else if ( type == typeid( kvs::UInt8 ) )
-    {
-        const kvs::UInt8* value = static_cast<const kvs::UInt8*>( array.data() );
-        for( size_t i = 0; i < array.size(); i++ )
-        {
-            min_value = kvs::Math::Min( min_value, kvs::Real64( value[i] ) );
-            max_value = kvs::Math::Max( max_value, kvs::Real64( value[i] ) );
-        }
-    }
-    else if ( type == typeid( kvs::Int16 ) )
-    {
-        const kvs::Int16* value = static_cast<const kvs::Int16*>( array.data() );
-        for( size_t i = 0; i < array.size(); i++ )
-        {
-            min_value = kvs::Math::Min( min_value, kvs::Real64( value[i] ) );
-            max_value = kvs::Math::Max( max_value, kvs::Real64( value[i] ) );
-        }
-    }
-    else if ( type == typeid( kvs::UInt16 ) )
-    {
-        const kvs::UInt16* value = static_cast<const kvs::UInt16*>( array.data() );
-        for( size_t i = 0; i < array.size(); i++ )
-        {
-            min_value = kvs::Math::Min( min_value, kvs::Real64( value[i] ) );
-            max_value = kvs::Math::Max( max_value, kvs::Real64( value[i] ) );
-        }
-    }
-    else if ( type == typeid( kvs::Int32 ) )
-    {
-        const kvs::Int32* value = static_cast<const kvs::Int32*>( array.data() );
-        for( size_t i = 0; i < array.size(); i++ )
-        {
-            min_value = kvs::Math::Min( min_value, kvs::Real64( value[i] ) );
-            max_value = kvs::Math::Max( max_value, kvs::Real64( value[i] ) );
-        }
-    }
-    else if ( type == typeid( kvs::UInt32 ) )
-    {
-        const kvs::UInt32* value = static_cast<const kvs::UInt32*>( array.data() );
-        for( size_t i = 0; i < array.size(); i++ )
-        {
-            min_value = kvs::Math::Min( min_value, kvs::Real64( value[i] ) );
-            max_value = kvs::Math::Max( max_value, kvs::Real64( value[i] ) );
-        }
-    }
-    else if ( type == typeid( kvs::Int64 ) )
-    {
-        const kvs::Int64* value = static_cast<const kvs::Int64*>( array.data() );
-        for( size_t i = 0; i < array.size(); i++ )
-        {
-            min_value = kvs::Math::Min( min_value, kvs::Real64( value[i] ) );
-            max_value = kvs::Math::Max( max_value, kvs::Real64( value[i] ) );
-        }
-    }
-    else if ( type == typeid( kvs::UInt64 ) )
-    {
-        const kvs::UInt64* value = static_cast<const kvs::UInt64*>( array.data() );
-        for( size_t i = 0; i < array.size(); i++ )
-        {
-            min_value = kvs::Math::Min( min_value, kvs::Real64( value[i] ) );
-            max_value = kvs::Math::Max( max_value, kvs::Real64( value[i] ) );
-        }
-    }
-    else if ( type == typeid( kvs::Real32 ) )
-    {
-        const kvs::Real32* value = static_cast<const kvs::Real32*>( array.data() );
-        for( size_t i = 0; i < array.size(); i++ )
-        {
-            min_value = kvs::Math::Min( min_value, kvs::Real64( value[i] ) );
-            max_value = kvs::Math::Max( max_value, kvs::Real64( value[i] ) );
-        }
-    }
-    else if ( type == typeid( kvs::Real64 ) )
-    {
-        const kvs::Real64* value = static_cast<const kvs::Real64*>( array.data() );
-        for( size_t i = 0; i < array.size(); i++ )
-        {
-            min_value = kvs::Math::Min( min_value, kvs::Real64( value[i] ) );
-            max_value = kvs::Math::Max( max_value, kvs::Real64( value[i] ) );
-        }
-    }
-    else if ( type == typeid( std::string ) )
-    {
-        min_value = 0.0;
-        max_value = 0.0;
+        const kvs::Range range = kvs::ValueStatistics::MinMax( array );
+        min_value = range.lower();
+        max_value = range.upper();
     }
 
     m_min_values.push_back( min_value );
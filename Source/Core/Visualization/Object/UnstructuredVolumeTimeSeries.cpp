@@ -0,0 +1,238 @@
+/*****************************************************************************/
+/**
+ *  @file   UnstructuredVolumeTimeSeries.cpp
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "UnstructuredVolumeTimeSeries.h"
+#include <cstring>
+#include <kvs/Message>
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the cell type name used in the file.
+ *  @param  type [in] cell type
+ *  @return cell type name (empty for the unknown cell type)
+ */
+/*===========================================================================*/
+std::string CellTypeName( const kvs::UnstructuredVolumeObject::CellType type )
+{
+    switch ( type )
+    {
+    case kvs::UnstructuredVolumeObject::Tetrahedra: return "tetrahedra";
+    case kvs::UnstructuredVolumeObject::QuadraticTetrahedra: return "quadratic tetrahedra";
+    case kvs::UnstructuredVolumeObject::Hexahedra: return "hexahedra";
+    case kvs::UnstructuredVolumeObject::QuadraticHexahedra: return "quadratic hexahedra";
+    case kvs::UnstructuredVolumeObject::Pyramid: return "pyramid";
+    case kvs::UnstructuredVolumeObject::Prism: return "prism";
+    case kvs::UnstructuredVolumeObject::Point: return "point";
+    default: return "";
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Converts to the cell type from the given string.
+ *  @param  name [in] cell type name
+ *  @return cell type
+ */
+/*===========================================================================*/
+kvs::UnstructuredVolumeObject::CellType CellType( const std::string& name )
+{
+    if (      name == "tetrahedra" ) { return kvs::UnstructuredVolumeObject::Tetrahedra; }
+    else if ( name == "quadratic tetrahedra" ) { return kvs::UnstructuredVolumeObject::QuadraticTetrahedra; }
+    else if ( name == "hexahedra" ) { return kvs::UnstructuredVolumeObject::Hexahedra; }
+    else if ( name == "quadratic hexahedra" ) { return kvs::UnstructuredVolumeObject::QuadraticHexahedra; }
+    else if ( name == "pyramid" ) { return kvs::UnstructuredVolumeObject::Pyramid; }
+    else if ( name == "point" ) { return kvs::UnstructuredVolumeObject::Point; }
+    else if ( name == "prism" ) { return kvs::UnstructuredVolumeObject::Prism; }
+    else
+    {
+        kvsMessageError( "Unknown cell type '%s'.", name.c_str() );
+        return kvs::UnstructuredVolumeObject::UnknownCellType;
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if the arrays have the same values.
+ *  @param  a [in] array
+ *  @param  b [in] array
+ *  @return true, if the arrays are shared or have the same values
+ */
+/*===========================================================================*/
+template <typename T>
+bool IsSame( const kvs::ValueArray<T>& a, const kvs::ValueArray<T>& b )
+{
+    if ( a.size() != b.size() ) { return false; }
+    if ( a.data() == b.data() || a.size() == 0 ) { return true; }
+    return std::memcmp( a.data(), b.data(), a.byteSize() ) == 0;
+}
+
+} // end of namespace
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new UnstructuredVolumeTimeSeries class.
+ */
+/*===========================================================================*/
+UnstructuredVolumeTimeSeries::UnstructuredVolumeTimeSeries()
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new UnstructuredVolumeTimeSeries class by reading the file.
+ *  @param  filename [in] filename
+ */
+/*===========================================================================*/
+UnstructuredVolumeTimeSeries::UnstructuredVolumeTimeSeries( const std::string& filename )
+{
+    this->read( filename );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the unstructured volume object of the step.
+ *  @param  index [in] index of the step
+ *  @return pointer to the new object (NULL, if the reading process is failed)
+ *
+ *  The coordinates and the connections of the returned object are shared
+ *  with the mesh (not copied). The object must be deleted by the caller, or
+ *  given to the scene which takes the ownership.
+ */
+/*===========================================================================*/
+kvs::UnstructuredVolumeObject* UnstructuredVolumeTimeSeries::object( const size_t index ) const
+{
+    const kvs::AnyValueArray values = m_file.values( index );
+    if ( values.empty() ) { return NULL; }
+
+    kvs::UnstructuredVolumeObject* object = new kvs::UnstructuredVolumeObject();
+    object->shallowCopy( m_mesh );
+    object->setValues( values );
+    object->updateMinMaxValues();
+    return object;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reads the mesh and the step index of the time-series file.
+ *  @param  filename [in] filename
+ *  @return true, if the reading process is done successfully
+ */
+/*===========================================================================*/
+bool UnstructuredVolumeTimeSeries::read( const std::string& filename )
+{
+    if ( !kvs::UnstructuredTimeSeries::CheckExtension( filename ) )
+    {
+        kvsMessageError( "%s is not a time-series file of the unstructured volume.", filename.c_str() );
+        return false;
+    }
+
+    if ( !m_file.read( filename ) ) { return false; }
+
+    m_mesh = kvs::UnstructuredVolumeObject();
+    m_mesh.setCellType( ::CellType( m_file.cellType() ) );
+    m_mesh.setVeclen( m_file.veclen() );
+    m_mesh.setNumberOfNodes( m_file.nnodes() );
+    m_mesh.setNumberOfCells( m_file.ncells() );
+    m_mesh.setCoords( m_file.coords() );
+    m_mesh.setConnections( m_file.connections() );
+    m_mesh.updateMinMaxCoords();
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Creates the time-series file and writes the mesh.
+ *  @param  filename [in] filename
+ *  @param  mesh [in] object which has the mesh of the steps
+ *  @param  encoding [in] encoding of the values
+ *  @param  key_interval [in] interval of the key frames
+ *  @return true, if the writing process is done successfully
+ */
+/*===========================================================================*/
+bool UnstructuredVolumeTimeSeries::create(
+    const std::string& filename,
+    const kvs::UnstructuredVolumeObject& mesh,
+    const Encoding encoding,
+    const size_t key_interval )
+{
+    const std::string cell_type = ::CellTypeName( mesh.cellType() );
+    if ( cell_type.empty() )
+    {
+        kvsMessageError( "Not supported cell type." );
+        return false;
+    }
+
+    m_mesh = kvs::UnstructuredVolumeObject();
+    m_mesh.setCellType( mesh.cellType() );
+    m_mesh.setVeclen( mesh.veclen() );
+    m_mesh.setNumberOfNodes( mesh.numberOfNodes() );
+    m_mesh.setNumberOfCells( mesh.numberOfCells() );
+    m_mesh.setCoords( mesh.coords() );
+    m_mesh.setConnections( mesh.connections() );
+
+    m_file.setCellType( cell_type );
+    m_file.setVeclen( mesh.veclen() );
+    m_file.setNNodes( mesh.numberOfNodes() );
+    m_file.setNCells( mesh.numberOfCells() );
+    m_file.setCoords( mesh.coords() );
+    m_file.setConnections( mesh.connections() );
+    m_file.setEncoding( encoding );
+    m_file.setKeyInterval( key_interval );
+    return m_file.create( filename );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Appends the values of the object to the time-series file.
+ *  @param  object [in] object of the step, which has the same mesh
+ *  @param  time [in] time of the step
+ *  @return true, if the writing process is done successfully
+ */
+/*===========================================================================*/
+bool UnstructuredVolumeTimeSeries::append( const kvs::UnstructuredVolumeObject& object, const double time )
+{
+    const bool same_mesh =
+        object.cellType() == m_mesh.cellType() &&
+        object.veclen() == m_mesh.veclen() &&
+        object.numberOfCells() == m_mesh.numberOfCells() &&
+        ::IsSame( object.coords(), m_mesh.coords() ) &&
+        ::IsSame( object.connections(), m_mesh.connections() );
+    if ( !same_mesh )
+    {
+        kvsMessageError( "The mesh of the object is different from the one of the time series." );
+        return false;
+    }
+
+    return m_file.append( object.values(), time );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Completes and closes the time-series file.
+ *  @return true, if the writing process is done successfully
+ */
+/*===========================================================================*/
+bool UnstructuredVolumeTimeSeries::close()
+{
+    return m_file.close();
+}
+
+} // end of namespace kvs
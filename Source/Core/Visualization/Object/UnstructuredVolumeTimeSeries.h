@@ -0,0 +1,68 @@
+/*****************************************************************************/
+/**
+ *  @file   UnstructuredVolumeTimeSeries.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#pragma once
+#include <string>
+#include <kvs/UnstructuredVolumeObject>
+#include <kvs/UnstructuredTimeSeries>
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Time series of the unstructured volume objects on the same mesh.
+ *
+ *  The objects returned by object() share the coordinate and connection
+ *  arrays of the mesh, which is read only once, and have their own values
+ *  decoded from the file on demand.
+ */
+/*===========================================================================*/
+class UnstructuredVolumeTimeSeries
+{
+public:
+
+    typedef kvs::UnstructuredTimeSeries::Encoding Encoding;
+
+private:
+
+    kvs::UnstructuredTimeSeries m_file; ///< time-series file
+    kvs::UnstructuredVolumeObject m_mesh; ///< mesh (without the values) shared by the steps
+
+public:
+
+    UnstructuredVolumeTimeSeries();
+    UnstructuredVolumeTimeSeries( const std::string& filename );
+
+    const kvs::UnstructuredVolumeObject& mesh() const { return m_mesh; }
+    size_t numberOfSteps() const { return m_file.numberOfSteps(); }
+    double time( const size_t index ) const { return m_file.time( index ); }
+    kvs::UnstructuredVolumeObject* object( const size_t index ) const;
+
+    bool read( const std::string& filename );
+    bool create(
+        const std::string& filename,
+        const kvs::UnstructuredVolumeObject& mesh,
+        const Encoding encoding = kvs::UnstructuredTimeSeries::DeltaEncoding,
+        const size_t key_interval = 16 );
+    bool append( const kvs::UnstructuredVolumeObject& object, const double time );
+    bool close();
+
+private:
+
+    UnstructuredVolumeTimeSeries( const UnstructuredVolumeTimeSeries& );
+    UnstructuredVolumeTimeSeries& operator =( const UnstructuredVolumeTimeSeries& );
+};
+
+} // end of namespace kvs
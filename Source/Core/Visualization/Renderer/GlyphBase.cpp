@@ -329,7 +329,6 @@ void GlyphBase::calculateColors( const kvs::VolumeObjectBase* volume )
     if ( !volume->hasMinMaxValues() ) { volume->updateMinMaxValues(); }
     const kvs::Real32 min_value = static_cast<kvs::Real32>(volume->minValue());
     const kvs::Real32 max_value = static_cast<kvs::Real32>(volume->maxValue());
-    const kvs::Real32 normalize = 1.0f / ( max_value - min_value );
 
     kvs::ValueArray<kvs::UInt8> colors( 3 * nnodes );
     kvs::UInt8* color = colors.data();
@@ -346,34 +345,24 @@ void GlyphBase::calculateColors( const kvs::VolumeObjectBase* volume )
         break;
     case GlyphBase::ColorByMagnitude:
     {
-        const kvs::ColorMap color_map( m_tfunc.colorMap() );
+        kvs::ColorMap color_map( m_tfunc.colorMap() );
+        color_map.setRange( min_value, max_value );
         if ( veclen == 1 )
         {
-            for ( size_t i = 0; i < nnodes; i++ )
-            {
-                const float d = normalize * ( static_cast<float>(value[i]) - min_value );
-                const size_t level = static_cast<size_t>( 255.0f * d );
-                const kvs::RGBColor c = color_map[ level ];
-                *( color++ ) = c.r();
-                *( color++ ) = c.g();
-                *( color++ ) = c.b();
-            }
+            color_map.mapColors( value, nnodes, color );
         }
         else if ( veclen == 3 )
         {
+            kvs::ValueArray<kvs::Real32> magnitudes( nnodes );
             for ( size_t i = 0, index = 0; i < nnodes; i++, index += 3 )
             {
                 const kvs::Vector3f v(
                     static_cast<float>(value[index]),
                     static_cast<float>(value[index+1]),
                     static_cast<float>(value[index+2]));
-                const float d = normalize * ( static_cast<float>(v.length()) - min_value );
-                const size_t level = static_cast<size_t>( 255.0f * d );
-                const kvs::RGBColor c = color_map[ level ];
-                *( color++ ) = c.r();
-                *( color++ ) = c.g();
-                *( color++ ) = c.b();
+                magnitudes[i] = v.length();
             }
+            color_map.mapColors( magnitudes.data(), nnodes, color );
         }
         break;
     }
@@ -83,7 +83,7 @@ void ParticleBasedRenderer::exec(
 
     kvs::PointObject* point = kvs::PointObject::DownCast( object );
     if ( !m_ref_point ) this->attachPointObject( point );
-    if ( point->normals().size() == 0 ) BaseClass::disableShading();
+    if ( point->numberOfNormals() == 0 && point->numberOfEncodedNormals() == 0 ) BaseClass::disableShading();
 
     BaseClass::startTimer();
     {
@@ -195,9 +195,25 @@ void ParticleBasedRenderer::project_particle(
     m_buffer->attachShader( &BaseClass::shader() );
     m_buffer->attachPointObject( point );
 
+    // The dequantization of the encoded coordinates is folded into the matrix.
+    const bool encoded = point->isEncoded();
+    if ( encoded )
+    {
+        const kvs::Vec3& o = point->quantizationOrigin();
+        const kvs::Vec3& s = point->quantizationStep();
+        for ( int c = 0; c < 4; c++ )
+        {
+            t[12+c] += o.x() * t[c] + o.y() * t[4+c] + o.z() * t[8+c];
+            t[c] *= s.x();
+            t[4+c] *= s.y();
+            t[8+c] *= s.z();
+        }
+    }
+
     // Aliases.
-    const size_t nv = point->numberOfVertices();
+    const size_t nv = encoded ? point->numberOfEncodedVertices() : point->numberOfVertices();
     const kvs::Real32* v  = point->coords().data();
+    const kvs::UInt16* q  = point->quantizedCoords().data();
 
     size_t index3 = 0;
     const size_t bounds_width = BaseClass::windowWidth() - 1;
@@ -207,11 +223,14 @@ void ParticleBasedRenderer::project_particle(
         /* Calculate the projected point position in the window coordinate system.
          * Ex.) Camera::projectObjectToWindow().
          */
+        const float x = encoded ? q[index3]   : v[index3];
+        const float y = encoded ? q[index3+1] : v[index3+1];
+        const float z = encoded ? q[index3+2] : v[index3+2];
         float p_tmp[4] = {
-            v[index3]*t[0] + v[index3+1]*t[4] + v[index3+2]*t[ 8] + t[12],
-            v[index3]*t[1] + v[index3+1]*t[5] + v[index3+2]*t[ 9] + t[13],
-            v[index3]*t[2] + v[index3+1]*t[6] + v[index3+2]*t[10] + t[14],
-            v[index3]*t[3] + v[index3+1]*t[7] + v[index3+2]*t[11] + t[15] };
+            x*t[0] + y*t[4] + z*t[ 8] + t[12],
+            x*t[1] + y*t[5] + z*t[ 9] + t[13],
+            x*t[2] + y*t[6] + z*t[10] + t[14],
+            x*t[3] + y*t[7] + z*t[11] + t[15] };
         p_tmp[3] = 1.0f / p_tmp[3];
         p_tmp[0] *= p_tmp[3];
         p_tmp[1] *= p_tmp[3];
@@ -283,7 +283,7 @@ void ParticleBasedRenderer::Engine::release()
 void ParticleBasedRenderer::Engine::create( kvs::ObjectBase* object, kvs::Camera* camera, kvs::Light* light )
 {
     kvs::PointObject* point = kvs::PointObject::DownCast( object );
-    m_has_normal = point->normals().size() > 0;
+    m_has_normal = point->normals().size() > 0 || point->numberOfEncodedNormals() > 0;
     if ( !m_has_normal ) setEnabledShading( false );
 
     // Create resources.
@@ -390,7 +390,7 @@ void ParticleBasedRenderer::Engine::draw( kvs::ObjectBase* object, kvs::Camera*
         m_shader_program.setUniform( "random_texture_size_inv", 1.0f / randomTextureSize() );
         m_shader_program.setUniform( "screen_scale", kvs::Vec2( width * 0.5f, height * 0.5f ) );
 
-        const size_t nvertices = point->numberOfVertices();
+        const size_t nvertices = point->isEncoded() ? point->numberOfEncodedVertices() : point->numberOfVertices();
         const size_t rem = nvertices % repetitionLevel();
         const size_t quo = nvertices / repetitionLevel();
         const size_t count = quo + ( repetitionCount() < rem ? 1 : 0 );
@@ -487,25 +487,26 @@ void ParticleBasedRenderer::Engine::create_shader_program()
 /*===========================================================================*/
 void ParticleBasedRenderer::Engine::create_buffer_object( const kvs::PointObject* point )
 {
-    KVS_ASSERT( point->coords().size() == point->colors().size() );
-
-    kvs::ValueArray<kvs::Real32> coords = point->coords();
-    kvs::ValueArray<kvs::UInt8> colors = point->colors();
-    kvs::ValueArray<kvs::Real32> normals = point->normals();
+    // The encoded attributes are decoded for the buffer objects (the decoded
+    // arrays are shared with the point object if they are not encoded).
+    kvs::ValueArray<kvs::Real32> coords = point->decodedCoords();
+    kvs::ValueArray<kvs::UInt8> colors = point->decodedColors();
+    kvs::ValueArray<kvs::Real32> normals = point->decodedNormals();
+    KVS_ASSERT( coords.size() == colors.size() );
     if ( m_enable_shuffle )
     {
         kvs::UInt32 seed = 12345678;
-        coords = ::ShuffleArray<3>( point->coords(), seed );
-        colors = ::ShuffleArray<3>( point->colors(), seed );
+        coords = ::ShuffleArray<3>( coords, seed );
+        colors = ::ShuffleArray<3>( colors, seed );
         if ( m_has_normal )
         {
-            normals = ::ShuffleArray<3>( point->normals(), seed );
+            normals = ::ShuffleArray<3>( normals, seed );
         }
     }
 
     if ( !m_vbo ) m_vbo = new kvs::VertexBufferObject [ repetitionLevel() ];
 
-    const size_t nvertices = point->numberOfVertices();
+    const size_t nvertices = coords.size() / 3;
     const size_t rem = nvertices % repetitionLevel();
     const size_t quo = nvertices / repetitionLevel();
     for ( size_t i = 0; i < repetitionLevel(); i++ )
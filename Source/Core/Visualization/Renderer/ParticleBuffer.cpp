@@ -13,11 +13,232 @@
  */
 /****************************************************************************/
 #include "ParticleBuffer.h"
+#include <vector>
+#include <algorithm>
+#include <typeinfo>
 #include <kvs/Type>
 #include <kvs/Math>
+#include <kvs/OpenMP>
 #include <kvs/PointObject>
 
 
+namespace
+{
+
+/// Max. number of the particle samples shaded at once.
+const size_t TileSize = 256;
+
+/*===========================================================================*/
+/**
+ *  @brief  Shading function without shading.
+ */
+/*===========================================================================*/
+struct NoShading
+{
+    static const bool Shaded = false;
+
+    const kvs::RGBColor operator ()( const kvs::RGBColor& color, const kvs::Vec3&, const kvs::Vec3& ) const
+    {
+        return color;
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Shading function of the shading model called without the virtual dispatch.
+ */
+/*===========================================================================*/
+template <typename Model>
+struct ModelShading
+{
+    static const bool Shaded = true;
+    const Model* model;
+
+    ModelShading( const kvs::Shader::ShadingModel* shader ): model( static_cast<const Model*>( shader ) ) {}
+
+    const kvs::RGBColor operator ()( const kvs::RGBColor& color, const kvs::Vec3& vertex, const kvs::Vec3& normal ) const
+    {
+        return model->Model::shadedColor( color, vertex, normal );
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Shading function of the shading model called virtually.
+ */
+/*===========================================================================*/
+struct VirtualShading
+{
+    static const bool Shaded = true;
+    const kvs::Shader::ShadingModel* model;
+
+    VirtualShading( const kvs::Shader::ShadingModel* shader ): model( shader ) {}
+
+    const kvs::RGBColor operator ()( const kvs::RGBColor& color, const kvs::Vec3& vertex, const kvs::Vec3& normal ) const
+    {
+        return model->shadedColor( color, vertex, normal );
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Attributes of the particle samples in the structure-of-arrays form.
+ */
+/*===========================================================================*/
+struct Tile
+{
+    kvs::Real32 vx[ TileSize ], vy[ TileSize ], vz[ TileSize ]; ///< coordinates
+    kvs::Real32 nx[ TileSize ], ny[ TileSize ], nz[ TileSize ]; ///< normal vectors
+    kvs::UInt8 r[ TileSize ], g[ TileSize ], b[ TileSize ]; ///< colors (source and shaded)
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Resolves the sub-pixel samples of the particle buffer to the image.
+ *  @param  shading [in] shading function
+ *  @param  buffer [in] pointer to the particle buffer
+ *  @param  color [out] pointer to the color data
+ *  @param  depth [out] pointer to the depth data
+ *
+ *  Each row of the pixels is resolved by a thread. The occupied samples of
+ *  the row are compacted, gathered to the tiles and shaded, and then summed
+ *  up to the pixels in the same order as the sub-pixels are scanned, so that
+ *  the image does not depend on the number of threads.
+ */
+/*===========================================================================*/
+template <typename Shading>
+void Resolve(
+    const Shading& shading,
+    const kvs::ParticleBuffer* buffer,
+    kvs::ValueArray<kvs::UInt8>* color,
+    kvs::ValueArray<kvs::Real32>* depth )
+{
+    const kvs::PointObject* point = buffer->pointObject();
+    const kvs::UInt32* index_buffer = buffer->indexBuffer().data();
+    const kvs::Real32* depth_buffer = buffer->depthBuffer().data();
+    const size_t width = buffer->width();
+    const size_t height = buffer->height();
+    const size_t level = buffer->subpixelLevel();
+    const size_t bw = width * level;
+
+    const float inv_ssize = 1.0f / ( level * level );
+    const float normalize_alpha = 255.0f * inv_ssize;
+
+    KVS_OMP_PARALLEL()
+    {
+        std::vector<float> R( width ), G( width ), B( width ), D( width );
+        std::vector<size_t> npoints( width );
+        std::vector<kvs::UInt32> samples; // occupied sample indices in the row
+        std::vector<kvs::UInt32> pixels; // pixel x of the samples
+        samples.reserve( bw * level );
+        pixels.reserve( bw * level );
+        ::Tile tile;
+
+        KVS_OMP_FOR( schedule(dynamic) )
+        for ( size_t py = 0; py < height; py++ )
+        {
+            std::fill( R.begin(), R.end(), 0.0f );
+            std::fill( G.begin(), G.end(), 0.0f );
+            std::fill( B.begin(), B.end(), 0.0f );
+            std::fill( D.begin(), D.end(), 0.0f );
+            std::fill( npoints.begin(), npoints.end(), 0 );
+
+            // Compact the occupied samples.
+            samples.clear();
+            pixels.clear();
+            for ( size_t by = py * level; by < ( py + 1 ) * level; by++ )
+            {
+                const size_t bindex_start = bw * by;
+                for ( size_t bx = 0; bx < bw; bx++ )
+                {
+                    const size_t bindex = bindex_start + bx;
+                    if ( depth_buffer[ bindex ] > 0.0f )
+                    {
+                        const size_t px = bx / level;
+                        D[ px ] = kvs::Math::Max( D[ px ], depth_buffer[ bindex ] );
+                        npoints[ px ]++;
+                        samples.push_back( static_cast<kvs::UInt32>( bindex ) );
+                        pixels.push_back( static_cast<kvs::UInt32>( px ) );
+                    }
+                }
+            }
+
+            const size_t nsamples = samples.size();
+            for ( size_t start = 0; start < nsamples; start += ::TileSize )
+            {
+                const size_t n = kvs::Math::Min( ::TileSize, nsamples - start );
+
+                // Gather the attributes.
+                for ( size_t i = 0; i < n; i++ )
+                {
+                    const size_t index = index_buffer[ samples[ start + i ] ];
+                    const kvs::RGBColor c = point->decodedColor( index );
+                    tile.r[i] = c.r();
+                    tile.g[i] = c.g();
+                    tile.b[i] = c.b();
+                    if ( Shading::Shaded )
+                    {
+                        const kvs::Vec3 v = point->decodedCoord( index );
+                        const kvs::Vec3 nv = point->decodedNormal( index );
+                        tile.vx[i] = v.x(); tile.vy[i] = v.y(); tile.vz[i] = v.z();
+                        tile.nx[i] = nv.x(); tile.ny[i] = nv.y(); tile.nz[i] = nv.z();
+                    }
+                }
+
+                // Shade the samples.
+                if ( Shading::Shaded )
+                {
+                    for ( size_t i = 0; i < n; i++ )
+                    {
+                        const kvs::RGBColor c = shading(
+                            kvs::RGBColor( tile.r[i], tile.g[i], tile.b[i] ),
+                            kvs::Vec3( tile.vx[i], tile.vy[i], tile.vz[i] ),
+                            kvs::Vec3( tile.nx[i], tile.ny[i], tile.nz[i] ) );
+                        tile.r[i] = c.r();
+                        tile.g[i] = c.g();
+                        tile.b[i] = c.b();
+                    }
+                }
+
+                // Accumulate the colors to the pixels.
+                for ( size_t i = 0; i < n; i++ )
+                {
+                    const size_t px = pixels[ start + i ];
+                    R[ px ] += tile.r[i];
+                    G[ px ] += tile.g[i];
+                    B[ px ] += tile.b[i];
+                }
+            }
+
+            for ( size_t px = 0; px < width; px++ )
+            {
+                const size_t pindex = py * width + px;
+                const size_t pindex4 = pindex * 4;
+                const float r = R[ px ] * inv_ssize;
+                const float g = G[ px ] * inv_ssize;
+                const float b = B[ px ] * inv_ssize;
+                if ( Shading::Shaded )
+                {
+                    (*color)[ pindex4 + 0 ] = static_cast<kvs::UInt8>( kvs::Math::Min( r, 255.0f ) + 0.5f );
+                    (*color)[ pindex4 + 1 ] = static_cast<kvs::UInt8>( kvs::Math::Min( g, 255.0f ) + 0.5f );
+                    (*color)[ pindex4 + 2 ] = static_cast<kvs::UInt8>( kvs::Math::Min( b, 255.0f ) + 0.5f );
+                }
+                else
+                {
+                    (*color)[ pindex4 + 0 ] = static_cast<kvs::UInt8>( r );
+                    (*color)[ pindex4 + 1 ] = static_cast<kvs::UInt8>( g );
+                    (*color)[ pindex4 + 2 ] = static_cast<kvs::UInt8>( b );
+                }
+                (*color)[ pindex4 + 3 ] = static_cast<kvs::UInt8>( npoints[ px ] * normalize_alpha );
+                (*depth)[ pindex ] = ( npoints[ px ] == 0 ) ? 1.0f : D[ px ];
+            }
+        }
+    }
+}
+
+} // end of namespace
+
+
 namespace kvs
 {
 
@@ -145,67 +366,31 @@ void ParticleBuffer::createImage(
  *  @brief  Creates the rendering image with shading.
  *  @param  color [in] pointer to color data
  *  @param  depth [in] pointer to depth data
+ *
+ *  The shading function of the built-in shading models is called without the
+ *  virtual dispatch, and the other shading models are called virtually.
  */
 /*===========================================================================*/
 void ParticleBuffer::create_image_with_shading(
     kvs::ValueArray<kvs::UInt8>* color,
     kvs::ValueArray<kvs::Real32>* depth )
 {
-    const kvs::Real32* point_coords = m_ref_point_object->coords().data();
-    const kvs::UInt8* point_color = m_ref_point_object->colors().data();
-    const kvs::Real32* point_normal = m_ref_point_object->normals().data();
-
-    const float inv_ssize = 1.0f / ( m_subpixel_level * m_subpixel_level );
-    const float normalize_alpha = 255.0f * inv_ssize;
-
-    size_t pindex = 0;
-    size_t pindex4 = 0;
-    size_t by_start = 0;
-    const size_t bw = m_extended_width;
-    for( size_t py = 0; py < m_height; py++, by_start += m_subpixel_level )
+    const std::type_info& type = typeid( *m_ref_shader );
+    if ( type == typeid( kvs::Shader::Lambert ) )
     {
-        size_t bx_start = 0;
-        for( size_t px = 0; px < m_width; px++, pindex++, pindex4 += 4, bx_start += m_subpixel_level )
-        {
-            float R = 0.0f;
-            float G = 0.0f;
-            float B = 0.0f;
-            float D = 0.0f;
-            size_t npoints = 0;
-            for( size_t by = by_start; by < by_start + m_subpixel_level; by++ )
-            {
-                const size_t bindex_start = bw * by;
-                for( size_t bx = bx_start; bx < bx_start + m_subpixel_level; bx++ )
-                {
-                    const size_t bindex = bindex_start + bx;
-                    if( m_depth_buffer[bindex] > 0.0f )
-                    {
-                        const size_t point_index3 = 3 * m_index_buffer[ bindex ];
-
-                        const kvs::Vector3f vertex( point_coords + point_index3 );
-                        const kvs::Vector3f normal( point_normal + point_index3 );
-                        kvs::RGBColor color( point_color + point_index3 );
-                        color = m_ref_shader->shadedColor( color, vertex, normal );
-                        R += color.r();
-                        G += color.g();
-                        B += color.b();
-                        D = kvs::Math::Max( D, m_depth_buffer[ bindex ] );
-
-                        npoints++;
-                    }
-                }
-            }
-
-            R *= inv_ssize;
-            G *= inv_ssize;
-            B *= inv_ssize;
-
-            (*color)[ pindex4 + 0 ] = static_cast<kvs::UInt8>( kvs::Math::Min( R, 255.0f ) + 0.5f );
-            (*color)[ pindex4 + 1 ] = static_cast<kvs::UInt8>( kvs::Math::Min( G, 255.0f ) + 0.5f );
-            (*color)[ pindex4 + 2 ] = static_cast<kvs::UInt8>( kvs::Math::Min( B, 255.0f ) + 0.5f );
-            (*color)[ pindex4 + 3 ] = static_cast<kvs::UInt8>( npoints * normalize_alpha );
-            (*depth)[ pindex ] = ( npoints == 0 ) ? 1.0f : D;
-        }
+        ::Resolve( ::ModelShading<kvs::Shader::Lambert>( m_ref_shader ), this, color, depth );
+    }
+    else if ( type == typeid( kvs::Shader::Phong ) )
+    {
+        ::Resolve( ::ModelShading<kvs::Shader::Phong>( m_ref_shader ), this, color, depth );
+    }
+    else if ( type == typeid( kvs::Shader::BlinnPhong ) )
+    {
+        ::Resolve( ::ModelShading<kvs::Shader::BlinnPhong>( m_ref_shader ), this, color, depth );
+    }
+    else
+    {
+        ::Resolve( ::VirtualShading( m_ref_shader ), this, color, depth );
     }
 }
 
@@ -220,55 +405,7 @@ void ParticleBuffer::create_image_without_shading(
     kvs::ValueArray<kvs::UInt8>* color,
     kvs::ValueArray<kvs::Real32>* depth )
 {
-    const kvs::UInt8* point_color = m_ref_point_object->colors().data();
-
-    const float inv_ssize = 1.0f / ( m_subpixel_level * m_subpixel_level );
-    const float normalize_alpha = 255.0f * inv_ssize;
-
-    size_t pindex = 0;
-    size_t pindex4 = 0;
-    size_t by_start = 0;
-    const size_t bw = m_extended_width;
-    for( size_t py = 0; py < m_height; py++, by_start += m_subpixel_level )
-    {
-        size_t bx_start = 0;
-        for( size_t px = 0; px < m_width; px++, pindex++, pindex4 += 4, bx_start += m_subpixel_level )
-        {
-            float R = 0.0f;
-            float G = 0.0f;
-            float B = 0.0f;
-            float D = 0.0f;
-            size_t npoints = 0;
-            for( size_t by = by_start; by < by_start + m_subpixel_level; by++ )
-            {
-                const size_t bindex_start = bw * by;
-                for( size_t bx = bx_start; bx < bx_start + m_subpixel_level; bx++ )
-                {
-                    const size_t bindex = bindex_start + bx;
-                    if( m_depth_buffer[bindex] > 0.0f )
-                    {
-                        const size_t point_index3 = 3 * m_index_buffer[ bindex ];
-
-                        R += point_color[ point_index3 + 0 ];
-                        G += point_color[ point_index3 + 1 ];
-                        B += point_color[ point_index3 + 2 ];
-                        D = kvs::Math::Max( D, m_depth_buffer[ bindex ] );
-                        npoints++;
-                    }
-                }
-            }
-
-            R *= inv_ssize;
-            G *= inv_ssize;
-            B *= inv_ssize;
-
-            (*color)[ pindex4 + 0 ] = static_cast<kvs::UInt8>(R);
-            (*color)[ pindex4 + 1 ] = static_cast<kvs::UInt8>(G);
-            (*color)[ pindex4 + 2 ] = static_cast<kvs::UInt8>(B);
-            (*color)[ pindex4 + 3 ] = static_cast<kvs::UInt8>( npoints * normalize_alpha );
-            (*depth)[ pindex ] = ( npoints == 0 ) ? 1.0f : D;
-        }
-    }
+    ::Resolve( ::NoShading(), this, color, depth );
 }
 
 } // end of namesapce kvs
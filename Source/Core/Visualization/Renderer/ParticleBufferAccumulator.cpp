@@ -192,14 +192,14 @@ void ParticleBufferAccumulator::createImage(
                         const kvs::PointObject*            object   = object_list[id];
                         const kvs::ParticleVolumeRenderer* renderer = renderer_list[id];
 
-                        const size_t point_index3 = 3 * m_index_buffer[bindex];
+                        const size_t point_index = m_index_buffer[bindex];
 
-                        kvs::RGBColor color( object->colors().data() + point_index3 );
+                        kvs::RGBColor color( object->decodedColor( point_index ) );
                         if( renderer->isEnabledShading() )
                         {
                             const kvs::Shader::ShadingModel* shader = renderer->particleBuffer()->shader();
-                            const kvs::Vector3f vertex( object->coords().data() + point_index3 );
-                            const kvs::Vector3f normal( object->normals().data() + point_index3 );
+                            const kvs::Vector3f vertex( object->decodedCoord( point_index ) );
+                            const kvs::Vector3f normal( object->decodedNormal( point_index ) );
                             color = shader->shadedColor( color, vertex, normal );
                         }
 
@@ -32,9 +32,10 @@ namespace
 /*===========================================================================*/
 kvs::ValueArray<kvs::UInt8> VertexColors( const kvs::PointObject* point )
 {
-    if ( point->numberOfVertices() == point->numberOfColors() ) return point->colors();
+    const size_t nvertices = point->isEncoded() ? point->numberOfEncodedVertices() : point->numberOfVertices();
+    const kvs::ValueArray<kvs::UInt8> vertex_colors = point->decodedColors();
+    if ( vertex_colors.size() == nvertices * 3 ) return vertex_colors;
 
-    const size_t nvertices = point->numberOfVertices();
     const kvs::RGBColor color = point->color();
 
     kvs::ValueArray<kvs::UInt8> colors( nvertices * 3 );
@@ -93,7 +94,7 @@ PointRenderer::~PointRenderer()
 void PointRenderer::exec( kvs::ObjectBase* object, kvs::Camera* camera, kvs::Light* light )
 {
     kvs::PointObject* point = kvs::PointObject::DownCast( object );
-    m_has_normal = point->numberOfNormals() > 0;
+    m_has_normal = point->numberOfNormals() > 0 || point->numberOfEncodedNormals() > 0;
     if ( !m_has_normal ) setEnabledShading( false );
 
     BaseClass::startTimer();
@@ -143,7 +144,7 @@ void PointRenderer::exec( kvs::ObjectBase* object, kvs::Camera* camera, kvs::Lig
         m_shader_program.setUniform( "ModelViewProjectionMatrix", PM );
         m_shader_program.setUniform( "NormalMatrix", N );
 
-        const size_t nvertices = point->numberOfVertices();
+        const size_t nvertices = point->isEncoded() ? point->numberOfEncodedVertices() : point->numberOfVertices();
         const size_t coord_size = nvertices * 3 * sizeof( kvs::Real32 );
         const size_t color_size = nvertices * 3 * sizeof( kvs::UInt8 );
 
@@ -225,9 +226,9 @@ void PointRenderer::create_shader_program()
 /*===========================================================================*/
 void PointRenderer::create_buffer_object( const kvs::PointObject* point )
 {
-    kvs::ValueArray<kvs::Real32> coords = point->coords();
+    kvs::ValueArray<kvs::Real32> coords = point->decodedCoords();
     kvs::ValueArray<kvs::UInt8> colors = ::VertexColors( point );
-    kvs::ValueArray<kvs::Real32> normals = point->normals();
+    kvs::ValueArray<kvs::Real32> normals = point->decodedNormals();
 
     const size_t coord_size = coords.byteSize();
     const size_t color_size = colors.byteSize();
@@ -16,6 +16,7 @@
 #include <cstring>
 #include <kvs/Math>
 #include <kvs/Type>
+#include <kvs/TypeDispatch>
 #include <kvs/Message>
 #include <kvs/StructuredVolumeObject>
 #include <kvs/TrilinearInterpolator>
@@ -72,6 +73,26 @@ RayCastingRenderer::RayCastingRenderer( const ShadingType shader ):
     BaseClass::setShader( shader );
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Functor to call rasterize with the value type of the volume.
+ */
+/*===========================================================================*/
+struct RayCastingRenderer::Rasterizer
+{
+    RayCastingRenderer* renderer;
+    const kvs::StructuredVolumeObject* volume;
+    const kvs::Camera* camera;
+    const kvs::Light* light;
+    Rasterizer(
+        RayCastingRenderer* r,
+        const kvs::StructuredVolumeObject* v,
+        const kvs::Camera* c,
+        const kvs::Light* l ):
+        renderer( r ), volume( v ), camera( c ), light( l ) {}
+    template <typename T> void operator ()( kvs::TypeTag<T> ) const { renderer->rasterize<T>( volume, camera, light ); }
+};
+
 /*===========================================================================*/
 /**
  *  @brief  Executes the rendering process.
@@ -107,33 +128,13 @@ void RayCastingRenderer::exec(
     if ( !volume->hasMinMaxValues() ) volume->updateMinMaxValues();
     const float min_value = static_cast<float>( volume->minValue() );
     const float max_value = static_cast<float>( volume->maxValue() );
-    const std::type_info& type = volume->values().typeInfo()->type();
-    if(      type == typeid(kvs::UInt8)  )
-    {
-        if ( !BaseClass::transferFunction().hasRange() ) BaseClass::transferFunction().setRange( 0, 255 );
-        this->rasterize<kvs::UInt8>( volume, camera, light );
-    }
-    else if( type == typeid(kvs::UInt16) )
+    if ( !BaseClass::transferFunction().hasRange() )
     {
-        if ( !BaseClass::transferFunction().hasRange() ) BaseClass::transferFunction().setRange( min_value, max_value );
-        this->rasterize<kvs::UInt16>( volume, camera, light );
+        if ( volume->values().typeID() == kvs::Type::TypeUInt8 ) BaseClass::transferFunction().setRange( 0, 255 );
+        else BaseClass::transferFunction().setRange( min_value, max_value );
     }
-    else if( type == typeid(kvs::Int16) )
-    {
-        if ( !BaseClass::transferFunction().hasRange() ) BaseClass::transferFunction().setRange( min_value, max_value );
-        this->rasterize<kvs::Int16>( volume, camera, light );
-    }
-    else if( type == typeid(kvs::Real32) )
-    {
-        if ( !BaseClass::transferFunction().hasRange() ) BaseClass::transferFunction().setRange( min_value, max_value );
-        this->rasterize<kvs::Real32>( volume, camera, light );
-    }
-    else if( type == typeid(kvs::Real64) )
-    {
-        if ( !BaseClass::transferFunction().hasRange() ) BaseClass::transferFunction().setRange( min_value, max_value );
-        this->rasterize<kvs::Real64>( volume, camera, light );
-    }
-    else
+
+    if ( !kvs::DispatchType( volume->values().typeID(), Rasterizer( this, volume, camera, light ) ) )
     {
         kvsMessageError( "Not supported data type '%s'.",
                          volume->values().typeInfo()->typeName() );
@@ -319,34 +320,4 @@ void RayCastingRenderer::rasterize(
     kvs::OpenGL::Finish();
 }
 
-template
-void RayCastingRenderer::rasterize<kvs::UInt8>(
-    const kvs::StructuredVolumeObject* volume,
-    const kvs::Camera* camera,
-    const kvs::Light* light );
-
-template
-void RayCastingRenderer::rasterize<kvs::UInt16>(
-    const kvs::StructuredVolumeObject* volume,
-    const kvs::Camera* camera,
-    const kvs::Light* light );
-
-template
-void RayCastingRenderer::rasterize<kvs::Int16>(
-    const kvs::StructuredVolumeObject* volume,
-    const kvs::Camera* camera,
-    const kvs::Light* light );
-
-template
-void RayCastingRenderer::rasterize<kvs::Real32>(
-    const kvs::StructuredVolumeObject* volume,
-    const kvs::Camera* camera,
-    const kvs::Light* light );
-
-template
-void RayCastingRenderer::rasterize<kvs::Real64>(
-    const kvs::StructuredVolumeObject* volume,
-    const kvs::Camera* camera,
-    const kvs::Light* light );
-
 } // end of namespace kvs
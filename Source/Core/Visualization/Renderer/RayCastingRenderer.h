@@ -58,6 +58,7 @@ public:
 
 private:
 
+    struct Rasterizer;
     template <typename T>
     void rasterize(
         const kvs::StructuredVolumeObject* volume,
@@ -19,35 +19,6 @@
 #include <kvs/Coordinate>
 
 
-#define kvsShaderAmbientTerm( ka ) \
-    ka
-
-#define kvsShaderDiffuseTerm( kd, N, L ) \
-    kd * kvs::Math::Max( N.dot( L ), 0.0f )
-
-#define kvsShaderSpecularTerm( ks, S, R, V ) \
-    Ks * std::pow( kvs::Math::Max( R.dot( V ), 0.0f ), S )
-
-
-namespace
-{
-
-inline const kvs::RGBColor Shade(
-    const kvs::RGBColor& color,
-    const float Ia,
-    const float Id,
-    const float Is )
-{
-    const float I1 = Ia + Id;
-    const float I2 = Is * 255.0f;
-    const kvs::UInt8 r = static_cast<kvs::UInt8>( kvs::Math::Min( color.r() * I1 + I2, 255.0f ) + 0.5f );
-    const kvs::UInt8 g = static_cast<kvs::UInt8>( kvs::Math::Min( color.g() * I1 + I2, 255.0f ) + 0.5f );
-    const kvs::UInt8 b = static_cast<kvs::UInt8>( kvs::Math::Min( color.b() * I1 + I2, 255.0f ) + 0.5f );
-    return kvs::RGBColor( r, g, b );
-}
-
-} // end of namespace
-
 namespace kvs
 {
 
@@ -132,31 +103,6 @@ Shader::Type Shader::Lambert::type() const
     return Shader::LambertShading;
 }
 
-/*===========================================================================*/
-/**
- *  @brief  Returns shaded color.
- *  @param  color [in] source color
- *  @param  vertex [in] vertex position
- *  @param  normal [in] normal vector
- *  @return shaded color
- */
-/*===========================================================================*/
-const kvs::RGBColor Shader::Lambert::shadedColor(
-    const kvs::RGBColor& color,
-    const kvs::Vector3f& vertex,
-    const kvs::Vector3f& normal ) const
-{
-    // Light vector L and normal vector N.
-    const kvs::Vector3f L = ( light_position - vertex ).normalized();
-    const kvs::Vector3f N = normal.normalized();
-
-    // Intensity values.
-    const float Ia = kvsShaderAmbientTerm( Ka );
-    const float Id = kvsShaderDiffuseTerm( Kd, N, L );
-
-    return color * ( Ia + Id );
-}
-
 /*==========================================================================*/
 /**
  *  Get the attenuation value.
@@ -255,34 +201,6 @@ Shader::Type Shader::Phong::type() const
     return Shader::PhongShading;
 }
 
-/*===========================================================================*/
-/**
- *  @brief  Returns shaded color.
- *  @param  color [in] source color
- *  @param  vertex [in] vertex position
- *  @param  normal [in] normal vector
- *  @return shaded color
- */
-/*===========================================================================*/
-const kvs::RGBColor Shader::Phong::shadedColor(
-    const kvs::RGBColor& color,
-    const kvs::Vector3f& vertex,
-    const kvs::Vector3f& normal ) const
-{
-    // Light vector L, normal vector N and reflection vector R.
-    const kvs::Vector3f V = ( camera_position - vertex ).normalized();
-    const kvs::Vector3f L = ( light_position - vertex ).normalized();
-    const kvs::Vector3f N = normal.normalized();
-    const kvs::Vector3f R = 2.0f * N.dot( L ) * N - L;
-
-    // Intensity values.
-    const float Ia = kvsShaderAmbientTerm( Ka );
-    const float Id = kvsShaderDiffuseTerm( Kd, N, L );
-    const float Is = kvsShaderSpecularTerm( ks, S, R, V );
-
-    return ::Shade( color, Ia, Id, Is );
-}
-
 /*==========================================================================*/
 /**
  *  Get the attenuation value.
@@ -381,34 +299,6 @@ Shader::Type Shader::BlinnPhong::type() const
     return Shader::BlinnPhongShading;
 }
 
-/*===========================================================================*/
-/**
- *  @brief  Returns shaded color.
- *  @param  color [in] source color
- *  @param  vertex [in] vertex position
- *  @param  normal [in] normal vector
- *  @return shaded color
- */
-/*===========================================================================*/
-const kvs::RGBColor Shader::BlinnPhong::shadedColor(
-    const kvs::RGBColor& color,
-    const kvs::Vector3f& vertex,
-    const kvs::Vector3f& normal ) const
-{
-    // Camera vector V, light vector L, halfway vector H and normal vector N.
-    const kvs::Vector3f V = ( camera_position - vertex ).normalized();
-    const kvs::Vector3f L = ( light_position - vertex ).normalized();
-    const kvs::Vector3f H = ( V + L ).normalized();
-    const kvs::Vector3f N = normal.normalized();
-
-    // Intensity values.
-    const float Ia = kvsShaderAmbientTerm( Ka );
-    const float Id = kvsShaderDiffuseTerm( Kd, N, L );
-    const float Is = kvsShaderSpecularTerm( ks, S, H, N );
-
-    return ::Shade( color, Ia, Id, Is );
-}
-
 /*==========================================================================*/
 /**
  *  Get the attenuation value.
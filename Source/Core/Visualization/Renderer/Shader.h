@@ -15,7 +15,10 @@
 #ifndef KVS__SHADER_H_INCLUDE
 #define KVS__SHADER_H_INCLUDE
 
+#include <cmath>
 #include <kvs/Vector3>
+#include <kvs/RGBColor>
+#include <kvs/Math>
 #include <kvs/Camera>
 #include <kvs/Light>
 #include <kvs/ObjectBase>
@@ -60,6 +63,10 @@ public:
             const kvs::Vector3f& vertex,
             const kvs::Vector3f& normal ) const = 0;
         virtual float attenuation( const kvs::Vector3f& vertex, const kvs::Vector3f& gradient ) const = 0;
+
+    protected:
+
+        static const kvs::RGBColor Shade( const kvs::RGBColor& color, const float Ia, const float Id, const float Is );
     };
 
 public:
@@ -115,6 +122,115 @@ public:
     };
 };
 
+/*===========================================================================*/
+/**
+ *  @brief  Returns the color shaded by the ambient, diffuse and specular terms.
+ *  @param  color [in] source color
+ *  @param  Ia [in] ambient term
+ *  @param  Id [in] diffuse term
+ *  @param  Is [in] specular term
+ *  @return shaded color
+ */
+/*===========================================================================*/
+inline const kvs::RGBColor Shader::Base::Shade(
+    const kvs::RGBColor& color,
+    const float Ia,
+    const float Id,
+    const float Is )
+{
+    const float I1 = Ia + Id;
+    const float I2 = Is * 255.0f;
+    const kvs::UInt8 r = static_cast<kvs::UInt8>( kvs::Math::Min( color.r() * I1 + I2, 255.0f ) + 0.5f );
+    const kvs::UInt8 g = static_cast<kvs::UInt8>( kvs::Math::Min( color.g() * I1 + I2, 255.0f ) + 0.5f );
+    const kvs::UInt8 b = static_cast<kvs::UInt8>( kvs::Math::Min( color.b() * I1 + I2, 255.0f ) + 0.5f );
+    return kvs::RGBColor( r, g, b );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns shaded color.
+ *  @param  color [in] source color
+ *  @param  vertex [in] vertex position
+ *  @param  normal [in] normal vector
+ *  @return shaded color
+ *
+ *  The shading functions are defined inline so that the callers which know
+ *  the shader type can call them without the virtual dispatch, for example
+ *  shader->Shader::Lambert::shadedColor( color, vertex, normal ).
+ */
+/*===========================================================================*/
+inline const kvs::RGBColor Shader::Lambert::shadedColor(
+    const kvs::RGBColor& color,
+    const kvs::Vector3f& vertex,
+    const kvs::Vector3f& normal ) const
+{
+    // Light vector L and normal vector N.
+    const kvs::Vector3f L = ( light_position - vertex ).normalized();
+    const kvs::Vector3f N = normal.normalized();
+
+    // Intensity values.
+    const float Ia = Ka;
+    const float Id = Kd * kvs::Math::Max( N.dot( L ), 0.0f );
+
+    return color * ( Ia + Id );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns shaded color.
+ *  @param  color [in] source color
+ *  @param  vertex [in] vertex position
+ *  @param  normal [in] normal vector
+ *  @return shaded color
+ */
+/*===========================================================================*/
+inline const kvs::RGBColor Shader::Phong::shadedColor(
+    const kvs::RGBColor& color,
+    const kvs::Vector3f& vertex,
+    const kvs::Vector3f& normal ) const
+{
+    // Light vector L, normal vector N and reflection vector R.
+    const kvs::Vector3f V = ( camera_position - vertex ).normalized();
+    const kvs::Vector3f L = ( light_position - vertex ).normalized();
+    const kvs::Vector3f N = normal.normalized();
+    const kvs::Vector3f R = 2.0f * N.dot( L ) * N - L;
+
+    // Intensity values.
+    const float Ia = Ka;
+    const float Id = Kd * kvs::Math::Max( N.dot( L ), 0.0f );
+    const float Is = Ks * std::pow( kvs::Math::Max( R.dot( V ), 0.0f ), S );
+
+    return Shade( color, Ia, Id, Is );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns shaded color.
+ *  @param  color [in] source color
+ *  @param  vertex [in] vertex position
+ *  @param  normal [in] normal vector
+ *  @return shaded color
+ */
+/*===========================================================================*/
+inline const kvs::RGBColor Shader::BlinnPhong::shadedColor(
+    const kvs::RGBColor& color,
+    const kvs::Vector3f& vertex,
+    const kvs::Vector3f& normal ) const
+{
+    // Camera vector V, light vector L, halfway vector H and normal vector N.
+    const kvs::Vector3f V = ( camera_position - vertex ).normalized();
+    const kvs::Vector3f L = ( light_position - vertex ).normalized();
+    const kvs::Vector3f H = ( V + L ).normalized();
+    const kvs::Vector3f N = normal.normalized();
+
+    // Intensity values.
+    const float Ia = Ka;
+    const float Id = Kd * kvs::Math::Max( N.dot( L ), 0.0f );
+    const float Is = Ks * std::pow( kvs::Math::Max( H.dot( N ), 0.0f ), S );
+
+    return Shade( color, Ia, Id, Is );
+}
+
 } // end of namespace kvs
 
 #endif // KVS__SHADER_H_INCLUDE
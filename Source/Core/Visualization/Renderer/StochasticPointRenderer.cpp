@@ -47,9 +47,10 @@ int RandomNumber()
 /*===========================================================================*/
 kvs::ValueArray<kvs::UInt8> VertexColors( const kvs::PointObject* point )
 {
-    if ( point->numberOfVertices() == point->numberOfColors() ) return point->colors();
+    const size_t nvertices = point->isEncoded() ? point->numberOfEncodedVertices() : point->numberOfVertices();
+    const kvs::ValueArray<kvs::UInt8> vertex_colors = point->decodedColors();
+    if ( vertex_colors.size() == nvertices * 3 ) return vertex_colors;
 
-    const size_t nvertices = point->numberOfVertices();
     const kvs::RGBColor color = point->color();
 
     kvs::ValueArray<kvs::UInt8> colors( nvertices * 3 );
@@ -125,7 +126,7 @@ void StochasticPointRenderer::Engine::release()
 void StochasticPointRenderer::Engine::create( kvs::ObjectBase* object, kvs::Camera* camera, kvs::Light* light )
 {
     kvs::PointObject* point = kvs::PointObject::DownCast( object );
-    m_has_normal = point->numberOfNormals() > 0;
+    m_has_normal = point->numberOfNormals() > 0 || point->numberOfEncodedNormals() > 0;
     if ( !m_has_normal ) setEnabledShading( false );
 
     attachObject( object );
@@ -194,7 +195,7 @@ void StochasticPointRenderer::Engine::draw( kvs::ObjectBase* object, kvs::Camera
         const kvs::Vec2 random_offset( offset_x, offset_y );
         m_shader_program.setUniform( "random_offset", random_offset );
 
-        const size_t nvertices = point->numberOfVertices();
+        const size_t nvertices = point->isEncoded() ? point->numberOfEncodedVertices() : point->numberOfVertices();
         const size_t index_size = nvertices * 2 * sizeof( kvs::UInt16 );
         const size_t coord_size = nvertices * 3 * sizeof( kvs::Real32 );
         const size_t color_size = nvertices * 3 * sizeof( kvs::UInt8 );
@@ -281,7 +282,7 @@ void StochasticPointRenderer::Engine::create_shader_program()
 /*===========================================================================*/
 void StochasticPointRenderer::Engine::create_buffer_object( const kvs::PointObject* point )
 {
-    const size_t nvertices = point->numberOfVertices();
+    const size_t nvertices = point->isEncoded() ? point->numberOfEncodedVertices() : point->numberOfVertices();
     kvs::ValueArray<kvs::UInt16> indices( nvertices * 2 );
     for ( size_t i = 0; i < nvertices; i++ )
     {
@@ -289,9 +290,9 @@ void StochasticPointRenderer::Engine::create_buffer_object( const kvs::PointObje
         indices[ 2 * i + 0 ] = static_cast<kvs::UInt16>( ( count ) % randomTextureSize() );
         indices[ 2 * i + 1 ] = static_cast<kvs::UInt16>( ( count / randomTextureSize() ) % randomTextureSize() );
     }
-    kvs::ValueArray<kvs::Real32> coords = point->coords();
+    kvs::ValueArray<kvs::Real32> coords = point->decodedCoords();
     kvs::ValueArray<kvs::UInt8> colors = ::VertexColors( point );
-    kvs::ValueArray<kvs::Real32> normals = point->normals();
+    kvs::ValueArray<kvs::Real32> normals = point->decodedNormals();
 
     const size_t index_size = indices.byteSize();
     const size_t coord_size = coords.byteSize();
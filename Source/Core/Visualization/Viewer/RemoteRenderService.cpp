@@ -0,0 +1,606 @@
+/*****************************************************************************/
+/**
+ *  @file   RemoteRenderService.cpp
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "RemoteRenderService.h"
+#include <cstring>
+#include <kvs/Message>
+#include <kvs/Math>
+#include <kvs/OpenGL>
+#include <kvs/OpenMP>
+#include <kvs/Scene>
+#include <kvs/Camera>
+#include <kvs/IDManager>
+#include <kvs/RendererManager>
+#include <kvs/VolumeRendererBase>
+#include <kvs/RayCastingRenderer>
+#include <kvs/ColorMap>
+#include <kvs/OpacityMap>
+#include <kvs/FastCompressor>
+
+
+namespace
+{
+
+typedef std::vector<kvs::UInt8> Buffer;
+
+/*===========================================================================*/
+/**
+ *  @brief  Appends the byte to the buffer.
+ *  @param  buffer [in/out] buffer
+ *  @param  value [in] byte
+ */
+/*===========================================================================*/
+inline void Put8( Buffer* buffer, const kvs::UInt8 value )
+{
+    buffer->push_back( value );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Appends the integer in the network byte order to the buffer.
+ *  @param  buffer [in/out] buffer
+ *  @param  value [in] integer
+ */
+/*===========================================================================*/
+inline void Put32( Buffer* buffer, const kvs::UInt32 value )
+{
+    const kvs::UInt32 v = htonl( value );
+    const kvs::UInt8* p = reinterpret_cast<const kvs::UInt8*>( &v );
+    buffer->insert( buffer->end(), p, p + sizeof( v ) );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reader of the message.
+ */
+/*===========================================================================*/
+class Reader
+{
+    const kvs::UInt8* m_p; ///< current position
+    const kvs::UInt8* m_end; ///< end of the message
+
+public:
+
+    Reader( const kvs::MessageBlock& message ):
+        m_p( static_cast<const kvs::UInt8*>( message.data() ) ),
+        m_end( m_p + message.size() ) {}
+
+    size_t remain() const { return m_end - m_p; }
+
+    bool get( kvs::UInt8* value )
+    {
+        if ( this->remain() < 1 ) { return false; }
+        *value = *m_p++;
+        return true;
+    }
+
+    bool get( kvs::UInt32* value )
+    {
+        if ( this->remain() < sizeof( kvs::UInt32 ) ) { return false; }
+        std::memcpy( value, m_p, sizeof( kvs::UInt32 ) );
+        *value = ntohl( *value );
+        m_p += sizeof( kvs::UInt32 );
+        return true;
+    }
+
+    bool get( kvs::Real32* value )
+    {
+        kvs::UInt32 bits = 0;
+        if ( !this->get( &bits ) ) { return false; }
+        std::memcpy( value, &bits, sizeof( kvs::Real32 ) );
+        return true;
+    }
+
+    bool get( kvs::Vec3* value )
+    {
+        return this->get( &(*value)[0] ) && this->get( &(*value)[1] ) && this->get( &(*value)[2] );
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if the tile differs between the frames.
+ *  @param  frame [in] RGB frame
+ *  @param  reference [in] RGB frame of the same size
+ *  @param  width [in] frame width
+ *  @param  x0, y0, x1, y1 [in] pixel range of the tile
+ *  @return true, if the tile has been changed
+ */
+/*===========================================================================*/
+bool IsChanged(
+    const kvs::UInt8* frame,
+    const kvs::UInt8* reference,
+    const size_t width,
+    const size_t x0, const size_t y0, const size_t x1, const size_t y1 )
+{
+    for ( size_t y = y0; y < y1; y++ )
+    {
+        const size_t offset = ( y * width + x0 ) * 3;
+        if ( std::memcmp( frame + offset, reference + offset, ( x1 - x0 ) * 3 ) != 0 ) { return true; }
+    }
+    return false;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Encodes the tile.
+ *  @param  frame [in] RGB frame
+ *  @param  width [in] frame width
+ *  @param  x0, y0, x1, y1 [in] pixel range of the tile
+ *  @param  encoded [out] codec (1 byte) and the data
+ *
+ *  The pixels are replaced by the difference from the left pixel, which is
+ *  zero in the flat regions, and compressed unless it is not smaller.
+ */
+/*===========================================================================*/
+void EncodeTile(
+    const kvs::UInt8* frame,
+    const size_t width,
+    const size_t x0, const size_t y0, const size_t x1, const size_t y1,
+    Buffer* encoded )
+{
+    const size_t row_size = ( x1 - x0 ) * 3;
+    Buffer delta( row_size * ( y1 - y0 ) );
+    kvs::UInt8* d = &delta[0];
+    for ( size_t y = y0; y < y1; y++ )
+    {
+        const kvs::UInt8* p = frame + ( y * width + x0 ) * 3;
+        d[0] = p[0]; d[1] = p[1]; d[2] = p[2];
+        for ( size_t i = 3; i < row_size; i++ ) { d[i] = static_cast<kvs::UInt8>( p[i] - p[i - 3] ); }
+        d += row_size;
+    }
+
+    encoded->resize( 1 + kvs::FastCompressor::MaxCompressedSize( delta.size() ) );
+    const size_t size = kvs::FastCompressor::Compress( &delta[0], delta.size(), &(*encoded)[1] );
+    if ( size < delta.size() )
+    {
+        (*encoded)[0] = 1;
+        encoded->resize( 1 + size );
+    }
+    else
+    {
+        (*encoded)[0] = 0;
+        std::memcpy( &(*encoded)[1], &delta[0], delta.size() );
+        encoded->resize( 1 + delta.size() );
+    }
+}
+
+} // end of namespace
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new RemoteRenderService class.
+ *  @param  scene [in] pointer to the scene
+ */
+/*===========================================================================*/
+RemoteRenderService::RemoteRenderService( kvs::Scene* scene ):
+    m_scene( scene ),
+    m_loop( this ),
+    m_tile_size( 64 ),
+    m_coarse_level( 3 ),
+    m_idle_time( 200.0 ),
+    m_camera_updated( false ),
+    m_tfunc_updated( false ),
+    m_interacting( false ),
+    m_interaction_ended( false ),
+    m_refine( false ),
+    m_width( 0 ),
+    m_height( 0 ),
+    m_frame_number( 0 ),
+    m_coarse( false ),
+    m_coarse_sent( false ),
+    m_encoding_time( 0.0 )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Destroys the RemoteRenderService class.
+ */
+/*===========================================================================*/
+RemoteRenderService::~RemoteRenderService()
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Listens to the port for the clients.
+ *  @param  port [in] port number
+ *  @return true, if the port is listened
+ */
+/*===========================================================================*/
+bool RemoteRenderService::listen( const int port )
+{
+    return m_loop.listen( port );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Processes the messages and sends the frame if needed.
+ *  @param  timeout [in] max. waiting time for the messages (NULL: until a message)
+ *  @return true, if a frame is sent
+ */
+/*===========================================================================*/
+bool RemoteRenderService::process( const kvs::SocketTimer* timeout )
+{
+    // Wait for the messages, but not beyond the pending full quality frame.
+    double wait_time = timeout ? timeout->value().tv_sec * 1000.0 + timeout->value().tv_usec / 1000.0 : -1.0;
+    if ( m_refine && !m_interacting )
+    {
+        m_idle_timer.stop();
+        const double remain = m_interaction_ended ? 0.0 : kvs::Math::Max( m_idle_time - m_idle_timer.msec(), 0.0 );
+        wait_time = wait_time < 0.0 ? remain : kvs::Math::Min( wait_time, remain );
+    }
+
+    const kvs::SocketTimer wait_timer( wait_time / 1000.0 );
+    if ( !m_loop.runOnce( wait_time < 0.0 ? NULL : &wait_timer ) ) { return false; }
+    if ( m_clients.empty() ) { return false; }
+
+    bool updated = false;
+    if ( m_camera_updated )
+    {
+        this->applyCamera( m_position, m_look_at, m_up );
+        m_camera_updated = false;
+        updated = true;
+    }
+
+    if ( m_tfunc_updated )
+    {
+        this->applyTransferFunction( m_tfunc );
+        m_tfunc_updated = false;
+        updated = true;
+    }
+
+    bool render = false;
+    if ( updated )
+    {
+        // Coarse quality until the interaction ends or the updates stop.
+        m_coarse = m_coarse_level > 1;
+        m_refine = m_coarse;
+        m_interaction_ended = false;
+        m_idle_timer.start();
+        render = true;
+    }
+    else if ( m_refine && !m_interacting )
+    {
+        m_idle_timer.stop();
+        if ( m_interaction_ended || m_idle_timer.msec() >= m_idle_time )
+        {
+            m_coarse = false;
+            m_refine = false;
+            m_interaction_ended = false;
+            render = true;
+        }
+    }
+
+    if ( !render && m_frame.size() == 0 )
+    {
+        // Render the first frame for the clients.
+        m_coarse = false;
+        render = true;
+    }
+
+    if ( render )
+    {
+        this->applyQuality( m_coarse );
+        this->render( &m_frame, &m_width, &m_height );
+        this->send_frame();
+        return true;
+    }
+
+    // Send the key frame to the new clients and the clients caught up.
+    std::map<id_type,bool>::const_iterator client = m_clients.begin();
+    for ( ; client != m_clients.end(); client++ )
+    {
+        if ( client->second && m_loop.pendingOutputSize( client->first ) == 0 ) { this->send_frame(); return true; }
+    }
+
+    return false;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Registers the new client.
+ *  @param  loop [in] pointer to the event loop
+ *  @param  id [in] socket ID of the client
+ *  @param  address [in] address of the client
+ */
+/*===========================================================================*/
+void RemoteRenderService::acceptEvent( kvs::SocketEventLoop*, const id_type id, const kvs::SocketAddress& )
+{
+    m_clients[ id ] = true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Receives the message from the client.
+ *  @param  loop [in] pointer to the event loop
+ *  @param  id [in] socket ID of the client
+ *  @param  message [in] message
+ */
+/*===========================================================================*/
+void RemoteRenderService::receiveEvent( kvs::SocketEventLoop* loop, const id_type id, const kvs::MessageBlock& message )
+{
+    ::Reader reader( message );
+    kvs::UInt8 type = 0;
+    if ( !reader.get( &type ) ) { return; }
+
+    bool valid = true;
+    switch ( type )
+    {
+    case 'C':
+    {
+        kvs::Vec3 position, look_at, up;
+        valid = reader.get( &position ) && reader.get( &look_at ) && reader.get( &up );
+        if ( valid )
+        {
+            m_position = position;
+            m_look_at = look_at;
+            m_up = up;
+            m_camera_updated = true;
+        }
+        break;
+    }
+    case 'I':
+    {
+        kvs::UInt8 interacting = 0;
+        valid = reader.get( &interacting );
+        if ( valid )
+        {
+            if ( m_interacting && !interacting ) { m_interaction_ended = true; }
+            m_interacting = interacting != 0;
+        }
+        break;
+    }
+    case 'T':
+    {
+        kvs::Real32 min_value = 0.0f, max_value = 0.0f;
+        kvs::UInt32 resolution = 0;
+        valid = reader.get( &min_value ) && reader.get( &max_value ) && reader.get( &resolution );
+        valid = valid && resolution > 0 && reader.remain() == resolution * ( 3 + sizeof( kvs::Real32 ) );
+        if ( valid )
+        {
+            kvs::ColorMap::Table colors( resolution * 3 );
+            kvs::OpacityMap::Table opacities( resolution );
+            for ( size_t i = 0; i < resolution; i++ )
+            {
+                reader.get( &colors[ i * 3 + 0 ] );
+                reader.get( &colors[ i * 3 + 1 ] );
+                reader.get( &colors[ i * 3 + 2 ] );
+                reader.get( &opacities[i] );
+            }
+
+            m_tfunc = kvs::TransferFunction( kvs::ColorMap( colors ), kvs::OpacityMap( opacities ) );
+            if ( min_value < max_value ) { m_tfunc.setRange( min_value, max_value ); }
+            m_tfunc_updated = true;
+        }
+        break;
+    }
+    case 'K':
+    {
+        m_clients[ id ] = true;
+        break;
+    }
+    default:
+        valid = false;
+        break;
+    }
+
+    if ( !valid )
+    {
+        kvsMessageError("Invalid message from the client.");
+        loop->close( id );
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Unregisters the client.
+ *  @param  loop [in] pointer to the event loop
+ *  @param  id [in] socket ID of the client
+ */
+/*===========================================================================*/
+void RemoteRenderService::closeEvent( kvs::SocketEventLoop*, const id_type id )
+{
+    m_clients.erase( id );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Applies the camera sent by the client to the scene.
+ *  @param  position [in] camera position
+ *  @param  look_at [in] look-at point
+ *  @param  up [in] up vector
+ */
+/*===========================================================================*/
+void RemoteRenderService::applyCamera( const kvs::Vec3& position, const kvs::Vec3& look_at, const kvs::Vec3& up )
+{
+    m_scene->camera()->setPosition( position, look_at, up );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Applies the transfer function sent by the client to the volume renderers.
+ *  @param  tfunc [in] transfer function
+ */
+/*===========================================================================*/
+void RemoteRenderService::applyTransferFunction( const kvs::TransferFunction& tfunc )
+{
+    const int size = m_scene->IDManager()->size();
+    for ( int index = 0; index < size; index++ )
+    {
+        const kvs::IDManager::IDPair id = m_scene->IDManager()->id( index );
+        kvs::RendererBase* renderer = m_scene->rendererManager()->renderer( id.second );
+        kvs::VolumeRendererBase* volume_renderer = dynamic_cast<kvs::VolumeRendererBase*>( renderer );
+        if ( volume_renderer ) { volume_renderer->setTransferFunction( tfunc ); }
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets the quality of the renderers.
+ *  @param  coarse [in] if true, the coarse quality (LOD) is used
+ */
+/*===========================================================================*/
+void RemoteRenderService::applyQuality( const bool coarse )
+{
+    const int size = m_scene->IDManager()->size();
+    for ( int index = 0; index < size; index++ )
+    {
+        const kvs::IDManager::IDPair id = m_scene->IDManager()->id( index );
+        kvs::RendererBase* renderer = m_scene->rendererManager()->renderer( id.second );
+        kvs::RayCastingRenderer* ray_caster = dynamic_cast<kvs::RayCastingRenderer*>( renderer );
+        if ( ray_caster )
+        {
+            if ( coarse ) { ray_caster->enableLODControl( m_coarse_level ); }
+            else { ray_caster->disableLODControl(); }
+        }
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Renders the scene and reads the frame.
+ *  @param  frame [out] RGB frame (newly allocated)
+ *  @param  width [out] frame width
+ *  @param  height [out] frame height
+ */
+/*===========================================================================*/
+void RemoteRenderService::render( kvs::ValueArray<kvs::UInt8>* frame, size_t* width, size_t* height )
+{
+    m_scene->paintFunction();
+    kvs::OpenGL::Finish();
+
+    *width = m_scene->camera()->windowWidth();
+    *height = m_scene->camera()->windowHeight();
+    frame->allocate( *width * *height * 3 );
+
+    kvs::OpenGL::SetPixelStorageMode( GL_PACK_ALIGNMENT, GLint( 1 ) );
+    kvs::OpenGL::ReadPixels( 0, 0, GLsizei( *width ), GLsizei( *height ), GL_RGB, GL_UNSIGNED_BYTE, frame->data() );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sends the current frame to the clients.
+ */
+/*===========================================================================*/
+void RemoteRenderService::send_frame()
+{
+    kvs::Timer timer( kvs::Timer::Start );
+
+    const size_t tile_size = kvs::Math::Max( m_tile_size, size_t( 1 ) );
+    const size_t ntiles_x = ( m_width + tile_size - 1 ) / tile_size;
+    const size_t ntiles_y = ( m_height + tile_size - 1 ) / tile_size;
+    const size_t ntiles = ntiles_x * ntiles_y;
+    const bool resized = m_reference.size() != m_frame.size();
+
+    // The frame is skipped for the clients whose previous frames are still
+    // queued, and they receive the key frame when the queue is drained.
+    std::vector<id_type> key_clients;
+    std::vector<id_type> delta_clients;
+    std::map<id_type,bool>::iterator client = m_clients.begin();
+    for ( ; client != m_clients.end(); client++ )
+    {
+        if ( m_loop.pendingOutputSize( client->first ) > 0 ) { client->second = true; }
+        else if ( client->second ) { key_clients.push_back( client->first ); }
+        else { delta_clients.push_back( client->first ); }
+    }
+    const bool key_frame = !key_clients.empty();
+
+    // Detect the changed tiles and encode them (and all the tiles for the key frame).
+    std::vector<char> changed( ntiles, 0 );
+    std::vector< ::Buffer > encoded( ntiles );
+    const kvs::UInt8* frame = m_frame.data();
+    const kvs::UInt8* reference = m_reference.data();
+    KVS_OMP_PARALLEL_FOR( schedule(dynamic) )
+    for ( int i = 0; i < int( ntiles ); i++ )
+    {
+        const size_t x0 = ( i % ntiles_x ) * tile_size;
+        const size_t y0 = ( i / ntiles_x ) * tile_size;
+        const size_t x1 = kvs::Math::Min( x0 + tile_size, m_width );
+        const size_t y1 = kvs::Math::Min( y0 + tile_size, m_height );
+        changed[i] = resized || ::IsChanged( frame, reference, m_width, x0, y0, x1, y1 );
+        if ( changed[i] || key_frame ) { ::EncodeTile( frame, m_width, x0, y0, x1, y1, &encoded[i] ); }
+    }
+
+    // Build the messages of the changed tiles and all the tiles.
+    size_t nchanged = 0;
+    for ( size_t i = 0; i < ntiles; i++ ) { nchanged += changed[i]; }
+
+    const bool send_delta = ( nchanged > 0 || m_coarse != m_coarse_sent ) && !delta_clients.empty();
+
+    // The clients may be closed by the failure of sending.
+    for ( int k = 0; k < 2; k++ )
+    {
+        const bool key = ( k == 1 );
+        if ( ( key && !key_frame ) || ( !key && !send_delta ) ) { continue; }
+
+        ::Buffer header;
+        ::Put8( &header, 'F' );
+        ::Put8( &header, m_coarse ? 0 : 1 );
+        ::Put32( &header, m_frame_number );
+        ::Put32( &header, static_cast<kvs::UInt32>( m_width ) );
+        ::Put32( &header, static_cast<kvs::UInt32>( m_height ) );
+        ::Put32( &header, static_cast<kvs::UInt32>( tile_size ) );
+        ::Put32( &header, static_cast<kvs::UInt32>( key ? ntiles : nchanged ) );
+
+        size_t size = header.size();
+        for ( size_t i = 0; i < ntiles; i++ )
+        {
+            if ( key || changed[i] ) { size += sizeof( kvs::UInt32 ) * 2 + encoded[i].size(); }
+        }
+
+        kvs::ValueArray<kvs::UInt8> data( size );
+        kvs::UInt8* p = data.data();
+        std::memcpy( p, &header[0], header.size() );
+        p += header.size();
+        for ( size_t i = 0; i < ntiles; i++ )
+        {
+            if ( !key && !changed[i] ) { continue; }
+
+            // index(u) codec(1B) size(u) data
+            ::Buffer tile_header;
+            ::Put32( &tile_header, static_cast<kvs::UInt32>( i ) );
+            ::Put8( &tile_header, encoded[i][0] );
+            ::Put32( &tile_header, static_cast<kvs::UInt32>( encoded[i].size() - 1 ) );
+            std::memcpy( p, &tile_header[0], tile_header.size() );
+            p += tile_header.size();
+            std::memcpy( p, &encoded[i][1], encoded[i].size() - 1 );
+            p += encoded[i].size() - 1;
+        }
+
+        // The message references the data until it is sent.
+        const kvs::MessageBlock message( data );
+        const std::vector<id_type>& ids = key ? key_clients : delta_clients;
+        for ( size_t i = 0; i < ids.size(); i++ ) { m_loop.send( ids[i], message ); }
+    }
+
+    for ( size_t i = 0; i < key_clients.size(); i++ )
+    {
+        client = m_clients.find( key_clients[i] );
+        if ( client != m_clients.end() ) { client->second = false; }
+    }
+
+    m_reference = m_frame;
+    m_coarse_sent = m_coarse;
+    m_frame_number++;
+
+    timer.stop();
+    m_encoding_time = timer.msec();
+}
+
+} // end of namespace kvs
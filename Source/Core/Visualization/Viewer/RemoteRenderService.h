@@ -0,0 +1,137 @@
+/*****************************************************************************/
+/**
+ *  @file   RemoteRenderService.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#pragma once
+
+#include <map>
+#include <vector>
+#include <kvs/Type>
+#include <kvs/Vector3>
+#include <kvs/ValueArray>
+#include <kvs/Timer>
+#include <kvs/TransferFunction>
+#include <kvs/SocketEventLoop>
+#include <kvs/SocketTimer>
+
+
+namespace kvs
+{
+
+class Scene;
+
+/*===========================================================================*/
+/**
+ *  @brief  Remote render service streaming the frames of the scene.
+ *
+ *  The clients connected to the port send the camera, the transfer function
+ *  and the interaction state as the messages, and the service renders the
+ *  scene with the latest state and sends the frame to all the clients. The
+ *  frame is divided into the tiles, and only the tiles changed from the
+ *  previous frame are sent (all the tiles are sent to the new clients and
+ *  on request). Each tile is encoded by the horizontal delta of the RGB
+ *  pixels and compressed by kvs::FastCompressor. The frames are skipped for
+ *  the slow clients whose previous frames have not been sent yet, and the
+ *  key frame is sent to them when they catch up.
+ *
+ *  The frames are rendered in the coarse quality (LOD of the renderers)
+ *  during the interaction, and the full quality frame follows when the
+ *  interaction ends or no update is received for the idle time.
+ *
+ *  process() must be called repeatedly in the thread whose OpenGL context
+ *  renders the scene (e.g. from the timer event of a hidden screen).
+ *
+ *  Messages (the integers and the floats in the network byte order):
+ *    client to service:
+ *      'C' position(3f) look_at(3f) up(3f) : camera
+ *      'I' interacting(1B)                 : interaction state
+ *      'T' min(f) max(f) resolution(u) {rgb(3B) opacity(f)}*resolution : transfer function
+ *      'K'                                 : key frame (all tiles) request
+ *    service to client:
+ *      'F' quality(1B, 0: coarse, 1: full) frame(u) width(u) height(u)
+ *          tile_size(u) ntiles(u) {index(u) codec(1B, 0: raw, 1: compressed)
+ *          size(u) data}*ntiles
+ *  The tiles are numbered in the row-major order from the bottom-left, and
+ *  the pixels are the RGB bytes in the bottom-to-top rows.
+ */
+/*===========================================================================*/
+class RemoteRenderService : public kvs::SocketEventLoop::Handler
+{
+public:
+
+    typedef kvs::SocketEventLoop::id_type id_type;
+
+private:
+
+    kvs::Scene* m_scene; ///< scene (not allocated in this class)
+    kvs::SocketEventLoop m_loop; ///< event loop of the clients
+    std::map<id_type,bool> m_clients; ///< clients (true, if the key frame is needed)
+    size_t m_tile_size; ///< tile size in pixels
+    size_t m_coarse_level; ///< LOD level (ray width) of the coarse quality
+    double m_idle_time; ///< idle time to the full quality frame in msec
+    bool m_camera_updated; ///< true, if the camera is updated
+    kvs::Vec3 m_position; ///< camera position
+    kvs::Vec3 m_look_at; ///< camera look-at point
+    kvs::Vec3 m_up; ///< camera up vector
+    bool m_tfunc_updated; ///< true, if the transfer function is updated
+    kvs::TransferFunction m_tfunc; ///< transfer function
+    bool m_interacting; ///< true, if the client is interacting
+    bool m_interaction_ended; ///< true, if the interaction has ended since the last update
+    bool m_refine; ///< true, if the full quality frame is pending
+    kvs::Timer m_idle_timer; ///< timer from the last update
+    size_t m_width; ///< frame width
+    size_t m_height; ///< frame height
+    kvs::ValueArray<kvs::UInt8> m_frame; ///< current frame (RGB)
+    kvs::ValueArray<kvs::UInt8> m_reference; ///< frame sent last (RGB)
+    kvs::UInt32 m_frame_number; ///< number of the frames sent
+    bool m_coarse; ///< true, if the current frame is in the coarse quality
+    bool m_coarse_sent; ///< true, if the frame sent last is in the coarse quality
+    double m_encoding_time; ///< time of encoding the last frame in msec
+
+public:
+
+    RemoteRenderService( kvs::Scene* scene );
+    virtual ~RemoteRenderService();
+
+    size_t numberOfClients() const { return m_clients.size(); }
+    size_t tileSize() const { return m_tile_size; }
+    size_t coarseLevel() const { return m_coarse_level; }
+    double idleTime() const { return m_idle_time; }
+    kvs::UInt32 numberOfFrames() const { return m_frame_number; }
+    double encodingTime() const { return m_encoding_time; }
+
+    void setTileSize( const size_t tile_size ) { m_tile_size = tile_size; }
+    void setCoarseLevel( const size_t level ) { m_coarse_level = level; }
+    void setIdleTime( const double msec ) { m_idle_time = msec; }
+
+    bool listen( const int port );
+    bool process( const kvs::SocketTimer* timeout = 0 );
+
+    void acceptEvent( kvs::SocketEventLoop* loop, const id_type id, const kvs::SocketAddress& address );
+    void receiveEvent( kvs::SocketEventLoop* loop, const id_type id, const kvs::MessageBlock& message );
+    void closeEvent( kvs::SocketEventLoop* loop, const id_type id );
+
+protected:
+
+    kvs::Scene* scene() { return m_scene; }
+
+    virtual void applyCamera( const kvs::Vec3& position, const kvs::Vec3& look_at, const kvs::Vec3& up );
+    virtual void applyTransferFunction( const kvs::TransferFunction& tfunc );
+    virtual void applyQuality( const bool coarse );
+    virtual void render( kvs::ValueArray<kvs::UInt8>* frame, size_t* width, size_t* height );
+
+private:
+
+    void send_frame();
+};
+
+} // end of namespace kvs
@@ -0,0 +1,473 @@
+/*****************************************************************************/
+/**
+ *  @file   TimeStepPlayer.cpp
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#include "TimeStepPlayer.h"
+#include <kvs/Scene>
+#include <kvs/Math>
+#include <kvs/Message>
+#include <kvs/Thread>
+#include <kvs/MutexLocker>
+#include <kvs/ObjectBase>
+#include <kvs/GeometryObjectBase>
+#include <kvs/PolygonObject>
+#include <kvs/LineObject>
+#include <kvs/VolumeObjectBase>
+#include <kvs/UnstructuredVolumeObject>
+
+
+namespace kvs
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Worker thread loading the time steps.
+ */
+/*===========================================================================*/
+class TimeStepPlayer::Worker : public kvs::Thread
+{
+private:
+
+    kvs::TimeStepPlayer* m_player; ///< player
+
+public:
+
+    Worker( kvs::TimeStepPlayer* player ): m_player( player ) {}
+
+    void run() { m_player->work(); }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new TimeStepPlayer class.
+ *  @param  scene [in] pointer to the scene
+ *  @param  object_name [in] name of the object replaced in the scene
+ *  @param  nsteps [in] number of the time steps
+ */
+/*===========================================================================*/
+TimeStepPlayer::TimeStepPlayer( kvs::Scene* scene, const std::string& object_name, const size_t nsteps ):
+    m_scene( scene ),
+    m_object_name( object_name ),
+    m_nsteps( nsteps ),
+    m_nthreads( 2 ),
+    m_nprefetches( 4 ),
+    m_memory_budget( 0 ),
+    m_loop( false ),
+    m_queue( NULL ),
+    m_current_step( 0 ),
+    m_loaded_size( 0 ),
+    m_finished( false ),
+    m_stopping( false )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Destroys the TimeStepPlayer class.
+ *
+ *  Since the workers call load() of the derived class, the derived class
+ *  should call stop() in its destructor.
+ */
+/*===========================================================================*/
+TimeStepPlayer::~TimeStepPlayer()
+{
+    this->stop();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the current step, which is shown by the next update().
+ *  @return current step
+ */
+/*===========================================================================*/
+size_t TimeStepPlayer::currentStep() const
+{
+    kvs::MutexLocker locker( &m_mutex );
+    return m_current_step;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if the last step has been shown (not looped).
+ *  @return true, if the playback is finished
+ */
+/*===========================================================================*/
+bool TimeStepPlayer::isFinished() const
+{
+    kvs::MutexLocker locker( &m_mutex );
+    return m_finished;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if the loading of the step is no longer needed.
+ *  @param  step [in] time step
+ *  @return true, if the step is out of the prefetch window or the player is stopped
+ *
+ *  load() can call this method to stop the long loading early.
+ */
+/*===========================================================================*/
+bool TimeStepPlayer::isCanceled( const size_t step ) const
+{
+    kvs::MutexLocker locker( &m_mutex );
+    return m_stopping || !this->is_in_window( step );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Starts the worker threads.
+ *  @param  step [in] first step
+ *  @return true, if the workers are started
+ */
+/*===========================================================================*/
+bool TimeStepPlayer::start( const size_t step )
+{
+    if ( this->isRunning() )
+    {
+        kvsMessageError( "The player is already running." );
+        return false;
+    }
+
+    if ( m_nsteps == 0 || m_nthreads == 0 || m_nprefetches == 0 )
+    {
+        kvsMessageError( "No steps or no workers to be played." );
+        return false;
+    }
+
+    m_current_step = kvs::Math::Min( step, m_nsteps - 1 );
+    m_finished = false;
+    m_stopping = false;
+    m_queue = new kvs::LockFreeQueue<Result>( 2 * m_nprefetches + m_nthreads );
+
+    for ( size_t i = 0; i < m_nthreads; i++ )
+    {
+        Worker* worker = new Worker( this );
+        m_workers.push_back( worker );
+        worker->start();
+    }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Stops the worker threads and discards the loaded objects.
+ */
+/*===========================================================================*/
+void TimeStepPlayer::stop()
+{
+    if ( !this->isRunning() ) { return; }
+
+    {
+        kvs::MutexLocker locker( &m_mutex );
+        m_stopping = true;
+    }
+    m_condition.wakeUpAll();
+
+    for ( size_t i = 0; i < m_workers.size(); i++ )
+    {
+        m_workers[i]->wait();
+        delete m_workers[i];
+    }
+    m_workers.clear();
+
+    Result result;
+    while ( m_queue->pop( &result ) ) { delete result.object; }
+    delete m_queue;
+    m_queue = NULL;
+
+    std::map<size_t,Result>::iterator loaded = m_loaded.begin();
+    while ( loaded != m_loaded.end() ) { delete loaded->second.object; ++loaded; }
+    m_loaded.clear();
+
+    m_pending.clear();
+    m_loaded_size = 0;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Moves the current step (scrubbing).
+ *  @param  step [in] time step
+ *
+ *  The loaded objects and the loading out of the new prefetch window are
+ *  discarded, and the objects in the window are kept.
+ */
+/*===========================================================================*/
+void TimeStepPlayer::seek( const size_t step )
+{
+    if ( m_nsteps == 0 ) { return; }
+
+    {
+        kvs::MutexLocker locker( &m_mutex );
+        m_current_step = kvs::Math::Min( step, m_nsteps - 1 );
+        m_finished = false;
+    }
+
+    std::map<size_t,Result>::iterator loaded = m_loaded.begin();
+    while ( loaded != m_loaded.end() )
+    {
+        bool keep = false;
+        {
+            kvs::MutexLocker locker( &m_mutex );
+            keep = this->is_in_window( loaded->first );
+        }
+
+        if ( keep ) { ++loaded; continue; }
+
+        this->release( loaded->second );
+        delete loaded->second.object;
+        m_loaded.erase( loaded++ );
+    }
+
+    m_condition.wakeUpAll();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Shows the object of the current step if it has been loaded.
+ *  @return true, if the object in the scene is replaced
+ *
+ *  This method must be called in the scene thread. It never waits for the
+ *  loading, and the current step is advanced only when it is shown.
+ */
+/*===========================================================================*/
+bool TimeStepPlayer::update()
+{
+    if ( !this->isRunning() ) { return false; }
+
+    // Receive the loaded objects.
+    Result result;
+    while ( m_queue->pop( &result ) )
+    {
+        bool keep = false;
+        {
+            kvs::MutexLocker locker( &m_mutex );
+            keep = this->is_in_window( result.step );
+        }
+
+        if ( keep )
+        {
+            m_loaded.insert( std::make_pair( result.step, result ) );
+        }
+        else
+        {
+            this->release( result );
+            delete result.object;
+        }
+    }
+
+    size_t step = 0;
+    {
+        kvs::MutexLocker locker( &m_mutex );
+        if ( m_finished ) { return false; }
+        step = m_current_step;
+    }
+
+    std::map<size_t,Result>::iterator loaded = m_loaded.find( step );
+    if ( loaded == m_loaded.end() ) { return false; }
+
+    result = loaded->second;
+    m_loaded.erase( loaded );
+    if ( result.object )
+    {
+        // The object is registered with the default renderer at first.
+        result.object->setName( m_object_name );
+        if ( m_scene->hasObject( m_object_name ) ) { m_scene->replaceObject( m_object_name, result.object ); }
+        else { m_scene->registerObject( result.object ); }
+    }
+
+    {
+        kvs::MutexLocker locker( &m_mutex );
+        m_pending.erase( result.step );
+        m_loaded_size -= result.size;
+        if ( m_current_step == step )
+        {
+            if ( step + 1 < m_nsteps ) { m_current_step = step + 1; }
+            else if ( m_loop ) { m_current_step = 0; }
+            else { m_finished = true; }
+        }
+    }
+    m_condition.wakeUpAll();
+
+    return result.object != NULL;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the memory size of the object.
+ *  @param  object [in] pointer to the object
+ *  @return memory size in bytes
+ *
+ *  The size of the arrays of the geometry and volume objects is returned by
+ *  default. Override this method for the other objects.
+ */
+/*===========================================================================*/
+size_t TimeStepPlayer::memorySize( const kvs::ObjectBase* object ) const
+{
+    size_t size = 0;
+    if ( const kvs::GeometryObjectBase* geometry = kvs::GeometryObjectBase::DownCast( object ) )
+    {
+        size += geometry->coords().byteSize();
+        size += geometry->colors().byteSize();
+        size += geometry->normals().byteSize();
+        if ( const kvs::PolygonObject* polygon = kvs::PolygonObject::DownCast( geometry ) )
+        {
+            size += polygon->connections().byteSize();
+        }
+        else if ( const kvs::LineObject* line = kvs::LineObject::DownCast( geometry ) )
+        {
+            size += line->connections().byteSize();
+        }
+    }
+    else if ( const kvs::VolumeObjectBase* volume = kvs::VolumeObjectBase::DownCast( object ) )
+    {
+        size += volume->coords().byteSize();
+        size += volume->values().byteSize();
+        if ( const kvs::UnstructuredVolumeObject* unstructured = kvs::UnstructuredVolumeObject::DownCast( volume ) )
+        {
+            size += unstructured->connections().byteSize();
+        }
+    }
+
+    return size;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if the step is in the prefetch window.
+ *  @param  step [in] time step
+ *  @return true, if the step is one of the next steps to be shown
+ *
+ *  The mutex must be locked by the caller.
+ */
+/*===========================================================================*/
+bool TimeStepPlayer::is_in_window( const size_t step ) const
+{
+    if ( m_finished || step >= m_nsteps ) { return false; }
+
+    if ( m_loop )
+    {
+        const size_t offset = ( step + m_nsteps - m_current_step ) % m_nsteps;
+        return offset < m_nprefetches;
+    }
+
+    return step >= m_current_step && step - m_current_step < m_nprefetches;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Finds the next step to be loaded.
+ *  @param  step [out] pointer to the step
+ *  @return true, if the step to be loaded is found
+ *
+ *  The mutex must be locked by the caller.
+ */
+/*===========================================================================*/
+bool TimeStepPlayer::next_step( size_t* step ) const
+{
+    if ( m_finished ) { return false; }
+
+    // The budget is checked for the objects not shown yet. The current step is
+    // loaded regardless of the budget, since the objects loaded in advance
+    // could fill the budget after seeking backward and are never shown before
+    // the current step.
+    const bool over_budget = m_memory_budget > 0 && m_loaded_size >= m_memory_budget;
+
+    const size_t nprefetches = m_loop ? kvs::Math::Min( m_nprefetches, m_nsteps ) : m_nprefetches;
+    for ( size_t i = 0; i < nprefetches; i++ )
+    {
+        size_t s = m_current_step + i;
+        if ( m_loop ) { s %= m_nsteps; }
+        else if ( s >= m_nsteps ) { break; }
+
+        if ( i > 0 && over_budget ) { break; }
+        if ( m_pending.find( s ) == m_pending.end() )
+        {
+            *step = s;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Releases the step of the result from the pending steps.
+ *  @param  result [in] result
+ */
+/*===========================================================================*/
+void TimeStepPlayer::release( const Result& result )
+{
+    {
+        kvs::MutexLocker locker( &m_mutex );
+        m_pending.erase( result.step );
+        m_loaded_size -= result.size;
+    }
+    m_condition.wakeUpAll();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Loads the steps in the worker thread until the player is stopped.
+ */
+/*===========================================================================*/
+void TimeStepPlayer::work()
+{
+    for ( ;; )
+    {
+        size_t step = 0;
+        {
+            kvs::MutexLocker locker( &m_mutex );
+            while ( !m_stopping && !this->next_step( &step ) ) { m_condition.wait( &m_mutex ); }
+            if ( m_stopping ) { return; }
+            m_pending.insert( step );
+        }
+
+        Result result;
+        result.step = step;
+        result.object = this->isCanceled( step ) ? NULL : this->load( step );
+        result.size = result.object ? this->memorySize( result.object ) : 0;
+
+        bool canceled = false;
+        {
+            kvs::MutexLocker locker( &m_mutex );
+            canceled = m_stopping || !this->is_in_window( step );
+            if ( canceled ) { m_pending.erase( step ); }
+            else { m_loaded_size += result.size; }
+        }
+
+        if ( canceled )
+        {
+            delete result.object;
+            m_condition.wakeUpAll();
+            continue;
+        }
+
+        // The queue is full only if the scene thread has not received the
+        // objects discarded by seek().
+        bool pushed = m_queue->push( result );
+        while ( !pushed && !this->isCanceled( step ) )
+        {
+            kvs::Thread::MilliSleep( 1 );
+            pushed = m_queue->push( result );
+        }
+
+        if ( !pushed )
+        {
+            this->release( result );
+            delete result.object;
+        }
+    }
+}
+
+} // end of namespace kvs
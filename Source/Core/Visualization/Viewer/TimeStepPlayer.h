@@ -0,0 +1,142 @@
+/*****************************************************************************/
+/**
+ *  @file   TimeStepPlayer.h
+ */
+/*----------------------------------------------------------------------------
+ *
+ *  Copyright (c) Visualization Laboratory, Kyoto University.
+ *  All rights reserved.
+ *  See http://www.viz.media.kyoto-u.ac.jp/kvs/copyright/ for details.
+ *
+ *  $Id$
+ */
+/*****************************************************************************/
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <kvs/Mutex>
+#include <kvs/Condition>
+#include <kvs/LockFreeQueue>
+
+
+namespace kvs
+{
+
+class Scene;
+class ObjectBase;
+
+/*===========================================================================*/
+/**
+ *  @brief  Player of the time steps prefetched in the background.
+ *
+ *  The worker threads call load() (e.g. the import and the mapping) for the
+ *  steps following the current step, and the loaded objects are handed to
+ *  the scene thread through the lock-free queue. update() is called in the
+ *  scene thread (e.g. from the timer event), and replaces the object of the
+ *  scene with the object of the current step if it has been loaded, so that
+ *  the scene thread never waits for the loading. The objects are named by
+ *  the given name, and the first one is registered with the default
+ *  renderer unless the object of the name has been registered.
+ *
+ *  The steps loaded in advance are limited by the number of the prefetch
+ *  steps and the memory budget (the memory size of the loaded objects not
+ *  yet shown). seek() moves the current step (scrubbing), and the loading
+ *  of the steps out of the new prefetch window are canceled: their objects
+ *  are discarded, and load() can stop early by checking isCanceled().
+ *
+ *  Usage:
+ *    class Player : public kvs::TimeStepPlayer
+ *    {
+ *        ~Player() { this->stop(); }
+ *        kvs::ObjectBase* load( const size_t step )
+ *        {
+ *            kvs::VolumeObjectBase* volume = new kvs::StructuredVolumeImporter( filename( step ) );
+ *            kvs::PolygonObject* object = new kvs::Isosurface( volume, level );
+ *            delete volume;
+ *            return object;
+ *        }
+ *    };
+ *    Player player( screen.scene(), "object", nsteps );
+ *    player.start();
+ *    ... player.update(); screen.redraw(); ... (in the timer event)
+ */
+/*===========================================================================*/
+class TimeStepPlayer
+{
+private:
+
+    class Worker;
+
+    /// Object of the step handed to the scene thread.
+    struct Result
+    {
+        size_t step; ///< time step
+        kvs::ObjectBase* object; ///< loaded object (NULL if the loading is failed)
+        size_t size; ///< memory size of the object in bytes
+    };
+
+    kvs::Scene* m_scene; ///< scene (not allocated in this class)
+    std::string m_object_name; ///< name of the object replaced in the scene
+    size_t m_nsteps; ///< number of the time steps
+    size_t m_nthreads; ///< number of the worker threads
+    size_t m_nprefetches; ///< number of the steps loaded in advance
+    size_t m_memory_budget; ///< memory budget in bytes (0: unlimited)
+    bool m_loop; ///< true, if the playback is looped
+    std::vector<Worker*> m_workers; ///< worker threads
+    kvs::LockFreeQueue<Result>* m_queue; ///< queue of the loaded objects
+    std::map<size_t,Result> m_loaded; ///< loaded objects received by the scene thread
+    mutable kvs::Mutex m_mutex; ///< mutex for the following members
+    kvs::Condition m_condition; ///< condition to wake up the workers
+    size_t m_current_step; ///< current step (to be shown next)
+    std::set<size_t> m_pending; ///< steps being loaded or not shown yet
+    size_t m_loaded_size; ///< memory size of the loaded objects not shown yet
+    bool m_finished; ///< true, if the last step has been shown (not looped)
+    bool m_stopping; ///< true, if the workers are being stopped
+
+public:
+
+    TimeStepPlayer( kvs::Scene* scene, const std::string& object_name, const size_t nsteps );
+    virtual ~TimeStepPlayer();
+
+    size_t numberOfSteps() const { return m_nsteps; }
+    size_t numberOfThreads() const { return m_nthreads; }
+    size_t numberOfPrefetchSteps() const { return m_nprefetches; }
+    size_t memoryBudget() const { return m_memory_budget; }
+    bool isLoop() const { return m_loop; }
+    bool isRunning() const { return !m_workers.empty(); }
+    size_t currentStep() const;
+    bool isFinished() const;
+    bool isCanceled( const size_t step ) const;
+
+    void setNumberOfThreads( const size_t nthreads ) { m_nthreads = nthreads; }
+    void setNumberOfPrefetchSteps( const size_t nprefetches ) { m_nprefetches = nprefetches; }
+    void setMemoryBudget( const size_t bytes ) { m_memory_budget = bytes; }
+    void setLoop( const bool loop ) { m_loop = loop; }
+
+    bool start( const size_t step = 0 );
+    void stop();
+    void seek( const size_t step );
+    bool update();
+
+protected:
+
+    kvs::Scene* scene() { return m_scene; }
+
+    virtual kvs::ObjectBase* load( const size_t step ) = 0;
+    virtual size_t memorySize( const kvs::ObjectBase* object ) const;
+
+private:
+
+    bool is_in_window( const size_t step ) const;
+    bool next_step( size_t* step ) const;
+    void release( const Result& result );
+    void work();
+
+    TimeStepPlayer( const TimeStepPlayer& );
+    TimeStepPlayer& operator =( const TimeStepPlayer& );
+};
+
+} // end of namespace kvs